@@ -49,7 +49,8 @@ int main(int argc, char const *argv[]) {
 		return 1;
 	}
 
-	RzDemangleOpts opts = RZ_DEMANGLE_OPT_BASE;
+	// the cli covers gnu v2 and bare types too
+	RzDemangleOpts opts = RZ_DEMANGLE_OPT_CXX_V2_FALLBACK | RZ_DEMANGLE_OPT_CXX_TYPE_FALLBACK;
 	const char *lang = argv[1];
 	const char *symbol = argv[2];
 
@@ -5,6 +5,9 @@
 #ifndef RZ_LIBDEMANGLE_H
 #define RZ_LIBDEMANGLE_H
 
+#include <stddef.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -20,9 +23,169 @@ extern "C" {
 typedef enum {
 	RZ_DEMANGLE_OPT_BASE = 0,
 	RZ_DEMANGLE_OPT_SIMPLIFY = (1 << 0),
+	RZ_DEMANGLE_OPT_CXX_V2_FALLBACK = (1 << 1), ///< C++: try GNU v2 on plausible symbols without `_Z`
+	RZ_DEMANGLE_OPT_CXX_TYPE_FALLBACK = (1 << 2), ///< C++: try bare Itanium types, like `PKc`, when nothing else matched
 	RZ_DEMANGLE_OPT_ENABLE_ALL = 0xFFFF,
+	// flags below reduce the output, so they are not part of RZ_DEMANGLE_OPT_ENABLE_ALL
+	RZ_DEMANGLE_OPT_MSVC_NO_STRING_LITERAL = (1 << 16), ///< MSVC: emit `string' instead of the literal content
+	RZ_DEMANGLE_OPT_MSVC_NAME_ONLY = (1 << 17), ///< MSVC: emit only the qualified name of the symbol
+	RZ_DEMANGLE_OPT_MSVC_NO_ACCESS_SPECIFIER = (1 << 18), ///< MSVC: omit public/private/protected (with static, virtual and [thunk])
+	RZ_DEMANGLE_OPT_MSVC_NO_CALLING_CONVENTION = (1 << 19), ///< MSVC: omit the calling convention of functions
+	RZ_DEMANGLE_OPT_MSVC_NO_RETURN_TYPE = (1 << 20), ///< MSVC: omit the return type of functions
+	RZ_DEMANGLE_OPT_RUST_NO_GENERICS = (1 << 21), ///< Rust v0: omit generic arguments
 } RzDemangleOpts;
 
+/**
+ * Allocator used for every allocation made by the library, including the
+ * strings returned by the handlers. When a custom allocator is installed the
+ * returned strings must be released with libdemangle_free().
+ */
+typedef struct {
+	void *(*malloc)(void *user, size_t size);
+	void *(*calloc)(void *user, size_t count, size_t size);
+	void *(*realloc)(void *user, void *ptr, size_t size);
+	void (*free)(void *user, void *ptr);
+	void *user; ///< passed as first argument to every callback
+} RzDemangleAllocator;
+
+/**
+ * Allocation statistics of the calling thread, collected between
+ * libdemangle_stats_reset() and libdemangle_stats_get().
+ */
+typedef struct {
+	size_t allocations; ///< number of malloc/calloc/realloc calls
+	size_t frees; ///< number of free calls
+	size_t bytes; ///< total amount of requested bytes
+	size_t live; ///< bytes currently allocated
+	size_t peak; ///< highest value reached by live
+} RzDemangleAllocStats;
+
+DEM_LIB_EXPORT void libdemangle_set_allocator(const RzDemangleAllocator *allocator);
+DEM_LIB_EXPORT const RzDemangleAllocator *libdemangle_set_thread_allocator(const RzDemangleAllocator *allocator);
+DEM_LIB_EXPORT void libdemangle_free(void *ptr);
+DEM_LIB_EXPORT void libdemangle_stats_enable(bool enable);
+DEM_LIB_EXPORT void libdemangle_stats_reset(void);
+DEM_LIB_EXPORT void libdemangle_stats_get(RzDemangleAllocStats *stats);
+
+/**
+ * Limits applied to every call of the C++ (v2, v3), Rust, MSVC, D and
+ * ObjC handlers made by the calling thread. A zero field means no limit.
+ */
+typedef struct {
+	size_t max_nodes; ///< parsed entities: AST nodes, parameters, back-reference expansions
+	size_t max_output; ///< bytes written to the output buffers
+	size_t max_steps; ///< parser rule invocations
+} RzDemangleBudget;
+
+typedef enum {
+	RZ_DEMANGLE_STATUS_OK = 0, ///< the symbol was demangled
+	RZ_DEMANGLE_STATUS_FAILED, ///< the symbol could not be demangled
+	RZ_DEMANGLE_STATUS_BUDGET_EXCEEDED, ///< the call was stopped by the RzDemangleBudget limits
+} RzDemangleStatus;
+
+DEM_LIB_EXPORT void libdemangle_set_budget(const RzDemangleBudget *budget);
+DEM_LIB_EXPORT RzDemangleStatus libdemangle_last_status(void);
+
+/**
+ * Counters of the negative-result filter of the calling thread, see
+ * libdemangle_negative_filter_enable().
+ */
+typedef struct {
+	size_t bits; ///< size of the filter, 0 when disabled
+	size_t insertions; ///< failures recorded since the filter was last cleared
+	size_t hits; ///< calls answered by the filter without parsing
+	size_t saturations; ///< times the filter was full and has been cleared
+} RzDemangleNegativeStats;
+
+DEM_LIB_EXPORT bool libdemangle_negative_filter_enable(size_t bits);
+DEM_LIB_EXPORT void libdemangle_negative_filter_reset(void);
+DEM_LIB_EXPORT void libdemangle_negative_filter_stats(RzDemangleNegativeStats *stats);
+
+typedef enum {
+	RZ_DEMANGLE_RUST_SPAN_CRATE = 0, ///< name of a crate root
+	RZ_DEMANGLE_RUST_SPAN_DISAMBIGUATOR, ///< crate disambiguator hash, like `[4d2]`
+	RZ_DEMANGLE_RUST_SPAN_SEGMENT, ///< path segment after `::`, like `foo` or `{closure#0}`
+	RZ_DEMANGLE_RUST_SPAN_GENERIC_ARGS, ///< generic arguments, from `<` to `>`
+} RzDemangleRustSpanKind;
+
+/**
+ * Part of a demangled Rust v0 symbol.
+ */
+typedef struct {
+	RzDemangleRustSpanKind kind;
+	size_t offset; ///< position within RzDemangleRustSymbol.demangled
+	size_t length;
+	size_t depth; ///< number of generic argument lists enclosing the span
+} RzDemangleRustSpan;
+
+/**
+ * Demangled Rust v0 symbol with the position of its parts. Spans are
+ * sorted by offset; enclosing spans come before the ones they contain.
+ */
+typedef struct {
+	char *demangled;
+	RzDemangleRustSpan *spans;
+	size_t n_spans;
+} RzDemangleRustSymbol;
+
+DEM_LIB_EXPORT RzDemangleRustSymbol *libdemangle_rust_v0_symbol(const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT void libdemangle_rust_symbol_free(RzDemangleRustSymbol *symbol);
+
+typedef enum {
+	RZ_DEMANGLE_SCHEME_UNKNOWN = 0,
+	RZ_DEMANGLE_SCHEME_CXX, ///< Itanium (`_Z`, `__Z`) and GNU v2 C++
+	RZ_DEMANGLE_SCHEME_RUST_LEGACY, ///< Rust `_ZN...E` with hash or `$` escapes
+	RZ_DEMANGLE_SCHEME_RUST_V0, ///< Rust `_R`
+	RZ_DEMANGLE_SCHEME_MSVC, ///< `?` and `.?`
+	RZ_DEMANGLE_SCHEME_BORLAND, ///< Borland/Delphi `@`
+	RZ_DEMANGLE_SCHEME_D, ///< `_D`
+	RZ_DEMANGLE_SCHEME_SWIFT, ///< `$s`, `_T`
+	RZ_DEMANGLE_SCHEME_JAVA, ///< `L...;` descriptors
+	RZ_DEMANGLE_SCHEME_OBJC, ///< `_OBJC_`, `+[`, `-[`
+	RZ_DEMANGLE_SCHEME_PASCAL, ///< Free Pascal `$$`
+	RZ_DEMANGLE_SCHEME_MAX,
+} RzDemangleScheme;
+
+DEM_LIB_EXPORT RzDemangleScheme libdemangle_classify(const char *symbol);
+DEM_LIB_EXPORT char *libdemangle_auto(const char *symbol, RzDemangleOpts opts, RzDemangleScheme *scheme);
+
+/**
+ * Counters of a RzDemangleBatch, indexed by RzDemangleScheme.
+ */
+typedef struct {
+	size_t symbols; ///< symbols passed to libdemangle_batch_demangle()
+	size_t demangled; ///< symbols that were demangled
+	size_t sampled; ///< symbols that voted
+	size_t votes[RZ_DEMANGLE_SCHEME_MAX]; ///< classification of the sampled symbols
+	size_t attempts[RZ_DEMANGLE_SCHEME_MAX]; ///< engine invocations
+	size_t successes[RZ_DEMANGLE_SCHEME_MAX]; ///< engine invocations that demangled the symbol
+} RzDemangleBatchStats;
+
+typedef struct rz_demangle_batch_t RzDemangleBatch;
+
+DEM_LIB_EXPORT RzDemangleBatch *libdemangle_batch_new(size_t sample_size, RzDemangleOpts opts);
+DEM_LIB_EXPORT void libdemangle_batch_free(RzDemangleBatch *batch);
+DEM_LIB_EXPORT char *libdemangle_batch_demangle(RzDemangleBatch *batch, const char *symbol, RzDemangleScheme *scheme);
+DEM_LIB_EXPORT void libdemangle_batch_stats(const RzDemangleBatch *batch, RzDemangleBatchStats *stats);
+
+/**
+ * Counters of a RzDemangleJavaBatch.
+ */
+typedef struct {
+	size_t symbols; ///< symbols passed to libdemangle_java_batch_demangle()
+	size_t types; ///< distinct class descriptors demangled
+	size_t type_hits; ///< class descriptors reused from an earlier symbol
+	size_t protos; ///< distinct `(args)ret` protos demangled
+	size_t proto_hits; ///< protos reused from an earlier symbol
+} RzDemangleJavaBatchStats;
+
+typedef struct rz_demangle_java_batch_t RzDemangleJavaBatch;
+
+DEM_LIB_EXPORT RzDemangleJavaBatch *libdemangle_java_batch_new(RzDemangleOpts opts);
+DEM_LIB_EXPORT void libdemangle_java_batch_free(RzDemangleJavaBatch *batch);
+DEM_LIB_EXPORT char *libdemangle_java_batch_demangle(RzDemangleJavaBatch *batch, const char *symbol);
+DEM_LIB_EXPORT void libdemangle_java_batch_stats(const RzDemangleJavaBatch *batch, RzDemangleJavaBatchStats *stats);
+
 DEM_LIB_EXPORT char *libdemangle_handler_cxx(const char *symbol, RzDemangleOpts opts);
 DEM_LIB_EXPORT char *libdemangle_handler_rust(const char *symbol, RzDemangleOpts opts);
 
@@ -32,6 +195,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *symbol, RzDemangleOpt
 
 DEM_LIB_EXPORT char *libdemangle_handler_java(const char *symbol, RzDemangleOpts opts);
 DEM_LIB_EXPORT char *libdemangle_handler_msvc(const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT char *libdemangle_handler_msvc_n(const char *symbol, size_t length, RzDemangleOpts opts);
 DEM_LIB_EXPORT char *libdemangle_handler_objc(const char *symbol, RzDemangleOpts opts);
 DEM_LIB_EXPORT char *libdemangle_handler_pascal(const char *symbol, RzDemangleOpts opts);
 DEM_LIB_EXPORT char *libdemangle_handler_d(const char *mangled, RzDemangleOpts opts);
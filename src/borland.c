@@ -16,55 +16,206 @@ typedef struct borland_repl_s {
 	size_t str_len;
 } borland_repl_t;
 
-borland_repl_t cxx_operators[] = {
-	borland_cxx_operator("bxor", "operator^"),
-	borland_cxx_operator("bsubs", "operator[]"),
-	borland_cxx_operator("bsub", "operator-"),
-	borland_cxx_operator("brxor", "operator^="),
-	borland_cxx_operator("brsh", "operator>>"),
-	borland_cxx_operator("brrsh", "operator>>="),
-	borland_cxx_operator("brplu", "operator+="),
-	borland_cxx_operator("bror", "operator|="),
-	borland_cxx_operator("brmul", "operator*="),
-	borland_cxx_operator("brmod", "operator%="),
-	borland_cxx_operator("brmin", "operator-="),
-	borland_cxx_operator("brlsh", "operator<<="),
-	borland_cxx_operator("brdiv", "operator/="),
-	borland_cxx_operator("brand", "operator&="),
-	borland_cxx_operator("bor", "operator|"),
-	borland_cxx_operator("bnot", "operator!"),
-	borland_cxx_operator("bneq", "operator!="),
-	borland_cxx_operator("bmul", "operator*"),
-	borland_cxx_operator("bmod", "operator%"),
-	borland_cxx_operator("blss", "operator<"),
-	borland_cxx_operator("blsh", "operator<<"),
-	borland_cxx_operator("blor", "operator||"),
-	borland_cxx_operator("bleq", "operator<="),
-	borland_cxx_operator("bland", "operator&&"),
-	borland_cxx_operator("bind", "operator*"),
-	borland_cxx_operator("binc", "operator++"),
-	borland_cxx_operator("bgtr", "operator>"),
-	borland_cxx_operator("bgeq", "operator>="),
-	borland_cxx_operator("beql", "operator=="),
-	borland_cxx_operator("bdiv", "operator/"),
-	borland_cxx_operator("bdec", "operator--"),
-	borland_cxx_operator("bcoma", "operator,"),
-	borland_cxx_operator("bcmp", "operator~"),
-	borland_cxx_operator("bcall", "operator()"),
-	borland_cxx_operator("basg", "operator="),
-	borland_cxx_operator("barwm", "operator->*"),
-	borland_cxx_operator("barow", "operator->"),
-	borland_cxx_operator("band", "operator&"),
-	borland_cxx_operator("badr", "operator&"),
-	borland_cxx_operator("badd", "operator+"),
-};
-
-borland_repl_t cxx_mem_operators[] = {
-	borland_cxx_operator("bnew", "operator new(unsigned int)"),
-	borland_cxx_operator("bnwa", "operator new[](unsigned int)"),
-	borland_cxx_operator("bdele", "operator delete(void *)"),
-	borland_cxx_operator("bdla", "operator delete[](void *)"),
-};
+/**
+ * Types declared by the template arguments and the parameters, referenced
+ * later by `t` followed by their 1-based index.
+ */
+typedef struct borland_types_s {
+	char **data;
+	size_t length;
+	size_t capacity;
+} borland_types_t;
+
+/* returns from the enclosing function when `begin` starts with the operator code */
+#define borland_try_operator(pfx, op) \
+	do { \
+		if (!strncmp(begin, pfx, sizeof(pfx) - 1)) { \
+			*repl = (borland_repl_t)borland_cxx_operator(pfx, op); \
+			return true; \
+		} \
+	} while (0)
+
+/**
+ * \brief Matches the `b*` operator codes, e.g. `badd` or `bsubs`.
+ *
+ * The switches are a prefix trie on the two characters following `b`,
+ * each leaf compares at most two codes, the longest one first.
+ *
+ * \param begin   Code to match, NUL-terminated
+ * \param repl    Filled with the operator on success
+ * \param is_mem  Set for new/delete, which take no other name part
+ *
+ * \return true when an operator has been matched
+ */
+static bool borland_delphi_operator(const char *begin, borland_repl_t *repl, bool *is_mem) {
+	if (begin[0] != 'b') {
+		return false;
+	}
+	*is_mem = false;
+	switch (begin[1]) {
+	case 'a':
+		switch (begin[2]) {
+		case 'd':
+			borland_try_operator("badd", "operator+");
+			borland_try_operator("badr", "operator&");
+			break;
+		case 'n':
+			borland_try_operator("band", "operator&");
+			break;
+		case 'r':
+			borland_try_operator("barow", "operator->");
+			borland_try_operator("barwm", "operator->*");
+			break;
+		case 's':
+			borland_try_operator("basg", "operator=");
+			break;
+		}
+		break;
+	case 'c':
+		switch (begin[2]) {
+		case 'a':
+			borland_try_operator("bcall", "operator()");
+			break;
+		case 'm':
+			borland_try_operator("bcmp", "operator~");
+			break;
+		case 'o':
+			borland_try_operator("bcoma", "operator,");
+			break;
+		}
+		break;
+	case 'd':
+		switch (begin[2]) {
+		case 'e':
+			*is_mem = begin[3] == 'l';
+			borland_try_operator("bdele", "operator delete(void *)");
+			borland_try_operator("bdec", "operator--");
+			break;
+		case 'i':
+			borland_try_operator("bdiv", "operator/");
+			break;
+		case 'l':
+			*is_mem = true;
+			borland_try_operator("bdla", "operator delete[](void *)");
+			break;
+		}
+		break;
+	case 'e':
+		borland_try_operator("beql", "operator==");
+		break;
+	case 'g':
+		borland_try_operator("bgeq", "operator>=");
+		borland_try_operator("bgtr", "operator>");
+		break;
+	case 'i':
+		borland_try_operator("binc", "operator++");
+		borland_try_operator("bind", "operator*");
+		break;
+	case 'l':
+		switch (begin[2]) {
+		case 'a':
+			borland_try_operator("bland", "operator&&");
+			break;
+		case 'e':
+			borland_try_operator("bleq", "operator<=");
+			break;
+		case 'o':
+			borland_try_operator("blor", "operator||");
+			break;
+		case 's':
+			borland_try_operator("blsh", "operator<<");
+			borland_try_operator("blss", "operator<");
+			break;
+		}
+		break;
+	case 'm':
+		borland_try_operator("bmod", "operator%");
+		borland_try_operator("bmul", "operator*");
+		break;
+	case 'n':
+		switch (begin[2]) {
+		case 'e':
+			*is_mem = begin[3] == 'w';
+			borland_try_operator("bnew", "operator new(unsigned int)");
+			borland_try_operator("bneq", "operator!=");
+			break;
+		case 'o':
+			borland_try_operator("bnot", "operator!");
+			break;
+		case 'w':
+			*is_mem = true;
+			borland_try_operator("bnwa", "operator new[](unsigned int)");
+			break;
+		}
+		break;
+	case 'o':
+		borland_try_operator("bor", "operator|");
+		break;
+	case 'r':
+		switch (begin[2]) {
+		case 'a':
+			borland_try_operator("brand", "operator&=");
+			break;
+		case 'd':
+			borland_try_operator("brdiv", "operator/=");
+			break;
+		case 'l':
+			borland_try_operator("brlsh", "operator<<=");
+			break;
+		case 'm':
+			borland_try_operator("brmin", "operator-=");
+			borland_try_operator("brmod", "operator%=");
+			borland_try_operator("brmul", "operator*=");
+			break;
+		case 'o':
+			borland_try_operator("bror", "operator|=");
+			break;
+		case 'p':
+			borland_try_operator("brplu", "operator+=");
+			break;
+		case 'r':
+			borland_try_operator("brrsh", "operator>>=");
+			break;
+		case 's':
+			borland_try_operator("brsh", "operator>>");
+			break;
+		case 'x':
+			borland_try_operator("brxor", "operator^=");
+			break;
+		}
+		break;
+	case 's':
+		borland_try_operator("bsubs", "operator[]");
+		borland_try_operator("bsub", "operator-");
+		break;
+	case 'x':
+		borland_try_operator("bxor", "operator^");
+		break;
+	}
+	*is_mem = false;
+	return false;
+}
+
+static bool borland_types_append(borland_types_t *types, char *type) {
+	if (types->length == types->capacity) {
+		size_t capacity = types->capacity ? types->capacity * 2 : 8;
+		char **data = dem_realloc(types->data, capacity * sizeof(char *));
+		if (!data) {
+			return false;
+		}
+		types->data = data;
+		types->capacity = capacity;
+	}
+	types->data[types->length++] = type;
+	return true;
+}
+
+static void borland_types_fini(borland_types_t *types) {
+	for (size_t i = 0; i < types->length; i++) {
+		dem_free(types->data[i]);
+	}
+	dem_free(types->data);
+}
 
 bool borland_delphi_procedure_call_type(DemString *ds, const char *begin, const char *end) {
 	if (begin >= end) {
@@ -221,7 +372,7 @@ char *borland_delphi_custom_type(const char *begin, const char *end, const char
 				dem_string_appends(ds, ", ");
 			}
 			dem_string_append(ds, subtype);
-			free(subtype);
+			dem_free(subtype);
 			first_type = false;
 			type_beg = begin;
 			begin--;
@@ -277,7 +428,7 @@ char *borland_delphi_custom_type(const char *begin, const char *end, const char
 				goto fail;
 			}
 			dem_string_append(ds, subtype);
-			free(subtype);
+			dem_free(subtype);
 			type_beg = begin;
 			begin--;
 			first_type = false;
@@ -346,14 +497,14 @@ char *borland_delphi_array(const char *begin, const char *end, const char **left
 				goto fail;
 			}
 			dem_string_appends_prefix(ds, ctype);
-			free(ctype);
+			dem_free(ctype);
 		} else {
 			char *ctype = borland_delphi_basic_type(begin, end, &begin);
 			if (!ctype) {
 				goto fail;
 			}
 			dem_string_appends_prefix(ds, ctype);
-			free(ctype);
+			dem_free(ctype);
 		}
 		break;
 	}
@@ -433,21 +584,21 @@ char *borland_delphi_type(const char *begin, const char *end, const char **lefto
 				goto fail;
 			}
 			dem_string_append(prefix, ctype);
-			free(ctype);
+			dem_free(ctype);
 		} else if (begin[0] == 'a') {
 			ctype = borland_delphi_array(begin + 1, end, &begin);
 			if (!ctype) {
 				goto fail;
 			}
 			dem_string_append(prefix, ctype);
-			free(ctype);
+			dem_free(ctype);
 		} else {
 			ctype = borland_delphi_basic_type(begin, end, &begin);
 			if (!ctype) {
 				goto fail;
 			}
 			dem_string_append(prefix, ctype);
-			free(ctype);
+			dem_free(ctype);
 		}
 		break;
 	}
@@ -478,7 +629,7 @@ char *borland_delphi_type(const char *begin, const char *end, const char **lefto
 			}
 			dem_string_appends_prefix(prefix, " ");
 			dem_string_appends_prefix(prefix, type);
-			free(type);
+			dem_free(type);
 		}
 	} else {
 		if (is_reference) {
@@ -589,7 +740,7 @@ bool borland_delphi_class(DemString *ds, const char *begin, const char *end, con
 	return true;
 }
 
-const char *borland_delphi_get_type(DemList *types, const char *begin, const char *end, const char **leftovers) {
+const char *borland_delphi_get_type(const borland_types_t *types, const char *begin, const char *end, const char **leftovers) {
 	size_t idx = 10;
 	if (IS_LOWER(begin[0])) {
 		// offset +10
@@ -598,10 +749,10 @@ const char *borland_delphi_get_type(DemList *types, const char *begin, const cha
 	} else {
 		idx = borland_delphi_parse_len(begin, end, leftovers);
 	}
-	if (idx < 1) {
+	if (idx < 1 || idx > types->length) {
 		return NULL;
 	}
-	return (const char *)dem_list_get_n(types, idx - 1);
+	return types->data[idx - 1];
 }
 
 /**
@@ -624,10 +775,10 @@ char *demangle_borland_delphi(const char *mangled) {
 	bool is_template = false;
 	const char *begin = mangled + 1, *tmp = NULL;
 	const char *end = mangled + mangled_len;
-	DemList *types = dem_list_newf(free);
+	borland_types_t types = { 0 };
 	DemString *prefix = dem_string_new();
 	DemString *suffix = dem_string_new();
-	if (!prefix || !suffix || !types) {
+	if (!prefix || !suffix) {
 		goto demangle_fail;
 	}
 
@@ -655,30 +806,22 @@ char *demangle_borland_delphi(const char *mangled) {
 	dem_string_append_n(prefix, begin, tmp - begin);
 	begin = tmp + 1;
 
-	for (size_t k = 0; k < RZ_ARRAY_SIZE(cxx_mem_operators); ++k) {
-		borland_repl_t *op = &cxx_mem_operators[k];
-		if (!strncmp(begin, op->pfx, op->pfx_len)) {
-			dem_string_append_n(prefix, op->str, op->str_len);
-			begin += op->pfx_len;
+	borland_repl_t op;
+	bool is_mem_op;
+	if (borland_delphi_operator(begin, &op, &is_mem_op)) {
+		dem_string_append_n(prefix, op.str, op.str_len);
+		begin += op.pfx_len;
+		if (is_mem_op) {
 			goto finish;
 		}
-	}
-
-	for (size_t k = 0; k < RZ_ARRAY_SIZE(cxx_operators); ++k) {
-		borland_repl_t *op = &cxx_operators[k];
-		if (!strncmp(begin, op->pfx, op->pfx_len)) {
-			dem_string_append_n(prefix, op->str, op->str_len);
-			begin += op->pfx_len;
-			if (!(begin = strchr(begin, '$'))) {
-				dem_string_appends(prefix, "()");
-				if (begin < end) {
-					dem_string_append_n(prefix, begin, end - begin);
-				}
-				goto finish;
+		if (!(begin = strchr(begin, '$'))) {
+			dem_string_appends(prefix, "()");
+			if (begin < end) {
+				dem_string_append_n(prefix, begin, end - begin);
 			}
-			begin++;
-			break;
+			goto finish;
 		}
+		begin++;
 	}
 
 	if (is_template) {
@@ -688,7 +831,7 @@ char *demangle_borland_delphi(const char *mangled) {
 				dem_string_appends(prefix, ", ");
 			}
 			if (begin[0] == 't') {
-				const char *ctype = borland_delphi_get_type(types, begin + 1, end, &begin);
+				const char *ctype = borland_delphi_get_type(&types, begin + 1, end, &begin);
 				if (!ctype) {
 					goto demangle_fail;
 				}
@@ -700,10 +843,11 @@ char *demangle_borland_delphi(const char *mangled) {
 					goto demangle_fail;
 				}
 				dem_string_append(prefix, type);
-				if (is_custom) {
-					dem_list_append(types, type);
-				} else {
-					free(type);
+				if (!is_custom) {
+					dem_free(type);
+				} else if (!borland_types_append(&types, type)) {
+					dem_free(type);
+					goto demangle_fail;
 				}
 			}
 		}
@@ -749,7 +893,7 @@ char *demangle_borland_delphi(const char *mangled) {
 				goto demangle_fail;
 			}
 			dem_string_appendf(prefix, "operator %s", tmp);
-			free((void *)tmp);
+			dem_free((void *)tmp);
 			continue;
 		case 'q':
 			goto procedure;
@@ -777,7 +921,7 @@ procedure:
 			}
 			continue; // we haven't appended yet any arg type
 		} else if (tmp[0] == 't') {
-			const char *ctype = borland_delphi_get_type(types, tmp + 1, end, &tmp);
+			const char *ctype = borland_delphi_get_type(&types, tmp + 1, end, &tmp);
 			if (!ctype) {
 				goto demangle_fail;
 			}
@@ -790,10 +934,11 @@ procedure:
 				goto demangle_fail;
 			}
 			dem_string_append(prefix, type);
-			if (is_custom) {
-				dem_list_append(types, type);
-			} else {
-				free(type);
+			if (!is_custom) {
+				dem_free(type);
+			} else if (!borland_types_append(&types, type)) {
+				dem_free(type);
+				goto demangle_fail;
 			}
 			tmp--;
 		}
@@ -809,7 +954,7 @@ procedure:
 		}
 		dem_string_appends_prefix(prefix, " ");
 		dem_string_appends_prefix(prefix, type);
-		free(type);
+		dem_free(type);
 	}
 
 	begin = tmp;
@@ -817,12 +962,12 @@ procedure:
 finish:
 	dem_string_concat(prefix, suffix);
 	dem_string_free(suffix);
-	dem_list_free(types);
+	borland_types_fini(&types);
 	return dem_string_drain(prefix);
 
 demangle_fail:
 	dem_string_free(prefix);
 	dem_string_free(suffix);
-	dem_list_free(types);
+	borland_types_fini(&types);
 	return NULL;
 }
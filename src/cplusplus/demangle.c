@@ -4,6 +4,69 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 
 #include "demangle.h"
+#include "../demangler_util.h"
+
+/**
+ * \brief Tells if the symbol may be a GNU v2 encoding.
+ *
+ * GNU v2 names are `<name>__<signature>`, constructors, type infos and
+ * thunks starting with `__`, or one of the special names: `_vt`,
+ * `_GLOBAL_$`, destructors (`_$_`, `_._`) and qualified static members
+ * (`_Q2...$bar`, `_3foo$bar`). The check is a single scan without
+ * allocations, thus plain C names are rejected before \ref cp_demangle_v2.
+ *
+ * \param mangled NUL-terminated symbol string. Must not be NULL.
+ * \return false when \ref cp_demangle_v2 cannot accept the symbol.
+ */
+bool cp_demangle_v2_plausible(const char *mangled) {
+	const char *p = mangled;
+	bool needs_term = false;
+	if (p[0] == '_' && p[1] != '_') {
+		if (!strncmp(p + 1, "vt", 2) || !strncmp(p + 1, "GLOBAL_$", 8) ||
+			((p[1] == '$' || p[1] == '.') && p[2] == '_')) {
+			return true;
+		}
+		// _ <qualifiers list> <list term> <name>
+		needs_term = IS_DIGIT(p[1]) || p[1] == 'Q' || p[1] == 't';
+	} else if (p[0] == '_' && p[1] == '_') {
+		if (IS_DIGIT(p[2]) || (p[2] && strchr("QtvG", p[2]))) {
+			return true;
+		}
+		// operators are followed by another `__`
+		p += 2;
+	}
+
+	for (; *p; p++) {
+		if (p[0] == '_' && p[1] == '_' && p > mangled) {
+			return true;
+		} else if (needs_term && (*p == '$' || *p == '.')) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief Tells if the symbol may be a bare Itanium type.
+ *
+ * Builtin types are a single lowercase letter, anything longer must start
+ * with a qualifier, a pointer or reference, a vendor type, a name or an
+ * uppercase production. Only the prefix is looked at.
+ *
+ * \param mangled NUL-terminated symbol string. Must not be NULL.
+ * \return false when \ref cp_demangle_v3_type cannot accept the symbol.
+ */
+bool cp_demangle_v3_type_plausible(const char *mangled) {
+	const char *p = mangled;
+	// qualifiers, pointers and references only wrap another type
+	while (*p && strchr("PROCGKVr", *p)) {
+		p++;
+	}
+	if (IS_UPPER(*p) || IS_DIGIT(*p) || *p == 'u') {
+		return true;
+	}
+	return IS_LOWER(*p) && *p != 'k' && *p != 'p' && *p != 'q' && !p[1];
+}
 
 /**
  * \brief Demangle a C++ symbol, automatically selecting the appropriate scheme.
@@ -11,9 +74,12 @@
  * Tries demangling strategies in the following order:
  *   1. If the symbol contains a "_Z" pattern (with possible leading underscores),
  *      attempt v3 (Itanium ABI) demangling via \ref cp_demangle_v3.
- *   2. If v3 fails or the pattern is absent, attempt v2 (legacy) demangling
- *      via \ref cp_demangle_v2.
- *   3. If v2 also fails, attempt bare-type demangling via \ref cp_demangle_v3_type.
+ *   2. If the pattern is absent, attempt v2 (legacy) demangling via
+ *      \ref cp_demangle_v2, when enabled by \ref DEM_OPT_V2 and the
+ *      symbol is plausible (see \ref cp_demangle_v2_plausible).
+ *   3. If v2 also fails, attempt bare-type demangling via
+ *      \ref cp_demangle_v3_type, when enabled by \ref DEM_OPT_TYPE and the
+ *      symbol is plausible (see \ref cp_demangle_v3_type_plausible).
  *
  * \param mangled NUL-terminated mangled symbol string. Must not be NULL.
  * \param opts    Demangling options controlling output verbosity (see \ref CpDemOptions).
@@ -35,9 +101,11 @@ char *cp_demangle(const char *mangled, CpDemOptions opts) {
 		}
 	}
 
-	res = cp_demangle_v2(mangled, opts);
+	if ((opts & DEM_OPT_V2) && cp_demangle_v2_plausible(mangled)) {
+		res = cp_demangle_v2(mangled, opts);
+	}
 
-	if (!res) {
+	if (!res && (opts & DEM_OPT_TYPE) && !dem_budget_exceeded() && cp_demangle_v3_type_plausible(mangled)) {
 		res = cp_demangle_v3_type(mangled, opts);
 	}
 
@@ -16,10 +16,14 @@ typedef enum {
 	DEM_OPT_ANSI = 1 << 0, /**< \b Emit qualifiers like const, volatile, etc... */
 	DEM_OPT_PARAMS = 1 << 1, /**< \b Emit parameters in demangled output. */
 	DEM_OPT_SIMPLE = 1 << 2, /**< \b Simplify the output, to make it more human readable */
+	DEM_OPT_V2 = 1 << 3, /**< \b Try GNU v2 demangling on symbols without `_Z` */
+	DEM_OPT_TYPE = 1 << 4, /**< \b Try bare type demangling when everything else failed */
 	DEM_OPT_ALL = 0xff /**< \b Everything, everywhere, all at once! */
 } CpDemOptions;
 
 static inline CpDemOptions cp_options_convert(RzDemangleOpts opts) {
+	const RzDemangleOpts fallbacks = opts & (RZ_DEMANGLE_OPT_CXX_V2_FALLBACK | RZ_DEMANGLE_OPT_CXX_TYPE_FALLBACK);
+	opts &= ~fallbacks;
 	CpDemOptions copts = DEM_OPT_ANSI | DEM_OPT_PARAMS;
 	if (opts & RZ_DEMANGLE_OPT_ENABLE_ALL) {
 		copts |= DEM_OPT_ALL;
@@ -33,6 +37,14 @@ static inline CpDemOptions cp_options_convert(RzDemangleOpts opts) {
 	if (opts == 0) {
 		copts = DEM_OPT_ALL - DEM_OPT_SIMPLE;
 	}
+	// the fallbacks of cp_demangle() are opt-in
+	copts &= ~(DEM_OPT_V2 | DEM_OPT_TYPE);
+	if (fallbacks & RZ_DEMANGLE_OPT_CXX_V2_FALLBACK) {
+		copts |= DEM_OPT_V2;
+	}
+	if (fallbacks & RZ_DEMANGLE_OPT_CXX_TYPE_FALLBACK) {
+		copts |= DEM_OPT_TYPE;
+	}
 	return copts;
 }
 
@@ -40,5 +52,7 @@ char *cp_demangle_v2(const char *mangled, CpDemOptions opts);
 char *cp_demangle_v3(const char *mangled, CpDemOptions opts);
 char *cp_demangle_v3_type(const char *mangled, CpDemOptions opts);
 char *cp_demangle(const char *mangled, CpDemOptions opts);
+bool cp_demangle_v2_plausible(const char *mangled);
+bool cp_demangle_v3_type_plausible(const char *mangled);
 
 #endif // CP_DEMANGLE_H
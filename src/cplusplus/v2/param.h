@@ -73,7 +73,7 @@ static inline void param_deinit(Param *p) {
 		const char *s = dem_str_newf(__VA_ARGS__); \
 		if (s) { \
 			param_append_to(p, field, s); \
-			free((void *)s); \
+			dem_free((void *)s); \
 		} \
 	} while (0)
 
@@ -219,7 +219,11 @@ char *cpdem_get_demangled(CpDem *dem) {
 		dem_string_concat(&demangled, &dem->suffix);
 	}
 
-	char *res = dem_str_ndup(demangled.buf, demangled.len);
+	// the buffer is released once the budget has been exceeded
+	char *res = NULL;
+	if (demangled.buf && !dem_budget_exceeded()) {
+		res = dem_str_ndup(demangled.buf, demangled.len);
+	}
 	dem_string_deinit(&demangled);
 
 	return res;
@@ -986,7 +990,7 @@ static CpDem *match_type(CpDem *dem, Param *param, ParamVec *params, bool *match
  * \return NULL otherwise.
  */
 CpDem *cpdem_param_type(CpDem *dem, ParamVec *params) {
-	if (!dem || !params) {
+	if (!dem || !params || !dem_budget_step()) {
 		return NULL;
 	}
 
@@ -1117,7 +1121,7 @@ CpDem *cpdem_param_type(CpDem *dem, ParamVec *params) {
 			param_append_to(&param, suffix, "[");
 			param_append_to(&param, suffix, val_str);
 			param_append_to(&param, suffix, "]");
-			free((void *)val_str);
+			dem_free((void *)val_str);
 
 			if (PEEK() == '_') {
 				ADV();
@@ -1369,6 +1373,10 @@ CpDem *cpdem_param_type(CpDem *dem, ParamVec *params) {
 		if (base_typename && (typeidx == 0)) {
 			/* the very first type is name of function itself, it should be considered at index 0 */
 			for (ut64 r = 0; r < (ut64)num_reps; r++) {
+				if (!dem_budget_node()) {
+					dem_free(base_typename);
+					return NULL;
+				}
 				Param p = { 0 };
 				param_init(&p);
 
@@ -1397,8 +1405,8 @@ CpDem *cpdem_param_type(CpDem *dem, ParamVec *params) {
 			for (ut64 r = 0; r < (ut64)num_reps; r++) {
 				Param p = { 0 };
 				Param *src = VecParam_at(params, typeidx);
-				if (!src) {
-					free(base_typename);
+				if (!src || !dem_budget_node()) {
+					dem_free(base_typename);
 					return NULL;
 				}
 				param_init_clone(&p, src);
@@ -1419,7 +1427,7 @@ CpDem *cpdem_param_type(CpDem *dem, ParamVec *params) {
 			}
 		}
 
-		free(base_typename);
+		dem_free(base_typename);
 
 		break;
 	}
@@ -1630,7 +1638,7 @@ CpDem *cpdem_template_function_keep_parsing(CpDem *dem) {
 					idx_end -= 1;
 					char *idx_str = dem_str_ndup(idx_start, idx_end - idx_start);
 					st64 tparam_idx = strtoll(idx_str, NULL, 10);
-					free(idx_str);
+					dem_free(idx_str);
 					if (tparam_idx >= 0) {
 						Param tp_clone = { 0 };
 						Param *tp_src = VecParam_at(&tparams, tparam_idx);
@@ -6,14 +6,17 @@
 #include "types.h"
 
 DemNode *DemNode_new(DemContext *ctx) {
-	DemNode *ast_node = calloc(sizeof(DemNode), 1);
+	if (!dem_budget_node()) {
+		return NULL;
+	}
+	DemNode *ast_node = dem_calloc(sizeof(DemNode), 1);
 	if (!ast_node) {
 		return NULL;
 	}
 	if (ctx) {
 		PDemNode ptr = ast_node;
 		if (!VecPDemNode_append(&ctx->node_pool, &ptr)) {
-			free(ast_node);
+			dem_free(ast_node);
 			return NULL;
 		}
 	}
@@ -89,7 +92,7 @@ DemNode *DemNode_ctor(DemContext *ctx, CpDemTypeKind tag, const char *val_begin,
 
 void DemNode_dtor(DemNode *xs) {
 	DemNode_deinit(xs);
-	free(xs);
+	dem_free(xs);
 }
 
 bool DemNode_init(DemNode *xs) {
@@ -112,7 +115,7 @@ void DemNode_deinit(DemNode *xs) {
 		break;
 	}
 	if (xs->children.data) {
-		free(xs->children.data);
+		dem_free(xs->children.data);
 	}
 	memset(xs, 0, sizeof(DemNode));
 }
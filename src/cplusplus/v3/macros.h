@@ -106,6 +106,10 @@ static inline bool parse_string(DemParser *p, const char *s) {
 		r->error = DEM_ERR_UNEXPECTED_END; \
 		return false; \
 	} \
+	if (!dem_budget_step()) { \
+		r->error = DEM_ERR_BUDGET_EXCEEDED; \
+		return false; \
+	} \
 	p->total_calls++; \
 	p->recursion_depth++; \
 	DemNode *node = NULL; \
@@ -214,7 +214,7 @@ static inline void VecNodeRef_free_inner(void *ptr) {
 	if (ptr) {
 		VecNodeRef *v = (VecNodeRef *)ptr;
 		if (v->data) {
-			free(v->data);
+			dem_free(v->data);
 			v->data = NULL;
 			v->length = 0;
 			v->capacity = 0;
@@ -477,7 +477,7 @@ VecIMPL(PNodeList, PNodeList_free);
 
 static inline void ForwardTemplateRef_free(void *pfwd) {
 	if (pfwd && *(void **)pfwd) {
-		free(*(void **)pfwd);
+		dem_free(*(void **)pfwd);
 	}
 }
 
@@ -531,6 +531,7 @@ typedef enum DemErrorCode {
 	DEM_ERR_UNEXPECTED_END,
 	DEM_ERR_OUT_OF_MEMORY,
 	DEM_ERR_INVALID_SYNTAX,
+	DEM_ERR_BUDGET_EXCEEDED,
 	DEM_ERR_UNKNOWN
 } DemErrorCode;
 
@@ -922,7 +922,7 @@ void ast_pp(NodeRef node, DemString *out, PPContext *ctx) {
 		return;
 	}
 	// Guard against infinite recursion (e.g. from circular template refs)
-	if (ctx->recursion_depth > 256) {
+	if (ctx->recursion_depth > 256 || dem_budget_exceeded()) {
 		return;
 	}
 	ctx->recursion_depth++;
@@ -2975,7 +2975,7 @@ bool rule_template_param(DemParser *p, DemResult *r) {
 		// own template args rather than the enclosing class's template args.
 		bool is_lambda_context = (p->parse_lambda_params_at_level != SIZE_MAX);
 		if (!can_resolve || (level == 0 && !is_lambda_context)) {
-			PForwardTemplateRef fwd = calloc(sizeof(ForwardTemplateRef), 1);
+			PForwardTemplateRef fwd = dem_calloc(sizeof(ForwardTemplateRef), 1);
 			if (!fwd) {
 				TRACE_RETURN_FAILURE();
 			}
@@ -2983,7 +2983,7 @@ bool rule_template_param(DemParser *p, DemResult *r) {
 			fwd->index = index;
 			PForwardTemplateRef *pfwd = VecF(PForwardTemplateRef, append)(&p->forward_template_refs, &fwd);
 			if (!pfwd) {
-				free(fwd);
+				dem_free(fwd);
 				TRACE_RETURN_FAILURE();
 			}
 
@@ -3703,11 +3703,11 @@ bool rule_local_name(DemParser *p, DemResult *r, NameState *ns) {
 			VecF(NodeRef, append)(&p->orphan_nodes, pn);
 		}
 	}
-	free(p->outer_template_params->data);
+	dem_free(p->outer_template_params->data);
 	p->outer_template_params->data = NULL;
 	p->outer_template_params->length = 0;
 	p->outer_template_params->capacity = 0;
-	free(p->outer_template_params);
+	dem_free(p->outer_template_params);
 
 	// 2. Move inner template_params entries to orphan_nodes,
 	//    then free the inner data arrays. VecVecNodeRef_at returns an
@@ -3722,13 +3722,13 @@ bool rule_local_name(DemParser *p, DemResult *r, NameState *ns) {
 					VecF(NodeRef, append)(&p->orphan_nodes, pn);
 				}
 			}
-			free(nl->data);
+			dem_free(nl->data);
 			nl->data = NULL;
 			nl->length = 0;
 			nl->capacity = 0;
 		}
 	}
-	free(p->template_params.data);
+	dem_free(p->template_params.data);
 
 	// 3. Move inner forward_template_refs entries to orphan_fwd_refs
 	//    (they will be freed by DemParser_deinit). We cannot move them
@@ -3741,7 +3741,7 @@ bool rule_local_name(DemParser *p, DemResult *r, NameState *ns) {
 			VecF(PForwardTemplateRef, append)(&p->orphan_fwd_refs, pfwd);
 		}
 	}
-	free(p->forward_template_refs.data);
+	dem_free(p->forward_template_refs.data);
 
 	p->template_params = saved_template_params_ln;
 	p->outer_template_params = saved_outer_template_params_ln;
@@ -4690,7 +4690,7 @@ bool parse_rule(DemContext *ctx, const char *mangled, DemRule rule, CpDemOptions
 		});
 		char *buf_str = dem_string_drain_no_free(&buf);
 		fprintf(stderr, "# substitutions:\n%s\n", buf_str ? buf_str : "(null)");
-		free(buf_str);
+		dem_free(buf_str);
 	}
 	DemNode *output_node = ctx->result.output;
 	if (!output_node) {
@@ -4762,7 +4762,7 @@ char *cp_demangle_v3(const char *mangled, CpDemOptions opts) {
 			is_block_invoke = true;
 			// Create a trimmed copy without the _block_invoke suffix
 			parse_len = (size_t)(block_invoke - p);
-			parse_buf = malloc(parse_len + 1);
+			parse_buf = dem_malloc(parse_len + 1);
 			if (!parse_buf) {
 				return NULL;
 			}
@@ -4796,7 +4796,7 @@ char *cp_demangle_v3(const char *mangled, CpDemOptions opts) {
 			if (has_chars && !all_digits) {
 				dot_suffix = last_dot;
 				parse_len = (size_t)(last_dot - p);
-				parse_buf = realloc(parse_buf, parse_len + 1);
+				parse_buf = dem_realloc(parse_buf, parse_len + 1);
 				if (!parse_buf) {
 					return NULL;
 				}
@@ -4811,7 +4811,7 @@ char *cp_demangle_v3(const char *mangled, CpDemOptions opts) {
 	DemContext_init(&ctx);
 	if (!parse_rule(&ctx, p, rule_mangled_name, opts)) {
 		DemContext_deinit(&ctx);
-		free(parse_buf);
+		dem_free(parse_buf);
 		return NULL;
 	}
 
@@ -4822,11 +4822,11 @@ char *cp_demangle_v3(const char *mangled, CpDemOptions opts) {
 		char *inner = dem_string_drain_no_free(&ctx.output);
 		if (inner) {
 			dem_string_append(&wrapped, inner);
-			free(inner);
+			dem_free(inner);
 		}
 		ctx.output = (DemString){ 0 };
 		DemContext_deinit(&ctx);
-		free(parse_buf);
+		dem_free(parse_buf);
 		return dem_string_drain_no_free(&wrapped);
 	}
 
@@ -4841,7 +4841,7 @@ char *cp_demangle_v3(const char *mangled, CpDemOptions opts) {
 	// Clear the output buffer so DemContext_deinit doesn't double-free it
 	ctx.output = (DemString){ 0 };
 	DemContext_deinit(&ctx);
-	free(parse_buf);
+	dem_free(parse_buf);
 	return result;
 }
 
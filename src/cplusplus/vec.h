@@ -70,19 +70,19 @@
 			for (size_t i = 0; i < self->length; i++) { \
 				F(&self->data[i]); \
 			} \
-			free(self->data); \
+			dem_free(self->data); \
 			self->data = NULL; \
 			self->length = 0; \
 			self->capacity = 0; \
 		} \
 	} \
 	__attribute__((unused)) static inline VecT(T) * VecF(T, ctor)() { \
-		return calloc(1, sizeof(VecT(T))); \
+		return dem_calloc(1, sizeof(VecT(T))); \
 	} \
 	__attribute__((unused)) static inline void VecF(T, dtor)(Vec##T * self) { \
 		if (self) { \
 			VecF(T, deinit)(self); \
-			free(self); \
+			dem_free(self); \
 		} \
 	} \
 	__attribute__((unused)) static inline T *VecF(T, at)(const Vec##T *self, size_t idx) { \
@@ -107,7 +107,7 @@
 		if (self->capacity >= new_cap) { \
 			return true; \
 		} \
-		T *new_data = realloc(self->data, sizeof(T) * new_cap); \
+		T *new_data = dem_realloc(self->data, sizeof(T) * new_cap); \
 		if (!new_data) { \
 			return false; \
 		} \
@@ -4,13 +4,25 @@
 
 #include "borland.h"
 #include "cplusplus/demangle.h"
+#include "demangler_util.h"
 #include <rz_libdemangle.h>
 
 DEM_LIB_EXPORT char *libdemangle_handler_cxx(const char *symbol, RzDemangleOpts opts) {
-	char *result = demangle_borland_delphi(symbol);
-	if (result) {
-		return result;
+	DemNegativeKey key;
+	if (!symbol || dem_negative_lookup(&key, DEM_LANG_CXX, symbol, SIZE_MAX, opts)) {
+		return NULL;
 	}
 
-	return (char *)cp_demangle(symbol, cp_options_convert(opts));
+	char *result = NULL;
+	dem_budget_begin();
+	// Itanium symbols are the common case, thus are dispatched first.
+	const char *p = symbol + (symbol[0] == '_' && symbol[1] == '_');
+	if (p[0] == '_' && p[1] == 'Z') {
+		result = cp_demangle_v3(symbol, cp_options_convert(opts));
+	} else if (symbol[0] == '@') {
+		result = demangle_borland_delphi(symbol);
+	} else {
+		result = cp_demangle(symbol, cp_options_convert(opts));
+	}
+	return dem_negative_record(&key, dem_budget_end(result));
 }
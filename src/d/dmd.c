@@ -11,10 +11,37 @@
 		return (ret); \
 	} while (0)
 
+#define D_BACKREF_TYPE        0
+#define D_BACKREF_SYMBOL      1
+#define D_BACKREF_IN_TEMPLATE 2
+
+/**
+ * Rendered output of a back reference target, valid for the same kind of
+ * production and the same template argument state.
+ */
+typedef struct DBackRef_t {
+	size_t key; ///< offset of the target + 1, 0 for free slots
+	const char *stop; ///< cursor after parsing the target
+	size_t start; ///< offset of the rendered output within DBackRefs.rendered
+	size_t size;
+	ut8 kind;
+} DBackRef;
+
+typedef struct DBackRefs_t {
+	DBackRef *entries;
+	size_t capacity; ///< always a power of two
+	size_t count;
+	DemString rendered;
+} DBackRefs;
+
 typedef struct DDemangleContext_t {
 	DemString *demangled;
 	DemString *attr;
-	size_t curr;
+	const char *beg; ///< start of the mangled symbol
+	const char *end; ///< terminating NUL of the mangled symbol
+	const char *cur; ///< next character to parse, always within [beg, end]
+	const char *last_backref; ///< `Q` being expanded, nested back references must come before it
+	DBackRefs backrefs; ///< expansions already rendered during this call
 	bool in_template_arg;
 	bool err;
 } DDemangleContext;
@@ -22,7 +49,7 @@ typedef struct DDemangleContext_t {
 typedef struct DDemangleCtxRef_t {
 	size_t len;
 	size_t attr_len;
-	size_t curr;
+	const char *cur;
 	bool err;
 } DDemangleCtxRef;
 
@@ -50,23 +77,23 @@ typedef enum {
 	FUNC_ATTR_SCOPE_RETURN = 1 << 12
 } FuncAttributes;
 
-static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx);
-static bool parseValueImpl(const char *mangled, DDemangleContext *ctx, const char *type_name, char type_char);
-static bool parseTemplateArgImpl(const char *mangled, DDemangleContext *ctx);
-static bool parseQualifiedName(const char *mangled, DDemangleContext *ctx);
-static bool parseSymbolName(const char *mangled, DDemangleContext *ctx);
+static bool parseTypeImpl(DDemangleContext *ctx);
+static bool parseValueImpl(DDemangleContext *ctx, const char *type_name, char type_char);
+static bool parseTemplateArgImpl(DDemangleContext *ctx);
+static bool parseQualifiedName(DDemangleContext *ctx);
+static bool parseSymbolName(DDemangleContext *ctx);
 
 static DDemangleCtxRef createCtxRef(DDemangleContext *ctx) {
 	DDemangleCtxRef ref = {
 		.len = 0,
 		.attr_len = 0,
-		.curr = 0,
+		.cur = NULL,
 		.err = false
 	};
 	if (!ctx) {
 		return ref;
 	}
-	ref.curr = ctx->curr;
+	ref.cur = ctx->cur;
 	ref.err = ctx->err;
 	if (ctx->demangled) {
 		ref.len = ctx->demangled->len;
@@ -81,7 +108,7 @@ static void ctxRestore(DDemangleContext *ctx, DDemangleCtxRef ref) {
 	if (!ctx) {
 		return;
 	}
-	ctx->curr = ref.curr;
+	ctx->cur = ref.cur;
 	ctx->err = ref.err;
 
 	if (ctx->demangled) {
@@ -99,91 +126,110 @@ static void ctxRestore(DDemangleContext *ctx, DDemangleCtxRef ref) {
 	}
 }
 
-static char lookAhead(const char *mangled, DDemangleContext *ctx, size_t n) {
-	if (!mangled || !ctx || ctx->curr + n > strlen(mangled)) {
+static char lookAhead(DDemangleContext *ctx, size_t n) {
+	if (!ctx || n > (size_t)(ctx->end - ctx->cur)) {
 		return '\0';
 	}
 
-	return mangled[ctx->curr + n];
+	return ctx->cur[n];
 }
 
-static char consumeN(const char *mangled, DDemangleContext *ctx, size_t n) {
-	if (!mangled || !ctx || ctx->curr + n > strlen(mangled)) {
+static char consumeN(DDemangleContext *ctx, size_t n) {
+	if (!ctx || n > (size_t)(ctx->end - ctx->cur)) {
 		return '\0';
 	}
 
-	char ret = mangled[ctx->curr];
-	ctx->curr += n;
+	char ret = *ctx->cur;
+	ctx->cur += n;
 	return ret;
 }
 
-static char consume(const char *mangled, DDemangleContext *ctx) {
-	return consumeN(mangled, ctx, 1);
+static char consume(DDemangleContext *ctx) {
+	return consumeN(ctx, 1);
 }
 
-static bool consumeIf(const char *mangled, DDemangleContext *ctx, char expected) {
-	if (!mangled || !ctx) {
+static bool consumeIf(DDemangleContext *ctx, char expected) {
+	if (!ctx) {
 		return false;
 	}
 
-	if (lookAhead(mangled, ctx, 0) == expected) {
-		ctx->curr++;
+	if (lookAhead(ctx, 0) == expected) {
+		ctx->cur++;
 		return true;
 	}
 
 	return false;
 }
 
-static bool consumeWhile(const char *mangled, DDemangleContext *ctx, char expected) {
-	if (!mangled || !ctx) {
+static bool consumeWhile(DDemangleContext *ctx, char expected) {
+	if (!ctx) {
 		return false;
 	}
 
 	bool consumed = false;
-	while (lookAhead(mangled, ctx, 0) == expected) {
-		ctx->curr++;
+	while (lookAhead(ctx, 0) == expected) {
+		ctx->cur++;
 		consumed = true;
 	}
 
 	return consumed;
 }
 
-static size_t consumeDigits(const char *mangled, DDemangleContext *ctx) {
+static size_t consumeDigits(DDemangleContext *ctx) {
 	size_t ret = 0;
-	if (!mangled || !ctx) {
+	if (!ctx) {
 		return 0;
 	}
 
-	while (IS_DIGIT(lookAhead(mangled, ctx, 0))) {
-		size_t digit = (size_t)(lookAhead(mangled, ctx, 0) - '0');
+	while (IS_DIGIT(lookAhead(ctx, 0))) {
+		size_t digit = (size_t)(lookAhead(ctx, 0) - '0');
 		if (ret > (SIZE_MAX - digit) / 10) {
 			ERR(ctx, 0);
 		}
 		ret = ret * 10 + digit;
-		ctx->curr++;
+		ctx->cur++;
 	}
 
 	return ret;
 }
 
-static char consumeHexDigit(const char *mangled, DDemangleContext *ctx) {
+static char consumeHexDigit(DDemangleContext *ctx) {
 	char ret = 0;
-	if (!mangled || !ctx) {
+	if (!ctx) {
 		return 0;
 	}
 
-	char c = lookAhead(mangled, ctx, 0);
+	char c = lookAhead(ctx, 0);
 	if (IS_HEX(c)) {
 		ret = c;
 	} else {
 		return 0;
 	}
 
-	ctx->curr++;
+	ctx->cur++;
 	return ret;
 }
 
-static bool demangleAppend(DDemangleContext *ctx, const char *fmt, ...) {
+static bool demangleAppendN(DDemangleContext *ctx, const char *str, size_t len) {
+	if (!ctx || !str || ctx->err || !ctx->demangled) {
+		return false;
+	}
+	if (!dem_string_append_n(ctx->demangled, str, len)) {
+		ERR(ctx, false);
+	}
+	return true;
+}
+
+static bool demangleAppendChar(DDemangleContext *ctx, char c) {
+	return demangleAppendN(ctx, &c, 1);
+}
+
+/* keywords and punctuation are appended as is, their length is known at compile time */
+#define APPEND_LIT(ctx, lit)   demangleAppendN(ctx, "" lit, sizeof(lit) - 1)
+#define DS_APPEND_LIT(ds, lit) dem_string_append_n(ds, "" lit, sizeof(lit) - 1)
+
+/* formatted output, only used for numeric literals */
+static bool demangleAppendf(DDemangleContext *ctx, const char *fmt, ...) {
 	if (!ctx || !fmt || ctx->err || !ctx->demangled) {
 		return false;
 	}
@@ -211,26 +257,26 @@ static bool isCallConvention(char c) {
 	}
 }
 
-static TypeCtor parseModifier(const char *mangled, DDemangleContext *ctx) {
+static TypeCtor parseModifier(DDemangleContext *ctx) {
 	TypeCtor res = TYPE_CTOR_NONE;
-	switch (lookAhead(mangled, ctx, 0)) {
+	switch (lookAhead(ctx, 0)) {
 	case 'y':
-		consume(mangled, ctx);
+		consume(ctx);
 		return TYPE_CTOR_IMMUTABLE;
 	case 'O':
-		consume(mangled, ctx);
+		consume(ctx);
 		res |= TYPE_CTOR_SHARED;
-		switch (lookAhead(mangled, ctx, 0)) {
+		switch (lookAhead(ctx, 0)) {
 		case 'x':
-			consume(mangled, ctx);
+			consume(ctx);
 			res |= TYPE_CTOR_CONST;
 			break;
 		case 'N':
-			if (lookAhead(mangled, ctx, 1) == 'g') {
-				consumeN(mangled, ctx, 2);
+			if (lookAhead(ctx, 1) == 'g') {
+				consumeN(ctx, 2);
 				res |= TYPE_CTOR_INOUT;
-				if (lookAhead(mangled, ctx, 0) == 'x') {
-					consume(mangled, ctx);
+				if (lookAhead(ctx, 0) == 'x') {
+					consume(ctx);
 					res |= TYPE_CTOR_CONST;
 				}
 			}
@@ -240,17 +286,17 @@ static TypeCtor parseModifier(const char *mangled, DDemangleContext *ctx) {
 		}
 		return res;
 	case 'N':
-		if (lookAhead(mangled, ctx, 1) == 'g') {
-			consumeN(mangled, ctx, 2);
+		if (lookAhead(ctx, 1) == 'g') {
+			consumeN(ctx, 2);
 			res |= TYPE_CTOR_INOUT;
-			if (lookAhead(mangled, ctx, 0) == 'x') {
-				consume(mangled, ctx);
+			if (lookAhead(ctx, 0) == 'x') {
+				consume(ctx);
 				res |= TYPE_CTOR_CONST;
 			}
 		}
 		return res;
 	case 'x':
-		consume(mangled, ctx);
+		consume(ctx);
 		res |= TYPE_CTOR_CONST;
 		return res;
 	default:
@@ -258,32 +304,32 @@ static TypeCtor parseModifier(const char *mangled, DDemangleContext *ctx) {
 	}
 }
 
-static FuncAttributes parseFuncAttrs(const char *mangled, DDemangleContext *ctx) {
+static FuncAttributes parseFuncAttrs(DDemangleContext *ctx) {
 	FuncAttributes result = FUNC_ATTR_NONE;
-	while (lookAhead(mangled, ctx, 0) == 'N') {
-		switch (lookAhead(mangled, ctx, 1)) {
+	while (lookAhead(ctx, 0) == 'N') {
+		switch (lookAhead(ctx, 1)) {
 		case 'a':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_PURE;
 			continue;
 		case 'b':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_NOTHROW;
 			continue;
 		case 'c':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_REF;
 			continue;
 		case 'd':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_PROPERTY;
 			continue;
 		case 'e':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_TRUSTED;
 			continue;
 		case 'f':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_SAFE;
 			continue;
 		case 'g':
@@ -292,29 +338,29 @@ static FuncAttributes parseFuncAttrs(const char *mangled, DDemangleContext *ctx)
 		case 'n':
 			return result;
 		case 'i':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_NOGC;
 			continue;
 		case 'j':
-			consumeN(mangled, ctx, 2);
-			if (lookAhead(mangled, ctx, 0) == 'N' && lookAhead(mangled, ctx, 1) == 'l') {
+			consumeN(ctx, 2);
+			if (lookAhead(ctx, 0) == 'N' && lookAhead(ctx, 1) == 'l') {
 				result |= FUNC_ATTR_RETURN_SCOPE;
-				consumeN(mangled, ctx, 2);
+				consumeN(ctx, 2);
 			} else {
 				result |= FUNC_ATTR_RETURN;
 			}
 			continue;
 		case 'l':
-			consumeN(mangled, ctx, 2);
-			if (lookAhead(mangled, ctx, 0) == 'N' && lookAhead(mangled, ctx, 1) == 'j') {
+			consumeN(ctx, 2);
+			if (lookAhead(ctx, 0) == 'N' && lookAhead(ctx, 1) == 'j') {
 				result |= FUNC_ATTR_SCOPE_RETURN;
-				consumeN(mangled, ctx, 2);
+				consumeN(ctx, 2);
 			} else {
 				result |= FUNC_ATTR_SCOPE;
 			}
 			continue;
 		case 'm':
-			consumeN(mangled, ctx, 2);
+			consumeN(ctx, 2);
 			result |= FUNC_ATTR_LIVE;
 			continue;
 		default:
@@ -327,158 +373,237 @@ static FuncAttributes parseFuncAttrs(const char *mangled, DDemangleContext *ctx)
 
 static void writeModifiers(TypeCtor modifiers, DemString *dest) {
 	if ((modifiers & TYPE_CTOR_IMMUTABLE) == TYPE_CTOR_IMMUTABLE) {
-		dem_string_appendf(dest, "immutable ");
+		DS_APPEND_LIT(dest, "immutable ");
 	}
 	if ((modifiers & TYPE_CTOR_SHARED) == TYPE_CTOR_SHARED) {
-		dem_string_appendf(dest, "shared ");
+		DS_APPEND_LIT(dest, "shared ");
 	}
 	if ((modifiers & TYPE_CTOR_INOUT) == TYPE_CTOR_INOUT) {
-		dem_string_appendf(dest, "inout ");
+		DS_APPEND_LIT(dest, "inout ");
 	}
 	if ((modifiers & TYPE_CTOR_CONST) == TYPE_CTOR_CONST) {
-		dem_string_appendf(dest, "const ");
+		DS_APPEND_LIT(dest, "const ");
 	}
 }
 
 static void writeFuncAttrs(FuncAttributes attrs, DemString *dest) {
 	if ((attrs & FUNC_ATTR_PURE) == FUNC_ATTR_PURE) {
-		dem_string_appendf(dest, "pure ");
+		DS_APPEND_LIT(dest, "pure ");
 	}
 	if ((attrs & FUNC_ATTR_NOTHROW) == FUNC_ATTR_NOTHROW) {
-		dem_string_appendf(dest, "nothrow ");
+		DS_APPEND_LIT(dest, "nothrow ");
 	}
 	if ((attrs & FUNC_ATTR_REF) == FUNC_ATTR_REF) {
-		dem_string_appendf(dest, "ref ");
+		DS_APPEND_LIT(dest, "ref ");
 	}
 	if ((attrs & FUNC_ATTR_PROPERTY) == FUNC_ATTR_PROPERTY) {
-		dem_string_appendf(dest, "@property ");
+		DS_APPEND_LIT(dest, "@property ");
 	}
 	if ((attrs & FUNC_ATTR_NOGC) == FUNC_ATTR_NOGC) {
-		dem_string_appendf(dest, "@nogc ");
+		DS_APPEND_LIT(dest, "@nogc ");
 	}
 	if ((attrs & FUNC_ATTR_RETURN_SCOPE) == FUNC_ATTR_RETURN_SCOPE) {
-		dem_string_appendf(dest, "return scope ");
+		DS_APPEND_LIT(dest, "return scope ");
 	}
 	if ((attrs & FUNC_ATTR_SCOPE_RETURN) == FUNC_ATTR_SCOPE_RETURN) {
-		dem_string_appendf(dest, "scope return ");
+		DS_APPEND_LIT(dest, "scope return ");
 	}
 	if ((attrs & FUNC_ATTR_RETURN) == FUNC_ATTR_RETURN) {
-		dem_string_appendf(dest, "return ");
+		DS_APPEND_LIT(dest, "return ");
 	}
 	if ((attrs & FUNC_ATTR_SCOPE) == FUNC_ATTR_SCOPE) {
-		dem_string_appendf(dest, "scope ");
+		DS_APPEND_LIT(dest, "scope ");
 	}
 	if ((attrs & FUNC_ATTR_LIVE) == FUNC_ATTR_LIVE) {
-		dem_string_appendf(dest, "@live ");
+		DS_APPEND_LIT(dest, "@live ");
 	}
 	if ((attrs & FUNC_ATTR_TRUSTED) == FUNC_ATTR_TRUSTED) {
-		dem_string_appendf(dest, "@trusted ");
+		DS_APPEND_LIT(dest, "@trusted ");
 	}
 	if ((attrs & FUNC_ATTR_SAFE) == FUNC_ATTR_SAFE) {
-		dem_string_appendf(dest, "@safe ");
+		DS_APPEND_LIT(dest, "@safe ");
 	}
 }
 
-static bool parseType(const char *mangled, DDemangleContext *ctx) {
+static bool parseType(DDemangleContext *ctx) {
+	if (!dem_budget_step()) {
+		ERR(ctx, false);
+	}
+	// attributes are rare, the buffer is allocated on the first append
+	DemString attr;
 	DemString *saved_attr = ctx->attr;
-	ctx->attr = dem_string_new();
-	bool res = parseTypeImpl(mangled, ctx);
-	dem_string_free(ctx->attr);
+	ctx->attr = dem_string_init(&attr);
+	bool res = parseTypeImpl(ctx);
+	dem_string_deinit(&attr);
 	ctx->attr = saved_attr;
 	return res;
 }
 
-static bool parseValue(const char *mangled, DDemangleContext *ctx, const char *type_name, char type_char) {
+static bool parseValue(DDemangleContext *ctx, const char *type_name, char type_char) {
+	if (!dem_budget_step()) {
+		ERR(ctx, false);
+	}
+	// attributes are rare, the buffer is allocated on the first append
+	DemString attr;
 	DemString *saved_attr = ctx->attr;
-	ctx->attr = dem_string_new();
-	bool res = parseValueImpl(mangled, ctx, type_name, type_char);
-	dem_string_free(ctx->attr);
+	ctx->attr = dem_string_init(&attr);
+	bool res = parseValueImpl(ctx, type_name, type_char);
+	dem_string_deinit(&attr);
 	ctx->attr = saved_attr;
 	return res;
 }
 
-static bool parseTemplateArg(const char *mangled, DDemangleContext *ctx) {
+static bool parseTemplateArg(DDemangleContext *ctx) {
+	if (!dem_budget_step()) {
+		ERR(ctx, false);
+	}
+	// attributes are rare, the buffer is allocated on the first append
+	DemString attr;
 	DemString *saved_attr = ctx->attr;
-	ctx->attr = dem_string_new();
-	bool res = parseTemplateArgImpl(mangled, ctx);
-	dem_string_free(ctx->attr);
+	ctx->attr = dem_string_init(&attr);
+	bool res = parseTemplateArgImpl(ctx);
+	dem_string_deinit(&attr);
 	ctx->attr = saved_attr;
 	return res;
 }
 
-static size_t parseBackRef(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
-		return 0;
+static const char *parseBackRef(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
+		return NULL;
 	}
 
-	if (lookAhead(mangled, ctx, 0) != 'Q') {
+	if (lookAhead(ctx, 0) != 'Q') {
 		ctx->err = true;
-		return 0;
+		return NULL;
 	}
 
-	size_t q = ctx->curr;
+	const char *q = ctx->cur;
+	if (q >= ctx->last_backref) {
+		// the reference would expand into itself
+		ERR(ctx, NULL);
+	}
 	size_t pos = 0;
-	consume(mangled, ctx);
+	consume(ctx);
 	while (1) {
-		char c = lookAhead(mangled, ctx, 0);
+		char c = lookAhead(ctx, 0);
 		if (IS_UPPER(c)) {
 			pos = pos * 26 + (c - 'A');
-			consume(mangled, ctx);
+			consume(ctx);
 		} else if (IS_LOWER(c)) {
 			pos = pos * 26 + (c - 'a');
-			consume(mangled, ctx);
+			consume(ctx);
 			break;
 		} else {
 			break;
 		}
 	}
-	if (pos == 0 || pos > q) {
-		ERR(ctx, 0);
+	if (pos == 0 || pos > (size_t)(q - ctx->beg)) {
+		ERR(ctx, NULL);
 	}
 	return q - pos;
 }
 
-static bool expandBackRefType(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
-		return false;
+static DBackRef *backRefSlot(DBackRefs *backrefs, size_t key, ut8 kind) {
+	size_t mask = backrefs->capacity - 1;
+	size_t i = (key * 31 + kind) & mask;
+	while (backrefs->entries[i].key) {
+		DBackRef *entry = &backrefs->entries[i];
+		if (entry->key == key && entry->kind == kind) {
+			break;
+		}
+		i = (i + 1) & mask;
 	}
+	return &backrefs->entries[i];
+}
 
-	size_t pos = parseBackRef(mangled, ctx);
-	if (ctx->err || pos >= ctx->curr) {
-		return false;
+static void backRefInsert(DBackRefs *backrefs, const DBackRef *entry) {
+	if ((backrefs->count + 1) * 2 > backrefs->capacity) {
+		DBackRefs grown = { 0 };
+		grown.capacity = backrefs->capacity ? backrefs->capacity * 2 : 16;
+		grown.entries = dem_calloc(grown.capacity, sizeof(DBackRef));
+		if (!grown.entries) {
+			return;
+		}
+		for (size_t i = 0; i < backrefs->capacity; i++) {
+			DBackRef *old = &backrefs->entries[i];
+			if (old->key) {
+				*backRefSlot(&grown, old->key, old->kind) = *old;
+			}
+		}
+		dem_free(backrefs->entries);
+		backrefs->entries = grown.entries;
+		backrefs->capacity = grown.capacity;
 	}
-
-	size_t saved_curr = ctx->curr;
-	ctx->curr = pos;
-	bool res = parseType(mangled, ctx);
-	ctx->curr = saved_curr;
-	return res;
+	DBackRef *slot = backRefSlot(backrefs, entry->key, entry->kind);
+	if (!slot->key) {
+		backrefs->count++;
+	}
+	*slot = *entry;
 }
 
-static bool expandBackRefSymbol(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+/**
+ * Parses the target of a back reference, reusing the output already
+ * rendered for the same target instead of walking it again.
+ */
+static bool expandBackRef(DDemangleContext *ctx, ut8 kind) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	size_t pos = parseBackRef(mangled, ctx);
-	if (ctx->err || pos >= ctx->curr) {
+	const char *q = ctx->cur;
+	const char *pos = parseBackRef(ctx);
+	if (ctx->err || !pos || pos >= ctx->cur) {
 		return false;
 	}
+	if (!dem_budget_node()) {
+		ERR(ctx, false);
+	}
+
+	DBackRefs *backrefs = &ctx->backrefs;
+	DBackRef entry = {
+		.key = (size_t)(pos - ctx->beg) + 1,
+		.kind = kind | (ctx->in_template_arg ? D_BACKREF_IN_TEMPLATE : 0),
+	};
+	if (backrefs->count) {
+		const DBackRef *cached = backRefSlot(backrefs, entry.key, entry.kind);
+		// nested references of the target must come before this one as well
+		if (cached->key && cached->stop <= q) {
+			if (cached->size && !dem_string_append_n(ctx->demangled, backrefs->rendered.buf + cached->start, cached->size)) {
+				ERR(ctx, false);
+			}
+			return true;
+		}
+	}
 
-	size_t ref_curr = ctx->curr;
-	ctx->curr = pos;
-	bool res = parseSymbolName(mangled, ctx);
-	ctx->curr = ref_curr;
+	DemString *demangled = ctx->demangled;
+	size_t start = demangled->len;
+	const char *saved_cur = ctx->cur;
+	const char *saved_backref = ctx->last_backref;
+	ctx->cur = pos;
+	ctx->last_backref = q;
+	bool res = kind == D_BACKREF_TYPE ? parseType(ctx) : parseSymbolName(ctx);
+	entry.stop = ctx->cur;
+	ctx->cur = saved_cur;
+	ctx->last_backref = saved_backref;
+
+	// only complete expansions appended to the same output can be replayed
+	if (res && !ctx->err && ctx->demangled == demangled && demangled->len >= start) {
+		entry.start = backrefs->rendered.len;
+		entry.size = demangled->len - start;
+		if (!entry.size || dem_string_append_n(&backrefs->rendered, demangled->buf + start, entry.size)) {
+			backRefInsert(backrefs, &entry);
+		}
+	}
 	return res;
 }
 
-static bool parseNameStart(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseNameStart(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	if (lookAhead(mangled, ctx, 0) == '_' || IS_ALPHA(lookAhead(mangled, ctx, 0))) {
-		consume(mangled, ctx);
+	if (lookAhead(ctx, 0) == '_' || IS_ALPHA(lookAhead(ctx, 0))) {
+		consume(ctx);
 	} else {
 		return false;
 	}
@@ -486,28 +611,28 @@ static bool parseNameStart(const char *mangled, DDemangleContext *ctx) {
 	return true;
 }
 
-static bool parseNameChar(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseNameChar(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
-	if (IS_DIGIT(lookAhead(mangled, ctx, 0)) || lookAhead(mangled, ctx, 0) == '_' || IS_ALPHA(lookAhead(mangled, ctx, 0))) {
-		consume(mangled, ctx);
+	if (IS_DIGIT(lookAhead(ctx, 0)) || lookAhead(ctx, 0) == '_' || IS_ALPHA(lookAhead(ctx, 0))) {
+		consume(ctx);
 		return true;
 	}
 	return false;
 }
 
-static bool parseName(const char *mangled, DDemangleContext *ctx, size_t len) {
-	if (!mangled || !ctx || ctx->err || len == 0) {
+static bool parseName(DDemangleContext *ctx, size_t len) {
+	if (!ctx || ctx->err || len == 0) {
 		return false;
 	}
 
-	if (!parseNameStart(mangled, ctx)) {
+	if (!parseNameStart(ctx)) {
 		return false;
 	}
 
 	while (len > 1) {
-		if (!parseNameChar(mangled, ctx)) {
+		if (!parseNameChar(ctx)) {
 			return false;
 		}
 		len--;
@@ -515,66 +640,64 @@ static bool parseName(const char *mangled, DDemangleContext *ctx, size_t len) {
 	return true;
 }
 
-static bool parseLName(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseLName(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	size_t len = consumeDigits(mangled, ctx);
+	size_t len = consumeDigits(ctx);
 	if (len == 0) {
-		demangleAppend(ctx, "__anonymous");
+		APPEND_LIT(ctx, "__anonymous");
 		return true;
 	}
 
-	if (lookAhead(mangled, ctx, 0) == '_' && lookAhead(mangled, ctx, 1) == '_' && lookAhead(mangled, ctx, 2) == 'S') {
-		consumeN(mangled, ctx, 3);
-		consumeDigits(mangled, ctx);
+	if (lookAhead(ctx, 0) == '_' && lookAhead(ctx, 1) == '_' && lookAhead(ctx, 2) == 'S') {
+		consumeN(ctx, 3);
+		consumeDigits(ctx);
 	} else {
-		size_t start = ctx->curr;
-		if (!parseName(mangled, ctx, len)) {
+		const char *start = ctx->cur;
+		if (!parseName(ctx, len)) {
 			ERR(ctx, false);
 		}
-		if (len + start <= strlen(mangled)) {
-			demangleAppend(ctx, "%.*s", (int)len, mangled + start);
-		}
+		demangleAppendN(ctx, start, len);
 	}
 	return true;
 }
 
-static bool parseTemplateID(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseTemplateID(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	if (lookAhead(mangled, ctx, 0) == '_' && lookAhead(mangled, ctx, 1) == '_') {
-		switch (lookAhead(mangled, ctx, 2)) {
+	if (lookAhead(ctx, 0) == '_' && lookAhead(ctx, 1) == '_') {
+		switch (lookAhead(ctx, 2)) {
 		case 'T':
 		case 'U':
-			consumeN(mangled, ctx, 3);
+			consumeN(ctx, 3);
 			return true;
 		default:
 			ERR(ctx, false);
 		}
-	} else if (lookAhead(mangled, ctx, 0) == 'T' || lookAhead(mangled, ctx, 0) == 'U') {
-		consume(mangled, ctx);
+	} else if (lookAhead(ctx, 0) == 'T' || lookAhead(ctx, 0) == 'U') {
+		consume(ctx);
 		return true;
 	}
 
 	ERR(ctx, false);
 }
 
-static bool parseMangledName(const char *mangled, DDemangleContext *ctx, bool displayType) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseMangledName(DDemangleContext *ctx, bool displayType) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
 	DDemangleCtxRef ref = createCtxRef(ctx);
-	if (lookAhead(mangled, ctx, 0) == '_' && lookAhead(mangled, ctx, 1) == 'D') {
-		consumeN(mangled, ctx, 2);
+	if (lookAhead(ctx, 0) == '_' && lookAhead(ctx, 1) == 'D') {
+		consumeN(ctx, 2);
 		DemString *original = ctx->demangled;
 		DemString *qual_name = dem_string_new();
 		ctx->demangled = qual_name;
-		if (!parseQualifiedName(mangled, ctx)) {
+		if (!parseQualifiedName(ctx)) {
 			ctx->demangled = original;
 			dem_string_free(qual_name);
 			ctxRestore(ctx, ref);
@@ -583,11 +706,11 @@ static bool parseMangledName(const char *mangled, DDemangleContext *ctx, bool di
 
 		DemString *type_str = dem_string_new();
 		ctx->demangled = type_str;
-		if (lookAhead(mangled, ctx, 0) == 'M') {
-			consume(mangled, ctx);
+		if (lookAhead(ctx, 0) == 'M') {
+			consume(ctx);
 		}
 
-		if (lookAhead(mangled, ctx, 0) != '\0' && !consumeIf(mangled, ctx, 'Z') && !parseType(mangled, ctx)) {
+		if (lookAhead(ctx, 0) != '\0' && !consumeIf(ctx, 'Z') && !parseType(ctx)) {
 			ctx->demangled = original;
 			dem_string_free(qual_name);
 			dem_string_free(type_str);
@@ -602,7 +725,7 @@ static bool parseMangledName(const char *mangled, DDemangleContext *ctx, bool di
 			}
 			dem_string_concat(ctx->demangled, type_str);
 			if (type_str->len > 0 && type_str->buf[type_str->len - 1] != ' ') {
-				demangleAppend(ctx, " ");
+				APPEND_LIT(ctx, " ");
 			}
 		}
 
@@ -615,71 +738,71 @@ static bool parseMangledName(const char *mangled, DDemangleContext *ctx, bool di
 	return true;
 }
 
-static bool parseHexFloat(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseHexFloat(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	if (lookAhead(mangled, ctx, 0) == 'N' && lookAhead(mangled, ctx, 1) == 'A' && lookAhead(mangled, ctx, 2) == 'N') {
-		consumeN(mangled, ctx, 3);
-		return demangleAppend(ctx, "real.nan");
-	} else if (lookAhead(mangled, ctx, 0) == 'I' && lookAhead(mangled, ctx, 1) == 'N' && lookAhead(mangled, ctx, 2) == 'F') {
-		consumeN(mangled, ctx, 3);
-		return demangleAppend(ctx, "real.infinity");
-	} else if (lookAhead(mangled, ctx, 0) == 'N' && lookAhead(mangled, ctx, 1) == 'I' && lookAhead(mangled, ctx, 2) == 'N' && lookAhead(mangled, ctx, 3) == 'F') {
-		consumeN(mangled, ctx, 4);
-		return demangleAppend(ctx, "-real.infinity");
+	if (lookAhead(ctx, 0) == 'N' && lookAhead(ctx, 1) == 'A' && lookAhead(ctx, 2) == 'N') {
+		consumeN(ctx, 3);
+		return APPEND_LIT(ctx, "real.nan");
+	} else if (lookAhead(ctx, 0) == 'I' && lookAhead(ctx, 1) == 'N' && lookAhead(ctx, 2) == 'F') {
+		consumeN(ctx, 3);
+		return APPEND_LIT(ctx, "real.infinity");
+	} else if (lookAhead(ctx, 0) == 'N' && lookAhead(ctx, 1) == 'I' && lookAhead(ctx, 2) == 'N' && lookAhead(ctx, 3) == 'F') {
+		consumeN(ctx, 4);
+		return APPEND_LIT(ctx, "-real.infinity");
 	}
 
 	bool is_neg = false;
-	if (lookAhead(mangled, ctx, 0) == 'N') {
+	if (lookAhead(ctx, 0) == 'N') {
 		is_neg = true;
-		consume(mangled, ctx);
+		consume(ctx);
 	}
 
 	if (is_neg) {
-		demangleAppend(ctx, "-0x");
+		APPEND_LIT(ctx, "-0x");
 	} else {
-		demangleAppend(ctx, "0x");
+		APPEND_LIT(ctx, "0x");
 	}
 
 	bool has_digits = false;
-	while (IS_HEX(lookAhead(mangled, ctx, 0))) {
+	while (IS_HEX(lookAhead(ctx, 0))) {
 		has_digits = true;
-		demangleAppend(ctx, "%c", consumeHexDigit(mangled, ctx));
+		demangleAppendChar(ctx, consumeHexDigit(ctx));
 	}
 
 	if (!has_digits) {
 		ERR(ctx, false);
 	}
 
-	if (lookAhead(mangled, ctx, 0) == 'P') {
-		consume(mangled, ctx);
-		demangleAppend(ctx, "p");
-		if (lookAhead(mangled, ctx, 0) == 'N') {
-			demangleAppend(ctx, "-");
-			consume(mangled, ctx);
+	if (lookAhead(ctx, 0) == 'P') {
+		consume(ctx);
+		APPEND_LIT(ctx, "p");
+		if (lookAhead(ctx, 0) == 'N') {
+			APPEND_LIT(ctx, "-");
+			consume(ctx);
 		} else {
-			demangleAppend(ctx, "+");
+			APPEND_LIT(ctx, "+");
 		}
-		demangleAppend(ctx, "%zu", consumeDigits(mangled, ctx));
+		demangleAppendf(ctx, "%zu", consumeDigits(ctx));
 	}
 
 	return true;
 }
 
-static bool parseValueImpl(const char *mangled, DDemangleContext *ctx, const char *type_name, char type_char) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseValueImpl(DDemangleContext *ctx, const char *type_name, char type_char) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	switch (lookAhead(mangled, ctx, 0)) {
+	switch (lookAhead(ctx, 0)) {
 	case 'n':
-		consume(mangled, ctx);
+		consume(ctx);
 		if (type_char != 'N') {
-			demangleAppend(ctx, "null");
+			APPEND_LIT(ctx, "null");
 		} else {
-			demangleAppend(ctx, "typeof(null)");
+			APPEND_LIT(ctx, "typeof(null)");
 		}
 		break;
 	case 'i':
@@ -695,98 +818,100 @@ static bool parseValueImpl(const char *mangled, DDemangleContext *ctx, const cha
 	case '8':
 	case '9': {
 		bool is_neg = false;
-		if (lookAhead(mangled, ctx, 0) == 'i') {
-			consume(mangled, ctx);
-		} else if (lookAhead(mangled, ctx, 0) == 'N') {
+		if (lookAhead(ctx, 0) == 'i') {
+			consume(ctx);
+		} else if (lookAhead(ctx, 0) == 'N') {
 			is_neg = true;
-			consume(mangled, ctx);
+			consume(ctx);
 		}
 
-		size_t val = consumeDigits(mangled, ctx);
+		size_t val = consumeDigits(ctx);
 		if (type_char == 'b') {
 			if (val) {
-				demangleAppend(ctx, "true");
+				APPEND_LIT(ctx, "true");
 			} else {
-				demangleAppend(ctx, "false");
+				APPEND_LIT(ctx, "false");
 			}
 		} else if (type_char == 'a' || type_char == 'u' || type_char == 'w') {
 			switch (val) {
 			case '\'':
-				demangleAppend(ctx, "'\\''");
+				APPEND_LIT(ctx, "'\\''");
 				break;
 			case '\\':
-				demangleAppend(ctx, "'\\\\'");
+				APPEND_LIT(ctx, "'\\\\'");
 				break;
 			case '\a':
-				demangleAppend(ctx, "'\\a'");
+				APPEND_LIT(ctx, "'\\a'");
 				break;
 			case '\b':
-				demangleAppend(ctx, "'\\b'");
+				APPEND_LIT(ctx, "'\\b'");
 				break;
 			case '\f':
-				demangleAppend(ctx, "'\\f'");
+				APPEND_LIT(ctx, "'\\f'");
 				break;
 			case '\n':
-				demangleAppend(ctx, "'\\n'");
+				APPEND_LIT(ctx, "'\\n'");
 				break;
 			case '\r':
-				demangleAppend(ctx, "'\\r'");
+				APPEND_LIT(ctx, "'\\r'");
 				break;
 			case '\t':
-				demangleAppend(ctx, "'\\t'");
+				APPEND_LIT(ctx, "'\\t'");
 				break;
 			case '\v':
-				demangleAppend(ctx, "'\\v'");
+				APPEND_LIT(ctx, "'\\v'");
 				break;
 			default:
 				if (type_char == 'a') {
 					if (val >= 0x20 && val < 0x7F) {
-						demangleAppend(ctx, "'%c'", val);
+						APPEND_LIT(ctx, "'");
+						demangleAppendChar(ctx, (char)val);
+						APPEND_LIT(ctx, "'");
 					} else {
-						demangleAppend(ctx, "\\x%02x", (unsigned int)val);
+						demangleAppendf(ctx, "\\x%02x", (unsigned int)val);
 					}
 				} else if (type_char == 'u') {
-					demangleAppend(ctx, "'\\u%04x'", (unsigned int)val);
+					demangleAppendf(ctx, "'\\u%04x'", (unsigned int)val);
 				} else if (type_char == 'w') {
-					demangleAppend(ctx, "'\\U%08x'", (unsigned int)val);
+					demangleAppendf(ctx, "'\\U%08x'", (unsigned int)val);
 				}
 			}
 		} else {
 			if (is_neg) {
-				demangleAppend(ctx, "-");
+				APPEND_LIT(ctx, "-");
 			}
-			demangleAppend(ctx, "%zu", val);
+			demangleAppendf(ctx, "%zu", val);
 			if (type_char == 'h' || type_char == 't' || type_char == 'k') {
-				demangleAppend(ctx, "u");
+				APPEND_LIT(ctx, "u");
 			} else if (type_char == 'm') {
-				demangleAppend(ctx, "uL");
+				APPEND_LIT(ctx, "uL");
 			} else if (type_char == 'l') {
-				demangleAppend(ctx, "L");
+				APPEND_LIT(ctx, "L");
 			}
 		}
 		break;
 	}
 
 	case 'e':
-		consume(mangled, ctx);
-		if (!parseHexFloat(mangled, ctx)) {
+		consume(ctx);
+		if (!parseHexFloat(ctx)) {
 			return false;
 		}
 		if (type_char == 'f') {
-			demangleAppend(ctx, "f");
+			APPEND_LIT(ctx, "f");
 		} else if (type_char == 'e') {
-			demangleAppend(ctx, "L");
+			APPEND_LIT(ctx, "L");
 		}
 		break;
 	case 'c':
-		consume(mangled, ctx);
-		if (!parseHexFloat(mangled, ctx)) {
+		consume(ctx);
+		if (!parseHexFloat(ctx)) {
 			return false;
 		}
-		demangleAppend(ctx, "+");
-		if (lookAhead(mangled, ctx, 0) == 'c') {
-			consume(mangled, ctx);
-			if (!parseHexFloat(mangled, ctx)) {
+		APPEND_LIT(ctx, "+");
+		if (lookAhead(ctx, 0) == 'c') {
+			consume(ctx);
+			if (!parseHexFloat(ctx)) {
 				return false;
 			}
 		} else {
@@ -796,21 +921,21 @@ static bool parseValueImpl(const char *mangled, DDemangleContext *ctx, const cha
 	case 'a':
 	case 'w':
 	case 'd': {
-		char type = lookAhead(mangled, ctx, 0);
-		consume(mangled, ctx);
-		size_t n = consumeDigits(mangled, ctx);
-		if (ctx->err || lookAhead(mangled, ctx, 0) != '_') {
+		char type = lookAhead(ctx, 0);
+		consume(ctx);
+		size_t n = consumeDigits(ctx);
+		if (ctx->err || lookAhead(ctx, 0) != '_') {
 			ERR(ctx, false);
 		}
-		consume(mangled, ctx);
-		demangleAppend(ctx, "\"");
+		consume(ctx);
+		APPEND_LIT(ctx, "\"");
 		for (size_t i = 0; i < n; i++) {
-			char c1 = consumeHexDigit(mangled, ctx);
+			char c1 = consumeHexDigit(ctx);
 			int a = 0, b = 0;
 			if (!c1) {
 				ERR(ctx, false);
 			}
-			char c2 = consumeHexDigit(mangled, ctx);
+			char c2 = consumeHexDigit(ctx);
 			if (!c2) {
 				ERR(ctx, false);
 			}
@@ -833,109 +958,109 @@ static bool parseValueImpl(const char *mangled, DDemangleContext *ctx, const cha
 
 			char v = ((a << 4) | b);
 			if (' ' <= v && v <= '~') {
-				demangleAppend(ctx, "%c", v);
+				demangleAppendChar(ctx, v);
 			} else {
-				demangleAppend(ctx, "\\x%02x", (unsigned char)v);
+				demangleAppendf(ctx, "\\x%02x", (unsigned char)v);
 			}
 		}
-		demangleAppend(ctx, "\"");
+		APPEND_LIT(ctx, "\"");
 		if (type == 'w') {
-			demangleAppend(ctx, "w");
+			APPEND_LIT(ctx, "w");
 		} else if (type == 'd') {
-			demangleAppend(ctx, "d");
+			APPEND_LIT(ctx, "d");
 		}
 		break;
 	}
 	case 'A': {
 		if (type_char == 'H') {
-			consume(mangled, ctx);
-			demangleAppend(ctx, "[");
-			size_t n = consumeDigits(mangled, ctx);
+			consume(ctx);
+			APPEND_LIT(ctx, "[");
+			size_t n = consumeDigits(ctx);
 			if (ctx->err) {
 				return false;
 			}
 			for (size_t i = 0; i < n; i++) {
 				if (i > 0) {
-					demangleAppend(ctx, ", ");
+					APPEND_LIT(ctx, ", ");
 				}
-				if (!parseValue(mangled, ctx, NULL, '\0')) {
+				if (!parseValue(ctx, NULL, '\0')) {
 					ERR(ctx, false);
 				}
-				demangleAppend(ctx, ":");
-				if (!parseValue(mangled, ctx, NULL, '\0')) {
+				APPEND_LIT(ctx, ":");
+				if (!parseValue(ctx, NULL, '\0')) {
 					ERR(ctx, false);
 				}
 			}
-			demangleAppend(ctx, "]");
+			APPEND_LIT(ctx, "]");
 			break;
 		}
 
-		consume(mangled, ctx);
-		demangleAppend(ctx, "[");
-		size_t n = consumeDigits(mangled, ctx);
+		consume(ctx);
+		APPEND_LIT(ctx, "[");
+		size_t n = consumeDigits(ctx);
 		if (ctx->err) {
 			return false;
 		}
 
 		for (size_t i = 0; i < n; i++) {
 			if (i > 0) {
-				demangleAppend(ctx, ", ");
+				APPEND_LIT(ctx, ", ");
 			}
-			if (!parseValue(mangled, ctx, NULL, '\0')) {
+			if (!parseValue(ctx, NULL, '\0')) {
 				ERR(ctx, false);
 			}
 		}
-		demangleAppend(ctx, "]");
+		APPEND_LIT(ctx, "]");
 		break;
 	}
 	case 'H': {
-		consume(mangled, ctx);
-		demangleAppend(ctx, "[");
-		size_t n = consumeDigits(mangled, ctx);
+		consume(ctx);
+		APPEND_LIT(ctx, "[");
+		size_t n = consumeDigits(ctx);
 		if (ctx->err) {
 			return false;
 		}
 		for (size_t i = 0; i < n; i++) {
 			if (i > 0) {
-				demangleAppend(ctx, ", ");
+				APPEND_LIT(ctx, ", ");
 			}
-			if (!parseValue(mangled, ctx, NULL, '\0')) {
+			if (!parseValue(ctx, NULL, '\0')) {
 				ERR(ctx, false);
 			}
-			demangleAppend(ctx, ":");
-			if (!parseValue(mangled, ctx, NULL, '\0')) {
+			APPEND_LIT(ctx, ":");
+			if (!parseValue(ctx, NULL, '\0')) {
 				ERR(ctx, false);
 			}
 		}
-		demangleAppend(ctx, "]");
+		APPEND_LIT(ctx, "]");
 		break;
 	}
 	case 'S': {
-		consume(mangled, ctx);
+		consume(ctx);
 		if (type_name && strlen(type_name) > 0) {
-			demangleAppend(ctx, "%s", type_name);
+			demangleAppendN(ctx, type_name, strlen(type_name));
 		}
 
-		demangleAppend(ctx, "(");
-		size_t n = consumeDigits(mangled, ctx);
+		APPEND_LIT(ctx, "(");
+		size_t n = consumeDigits(ctx);
 		if (ctx->err) {
 			return false;
 		}
 
 		for (size_t i = 0; i < n; i++) {
 			if (i > 0) {
-				demangleAppend(ctx, ", ");
+				APPEND_LIT(ctx, ", ");
 			}
-			if (!parseValue(mangled, ctx, NULL, '\0')) {
+			if (!parseValue(ctx, NULL, '\0')) {
 				ERR(ctx, false);
 			}
 		}
-		demangleAppend(ctx, ")");
+		APPEND_LIT(ctx, ")");
 		break;
 	}
 	case 'f':
-		consume(mangled, ctx);
-		if (!parseMangledName(mangled, ctx, false)) {
+		consume(ctx);
+		if (!parseMangledName(ctx, false)) {
 			ERR(ctx, false);
 		}
 		break;
@@ -945,44 +1070,44 @@ static bool parseValueImpl(const char *mangled, DDemangleContext *ctx, const cha
 	return true;
 }
 
-static bool parseTemplateArgImpl(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseTemplateArgImpl(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
 	bool prev = ctx->in_template_arg;
 	ctx->in_template_arg = true;
 	DDemangleCtxRef ref = createCtxRef(ctx);
-	if (lookAhead(mangled, ctx, 0) == 'H') {
-		consume(mangled, ctx);
+	if (lookAhead(ctx, 0) == 'H') {
+		consume(ctx);
 	}
 
-	switch (lookAhead(mangled, ctx, 0)) {
+	switch (lookAhead(ctx, 0)) {
 	case 'T':
-		consume(mangled, ctx);
-		if (!parseType(mangled, ctx)) {
+		consume(ctx);
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			ctx->in_template_arg = prev;
 			return false;
 		}
 		break;
 	case 'V': {
-		consume(mangled, ctx);
-		char type_char = lookAhead(mangled, ctx, 0);
+		consume(ctx);
+		char type_char = lookAhead(ctx, 0);
 		if (type_char == 'Q') {
-			size_t saved_curr = ctx->curr;
-			size_t pos = parseBackRef(mangled, ctx);
-			if (!ctx->err && pos < ctx->curr) {
-				type_char = mangled[pos];
+			const char *saved_cur = ctx->cur;
+			const char *pos = parseBackRef(ctx);
+			if (!ctx->err && pos && pos < ctx->cur) {
+				type_char = *pos;
 			}
 			ctx->err = false;
-			ctx->curr = saved_curr;
+			ctx->cur = saved_cur;
 		}
 
 		DemString *saved = ctx->demangled;
 		DemString *type_str = dem_string_new();
 		ctx->demangled = type_str;
-		if (!parseType(mangled, ctx)) {
+		if (!parseType(ctx)) {
 			ctx->demangled = saved;
 			dem_string_free(type_str);
 			ctxRestore(ctx, ref);
@@ -991,7 +1116,7 @@ static bool parseTemplateArgImpl(const char *mangled, DDemangleContext *ctx) {
 		}
 
 		ctx->demangled = saved;
-		if (!parseValue(mangled, ctx, type_str->buf, type_char)) {
+		if (!parseValue(ctx, type_str->buf, type_char)) {
 			dem_string_free(type_str);
 			ctxRestore(ctx, ref);
 			ctx->in_template_arg = prev;
@@ -1001,12 +1126,12 @@ static bool parseTemplateArgImpl(const char *mangled, DDemangleContext *ctx) {
 		break;
 	}
 	case 'S':
-		consume(mangled, ctx);
-		if (lookAhead(mangled, ctx, 0) == '_' && lookAhead(mangled, ctx, 1) == 'D') {
-			consumeN(mangled, ctx, 2);
+		consume(ctx);
+		if (lookAhead(ctx, 0) == '_' && lookAhead(ctx, 1) == 'D') {
+			consumeN(ctx, 2);
 			DemString *str = dem_string_new();
 			DemString *saved = ctx->demangled;
-			if (!parseQualifiedName(mangled, ctx)) {
+			if (!parseQualifiedName(ctx)) {
 				dem_string_free(str);
 				ctxRestore(ctx, ref);
 				ctx->in_template_arg = prev;
@@ -1014,14 +1139,14 @@ static bool parseTemplateArgImpl(const char *mangled, DDemangleContext *ctx) {
 			}
 
 			ctx->demangled = str;
-			if (!consumeIf(mangled, ctx, 'Z')) {
-				parseType(mangled, ctx);
+			if (!consumeIf(ctx, 'Z')) {
+				parseType(ctx);
 			}
 
 			ctx->demangled = saved;
 			dem_string_free(str);
 		} else {
-			if (!parseQualifiedName(mangled, ctx)) {
+			if (!parseQualifiedName(ctx)) {
 				ctxRestore(ctx, ref);
 				ctx->in_template_arg = prev;
 				return false;
@@ -1029,8 +1154,8 @@ static bool parseTemplateArgImpl(const char *mangled, DDemangleContext *ctx) {
 		}
 		break;
 	case 'X':
-		consume(mangled, ctx);
-		if (!parseLName(mangled, ctx)) {
+		consume(ctx);
+		if (!parseLName(ctx)) {
 			ctxRestore(ctx, ref);
 			ctx->in_template_arg = prev;
 			return false;
@@ -1044,8 +1169,8 @@ static bool parseTemplateArgImpl(const char *mangled, DDemangleContext *ctx) {
 	return true;
 }
 
-static bool parseTemplateArgs(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseTemplateArgs(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
@@ -1053,9 +1178,9 @@ static bool parseTemplateArgs(const char *mangled, DDemangleContext *ctx) {
 	while (1) {
 		DDemangleCtxRef ref = createCtxRef(ctx);
 		if (parsed) {
-			demangleAppend(ctx, ", ");
+			APPEND_LIT(ctx, ", ");
 		}
-		if (parseTemplateArg(mangled, ctx)) {
+		if (parseTemplateArg(ctx)) {
 			parsed = true;
 		} else {
 			ctxRestore(ctx, ref);
@@ -1065,19 +1190,19 @@ static bool parseTemplateArgs(const char *mangled, DDemangleContext *ctx) {
 	return parsed;
 }
 
-static bool parseTemplateInstanceName(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseTemplateInstanceName(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
 	DDemangleCtxRef ref = createCtxRef(ctx);
-	if (parseTemplateID(mangled, ctx)) {
-		if (parseSymbolName(mangled, ctx)) {
-			demangleAppend(ctx, "!(");
-			bool has_args = parseTemplateArgs(mangled, ctx);
+	if (parseTemplateID(ctx)) {
+		if (parseSymbolName(ctx)) {
+			APPEND_LIT(ctx, "!(");
+			bool has_args = parseTemplateArgs(ctx);
 			(void)has_args;
-			if (consumeIf(mangled, ctx, 'Z')) {
-				demangleAppend(ctx, ")");
+			if (consumeIf(ctx, 'Z')) {
+				APPEND_LIT(ctx, ")");
 				return true;
 			}
 		}
@@ -1087,23 +1212,23 @@ static bool parseTemplateInstanceName(const char *mangled, DDemangleContext *ctx
 	ERR(ctx, false);
 }
 
-static bool parseSymbolName(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseSymbolName(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	if (lookAhead(mangled, ctx, 0) == '0') {
-		consume(mangled, ctx);
-	} else if (IS_DIGIT(lookAhead(mangled, ctx, 0))) {
-		if (!parseLName(mangled, ctx)) {
+	if (lookAhead(ctx, 0) == '0') {
+		consume(ctx);
+	} else if (IS_DIGIT(lookAhead(ctx, 0))) {
+		if (!parseLName(ctx)) {
 			return false;
 		}
-	} else if (lookAhead(mangled, ctx, 0) == 'Q') {
-		if (!expandBackRefSymbol(mangled, ctx)) {
+	} else if (lookAhead(ctx, 0) == 'Q') {
+		if (!expandBackRef(ctx, D_BACKREF_SYMBOL)) {
 			return false;
 		}
-	} else if (lookAhead(mangled, ctx, 0) == '_' || lookAhead(mangled, ctx, 0) == 'T' || lookAhead(mangled, ctx, 0) == 'U') {
-		if (!parseTemplateInstanceName(mangled, ctx)) {
+	} else if (lookAhead(ctx, 0) == '_' || lookAhead(ctx, 0) == 'T' || lookAhead(ctx, 0) == 'U') {
+		if (!parseTemplateInstanceName(ctx)) {
 			return false;
 		}
 	} else {
@@ -1113,45 +1238,45 @@ static bool parseSymbolName(const char *mangled, DDemangleContext *ctx) {
 	return true;
 }
 
-static bool parseCallingConvention(const char *mangled, DDemangleContext *ctx, DemString *dest) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseCallingConvention(DDemangleContext *ctx, DemString *dest) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	switch (lookAhead(mangled, ctx, 0)) {
+	switch (lookAhead(ctx, 0)) {
 	case 'F':
-		consume(mangled, ctx);
+		consume(ctx);
 		break;
 	case 'U':
-		consume(mangled, ctx);
+		consume(ctx);
 		if (dest) {
-			dem_string_appendf(dest, "extern (C) ");
+			DS_APPEND_LIT(dest, "extern (C) ");
 		} else {
-			demangleAppend(ctx, "extern (C) ");
+			APPEND_LIT(ctx, "extern (C) ");
 		}
 		break;
 	case 'W':
-		consume(mangled, ctx);
+		consume(ctx);
 		if (dest) {
-			dem_string_appendf(dest, "extern (Windows) ");
+			DS_APPEND_LIT(dest, "extern (Windows) ");
 		} else {
-			demangleAppend(ctx, "extern (Windows) ");
+			APPEND_LIT(ctx, "extern (Windows) ");
 		}
 		break;
 	case 'R':
-		consume(mangled, ctx);
+		consume(ctx);
 		if (dest) {
-			dem_string_appendf(dest, "extern (C++) ");
+			DS_APPEND_LIT(dest, "extern (C++) ");
 		} else {
-			demangleAppend(ctx, "extern (C++) ");
+			APPEND_LIT(ctx, "extern (C++) ");
 		}
 		break;
 	case 'Y':
-		consume(mangled, ctx);
+		consume(ctx);
 		if (dest) {
-			dem_string_appendf(dest, "extern (Objective-C) ");
+			DS_APPEND_LIT(dest, "extern (Objective-C) ");
 		} else {
-			demangleAppend(ctx, "extern (Objective-C) ");
+			APPEND_LIT(ctx, "extern (Objective-C) ");
 		}
 		break;
 	default:
@@ -1160,91 +1285,91 @@ static bool parseCallingConvention(const char *mangled, DDemangleContext *ctx, D
 	return true;
 }
 
-static bool parseParameter(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseParameter(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
 	DDemangleCtxRef ref = createCtxRef(ctx);
-	char c = lookAhead(mangled, ctx, 0);
-	char c1 = lookAhead(mangled, ctx, 1);
-	char c2 = lookAhead(mangled, ctx, 2);
-	char c3 = lookAhead(mangled, ctx, 3);
+	char c = lookAhead(ctx, 0);
+	char c1 = lookAhead(ctx, 1);
+	char c2 = lookAhead(ctx, 2);
+	char c3 = lookAhead(ctx, 3);
 	if (c == 'M' && c1 == 'N' && c2 == 'k' && c3 == 'J') {
-		consumeN(mangled, ctx, 4);
-		demangleAppend(ctx, "scope return out ");
+		consumeN(ctx, 4);
+		APPEND_LIT(ctx, "scope return out ");
 	} else if (c == 'M' && c1 == 'N' && c2 == 'k' && c3 == 'K') {
-		consumeN(mangled, ctx, 4);
-		demangleAppend(ctx, "scope return ref ");
+		consumeN(ctx, 4);
+		APPEND_LIT(ctx, "scope return ref ");
 	} else if (c == 'N' && c1 == 'k' && c2 == 'J') {
-		consumeN(mangled, ctx, 3);
-		demangleAppend(ctx, "return out ");
+		consumeN(ctx, 3);
+		APPEND_LIT(ctx, "return out ");
 	} else if (c == 'N' && c1 == 'k' && c2 == 'K') {
-		consumeN(mangled, ctx, 3);
-		demangleAppend(ctx, "return ref ");
+		consumeN(ctx, 3);
+		APPEND_LIT(ctx, "return ref ");
 	} else if (c == 'N' && c1 == 'k' && c2 == 'M' && c3 == 'J') {
-		consumeN(mangled, ctx, 4);
-		demangleAppend(ctx, "return scope out ");
+		consumeN(ctx, 4);
+		APPEND_LIT(ctx, "return scope out ");
 	} else if (c == 'N' && c1 == 'k' && c2 == 'M' && c3 == 'K') {
-		consumeN(mangled, ctx, 4);
-		demangleAppend(ctx, "return scope ref ");
+		consumeN(ctx, 4);
+		APPEND_LIT(ctx, "return scope ref ");
 	} else if (c == 'N' && c1 == 'k' && c2 == 'M') {
-		consumeN(mangled, ctx, 3);
-		demangleAppend(ctx, "return scope ");
+		consumeN(ctx, 3);
+		APPEND_LIT(ctx, "return scope ");
 	} else if (c == 'M') {
-		consume(mangled, ctx);
-		demangleAppend(ctx, "scope ");
+		consume(ctx);
+		APPEND_LIT(ctx, "scope ");
 	} else if (c == 'N' && c1 == 'k') {
-		consumeN(mangled, ctx, 2);
-		demangleAppend(ctx, "return ");
+		consumeN(ctx, 2);
+		APPEND_LIT(ctx, "return ");
 	}
 
-	switch (lookAhead(mangled, ctx, 0)) {
+	switch (lookAhead(ctx, 0)) {
 	case 'I':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "in ");
-		if (lookAhead(mangled, ctx, 0) == 'K') {
-			consume(mangled, ctx);
-			demangleAppend(ctx, "ref ");
+		consume(ctx);
+		APPEND_LIT(ctx, "in ");
+		if (lookAhead(ctx, 0) == 'K') {
+			consume(ctx);
+			APPEND_LIT(ctx, "ref ");
 		}
 		break;
 	case 'J':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "out ");
+		consume(ctx);
+		APPEND_LIT(ctx, "out ");
 		break;
 	case 'K':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "ref ");
+		consume(ctx);
+		APPEND_LIT(ctx, "ref ");
 		break;
 	case 'L':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "lazy ");
+		consume(ctx);
+		APPEND_LIT(ctx, "lazy ");
 		break;
 	}
 
-	if (!parseType(mangled, ctx)) {
+	if (!parseType(ctx)) {
 		ctxRestore(ctx, ref);
 		return false;
 	}
 	return true;
 }
 
-static bool parseParameters(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseParameters(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 	bool parsed = false;
 	while (1) {
-		char c = lookAhead(mangled, ctx, 0);
+		char c = lookAhead(ctx, 0);
 		if (c == 'X' || c == 'Y' || c == 'Z') {
 			break;
 		}
 
 		DDemangleCtxRef ref = createCtxRef(ctx);
 		if (parsed) {
-			demangleAppend(ctx, ", ");
+			APPEND_LIT(ctx, ", ");
 		}
-		if (parseParameter(mangled, ctx)) {
+		if (parseParameter(ctx)) {
 			parsed = true;
 		} else {
 			ctxRestore(ctx, ref);
@@ -1254,23 +1379,23 @@ static bool parseParameters(const char *mangled, DDemangleContext *ctx) {
 	return parsed;
 }
 
-static bool parseParamClose(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseParamClose(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	switch (lookAhead(mangled, ctx, 0)) {
+	switch (lookAhead(ctx, 0)) {
 	case 'X':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "...)");
+		consume(ctx);
+		APPEND_LIT(ctx, "...)");
 		break;
 	case 'Y':
-		consume(mangled, ctx);
-		demangleAppend(ctx, ", ...)");
+		consume(ctx);
+		APPEND_LIT(ctx, ", ...)");
 		break;
 	case 'Z':
-		consume(mangled, ctx);
-		demangleAppend(ctx, ")");
+		consume(ctx);
+		APPEND_LIT(ctx, ")");
 		break;
 	default:
 		return false;
@@ -1278,24 +1403,24 @@ static bool parseParamClose(const char *mangled, DDemangleContext *ctx) {
 	return true;
 }
 
-static bool parseTypeFunctionNoReturn(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseTypeFunctionNoReturn(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
-	FuncAttributes attrs = parseFuncAttrs(mangled, ctx);
-	demangleAppend(ctx, "(");
-	parseParameters(mangled, ctx);
+	FuncAttributes attrs = parseFuncAttrs(ctx);
+	APPEND_LIT(ctx, "(");
+	parseParameters(ctx);
 	if (ctx->demangled->len > 0 && ctx->demangled->buf[ctx->demangled->len - 1] == ' ') {
 		ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
 		ctx->demangled->len--;
 	}
 
-	if (!parseParamClose(mangled, ctx)) {
+	if (!parseParamClose(ctx)) {
 		return false;
 	}
 	if (attrs != FUNC_ATTR_NONE) {
-		demangleAppend(ctx, " ");
+		APPEND_LIT(ctx, " ");
 		writeFuncAttrs(attrs, ctx->demangled);
 		if (ctx->demangled->len > 0 && ctx->demangled->buf[ctx->demangled->len - 1] == ' ') {
 			ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
@@ -1305,19 +1430,19 @@ static bool parseTypeFunctionNoReturn(const char *mangled, DDemangleContext *ctx
 	return true;
 }
 
-static bool parseTypeFunction(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseTypeFunction(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
-	if (!parseCallingConvention(mangled, ctx, NULL)) {
+	if (!parseCallingConvention(ctx, NULL)) {
 		ERR(ctx, false);
 	}
 
 	DemString *saved = ctx->demangled;
 	DemString *args_str = dem_string_new();
 	ctx->demangled = args_str;
-	demangleAppend(ctx, "function");
-	if (!parseTypeFunctionNoReturn(mangled, ctx)) {
+	APPEND_LIT(ctx, "function");
+	if (!parseTypeFunctionNoReturn(ctx)) {
 		ctx->demangled = saved;
 		dem_string_free(args_str);
 		return false;
@@ -1325,7 +1450,7 @@ static bool parseTypeFunction(const char *mangled, DDemangleContext *ctx) {
 
 	DemString *ret_str = dem_string_new();
 	ctx->demangled = ret_str;
-	if (!parseType(mangled, ctx)) {
+	if (!parseType(ctx)) {
 		ctx->demangled = saved;
 		dem_string_free(args_str);
 		dem_string_free(ret_str);
@@ -1334,66 +1459,66 @@ static bool parseTypeFunction(const char *mangled, DDemangleContext *ctx) {
 
 	ctx->demangled = saved;
 	dem_string_concat(ctx->demangled, ret_str);
-	demangleAppend(ctx, " ");
+	APPEND_LIT(ctx, " ");
 	dem_string_concat(ctx->demangled, args_str);
 	dem_string_free(args_str);
 	dem_string_free(ret_str);
 	return true;
 }
 
-static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseTypeImpl(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
 	DDemangleCtxRef ref = createCtxRef(ctx);
-	char c = lookAhead(mangled, ctx, 0);
+	char c = lookAhead(ctx, 0);
 	if (c == 'x') {
-		consume(mangled, ctx);
-		demangleAppend(ctx, "const(");
-		if (!parseType(mangled, ctx)) {
+		consume(ctx);
+		APPEND_LIT(ctx, "const(");
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
-		demangleAppend(ctx, ")");
+		APPEND_LIT(ctx, ")");
 		return true;
 	} else if (c == 'y') {
-		consume(mangled, ctx);
-		demangleAppend(ctx, "immutable(");
-		if (!parseType(mangled, ctx)) {
+		consume(ctx);
+		APPEND_LIT(ctx, "immutable(");
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
-		demangleAppend(ctx, ")");
+		APPEND_LIT(ctx, ")");
 		return true;
 	} else if (c == 'O') {
-		consume(mangled, ctx);
-		demangleAppend(ctx, "shared(");
-		if (!parseType(mangled, ctx)) {
+		consume(ctx);
+		APPEND_LIT(ctx, "shared(");
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
-		demangleAppend(ctx, ")");
+		APPEND_LIT(ctx, ")");
 		return true;
-	} else if (c == 'N' && lookAhead(mangled, ctx, 1) == 'g') {
-		consumeN(mangled, ctx, 2);
-		demangleAppend(ctx, "inout(");
-		if (!parseType(mangled, ctx)) {
+	} else if (c == 'N' && lookAhead(ctx, 1) == 'g') {
+		consumeN(ctx, 2);
+		APPEND_LIT(ctx, "inout(");
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
-		demangleAppend(ctx, ")");
+		APPEND_LIT(ctx, ")");
 		return true;
 	}
 
-	if (lookAhead(mangled, ctx, 0) == 'Q') {
-		return expandBackRefType(mangled, ctx);
+	if (lookAhead(ctx, 0) == 'Q') {
+		return expandBackRef(ctx, D_BACKREF_TYPE);
 	}
 
-	switch (lookAhead(mangled, ctx, 0)) {
+	switch (lookAhead(ctx, 0)) {
 	case 'A':
-		consume(mangled, ctx);
-		if (!parseType(mangled, ctx)) {
+		consume(ctx);
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
@@ -1401,11 +1526,11 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 			ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
 			ctx->demangled->len--;
 		}
-		demangleAppend(ctx, "[]");
+		APPEND_LIT(ctx, "[]");
 		break;
 	case 'P':
-		consume(mangled, ctx);
-		if (!parseType(mangled, ctx)) {
+		consume(ctx);
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
@@ -1413,18 +1538,18 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 			ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
 			ctx->demangled->len--;
 		}
-		demangleAppend(ctx, "*");
+		APPEND_LIT(ctx, "*");
 		break;
 	case 'G': {
-		consume(mangled, ctx);
-		bool has_digits = IS_DIGIT(lookAhead(mangled, ctx, 0));
+		consume(ctx);
+		bool has_digits = IS_DIGIT(lookAhead(ctx, 0));
 		size_t size = 0;
 		if (has_digits) {
-			size = consumeDigits(mangled, ctx);
+			size = consumeDigits(ctx);
 		} else {
 			ERR(ctx, false);
 		}
-		if (!parseType(mangled, ctx)) {
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
@@ -1432,22 +1557,23 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 			ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
 			ctx->demangled->len--;
 		}
-		demangleAppend(ctx, "[%zu]", size);
+		demangleAppendf(ctx, "[%zu]", size);
 		break;
 	}
 	case 'H':
-		consume(mangled, ctx);
+		consume(ctx);
 		DemString *key_str = dem_string_new();
 		DemString *saved = ctx->demangled;
 		ctx->demangled = key_str;
-		if (!parseType(mangled, ctx)) {
+		if (!parseType(ctx)) {
 			ctx->demangled = saved;
 			dem_string_free(key_str);
 			ctxRestore(ctx, ref);
 			return false;
 		}
 		ctx->demangled = saved;
-		if (!parseType(mangled, ctx)) {
+		if (!parseType(ctx)) {
+			dem_string_free(key_str);
 			ctxRestore(ctx, ref);
 			return false;
 		}
@@ -1455,9 +1581,9 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 			ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
 			ctx->demangled->len--;
 		}
-		demangleAppend(ctx, "[");
+		APPEND_LIT(ctx, "[");
 		dem_string_concat(ctx->demangled, key_str);
-		demangleAppend(ctx, "]");
+		APPEND_LIT(ctx, "]");
 		dem_string_free(key_str);
 		break;
 	case 'F':
@@ -1465,55 +1591,60 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 	case 'W':
 	case 'R':
 	case 'Y':
-		return parseTypeFunction(mangled, ctx);
+		return parseTypeFunction(ctx);
 	case 'N':
-		if (lookAhead(mangled, ctx, 1) == 'n') {
-			consumeN(mangled, ctx, 2);
-			demangleAppend(ctx, "noreturn");
+		if (lookAhead(ctx, 1) == 'n') {
+			consumeN(ctx, 2);
+			APPEND_LIT(ctx, "noreturn");
 			return true;
-		} else if (lookAhead(mangled, ctx, 1) != 'h') {
+		} else if (lookAhead(ctx, 1) != 'h') {
 			return false;
 		}
-		consumeN(mangled, ctx, 2);
-		demangleAppend(ctx, "__vector(");
-		if (!parseType(mangled, ctx)) {
+		consumeN(ctx, 2);
+		APPEND_LIT(ctx, "__vector(");
+		if (!parseType(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
-		demangleAppend(ctx, ")");
+		APPEND_LIT(ctx, ")");
 		break;
 	case 'I':
 	case 'C':
 	case 'S':
 	case 'E':
 	case 'T':
-		consume(mangled, ctx);
-		if (!parseQualifiedName(mangled, ctx)) {
+		consume(ctx);
+		if (!parseQualifiedName(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
 		break;
 	case 'D': {
-		consume(mangled, ctx);
-		TypeCtor type_modifiers = parseModifier(mangled, ctx);
-		if (lookAhead(mangled, ctx, 0) == 'Q') {
-			size_t pos = parseBackRef(mangled, ctx);
-			if (ctx->err || pos >= ctx->curr) {
+		consume(ctx);
+		TypeCtor type_modifiers = parseModifier(ctx);
+		if (lookAhead(ctx, 0) == 'Q') {
+			const char *q = ctx->cur;
+			const char *pos = parseBackRef(ctx);
+			if (ctx->err || !pos || pos >= ctx->cur) {
 				return false;
 			}
 
-			size_t saved_curr = ctx->curr;
-			ctx->curr = pos;
-			if (!parseCallingConvention(mangled, ctx, NULL)) {
-				ctx->curr = saved_curr;
+			const char *saved_cur = ctx->cur;
+			const char *saved_backref = ctx->last_backref;
+			ctx->cur = pos;
+			ctx->last_backref = q;
+			if (!parseCallingConvention(ctx, NULL)) {
+				ctx->cur = saved_cur;
+				ctx->last_backref = saved_backref;
 				return false;
 			}
 			DemString *saved_demangled = ctx->demangled;
 			DemString *args_str = dem_string_new();
 			ctx->demangled = args_str;
-			demangleAppend(ctx, "delegate");
-			if (!parseTypeFunctionNoReturn(mangled, ctx)) {
-				ctx->curr = saved_curr;
+			APPEND_LIT(ctx, "delegate");
+			if (!parseTypeFunctionNoReturn(ctx)) {
+				ctx->cur = saved_cur;
+				ctx->last_backref = saved_backref;
 				ctx->demangled = saved_demangled;
 				dem_string_free(args_str);
 				return false;
@@ -1521,17 +1652,19 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 
 			DemString *ret_str = dem_string_new();
 			ctx->demangled = ret_str;
-			if (!parseType(mangled, ctx)) {
-				ctx->curr = saved_curr;
+			if (!parseType(ctx)) {
+				ctx->cur = saved_cur;
+				ctx->last_backref = saved_backref;
 				ctx->demangled = saved_demangled;
 				dem_string_free(args_str);
 				dem_string_free(ret_str);
 				return false;
 			}
 
-			ctx->curr = saved_curr;
+			ctx->cur = saved_cur;
+			ctx->last_backref = saved_backref;
 			if (type_modifiers != TYPE_CTOR_NONE) {
-				dem_string_appendf(args_str, " ");
+				DS_APPEND_LIT(args_str, " ");
 				writeModifiers(type_modifiers, args_str);
 				if (args_str->len > 0 && args_str->buf[args_str->len - 1] == ' ') {
 					args_str->buf[args_str->len - 1] = '\0';
@@ -1541,27 +1674,27 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 
 			ctx->demangled = saved_demangled;
 			dem_string_concat(ctx->demangled, ret_str);
-			demangleAppend(ctx, " ");
+			APPEND_LIT(ctx, " ");
 			dem_string_concat(ctx->demangled, args_str);
 			dem_string_free(args_str);
 			dem_string_free(ret_str);
 		} else {
-			if (!parseCallingConvention(mangled, ctx, NULL)) {
+			if (!parseCallingConvention(ctx, NULL)) {
 				return false;
 			}
 
 			DemString *saved_demangled = ctx->demangled;
 			DemString *args_str = dem_string_new();
 			ctx->demangled = args_str;
-			demangleAppend(ctx, "delegate");
-			if (!parseTypeFunctionNoReturn(mangled, ctx)) {
+			APPEND_LIT(ctx, "delegate");
+			if (!parseTypeFunctionNoReturn(ctx)) {
 				ctx->demangled = saved_demangled;
 				dem_string_free(args_str);
 				return false;
 			}
 
 			if (type_modifiers != TYPE_CTOR_NONE) {
-				demangleAppend(ctx, " ");
+				APPEND_LIT(ctx, " ");
 				writeModifiers(type_modifiers, ctx->demangled);
 				if (ctx->demangled->len > 0 && ctx->demangled->buf[ctx->demangled->len - 1] == ' ') {
 					ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
@@ -1571,7 +1704,7 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 
 			DemString *ret_str = dem_string_new();
 			ctx->demangled = ret_str;
-			if (!parseType(mangled, ctx)) {
+			if (!parseType(ctx)) {
 				ctx->demangled = saved_demangled;
 				dem_string_free(args_str);
 				dem_string_free(ret_str);
@@ -1580,7 +1713,7 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 
 			ctx->demangled = saved_demangled;
 			dem_string_concat(ctx->demangled, ret_str);
-			demangleAppend(ctx, " ");
+			APPEND_LIT(ctx, " ");
 			dem_string_concat(ctx->demangled, args_str);
 			dem_string_free(args_str);
 			dem_string_free(ret_str);
@@ -1588,121 +1721,121 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 		break;
 	}
 	case 'v':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "void");
+		consume(ctx);
+		APPEND_LIT(ctx, "void");
 		break;
 	case 'g':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "byte");
+		consume(ctx);
+		APPEND_LIT(ctx, "byte");
 		break;
 	case 'h':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "ubyte");
+		consume(ctx);
+		APPEND_LIT(ctx, "ubyte");
 		break;
 	case 's':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "short");
+		consume(ctx);
+		APPEND_LIT(ctx, "short");
 		break;
 	case 't':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "ushort");
+		consume(ctx);
+		APPEND_LIT(ctx, "ushort");
 		break;
 	case 'i':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "int");
+		consume(ctx);
+		APPEND_LIT(ctx, "int");
 		break;
 	case 'k':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "uint");
+		consume(ctx);
+		APPEND_LIT(ctx, "uint");
 		break;
 	case 'l':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "long");
+		consume(ctx);
+		APPEND_LIT(ctx, "long");
 		break;
 	case 'm':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "ulong");
+		consume(ctx);
+		APPEND_LIT(ctx, "ulong");
 		break;
 	case 'f':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "float");
+		consume(ctx);
+		APPEND_LIT(ctx, "float");
 		break;
 	case 'd':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "double");
+		consume(ctx);
+		APPEND_LIT(ctx, "double");
 		break;
 	case 'e':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "real");
+		consume(ctx);
+		APPEND_LIT(ctx, "real");
 		break;
 	case 'o':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "ifloat");
+		consume(ctx);
+		APPEND_LIT(ctx, "ifloat");
 		break;
 	case 'p':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "idouble");
+		consume(ctx);
+		APPEND_LIT(ctx, "idouble");
 		break;
 	case 'j':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "ireal");
+		consume(ctx);
+		APPEND_LIT(ctx, "ireal");
 		break;
 	case 'q':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "cfloat");
+		consume(ctx);
+		APPEND_LIT(ctx, "cfloat");
 		break;
 	case 'r':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "cdouble");
+		consume(ctx);
+		APPEND_LIT(ctx, "cdouble");
 		break;
 	case 'c':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "creal");
+		consume(ctx);
+		APPEND_LIT(ctx, "creal");
 		break;
 	case 'b':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "bool");
+		consume(ctx);
+		APPEND_LIT(ctx, "bool");
 		break;
 	case 'a':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "char");
+		consume(ctx);
+		APPEND_LIT(ctx, "char");
 		break;
 	case 'u':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "wchar");
+		consume(ctx);
+		APPEND_LIT(ctx, "wchar");
 		break;
 	case 'w':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "dchar");
+		consume(ctx);
+		APPEND_LIT(ctx, "dchar");
 		break;
 	case 'n':
-		consume(mangled, ctx);
+		consume(ctx);
 		break;
 	case 'Z':
-		consume(mangled, ctx);
+		consume(ctx);
 		break;
 	case 'z':
-		switch (lookAhead(mangled, ctx, 1)) {
+		switch (lookAhead(ctx, 1)) {
 		case 'i':
-			consumeN(mangled, ctx, 2);
-			demangleAppend(ctx, "cent");
+			consumeN(ctx, 2);
+			APPEND_LIT(ctx, "cent");
 			break;
 		case 'k':
-			consumeN(mangled, ctx, 2);
-			demangleAppend(ctx, "ucent");
+			consumeN(ctx, 2);
+			APPEND_LIT(ctx, "ucent");
 			break;
 		default: return false;
 		}
 		break;
 	case 'B':
-		consume(mangled, ctx);
-		demangleAppend(ctx, "tuple!(");
-		if (!parseParameters(mangled, ctx)) {
+		consume(ctx);
+		APPEND_LIT(ctx, "tuple!(");
+		if (!parseParameters(ctx)) {
 			ctxRestore(ctx, ref);
 			return false;
 		}
-		if (lookAhead(mangled, ctx, 0) == 'Z') {
-			consume(mangled, ctx);
+		if (lookAhead(ctx, 0) == 'Z') {
+			consume(ctx);
 		} else {
 			return false;
 		}
@@ -1713,13 +1846,13 @@ static bool parseTypeImpl(const char *mangled, DDemangleContext *ctx) {
 	return true;
 }
 
-static bool parseSymbolFunctionName(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseSymbolFunctionName(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
 	DDemangleCtxRef ref = createCtxRef(ctx);
-	if (!parseSymbolName(mangled, ctx)) {
+	if (!parseSymbolName(ctx)) {
 		ctxRestore(ctx, ref);
 		return false;
 	}
@@ -1729,44 +1862,44 @@ static bool parseSymbolFunctionName(const char *mangled, DDemangleContext *ctx)
 	ctx->attr = dem_string_new();
 	TypeCtor modifiers = TYPE_CTOR_NONE;
 	bool m = false;
-	if (lookAhead(mangled, ctx, 0) == 'M') {
-		consume(mangled, ctx);
+	if (lookAhead(ctx, 0) == 'M') {
+		consume(ctx);
 		m = true;
-		modifiers = parseModifier(mangled, ctx);
+		modifiers = parseModifier(ctx);
 	}
 
-	if (isCallConvention(lookAhead(mangled, ctx, 0))) {
+	if (isCallConvention(lookAhead(ctx, 0))) {
 		if (ctx->in_template_arg) {
 			if ((modifiers & TYPE_CTOR_CONST) == TYPE_CTOR_CONST) {
-				demangleAppend(ctx, "const ");
+				APPEND_LIT(ctx, "const ");
 				modifiers &= ~TYPE_CTOR_CONST;
 			}
 			if ((modifiers & TYPE_CTOR_INOUT) == TYPE_CTOR_INOUT) {
-				demangleAppend(ctx, "inout ");
+				APPEND_LIT(ctx, "inout ");
 				modifiers &= ~TYPE_CTOR_INOUT;
 			}
 			if ((modifiers & TYPE_CTOR_SHARED) == TYPE_CTOR_SHARED) {
-				demangleAppend(ctx, "shared ");
+				APPEND_LIT(ctx, "shared ");
 				modifiers &= ~TYPE_CTOR_SHARED;
 			}
 			if ((modifiers & TYPE_CTOR_IMMUTABLE) == TYPE_CTOR_IMMUTABLE) {
-				demangleAppend(ctx, "immutable ");
+				APPEND_LIT(ctx, "immutable ");
 				modifiers &= ~TYPE_CTOR_IMMUTABLE;
 			}
 		}
 
 		writeModifiers(modifiers, ctx->attr);
-		parseCallingConvention(mangled, ctx, ctx->attr);
-		FuncAttributes attrs = parseFuncAttrs(mangled, ctx);
+		parseCallingConvention(ctx, ctx->attr);
+		FuncAttributes attrs = parseFuncAttrs(ctx);
 		writeFuncAttrs(attrs, ctx->attr);
-		demangleAppend(ctx, "(");
-		parseParameters(mangled, ctx);
+		APPEND_LIT(ctx, "(");
+		parseParameters(ctx);
 		if (ctx->demangled->len > 0 && ctx->demangled->buf[ctx->demangled->len - 1] == ' ') {
 			ctx->demangled->buf[ctx->demangled->len - 1] = '\0';
 			ctx->demangled->len--;
 		}
 
-		if (!parseParamClose(mangled, ctx)) {
+		if (!parseParamClose(ctx)) {
 			ctxRestore(ctx, ref_after_name);
 			ctx->err = false;
 			dem_string_free(ctx->attr);
@@ -1815,8 +1948,8 @@ static bool parseSymbolFunctionName(const char *mangled, DDemangleContext *ctx)
 	return true;
 }
 
-static bool parseQualifiedName(const char *mangled, DDemangleContext *ctx) {
-	if (!mangled || !ctx || ctx->err) {
+static bool parseQualifiedName(DDemangleContext *ctx) {
+	if (!ctx || ctx->err) {
 		return false;
 	}
 
@@ -1824,9 +1957,9 @@ static bool parseQualifiedName(const char *mangled, DDemangleContext *ctx) {
 	while (1) {
 		DDemangleCtxRef ref = createCtxRef(ctx);
 		if (parsed) {
-			demangleAppend(ctx, ".");
+			APPEND_LIT(ctx, ".");
 		}
-		if (parseSymbolFunctionName(mangled, ctx)) {
+		if (parseSymbolFunctionName(ctx)) {
 			parsed = true;
 		} else {
 			ctxRestore(ctx, ref);
@@ -1836,18 +1969,29 @@ static bool parseQualifiedName(const char *mangled, DDemangleContext *ctx) {
 	return parsed;
 }
 
-DEM_LIB_EXPORT char *libdemangle_handler_d(const char *mangled, RzDemangleOpts opts) {
-	DDemangleContext *ctx = malloc(sizeof(DDemangleContext));
+static char *dmd_demangle(const char *mangled) {
+	DDemangleContext *ctx = dem_malloc(sizeof(DDemangleContext));
 	if (!ctx) {
 		return NULL;
 	}
 
-	ctx->demangled = dem_string_new();
+	if (!mangled) {
+		RZ_FREE(ctx);
+		return NULL;
+	}
+
+	size_t length = strlen(mangled);
+	// the output is rarely longer than twice the input, thus it is seldom reallocated
+	ctx->demangled = dem_string_new_with_capacity(length * 2 + 64);
 	ctx->attr = dem_string_new();
-	ctx->curr = 0;
 	ctx->err = false;
 	ctx->in_template_arg = false;
-	if (!mangled) {
+	memset(&ctx->backrefs, 0, sizeof(ctx->backrefs));
+	ctx->beg = mangled;
+	ctx->cur = mangled;
+	ctx->end = mangled + length;
+	ctx->last_backref = ctx->end;
+	if (!ctx->demangled || !ctx->attr) {
 		dem_string_free(ctx->demangled);
 		dem_string_free(ctx->attr);
 		RZ_FREE(ctx);
@@ -1855,13 +1999,24 @@ DEM_LIB_EXPORT char *libdemangle_handler_d(const char *mangled, RzDemangleOpts o
 	}
 
 	char *res = NULL;
-	consumeWhile(mangled, ctx, ' ');
-	if (parseMangledName(mangled, ctx, true)) {
+	consumeWhile(ctx, ' ');
+	if (parseMangledName(ctx, true)) {
 		res = dem_string_drain(ctx->demangled);
 	} else {
 		dem_string_free(ctx->demangled);
 	}
 	dem_string_free(ctx->attr);
+	dem_free(ctx->backrefs.entries);
+	dem_string_deinit(&ctx->backrefs.rendered);
 	RZ_FREE(ctx);
 	return res;
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_d(const char *mangled, RzDemangleOpts opts) {
+	DemNegativeKey key;
+	if (!mangled || dem_negative_lookup(&key, DEM_LANG_D, mangled, SIZE_MAX, opts)) {
+		return NULL;
+	}
+	dem_budget_begin();
+	return dem_negative_record(&key, dem_budget_end(dmd_demangle(mangled)));
+}
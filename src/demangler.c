@@ -38,7 +38,7 @@ get_mangling_type_err:
 EDemanglerErr create_demangler(SDemangler **demangler) {
 	EDemanglerErr err = eDemanglerErrOK;
 
-	*demangler = (SDemangler *)malloc(sizeof(SDemangler));
+	*demangler = (SDemangler *)dem_malloc(sizeof(SDemangler));
 
 	if (!*demangler) {
 		err = eDemanglerErrMemoryAllocation;
@@ -85,7 +85,7 @@ EDemanglerErr init_demangler(SDemangler *demangler, char *sym) {
 		goto init_demangler_err;
 	}
 
-	demangler->symbol = strdup(sym);
+	demangler->symbol = dem_strdup(sym);
 	demangler->demangle = demangle_funcs[mangling_type];
 
 init_demangler_err:
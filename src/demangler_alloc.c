@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+/* Every allocation made by the library goes through the functions below. */
+
+static void *libc_malloc(void *user, size_t size) {
+	(void)user;
+	return malloc(size);
+}
+
+static void *libc_calloc(void *user, size_t count, size_t size) {
+	(void)user;
+	return calloc(count, size);
+}
+
+static void *libc_realloc(void *user, void *ptr, size_t size) {
+	(void)user;
+	return realloc(ptr, size);
+}
+
+static void libc_free(void *user, void *ptr) {
+	(void)user;
+	free(ptr);
+}
+
+static RzDemangleAllocator global_allocator = {
+	.malloc = libc_malloc,
+	.calloc = libc_calloc,
+	.realloc = libc_realloc,
+	.free = libc_free,
+	.user = NULL,
+};
+
+static DEM_THREAD_LOCAL const RzDemangleAllocator *thread_allocator = NULL;
+
+/**
+ * Sizes of the live allocations, needed to know how many bytes are released
+ * by dem_free(). The table is only filled while the statistics are enabled
+ * and it is allocated with libc, so it never shows up in the statistics.
+ */
+typedef struct {
+	void **ptrs;
+	size_t *sizes;
+	size_t capacity; ///< always a power of two
+	size_t used; ///< live entries plus tombstones
+} AllocSizeTable;
+
+typedef struct {
+	bool enabled;
+	RzDemangleAllocStats stats;
+	AllocSizeTable table;
+} AllocTracker;
+
+static DEM_THREAD_LOCAL AllocTracker tracker;
+
+#define SIZE_TABLE_TOMBSTONE ((void *)(uintptr_t)1)
+
+static inline size_t size_table_slot(const AllocSizeTable *table, const void *ptr) {
+	uintptr_t h = (uintptr_t)ptr;
+	h ^= h >> 17;
+	h *= (uintptr_t)0x9E3779B97F4A7C15ull;
+	return (size_t)(h >> 7) & (table->capacity - 1);
+}
+
+static bool size_table_insert(AllocSizeTable *table, void *ptr, size_t size);
+
+static bool size_table_grow(AllocSizeTable *table) {
+	AllocSizeTable grown = { 0 };
+	grown.capacity = table->capacity ? table->capacity * 2 : 256;
+	grown.ptrs = calloc(grown.capacity, sizeof(void *));
+	grown.sizes = calloc(grown.capacity, sizeof(size_t));
+	if (!grown.ptrs || !grown.sizes) {
+		free(grown.ptrs);
+		free(grown.sizes);
+		return false;
+	}
+	for (size_t i = 0; i < table->capacity; i++) {
+		void *ptr = table->ptrs[i];
+		if (ptr && ptr != SIZE_TABLE_TOMBSTONE) {
+			size_table_insert(&grown, ptr, table->sizes[i]);
+		}
+	}
+	free(table->ptrs);
+	free(table->sizes);
+	*table = grown;
+	return true;
+}
+
+static bool size_table_insert(AllocSizeTable *table, void *ptr, size_t size) {
+	if ((table->used + 1) * 4 > table->capacity * 3 && !size_table_grow(table)) {
+		return false;
+	}
+	size_t i = size_table_slot(table, ptr);
+	while (table->ptrs[i] && table->ptrs[i] != SIZE_TABLE_TOMBSTONE) {
+		i = (i + 1) & (table->capacity - 1);
+	}
+	if (!table->ptrs[i]) {
+		table->used++;
+	}
+	table->ptrs[i] = ptr;
+	table->sizes[i] = size;
+	return true;
+}
+
+/* returns the size of the removed entry, or 0 when ptr is not tracked */
+static size_t size_table_remove(AllocSizeTable *table, const void *ptr) {
+	if (!table->capacity) {
+		return 0;
+	}
+	size_t i = size_table_slot(table, ptr);
+	while (table->ptrs[i]) {
+		if (table->ptrs[i] == ptr) {
+			table->ptrs[i] = SIZE_TABLE_TOMBSTONE;
+			return table->sizes[i];
+		}
+		i = (i + 1) & (table->capacity - 1);
+	}
+	return 0;
+}
+
+static void size_table_fini(AllocSizeTable *table) {
+	free(table->ptrs);
+	free(table->sizes);
+	memset(table, 0, sizeof(*table));
+}
+
+static void track_alloc(void *ptr, size_t size) {
+	RzDemangleAllocStats *stats = &tracker.stats;
+	stats->allocations++;
+	stats->bytes += size;
+	stats->live += size;
+	if (stats->live > stats->peak) {
+		stats->peak = stats->live;
+	}
+	size_table_insert(&tracker.table, ptr, size);
+}
+
+static void track_free(void *ptr) {
+	RzDemangleAllocStats *stats = &tracker.stats;
+	size_t size = size_table_remove(&tracker.table, ptr);
+	stats->frees++;
+	stats->live -= RZ_MIN(size, stats->live);
+}
+
+static inline const RzDemangleAllocator *current_allocator(void) {
+	return thread_allocator ? thread_allocator : &global_allocator;
+}
+
+void *dem_malloc(size_t size) {
+	const RzDemangleAllocator *a = current_allocator();
+	void *ptr = a->malloc(a->user, size);
+	if (ptr && tracker.enabled) {
+		track_alloc(ptr, size);
+	}
+	return ptr;
+}
+
+void *dem_calloc(size_t count, size_t size) {
+	const RzDemangleAllocator *a = current_allocator();
+	void *ptr = a->calloc(a->user, count, size);
+	if (ptr && tracker.enabled) {
+		track_alloc(ptr, count * size);
+	}
+	return ptr;
+}
+
+void *dem_realloc(void *ptr, size_t size) {
+	const RzDemangleAllocator *a = current_allocator();
+	void *res = a->realloc(a->user, ptr, size);
+	if (res && tracker.enabled) {
+		if (ptr) {
+			size_t old = size_table_remove(&tracker.table, ptr);
+			tracker.stats.live -= RZ_MIN(old, tracker.stats.live);
+		}
+		track_alloc(res, size);
+	}
+	return res;
+}
+
+void dem_free(void *ptr) {
+	if (!ptr) {
+		return;
+	}
+	const RzDemangleAllocator *a = current_allocator();
+	if (tracker.enabled) {
+		track_free(ptr);
+	}
+	a->free(a->user, ptr);
+}
+
+char *dem_strdup(const char *str) {
+	if (!str) {
+		return NULL;
+	}
+	return dem_str_ndup(str, strlen(str));
+}
+
+/**
+ * \brief Installs the allocator used by every thread without its own one
+ *
+ * The allocator is copied without any locking, so it must not be called
+ * while other threads are demangling; install it once at startup, or use
+ * libdemangle_set_thread_allocator() to change it at runtime. Strings
+ * allocated before the change must be released with the allocator that
+ * created them.
+ *
+ * \param allocator The allocator to install, NULL restores libc.
+ */
+DEM_LIB_EXPORT void libdemangle_set_allocator(const RzDemangleAllocator *allocator) {
+	if (!allocator) {
+		global_allocator.malloc = libc_malloc;
+		global_allocator.calloc = libc_calloc;
+		global_allocator.realloc = libc_realloc;
+		global_allocator.free = libc_free;
+		global_allocator.user = NULL;
+		return;
+	}
+	global_allocator = *allocator;
+}
+
+DEM_LIB_EXPORT const RzDemangleAllocator *libdemangle_set_thread_allocator(const RzDemangleAllocator *allocator) {
+	const RzDemangleAllocator *previous = thread_allocator;
+	thread_allocator = allocator;
+	return previous;
+}
+
+DEM_LIB_EXPORT void libdemangle_free(void *ptr) {
+	dem_free(ptr);
+}
+
+DEM_LIB_EXPORT void libdemangle_stats_enable(bool enable) {
+	if (!enable) {
+		size_table_fini(&tracker.table);
+	}
+	tracker.enabled = enable;
+}
+
+DEM_LIB_EXPORT void libdemangle_stats_reset(void) {
+	memset(&tracker.stats, 0, sizeof(tracker.stats));
+	size_table_fini(&tracker.table);
+}
+
+DEM_LIB_EXPORT void libdemangle_stats_get(RzDemangleAllocStats *stats) {
+	if (stats) {
+		*stats = tracker.stats;
+	}
+}
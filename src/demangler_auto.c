@@ -0,0 +1,339 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+typedef char *(*DemHandler)(const char *symbol, RzDemangleOpts opts);
+
+struct rz_demangle_batch_t {
+	RzDemangleOpts opts;
+	size_t sample_size; ///< number of symbols classified before voting
+	RzDemangleBatchStats stats;
+};
+
+/**
+ * Names reach the C++ engine only when the classifier found an Itanium
+ * prefix or a GNU v2 form, thus the GNU v2 fallback is always enabled.
+ */
+static char *auto_handler_cxx(const char *symbol, RzDemangleOpts opts) {
+	return libdemangle_handler_cxx(symbol, opts | RZ_DEMANGLE_OPT_CXX_V2_FALLBACK);
+}
+
+static const DemHandler auto_handlers[RZ_DEMANGLE_SCHEME_MAX] = {
+	[RZ_DEMANGLE_SCHEME_CXX] = auto_handler_cxx,
+	[RZ_DEMANGLE_SCHEME_RUST_LEGACY] = libdemangle_handler_rust,
+	[RZ_DEMANGLE_SCHEME_RUST_V0] = libdemangle_handler_rust,
+	[RZ_DEMANGLE_SCHEME_MSVC] = libdemangle_handler_msvc,
+	[RZ_DEMANGLE_SCHEME_BORLAND] = libdemangle_handler_cxx,
+	[RZ_DEMANGLE_SCHEME_D] = libdemangle_handler_d,
+#if WITH_SWIFT_DEMANGLER
+	[RZ_DEMANGLE_SCHEME_SWIFT] = libdemangle_handler_swift,
+#endif
+	[RZ_DEMANGLE_SCHEME_JAVA] = libdemangle_handler_java,
+	[RZ_DEMANGLE_SCHEME_OBJC] = libdemangle_handler_objc,
+	[RZ_DEMANGLE_SCHEME_PASCAL] = libdemangle_handler_pascal,
+};
+
+/**
+ * Rust legacy symbols are valid Itanium names, but usually end with the
+ * `17h<16 hex digits>E` hash segment, optionally followed by a `.` suffix.
+ */
+static bool auto_is_rust_hash(const char *hash) {
+	if (hash[0] != '1' || hash[1] != '7' || hash[2] != 'h') {
+		return false;
+	}
+	for (size_t i = 3; i < 19; i++) {
+		if (!IS_HEX(hash[i])) {
+			return false;
+		}
+	}
+	return hash[19] == 'E' && (!hash[20] || hash[20] == '.');
+}
+
+#define IS_JAVA_PRIMITIVE(x) ((x) && strchr("BCDFIJSVZ", (x)))
+
+/**
+ * Java type descriptors: primitives, arrays and `L` followed by a path
+ * made of `/` separated names (with optional generics) and terminated by `;`.
+ */
+static bool auto_is_java(const char *p) {
+	while (*p == '[') {
+		p++;
+	}
+	if (IS_JAVA_PRIMITIVE(*p) && !p[1]) {
+		return true;
+	} else if (*p++ != 'L' || !(IS_ALPHA(*p) || *p == '_' || *p == '$')) {
+		return false;
+	}
+	bool terminated = false;
+	for (; *p; p++) {
+		if (*p == ';') {
+			terminated = true;
+		} else if (!(IS_ALPHA(*p) || IS_DIGIT(*p) || strchr("_$/<>*[+-.()", *p))) {
+			return false;
+		}
+	}
+	return terminated;
+}
+
+/**
+ * GNU v2 special names: `_vt`, `_GLOBAL_`, destructors (`_$_`, `_._`),
+ * static members (`_3foo$bar`, `_Q2...`) and `__` constructors, templates
+ * and type infos.
+ */
+static bool auto_is_gnu_v2(const char *p) {
+	if (p[1] == '_') {
+		return IS_DIGIT(p[2]) || p[2] == 'Q' || p[2] == 't' || !strncmp(p, "__vt_", 5);
+	}
+	return IS_DIGIT(p[1]) || p[1] == 'Q' || ((p[1] == '$' || p[1] == '.') && p[2] == '_') ||
+		!strncmp(p, "_vt", 3) || !strncmp(p, "_GLOBAL_", 8);
+}
+
+/**
+ * \brief Classifies the symbol by looking at its prefix
+ *
+ * Only symbols without a distinctive prefix (Pascal, GNU v2 C++) and
+ * `_ZN` names, shared between C++ and Rust legacy, are scanned further.
+ * \p fallback is set to the scheme to try when the first one fails.
+ */
+static RzDemangleScheme auto_classify(const char *symbol, RzDemangleScheme *fallback) {
+	*fallback = RZ_DEMANGLE_SCHEME_UNKNOWN;
+	if (RZ_STR_ISEMPTY(symbol)) {
+		return RZ_DEMANGLE_SCHEME_UNKNOWN;
+	}
+
+	const char *p = symbol;
+	bool v2 = false;
+	switch (p[0]) {
+	case '?':
+		return RZ_DEMANGLE_SCHEME_MSVC;
+	case '.':
+		return p[1] == '?' ? RZ_DEMANGLE_SCHEME_MSVC : RZ_DEMANGLE_SCHEME_UNKNOWN;
+	case '@':
+		return RZ_DEMANGLE_SCHEME_BORLAND;
+	case '+':
+	case '-':
+		return p[1] == '[' ? RZ_DEMANGLE_SCHEME_OBJC : RZ_DEMANGLE_SCHEME_UNKNOWN;
+	case 'L':
+	case '[':
+		if (auto_is_java(p)) {
+			return RZ_DEMANGLE_SCHEME_JAVA;
+		}
+		break;
+	case '$':
+		if (p[1] == 's' || p[1] == 'S' || p[1] == 'e') {
+			return RZ_DEMANGLE_SCHEME_SWIFT;
+		}
+		break;
+	case '_':
+		if (p[1] == '_' && (p[2] == 'Z' || p[2] == 'R' || p[2] == 'T')) {
+			p++;
+		}
+		switch (p[1]) {
+		case 'Z':
+			if (p[2] != 'N') {
+				return RZ_DEMANGLE_SCHEME_CXX;
+			}
+			break;
+		case 'R':
+			return IS_UPPER(p[2]) ? RZ_DEMANGLE_SCHEME_RUST_V0 : RZ_DEMANGLE_SCHEME_UNKNOWN;
+		case 'T':
+			if (IS_UPPER(p[2]) || p[2] == 't') {
+				return RZ_DEMANGLE_SCHEME_SWIFT;
+			}
+			break;
+		case '$':
+			if (p[2] == 's' || p[2] == 'S' || p[2] == 'e') {
+				return RZ_DEMANGLE_SCHEME_SWIFT;
+			}
+			break;
+		case 'D':
+			if (IS_DIGIT(p[2]) || !strcmp(p + 2, "main")) {
+				return RZ_DEMANGLE_SCHEME_D;
+			}
+			break;
+		case 'O':
+			if (!strncmp(p, "_OBJC_", 6)) {
+				return RZ_DEMANGLE_SCHEME_OBJC;
+			}
+			break;
+		case 'i':
+		case 'c':
+			if (p[2] == '_') {
+				*fallback = RZ_DEMANGLE_SCHEME_CXX;
+				return RZ_DEMANGLE_SCHEME_OBJC;
+			}
+			break;
+		default:
+			break;
+		}
+		v2 = auto_is_gnu_v2(p);
+		break;
+	default:
+		if (IS_JAVA_PRIMITIVE(p[0]) && !p[1]) {
+			return RZ_DEMANGLE_SCHEME_JAVA;
+		}
+		break;
+	}
+
+	// single scan for the schemes that are recognized by their content;
+	// `.` starts a suffix, except in rust legacy names.
+	bool is_nested = (p[0] == '_' && p[1] == 'Z' && p[2] == 'N') || (p[0] == 'Z' && p[1] == 'N');
+	bool dollar = false, pascal = false, rust_hash = false;
+	const char *end = p;
+	for (; *end && (*end != '.' || is_nested); end++) {
+		if (*end == '$') {
+			dollar = true;
+			pascal |= end[1] == '$' || (end[1] == '_' && end[2] == '$');
+		} else if (*end == '_' && end[1] == '_' && end > p) {
+			v2 = true;
+		} else if ((*end == '+' || *end == '-') && end[1] == '[') {
+			// block invocations like ___32+[Foo bar]_block_invoke
+			return RZ_DEMANGLE_SCHEME_OBJC;
+		} else if (*end == '1' && is_nested) {
+			rust_hash |= auto_is_rust_hash(end);
+		} else if (*end == '(' && !is_nested) {
+			// java method descriptors like name(Ljava/lang/String;)V
+			return RZ_DEMANGLE_SCHEME_JAVA;
+		}
+	}
+	if (is_nested) {
+		if (dollar || rust_hash) {
+			*fallback = RZ_DEMANGLE_SCHEME_CXX;
+			return RZ_DEMANGLE_SCHEME_RUST_LEGACY;
+		}
+		*fallback = RZ_DEMANGLE_SCHEME_RUST_LEGACY;
+		return RZ_DEMANGLE_SCHEME_CXX;
+	} else if (pascal) {
+		return RZ_DEMANGLE_SCHEME_PASCAL;
+	} else if (v2) {
+		return RZ_DEMANGLE_SCHEME_CXX;
+	} else if (*end == '.' && end > p && auto_is_java(end + 1)) {
+		// java fields with their type, like name.Ljava/lang/String;
+		return RZ_DEMANGLE_SCHEME_JAVA;
+	} else if (dollar) {
+		return RZ_DEMANGLE_SCHEME_PASCAL;
+	}
+	return RZ_DEMANGLE_SCHEME_UNKNOWN;
+}
+
+/**
+ * \brief Returns the mangling scheme the symbol most likely belongs to
+ */
+DEM_LIB_EXPORT RzDemangleScheme libdemangle_classify(const char *symbol) {
+	RzDemangleScheme fallback;
+	return auto_classify(symbol, &fallback);
+}
+
+/**
+ * Runs the engines of \p first and then \p second, until one succeeds.
+ */
+static char *auto_demangle(const char *symbol, RzDemangleOpts opts, RzDemangleScheme first, RzDemangleScheme second, RzDemangleScheme *scheme, RzDemangleBatchStats *stats) {
+	RzDemangleScheme tries[2] = { first, second };
+	char *result = NULL;
+	RzDemangleScheme found = RZ_DEMANGLE_SCHEME_UNKNOWN;
+	for (size_t i = 0; i < 2 && !result; i++) {
+		found = tries[i];
+		if (!auto_handlers[found]) {
+			continue;
+		}
+		result = auto_handlers[found](symbol, opts);
+		if (stats) {
+			stats->attempts[found]++;
+			stats->successes[found] += result != NULL;
+		}
+		if (!result && libdemangle_last_status() == RZ_DEMANGLE_STATUS_BUDGET_EXCEEDED) {
+			break;
+		}
+	}
+	if (scheme) {
+		*scheme = result ? found : RZ_DEMANGLE_SCHEME_UNKNOWN;
+	}
+	return result;
+}
+
+/**
+ * \brief Demangles a symbol of unknown scheme
+ *
+ * The symbol is classified by its prefix and handed to exactly one engine;
+ * a second one is tried only for ambiguous prefixes, like `_ZN` which is
+ * shared between C++ and Rust legacy.
+ *
+ * \param symbol  The mangled symbol
+ * \param opts    The demangling options
+ * \param scheme  Optional, set to the scheme of the engine that demangled the symbol
+ */
+DEM_LIB_EXPORT char *libdemangle_auto(const char *symbol, RzDemangleOpts opts, RzDemangleScheme *scheme) {
+	RzDemangleScheme fallback;
+	RzDemangleScheme found = auto_classify(symbol, &fallback);
+	return auto_demangle(symbol, opts, found, fallback, scheme, NULL);
+}
+
+/**
+ * \brief Creates a batch for demangling the symbols of one binary
+ *
+ * The first \p sample_size mangled symbols vote with their classification;
+ * the scheme of the following ones is assumed to be among the voted ones, so
+ * ambiguous symbols are handed first to the dominant engine and engines
+ * that got no vote are never tried as a fallback.
+ *
+ * \param sample_size  Number of symbols to sample, 0 disables the voting
+ * \param opts         The demangling options
+ */
+DEM_LIB_EXPORT RzDemangleBatch *libdemangle_batch_new(size_t sample_size, RzDemangleOpts opts) {
+	RzDemangleBatch *batch = RZ_NEW0(RzDemangleBatch);
+	if (!batch) {
+		return NULL;
+	}
+	batch->opts = opts;
+	batch->sample_size = sample_size;
+	return batch;
+}
+
+DEM_LIB_EXPORT void libdemangle_batch_free(RzDemangleBatch *batch) {
+	dem_free(batch);
+}
+
+/**
+ * \brief Demangles the next symbol of the batch, like libdemangle_auto()
+ */
+DEM_LIB_EXPORT char *libdemangle_batch_demangle(RzDemangleBatch *batch, const char *symbol, RzDemangleScheme *scheme) {
+	if (!batch) {
+		return NULL;
+	}
+	RzDemangleBatchStats *stats = &batch->stats;
+	RzDemangleScheme fallback;
+	RzDemangleScheme found = auto_classify(symbol, &fallback);
+	stats->symbols++;
+
+	// unmangled names do not vote, so a leading run of plain C symbols
+	// cannot prune every fallback.
+	if (found && stats->sampled < batch->sample_size) {
+		stats->sampled++;
+		stats->votes[found]++;
+	} else if (stats->sampled && fallback) {
+		// the table decides between the two candidates.
+		if (stats->votes[fallback] > stats->votes[found]) {
+			RzDemangleScheme tmp = found;
+			found = fallback;
+			fallback = tmp;
+		} else if (!stats->votes[fallback]) {
+			fallback = RZ_DEMANGLE_SCHEME_UNKNOWN;
+		}
+	}
+
+	char *result = auto_demangle(symbol, batch->opts, found, fallback, scheme, stats);
+	stats->demangled += result != NULL;
+	return result;
+}
+
+/**
+ * \brief Copies the counters of the batch into \p stats
+ */
+DEM_LIB_EXPORT void libdemangle_batch_stats(const RzDemangleBatch *batch, RzDemangleBatchStats *stats) {
+	if (!batch || !stats) {
+		return;
+	}
+	*stats = batch->stats;
+}
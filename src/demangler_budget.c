@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+DEM_THREAD_LOCAL DemBudget dem_budget;
+
+/**
+ * Resets the budget counters when entering the outermost public handler,
+ * so that nested handlers (e.g. ObjC falling back to C++) share one budget.
+ */
+void dem_budget_begin(void) {
+	if (!dem_budget.depth++) {
+		dem_budget.nodes = 0;
+		dem_budget.output = 0;
+		dem_budget.steps = 0;
+		dem_budget.exceeded = false;
+	}
+}
+
+/**
+ * Records the status of the call and drops the (possibly truncated) result
+ * when the budget has been exceeded.
+ */
+char *dem_budget_end(char *result) {
+	if (--dem_budget.depth) {
+		return result;
+	}
+	if (dem_budget.exceeded) {
+		dem_free(result);
+		dem_budget.status = RZ_DEMANGLE_STATUS_BUDGET_EXCEEDED;
+		return NULL;
+	}
+	dem_budget.status = result ? RZ_DEMANGLE_STATUS_OK : RZ_DEMANGLE_STATUS_FAILED;
+	return result;
+}
+
+DEM_LIB_EXPORT void libdemangle_set_budget(const RzDemangleBudget *budget) {
+	if (budget) {
+		dem_budget.limit = *budget;
+	} else {
+		memset(&dem_budget.limit, 0, sizeof(dem_budget.limit));
+	}
+}
+
+DEM_LIB_EXPORT RzDemangleStatus libdemangle_last_status(void) {
+	return dem_budget.status;
+}
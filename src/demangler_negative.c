@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+/**
+ * Blocked bloom filter of the symbols that failed to demangle. Each key sets
+ * NEGATIVE_PROBES bits within a single 512 bits block, thus a lookup touches
+ * one cache line. The filter outlives any single call, thus its words are
+ * allocated with libc, like the allocation size table: an allocator such as
+ * an arena reset between calls never owns them, and they never show
+ * up in the allocation statistics.
+ */
+#define NEGATIVE_BLOCK_WORDS 8
+#define NEGATIVE_BLOCK_BITS  (NEGATIVE_BLOCK_WORDS * 64)
+#define NEGATIVE_PROBES      6
+/* insertions per bit, kept below 1/24 so false positives stay under ~0.02% */
+#define NEGATIVE_BITS_PER_KEY 24
+
+typedef struct {
+	ut64 *words; ///< NULL when the filter is disabled
+	size_t n_blocks; ///< always a power of two
+	size_t capacity; ///< insertions before the filter is cleared
+	RzDemangleNegativeStats stats;
+} NegativeFilter;
+
+static DEM_THREAD_LOCAL NegativeFilter filter;
+
+static inline ut64 negative_mix(ut64 h) {
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 31;
+	return h;
+}
+
+static ut64 negative_hash(DemLanguage lang, const char *symbol, size_t length, RzDemangleOpts opts) {
+	ut64 h = 0xCBF29CE484222325ull ^ (((ut64)lang << 32) | (ut32)opts);
+	for (size_t i = 0; i < length && symbol[i]; i++) {
+		h ^= (ut8)symbol[i];
+		h *= 0x100000001B3ull;
+	}
+	return negative_mix(h);
+}
+
+static inline ut64 *negative_block(ut64 hash) {
+	return filter.words + (hash & (filter.n_blocks - 1)) * NEGATIVE_BLOCK_WORDS;
+}
+
+static bool negative_test(ut64 hash) {
+	const ut64 *block = negative_block(hash);
+	ut64 bits = negative_mix(hash + 0x9E3779B97F4A7C15ull);
+	for (size_t i = 0; i < NEGATIVE_PROBES; i++, bits >>= 9) {
+		size_t bit = bits & (NEGATIVE_BLOCK_BITS - 1);
+		if (!(block[bit / 64] & (1ull << (bit % 64)))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void negative_set(ut64 hash) {
+	ut64 *block = negative_block(hash);
+	ut64 bits = negative_mix(hash + 0x9E3779B97F4A7C15ull);
+	for (size_t i = 0; i < NEGATIVE_PROBES; i++, bits >>= 9) {
+		size_t bit = bits & (NEGATIVE_BLOCK_BITS - 1);
+		block[bit / 64] |= 1ull << (bit % 64);
+	}
+}
+
+static void negative_clear(void) {
+	memset(filter.words, 0, filter.n_blocks * NEGATIVE_BLOCK_WORDS * sizeof(ut64));
+	filter.stats.insertions = 0;
+}
+
+/**
+ * \brief Checks if the symbol already failed for the given language and options.
+ *
+ * The key is always initialized and must be handed to dem_negative_record()
+ * together with the result of the handler.
+ *
+ * \return true when the handler can return NULL without parsing the symbol.
+ */
+bool dem_negative_lookup(DemNegativeKey *key, DemLanguage lang, const char *symbol, size_t length, RzDemangleOpts opts) {
+	key->active = filter.words != NULL;
+	if (!key->active) {
+		return false;
+	}
+	key->hash = negative_hash(lang, symbol, length, opts);
+	if (!negative_test(key->hash)) {
+		return false;
+	}
+	filter.stats.hits++;
+	if (!dem_budget.depth) {
+		dem_budget.status = RZ_DEMANGLE_STATUS_FAILED;
+	}
+	return true;
+}
+
+/**
+ * \brief Records a failure of the handler, unless it was caused by the budget.
+ *
+ * \return the given result.
+ */
+char *dem_negative_record(const DemNegativeKey *key, char *result) {
+	if (result || !key->active || !filter.words || dem_budget.exceeded) {
+		return result;
+	}
+	if (filter.stats.insertions >= filter.capacity) {
+		negative_clear();
+		filter.stats.saturations++;
+	}
+	negative_set(key->hash);
+	filter.stats.insertions++;
+	return NULL;
+}
+
+/**
+ * \brief Enables the negative-result filter of the calling thread.
+ *
+ * Symbols that fail to demangle are recorded per language and options, so
+ * that asking again for them returns NULL before any parser runs. The filter
+ * is approximate: a symbol that never failed may be reported as failing with
+ * a probability below ~0.02%, since the filter is cleared before it holds
+ * more than one entry every 24 bits. Failures caused by the budget are never
+ * recorded.
+ *
+ * \param bits Size of the filter, rounded up to a power of two of at least
+ *             512 bits; 0 disables the filter and releases its memory.
+ * \return false when the filter could not be allocated.
+ */
+DEM_LIB_EXPORT bool libdemangle_negative_filter_enable(size_t bits) {
+	free(filter.words);
+	memset(&filter, 0, sizeof(filter));
+	if (!bits) {
+		return true;
+	}
+
+	size_t n_blocks = 1;
+	while (n_blocks * NEGATIVE_BLOCK_BITS < bits && n_blocks < SIZE_MAX / (2 * NEGATIVE_BLOCK_BITS)) {
+		n_blocks *= 2;
+	}
+	filter.words = calloc(n_blocks * NEGATIVE_BLOCK_WORDS, sizeof(ut64));
+	if (!filter.words) {
+		return false;
+	}
+	filter.n_blocks = n_blocks;
+	filter.capacity = n_blocks * NEGATIVE_BLOCK_BITS / NEGATIVE_BITS_PER_KEY;
+	filter.stats.bits = n_blocks * NEGATIVE_BLOCK_BITS;
+	return true;
+}
+
+/**
+ * \brief Forgets every failure recorded by the calling thread and clears the counters.
+ */
+DEM_LIB_EXPORT void libdemangle_negative_filter_reset(void) {
+	if (!filter.words) {
+		return;
+	}
+	negative_clear();
+	filter.stats.hits = 0;
+	filter.stats.saturations = 0;
+}
+
+DEM_LIB_EXPORT void libdemangle_negative_filter_stats(RzDemangleNegativeStats *stats) {
+	if (stats) {
+		*stats = filter.stats;
+	}
+}
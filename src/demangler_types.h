@@ -13,6 +13,7 @@ typedef enum EDemanglerErr {
 	eDemanglerErrUnkown, ///< unknown mangling scheme
 	eDemanglerErrUncorrectMangledSymbol, ///< uncorrect mangled symbol
 	eDemanglerErrInternal, ///< when something very wrong happens
+	eDemanglerErrBudgetExceeded, ///< the per-call budget (see RzDemangleBudget) ran out
 	eDemanglerErrMax
 } EDemanglerErr;
 
@@ -55,7 +55,7 @@ char *dem_str_replace(char *str, const char *key, const char *val, int g) {
 			int tlen = slen - (off + klen);
 			slen += vlen - klen;
 			if (vlen > klen) {
-				newstr = realloc(str, slen + 1);
+				newstr = dem_realloc(str, slen + 1);
 				if (!newstr) {
 					RZ_FREE(str);
 					break;
@@ -76,11 +76,16 @@ char *dem_str_replace(char *str, const char *key, const char *val, int g) {
 }
 
 char *dem_str_ndup(const char *ptr, size_t len) {
-	char *out = malloc(len + 1);
+	if (!ptr && len) {
+		return NULL;
+	}
+	char *out = dem_malloc(len + 1);
 	if (!out) {
 		return NULL;
 	}
-	memcpy(out, ptr, len);
+	if (len) {
+		memcpy(out, ptr, len);
+	}
 	out[len] = 0;
 	return out;
 }
@@ -92,12 +97,12 @@ char *dem_str_newf(const char *fmt, ...) {
 	va_start(ap, fmt);
 	if (!strchr(fmt, '%')) {
 		va_end(ap);
-		return strdup(fmt);
+		return dem_strdup(fmt);
 	}
 	va_copy(ap2, ap);
 	int ret = vsnprintf(NULL, 0, fmt, ap2);
 	ret++;
-	char *p = calloc(1, ret);
+	char *p = dem_calloc(1, ret);
 	if (p) {
 		(void)vsnprintf(p, ret, fmt, ap);
 	}
@@ -108,16 +113,16 @@ char *dem_str_newf(const char *fmt, ...) {
 
 char *dem_str_append(char *ptr, const char *string) {
 	if (string && !ptr) {
-		return strdup(string);
+		return dem_strdup(string);
 	}
 	if (RZ_STR_ISEMPTY(string)) {
 		return ptr;
 	}
 	int plen = strlen(ptr);
 	int slen = strlen(string);
-	char *newptr = realloc(ptr, slen + plen + 1);
+	char *newptr = dem_realloc(ptr, slen + plen + 1);
 	if (!newptr) {
-		free(ptr);
+		dem_free(ptr);
 		return NULL;
 	}
 	ptr = newptr;
@@ -140,7 +145,7 @@ void dem_string_free(DemString *ds) {
 		return;
 	}
 	dem_string_deinit(ds);
-	free(ds);
+	dem_free(ds);
 }
 
 DemString *dem_string_new_with_capacity(size_t cap) {
@@ -151,9 +156,9 @@ DemString *dem_string_new_with_capacity(size_t cap) {
 	if (!ds) {
 		return NULL;
 	}
-	ds->buf = malloc(cap);
+	ds->buf = dem_malloc(cap);
 	if (!ds->buf) {
-		free(ds);
+		dem_free(ds);
 		return NULL;
 	}
 	ds->cap = cap;
@@ -176,7 +181,7 @@ void dem_string_deinit(DemString *ds) {
 		return;
 	}
 	if (ds->buf) {
-		free(ds->buf);
+		dem_free(ds->buf);
 	}
 	memset(ds, 0, sizeof(DemString));
 }
@@ -215,7 +220,7 @@ DemString *dem_string_init_clone(DemString *dst, const DemString *src) {
 	}
 
 	if (src->buf) {
-		dst->buf = strdup(src->buf);
+		dst->buf = dem_strdup(src->buf);
 		dst->len = strlen(dst->buf);
 		dst->cap = dst->len;
 	} else {
@@ -230,14 +235,17 @@ static bool dem_string_has_enough_capacity(DemString *ds, size_t size) {
 }
 
 static bool dem_string_increase_capacity(DemString *ds, size_t size) {
+	if (!dem_budget_output(size)) {
+		return false;
+	}
 	if (dem_string_has_enough_capacity(ds, size)) {
 		return true;
 	}
 	char *tmp = NULL;
 	if (ds->cap < 1) {
-		tmp = malloc(size + 1);
+		tmp = dem_malloc(size + 1);
 	} else {
-		tmp = realloc(ds->buf, ds->cap + size + 1);
+		tmp = dem_realloc(ds->buf, ds->cap + size + 1);
 	}
 	if (!tmp) {
 		return false;
@@ -252,7 +260,7 @@ char *dem_string_drain_no_free(DemString *ds) {
 	char *ret = ds->buf;
 	if (ds->len + 1 < ds->cap) {
 		// optimise memory space.
-		ret = realloc(ret, ds->len + 1);
+		ret = dem_realloc(ret, ds->len + 1);
 	}
 	ds->buf = NULL;
 	ds->len = 0;
@@ -271,7 +279,7 @@ char *dem_string_drain_no_free(DemString *ds) {
 char *dem_string_drain(DemString *ds) {
 	dem_return_val_if_fail(ds, NULL);
 	char *ret = dem_string_drain_no_free(ds);
-	free(ds);
+	dem_free(ds);
 	return ret;
 }
 
@@ -319,13 +327,13 @@ bool dem_string_append_n(DemString *ds, const char *string, size_t size) {
 
 	// Safe to proceed: either no realloc needed, or string is now external (copy)
 	if (!dem_string_increase_capacity(ds, size)) {
-		free(string_copy);
+		dem_free(string_copy);
 		return false;
 	}
 
 	// Fix cid: 900607
 	if (!ds->buf) {
-		free(string_copy);
+		dem_free(string_copy);
 		return false;
 	}
 
@@ -333,7 +341,7 @@ bool dem_string_append_n(DemString *ds, const char *string, size_t size) {
 	ds->len += size;
 	ds->buf[ds->len] = 0;
 
-	free(string_copy); // No-op if NULL
+	dem_free(string_copy); // No-op if NULL
 	return true;
 }
 
@@ -423,6 +431,39 @@ bool dem_string_append_char(DemString *ds, const char ch) {
 	return true;
 }
 
+/**
+ * \brief Appends the UTF-8 encoding of the code point \p cp
+ *
+ * \return false when \p cp is not a valid code point or on allocation failure
+ */
+bool dem_string_append_utf8(DemString *ds, ut32 cp) {
+	dem_return_val_if_fail(ds, false);
+	char utf8[4];
+	size_t size;
+	if (cp < 0x80) {
+		utf8[0] = cp;
+		size = 1;
+	} else if (cp < 0x800) {
+		utf8[0] = 0xc0 | (cp >> 6);
+		utf8[1] = 0x80 | (cp & 0x3f);
+		size = 2;
+	} else if (cp < 0x10000) {
+		utf8[0] = 0xe0 | (cp >> 12);
+		utf8[1] = 0x80 | ((cp >> 6) & 0x3f);
+		utf8[2] = 0x80 | (cp & 0x3f);
+		size = 3;
+	} else if (cp < 0x110000) {
+		utf8[0] = 0xf0 | (cp >> 18);
+		utf8[1] = 0x80 | ((cp >> 12) & 0x3f);
+		utf8[2] = 0x80 | ((cp >> 6) & 0x3f);
+		utf8[3] = 0x80 | (cp & 0x3f);
+		size = 4;
+	} else {
+		return false;
+	}
+	return dem_string_append_n(ds, utf8, size);
+}
+
 void dem_string_replace_char(DemString *ds, char ch, char rp) {
 	if (!ds->buf) {
 		return;
@@ -518,7 +559,7 @@ void dem_list_delete(DemList *list, DemListIter *iter) {
 		list->free(iter->data);
 	}
 	iter->data = NULL;
-	free(iter);
+	dem_free(iter);
 }
 
 void dem_list_purge(DemList *list) {
@@ -537,7 +578,7 @@ void dem_list_purge(DemList *list) {
 void dem_list_free(DemList *list) {
 	if (list) {
 		dem_list_purge(list);
-		free(list);
+		dem_free(list);
 	}
 }
 
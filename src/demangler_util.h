@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <rz_libdemangle.h>
 
 #if defined(_MSC_VER)
 #include <BaseTsd.h>
@@ -22,12 +23,18 @@ typedef SSIZE_T ssize_t;
 
 #endif
 
+#if defined(_MSC_VER)
+#define DEM_THREAD_LOCAL __declspec(thread)
+#else
+#define DEM_THREAD_LOCAL __thread
+#endif
+
 #define RZ_ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
-#define RZ_NEW0(x)       (x *)calloc(1, sizeof(x))
-#define RZ_NEW(x)        (x *)malloc(sizeof(x))
+#define RZ_NEW0(x)       (x *)dem_calloc(1, sizeof(x))
+#define RZ_NEW(x)        (x *)dem_malloc(sizeof(x))
 #define RZ_FREE(x) \
 	{ \
-		free((void *)x); \
+		dem_free((void *)x); \
 		x = NULL; \
 	}
 
@@ -54,8 +61,81 @@ typedef long long st64;
 #define IS_ALPHA(x)       (IS_UPPER(x) || IS_LOWER(x))
 #define IS_PRINTABLE(x)   ((x) >= ' ' && (x) <= '~')
 #define RZ_MIN(x, y)      (((x) > (y)) ? (y) : (x))
+#define RZ_MAX(x, y)      (((x) > (y)) ? (x) : (y))
 #define RZ_STR_ISEMPTY(x) (!(x) || !*(x))
 
+/* allocation functions, see libdemangle_set_allocator() */
+void *dem_malloc(size_t size);
+void *dem_calloc(size_t count, size_t size);
+void *dem_realloc(void *ptr, size_t size);
+void dem_free(void *ptr);
+char *dem_strdup(const char *str);
+
+/**
+ * Per-call budget of the calling thread, see libdemangle_set_budget().
+ * The counters are reset when a public handler is entered.
+ */
+typedef struct {
+	RzDemangleBudget limit;
+	size_t nodes;
+	size_t output;
+	size_t steps;
+	ut32 depth; ///< nesting level of the public handlers
+	bool exceeded;
+	RzDemangleStatus status;
+} DemBudget;
+
+extern DEM_THREAD_LOCAL DemBudget dem_budget;
+
+static inline bool dem_budget_charge(size_t *used, size_t amount, size_t limit) {
+	*used += amount;
+	if (limit && *used > limit) {
+		dem_budget.exceeded = true;
+	}
+	return !dem_budget.exceeded;
+}
+
+/* each returns false once any limit of the current call has been exceeded */
+static inline bool dem_budget_node(void) {
+	return dem_budget_charge(&dem_budget.nodes, 1, dem_budget.limit.max_nodes);
+}
+
+static inline bool dem_budget_step(void) {
+	return dem_budget_charge(&dem_budget.steps, 1, dem_budget.limit.max_steps);
+}
+
+static inline bool dem_budget_output(size_t size) {
+	return dem_budget_charge(&dem_budget.output, size, dem_budget.limit.max_output);
+}
+
+static inline bool dem_budget_exceeded(void) {
+	return dem_budget.exceeded;
+}
+
+void dem_budget_begin(void);
+char *dem_budget_end(char *result);
+
+/* languages of the public handlers, part of the negative-result filter keys */
+typedef enum {
+	DEM_LANG_CXX = 0,
+	DEM_LANG_RUST,
+	DEM_LANG_MSVC,
+	DEM_LANG_D,
+	DEM_LANG_SWIFT,
+	DEM_LANG_JAVA,
+	DEM_LANG_OBJC,
+	DEM_LANG_PASCAL,
+} DemLanguage;
+
+typedef struct {
+	ut64 hash;
+	bool active; ///< false when the filter is disabled
+} DemNegativeKey;
+
+/* see libdemangle_negative_filter_enable(); length may be SIZE_MAX for NUL-terminated symbols */
+bool dem_negative_lookup(DemNegativeKey *key, DemLanguage lang, const char *symbol, size_t length, RzDemangleOpts opts);
+char *dem_negative_record(const DemNegativeKey *key, char *result);
+
 char *dem_str_ndup(const char *ptr, size_t len);
 char *dem_str_newf(const char *fmt, ...);
 char *dem_str_append(char *ptr, const char *string);
@@ -83,6 +163,7 @@ bool dem_string_append_n(DemString *ds, const char *string, size_t size);
 bool dem_string_appendf(DemString *ds, const char *fmt, ...);
 bool dem_string_appendv(DemString *ds, const char *fmt, va_list varg);
 bool dem_string_append_char(DemString *ds, const char ch);
+bool dem_string_append_utf8(DemString *ds, ut32 cp);
 bool dem_string_concat(DemString *dst, DemString *src);
 bool dem_string_equals(DemString *ds, DemString *other);
 bool dem_string_empty(const DemString *ds);
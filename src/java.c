@@ -3,143 +3,435 @@
 #include "demangler_util.h"
 #include <rz_libdemangle.h>
 
+/**
+ * Read-only view over the mangled string. Sub-ranges (the owner class,
+ * the arguments, a generic parameter list...) are delimited by explicit
+ * end offsets, so the input is never copied nor NUL-split.
+ */
 typedef struct {
-	const char *search;
-	const char *replace;
-} java_replace_t;
+	const char *buf;
+	size_t len;
+	bool simplify;
+	RzDemangleJavaBatch *batch; ///< NULL outside of libdemangle_java_batch_demangle()
+} java_view_t;
+
+#define JAVA_LANG     "java/lang/"
+#define JAVA_LANG_LEN (sizeof(JAVA_LANG) - 1)
 
 #define is_native_type(x) ((x) && !IS_UPPER(x))
-#define is_varargs(x)     ((x)[0] == '.' && (x)[1] == '.' && (x)[2] == '.')
-
-// The following table contains the list of java classes that can be simplified
-// to save memory and making the demangled string more readable.
-static java_replace_t java_replace_table[] = {
-	{ "java/lang/Boolean", "Boolean" },
-	{ "java/lang/Byte", "Byte" },
-	{ "java/lang/Character", "Character" },
-	{ "java/lang/Class", "Class" },
-	{ "java/lang/ClassLoader", "ClassLoader" },
-	{ "java/lang/ClassValue", "ClassValue" },
-	{ "java/lang/Compiler", "Compiler" },
-	{ "java/lang/Double", "Double" },
-	{ "java/lang/Enum", "Enum" },
-	{ "java/lang/Exception", "Exception" },
-	{ "java/lang/Float", "Float" },
-	{ "java/lang/InheritableThreadLocal", "InheritableThreadLocal" },
-	{ "java/lang/Integer", "Integer" },
-	{ "java/lang/Long", "Long" },
-	{ "java/lang/Math", "Math" },
-	{ "java/lang/Number", "Number" },
-	{ "java/lang/Object", "Object" },
-	{ "java/lang/Package", "Package" },
-	{ "java/lang/Process", "Process" },
-	{ "java/lang/ProcessBuilder", "ProcessBuilder" },
-	{ "java/lang/Runtime", "Runtime" },
-	{ "java/lang/RuntimePermission", "RuntimePermission" },
-	{ "java/lang/SecurityManager", "SecurityManager" },
-	{ "java/lang/Short", "Short" },
-	{ "java/lang/StackTraceElement", "StackTraceElement" },
-	{ "java/lang/StrictMath", "StrictMath" },
-	{ "java/lang/String", "String" },
-	{ "java/lang/StringBuffer", "StringBuffer" },
-	{ "java/lang/StringBuilder", "StringBuilder" },
-	{ "java/lang/System", "System" },
-	{ "java/lang/Thread", "Thread" },
-	{ "java/lang/ThreadGroup", "ThreadGroup" },
-	{ "java/lang/ThreadLocal", "ThreadLocal" },
-	{ "java/lang/Throwable", "Throwable" },
-	{ "java/lang/Void", "Void" },
+
+/* matches `name` as prefix of `s[0..n)` */
+#define java_has_prefix(s, n, name) ((n) >= sizeof(name) - 1 && !memcmp(s, name, sizeof(name) - 1))
+
+/**
+ * \brief Matches the java/lang classes that can be simplified, to save
+ * memory and making the demangled string more readable.
+ *
+ * The switch is a prefix trie on the first character of the class name;
+ * longer names sharing a prefix (ClassLoader, ProcessBuilder, StringBuilder,
+ * ThreadLocal, ...) are covered by their shorter entry since only the
+ * package is dropped.
+ *
+ * \param s  Class name following `java/lang/`
+ * \param n  Bytes available at s
+ *
+ * \return true when `java/lang/` can be omitted before s
+ */
+static bool java_is_base_class(const char *s, size_t n) {
+	if (n < 1) {
+		return false;
+	}
+	switch (s[0]) {
+	case 'B':
+		return java_has_prefix(s, n, "Boolean") || java_has_prefix(s, n, "Byte");
+	case 'C':
+		return java_has_prefix(s, n, "Character") || java_has_prefix(s, n, "Class") ||
+			java_has_prefix(s, n, "Compiler");
+	case 'D':
+		return java_has_prefix(s, n, "Double");
+	case 'E':
+		return java_has_prefix(s, n, "Enum") || java_has_prefix(s, n, "Exception");
+	case 'F':
+		return java_has_prefix(s, n, "Float");
+	case 'I':
+		return java_has_prefix(s, n, "InheritableThreadLocal") || java_has_prefix(s, n, "Integer");
+	case 'L':
+		return java_has_prefix(s, n, "Long");
+	case 'M':
+		return java_has_prefix(s, n, "Math");
+	case 'N':
+		return java_has_prefix(s, n, "Number");
+	case 'O':
+		return java_has_prefix(s, n, "Object");
+	case 'P':
+		return java_has_prefix(s, n, "Package") || java_has_prefix(s, n, "Process");
+	case 'R':
+		return java_has_prefix(s, n, "Runtime");
+	case 'S':
+		if (n < 2) {
+			return false;
+		}
+		switch (s[1]) {
+		case 'e':
+			return java_has_prefix(s, n, "SecurityManager");
+		case 'h':
+			return java_has_prefix(s, n, "Short");
+		case 't':
+			return java_has_prefix(s, n, "StackTraceElement") || java_has_prefix(s, n, "StrictMath") ||
+				java_has_prefix(s, n, "String");
+		case 'y':
+			return java_has_prefix(s, n, "System");
+		default:
+			return false;
+		}
+	case 'T':
+		return java_has_prefix(s, n, "Thread") || java_has_prefix(s, n, "Throwable");
+	case 'V':
+		return java_has_prefix(s, n, "Void");
+	default:
+		return false;
+	}
+}
+
+/* skips the `java/lang/` package at pos when it is simplified away */
+static size_t java_skip(const java_view_t *v, size_t pos) {
+	if (v->simplify && pos < v->len && v->buf[pos] == 'j' &&
+		java_has_prefix(v->buf + pos, v->len - pos, JAVA_LANG) &&
+		java_is_base_class(v->buf + pos + JAVA_LANG_LEN, v->len - pos - JAVA_LANG_LEN)) {
+		return pos + JAVA_LANG_LEN;
+	}
+	return pos;
+}
+
+/* character at *pos (moved past a simplified package) or 0 at the end of the range */
+static char java_peek(const java_view_t *v, size_t *pos, size_t end) {
+	*pos = java_skip(v, *pos);
+	return *pos < end ? v->buf[*pos] : 0;
+}
+
+static const char *java_find(const java_view_t *v, size_t from, size_t end, char ch) {
+	return from < end ? memchr(v->buf + from, ch, end - from) : NULL;
+}
+
+/**
+ * \brief Appends buf[from..to) with '/' written as '.', dropping the
+ * `java/lang/` package of the simplified base classes.
+ */
+static void java_emit(const java_view_t *v, size_t from, size_t to, DemString *sb) {
+	const char *s = v->buf;
+	size_t start = sb->len;
+	size_t run = from;
+	if (v->simplify) {
+		const char *j;
+		for (size_t scan = from; (j = java_find(v, scan, to, 'j'));) {
+			size_t at = j - s, skip = java_skip(v, at);
+			if (skip != at) {
+				dem_string_append_n(sb, s + run, at - run);
+				run = skip;
+			}
+			scan = skip + (skip == at);
+		}
+	}
+	dem_string_append_n(sb, s + run, to - run);
+	if (sb->len > start) {
+		dem_str_replace_char(sb->buf + start, sb->len - start, '/', '.');
+	}
+}
+
+/**
+ * Growable byte buffer; the interned keys and pieces are referenced by
+ * offset, so it can be moved by dem_realloc.
+ */
+typedef struct {
+	char *buf;
+	size_t len;
+	size_t cap;
+} java_arena_t;
+
+/**
+ * Demangled form of a class descriptor or of a `(args)ret` proto; a proto
+ * piece is its return type followed by its "(args)" list, split at `split`.
+ */
+typedef struct {
+	ut64 hash; ///< 0 for an empty slot
+	size_t key; ///< offset of the descriptor in keys
+	size_t key_len;
+	size_t piece; ///< offset of the demangled form in pieces
+	size_t piece_len;
+	size_t split; ///< JAVA_INTERN_FAILED for a proto that cannot be demangled
+} java_intern_t;
+
+#define JAVA_INTERN_FAILED    SIZE_MAX
+#define JAVA_INTERN_MIN_SLOTS 256
+#define JAVA_ARENA_MIN_SIZE   4096
+
+struct rz_demangle_java_batch_t {
+	RzDemangleOpts opts;
+	java_intern_t *slots; ///< open addressing, linear probing
+	size_t n_slots; ///< power of two, kept at most half full
+	size_t n_used;
+	java_arena_t keys;
+	java_arena_t pieces;
+	RzDemangleJavaBatchStats stats;
 };
 
-static bool demangle_type(char *type, DemString *sb, size_t *used) {
-	bool array = false, varargs = false, subtype = false;
-	char *end = NULL, *tmp = NULL;
-	size_t type_len = 1;
+static bool java_arena_push(java_arena_t *arena, const char *data, size_t size) {
+	if (!size) {
+		return true;
+	}
+	if (arena->len + size > arena->cap) {
+		size_t cap = arena->cap ? arena->cap : JAVA_ARENA_MIN_SIZE;
+		while (cap < arena->len + size) {
+			cap *= 2;
+		}
+		char *tmp = dem_realloc(arena->buf, cap);
+		if (!tmp) {
+			return false;
+		}
+		arena->buf = tmp;
+		arena->cap = cap;
+	}
+	memcpy(arena->buf + arena->len, data, size);
+	arena->len += size;
+	return true;
+}
+
+static ut64 java_intern_hash(const char *key, size_t key_len) {
+	ut64 h = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i < key_len; i++) {
+		h ^= (ut8)key[i];
+		h *= 0x100000001B3ull;
+	}
+	return h | 1;
+}
 
-	if (is_varargs(type)) {
+/* slot holding key, or the empty slot where it belongs */
+static java_intern_t *java_intern_slot(const RzDemangleJavaBatch *batch, const char *key, size_t key_len, ut64 hash) {
+	size_t mask = batch->n_slots - 1;
+	for (size_t i = hash & mask;; i = (i + 1) & mask) {
+		java_intern_t *slot = &batch->slots[i];
+		if (!slot->hash || (slot->hash == hash && slot->key_len == key_len &&
+					   !memcmp(batch->keys.buf + slot->key, key, key_len))) {
+			return slot;
+		}
+	}
+}
+
+static const java_intern_t *java_intern_find(const RzDemangleJavaBatch *batch, const char *key, size_t key_len, ut64 hash) {
+	if (!batch->n_slots) {
+		return NULL;
+	}
+	const java_intern_t *slot = java_intern_slot(batch, key, key_len, hash);
+	return slot->hash ? slot : NULL;
+}
+
+static bool java_intern_reserve(RzDemangleJavaBatch *batch) {
+	if ((batch->n_used + 1) * 2 <= batch->n_slots) {
+		return true;
+	}
+	size_t n_slots = batch->n_slots ? batch->n_slots * 2 : JAVA_INTERN_MIN_SLOTS;
+	java_intern_t *slots = dem_calloc(n_slots, sizeof(java_intern_t));
+	if (!slots) {
+		return false;
+	}
+	for (size_t i = 0; i < batch->n_slots; i++) {
+		const java_intern_t *old = &batch->slots[i];
+		if (!old->hash) {
+			continue;
+		}
+		size_t j = old->hash & (n_slots - 1);
+		while (slots[j].hash) {
+			j = (j + 1) & (n_slots - 1);
+		}
+		slots[j] = *old;
+	}
+	dem_free(batch->slots);
+	batch->slots = slots;
+	batch->n_slots = n_slots;
+	return true;
+}
+
+/**
+ * \brief Records the demangled form of key; value holds the piece that
+ * has already been pushed to the pieces arena.
+ *
+ * Nothing is recorded once the budget of the call is exceeded, since the
+ * piece may have been truncated.
+ */
+static void java_intern_add(RzDemangleJavaBatch *batch, const char *key, size_t key_len, ut64 hash, const java_intern_t *value) {
+	if (dem_budget_exceeded() || !java_intern_reserve(batch)) {
+		return;
+	}
+	size_t at = batch->keys.len;
+	if (!java_arena_push(&batch->keys, key, key_len)) {
+		return;
+	}
+	java_intern_t *slot = java_intern_slot(batch, key, key_len, hash);
+	*slot = *value;
+	slot->hash = hash;
+	slot->key = at;
+	slot->key_len = key_len;
+	batch->n_used++;
+}
+
+static void java_intern_append(const RzDemangleJavaBatch *batch, size_t piece, size_t size, DemString *sb) {
+	if (size) {
+		dem_string_append_n(sb, batch->pieces.buf + piece, size);
+	}
+}
+
+/**
+ * \brief Returns the end of the (array of) class descriptor at pos, or 0
+ * when the type at pos is something else.
+ *
+ * Generic descriptors are not returned, the parameters list may extend
+ * past the `;` ending the class name.
+ */
+static size_t java_class_extent(const java_view_t *v, size_t pos, size_t end) {
+	const char *s = v->buf;
+	size_t p = pos + (pos < end && s[pos] == '[');
+	if (p >= end || s[p] != 'L') {
+		return 0;
+	}
+	const char *semi = java_find(v, p, end, ';');
+	if (!semi || java_find(v, p, semi - s, '<')) {
+		return 0;
+	}
+	return semi - s + 1;
+}
+
+static bool java_parse_type(const java_view_t *v, size_t pos, size_t end, DemString *sb, size_t *next);
+
+/**
+ * \brief Demangles the type starting at pos and ending before end.
+ *
+ * Within a batch, class descriptors are demangled once and then copied
+ * from the batch.
+ *
+ * \param next  When not NULL, set to the offset following the type
+ */
+static bool demangle_type(const java_view_t *v, size_t pos, size_t end, DemString *sb, size_t *next) {
+	RzDemangleJavaBatch *batch = v->batch;
+	size_t extent;
+	if (!batch || !(extent = java_class_extent(v, pos, end))) {
+		return java_parse_type(v, pos, end, sb, next);
+	}
+
+	const char *key = v->buf + pos;
+	size_t key_len = extent - pos;
+	ut64 hash = java_intern_hash(key, key_len);
+	const java_intern_t *hit = java_intern_find(batch, key, key_len, hash);
+	if (hit) {
+		batch->stats.type_hits++;
+		java_intern_append(batch, hit->piece, hit->piece_len, sb);
+	} else {
+		size_t start = sb->len;
+		if (!java_parse_type(v, pos, end, sb, NULL)) {
+			return false;
+		}
+		batch->stats.types++;
+		java_intern_t value = { .piece = batch->pieces.len, .piece_len = sb->len - start };
+		if (java_arena_push(&batch->pieces, value.piece_len ? sb->buf + start : "", value.piece_len)) {
+			java_intern_add(batch, key, key_len, hash, &value);
+		}
+	}
+	if (next) {
+		*next = extent;
+	}
+	return true;
+}
+
+static bool java_parse_type(const java_view_t *v, size_t pos, size_t end, DemString *sb, size_t *next) {
+	const char *s = v->buf;
+	const char *semi = NULL, *lt = NULL, *gt = NULL;
+	bool array = false, varargs = false;
+	size_t after;
+
+	pos = java_skip(v, pos);
+	if (pos + 3 <= end && s[pos] == '.' && s[pos + 1] == '.' && s[pos + 2] == '.') {
 		varargs = true;
-		type += 3;
+		pos += 3;
 	}
-	if (type[0] == '[') {
+	if (java_peek(v, &pos, end) == '[') {
 		array = true;
-		type++;
+		pos++;
 	}
 
-	switch (type[0]) {
+	char type = java_peek(v, &pos, end);
+	after = pos + 1;
+	char follow = java_peek(v, &after, end);
+
+	switch (type) {
 	case 'L':
-		if (!(end = strchr(type, ';'))) {
+		if (!(semi = java_find(v, pos, end, ';'))) {
 			return false;
 		}
-		if ((tmp = strchr(type, '<')) && tmp < end) {
-			if (!strstr(tmp + 1, ">")) {
+		if ((lt = java_find(v, pos, semi - s, '<'))) {
+			if (!(gt = java_find(v, lt - s + 1, end, '>'))) {
 				return false;
 			}
-			end = tmp;
-			subtype = true;
+			java_emit(v, pos + 1, lt - s, sb);
+		} else {
+			java_emit(v, pos + 1, semi - s, sb);
 		}
-
-		end[0] = 0;
-		type_len = strlen(type);
-		dem_string_append_n(sb, type + 1, type_len - 1);
-		type_len++;
-		type = end + 1;
+		after = semi - s + 1;
 		break;
 	case 'B':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "byte");
 		break;
 	case 'C':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "char");
 		break;
 	case 'D':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "double");
 		break;
 	case 'F':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "float");
 		break;
 	case 'I':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "int");
 		break;
 	case 'J':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "long");
 		break;
 	case 'S':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "short");
 		break;
 	case 'V':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "void");
 		break;
 	case 'Z':
-		if (is_native_type(type[1])) {
+		if (is_native_type(follow)) {
 			return false;
 		}
 		dem_string_append(sb, "boolean");
 		break;
 	case 'T': // templates
-		if (is_native_type(type[1]) && type[1] != ';') {
+		if (is_native_type(follow) && follow != ';') {
 			return false;
 		}
 		dem_string_append(sb, "T");
@@ -147,201 +439,194 @@ static bool demangle_type(char *type, DemString *sb, size_t *used) {
 	default:
 		return false;
 	}
-	if (subtype) {
+	if (gt) {
+		// generic parameters, up to the first '>'
+		size_t close = gt - s;
 		dem_string_append(sb, "<");
-		if (*type == '*') {
+		if (s[lt - s + 1] == '*') {
 			dem_string_append(sb, "T");
 		} else {
 			bool comma = false;
-			end = strstr(type, ">");
-			end[0] = 0;
-			while (*type && type != end) {
-				if (*type == ';') {
-					type++;
+			for (size_t p = lt - s + 1; java_peek(v, &p, close);) {
+				if (s[p] == ';') {
+					p++;
 					continue;
 				} else if (comma) {
 					dem_string_append(sb, ", ");
 				}
-				size_t len = 0;
-				if (!demangle_type(type, sb, &len)) {
+				if (!demangle_type(v, p, close, sb, &p)) {
 					return false;
 				}
-				type += len;
-				type_len += len;
 				comma = true;
 			}
 		}
 		dem_string_append(sb, ">");
+		after = close + 1;
+		if (after < end && s[after] == ';') {
+			after++;
+		}
 	}
 	if (varargs) {
 		dem_string_append(sb, "...");
-		type_len += 3;
+	} else if (array) {
+		dem_string_append(sb, "[]");
 	}
-	if (array) {
-		if (!varargs) {
-			dem_string_append(sb, "[]");
-		}
-		type_len++;
+	if (next) {
+		*next = after;
 	}
-	if (used) {
-		*used = type_len;
+	return true;
+}
+
+/* demangles the "(args)" list of a proto, up to return_type */
+static bool demangle_arguments(const java_view_t *v, size_t arguments, size_t return_type, DemString *sb) {
+	dem_string_append(sb, "(");
+	for (size_t pos = arguments + 1; pos < return_type;) {
+		if (!demangle_type(v, pos, return_type, sb, &pos)) {
+			return false;
+		}
+		if (pos < return_type) {
+			dem_string_append(sb, ", ");
+		}
 	}
+	dem_string_append(sb, ")");
 	return true;
 }
 
-static char *demangle_method(char *name, char *arguments, char *return_type) {
+static char *demangle_method(const java_view_t *v, size_t arguments, size_t return_type) {
 	// example: Lsome/class/Object;.myMethod([F)I
 	// name = Lsome/class/Object;.myMethod
 	// args = [F
 	// rett = I
-	DemString *sb = NULL;
-	size_t args_length = 0;
+	RzDemangleJavaBatch *batch = v->batch;
+	const java_intern_t *proto = NULL;
+	const char *key = v->buf + arguments;
+	size_t key_len = v->len - arguments;
+	ut64 hash = 0;
+
+	if (batch) {
+		// the proto is everything from '(' to the end.
+		hash = java_intern_hash(key, key_len);
+		if ((proto = java_intern_find(batch, key, key_len, hash))) {
+			batch->stats.proto_hits++;
+			if (proto->split == JAVA_INTERN_FAILED) {
+				return NULL;
+			}
+		} else {
+			batch->stats.protos++;
+		}
+	}
 
-	sb = dem_string_new();
+	DemString *sb = dem_string_new();
 	if (!sb) {
-		goto demangle_method_bad;
+		return NULL;
 	}
 
-	arguments[0] = 0;
-	arguments++;
-	args_length = return_type - arguments;
-
-	return_type[0] = 0;
-	return_type++;
-
-	if (!demangle_type(return_type, sb, NULL)) {
-		goto demangle_method_bad;
+	if (proto) {
+		java_intern_append(batch, proto->piece, proto->split, sb);
+	} else if (!demangle_type(v, return_type + 1, v->len, sb, NULL)) {
+		goto demangle_method_bad_proto;
 	}
+	size_t return_len = sb->len;
 
 	dem_string_append(sb, " ");
 
-	const char *t = NULL;
-	if (name[0] == 'L' && (t = strchr(name, ';')) && !demangle_type(name, sb, NULL)) {
-		goto demangle_method_bad;
-	} else if (name[0] == 'L' && t) {
-		dem_string_append(sb, t + 1);
+	size_t name = 0;
+	if (java_peek(v, &name, arguments) == 'L' && java_find(v, name, arguments, ';')) {
+		size_t tail = 0;
+		if (!demangle_type(v, name, arguments, sb, &tail)) {
+			goto demangle_method_bad;
+		}
+		java_emit(v, tail, arguments, sb);
 	} else {
-		dem_string_append(sb, name);
+		java_emit(v, 0, arguments, sb);
 	}
 
-	dem_string_append(sb, "(");
-	for (size_t pos = 0, used = 0; pos < args_length;) {
-		if (!demangle_type(arguments + pos, sb, &used)) {
-			goto demangle_method_bad;
-		}
-		pos += used;
-		if (pos < args_length) {
-			dem_string_append(sb, ", ");
+	size_t args_start = sb->len;
+	if (proto) {
+		java_intern_append(batch, proto->piece + proto->split, proto->piece_len - proto->split, sb);
+	} else if (!demangle_arguments(v, arguments, return_type, sb)) {
+		goto demangle_method_bad_proto;
+	} else if (batch) {
+		java_intern_t value = { .piece = batch->pieces.len, .piece_len = return_len + sb->len - args_start, .split = return_len };
+		if (java_arena_push(&batch->pieces, sb->buf, return_len) &&
+			java_arena_push(&batch->pieces, sb->buf + args_start, sb->len - args_start)) {
+			java_intern_add(batch, key, key_len, hash, &value);
 		}
 	}
-	dem_string_append(sb, ")");
-
-	free(name);
-	dem_string_replace_char(sb, '/', '.');
 	return dem_string_drain(sb);
 
+demangle_method_bad_proto:
+	if (batch) {
+		java_intern_t value = { .split = JAVA_INTERN_FAILED };
+		java_intern_add(batch, key, key_len, hash, &value);
+	}
 demangle_method_bad:
 	dem_string_free(sb);
-	free(name);
 	return NULL;
 }
 
-static char *demangle_class_object(char *object, char *name) {
+static char *demangle_class_object(const java_view_t *v, size_t name) {
 	// example: Lsome/class/Object;.myMethod.I
 	// object = Lsome/class/Object;
 	// name   = myMethod.I
-	DemString *sb = NULL;
-	char *type = NULL;
-
-	sb = dem_string_new();
+	DemString *sb = dem_string_new();
 	if (!sb) {
-		goto demangle_class_object_bad;
+		return NULL;
 	}
 
-	name[0] = 0;
-	name++;
-
-	type = strchr(name, '.');
-
-	if (!demangle_type(object, sb, NULL)) {
-		goto demangle_class_object_bad;
+	if (!demangle_type(v, 0, name, sb, NULL)) {
+		dem_string_free(sb);
+		return NULL;
 	}
 
-	if (type) {
-		type[0] = 0;
-		type++;
-		dem_string_appendf(sb, ".%s:", name);
-		if (!demangle_type(type, sb, NULL)) {
-			goto demangle_class_object_bad;
-		}
-	} else {
-		dem_string_appendf(sb, ".%s", name);
+	name++;
+	dem_string_append(sb, ".");
+	const char *type = java_find(v, name, v->len, '.');
+	if (!type) {
+		java_emit(v, name, v->len, sb);
+		return dem_string_drain(sb);
 	}
 
-	free(object);
-	dem_string_replace_char(sb, '/', '.');
+	java_emit(v, name, type - v->buf, sb);
+	dem_string_append(sb, ":");
+	if (!demangle_type(v, type - v->buf + 1, v->len, sb, NULL)) {
+		dem_string_free(sb);
+		return NULL;
+	}
 	return dem_string_drain(sb);
-
-demangle_class_object_bad:
-	dem_string_free(sb);
-	free(object);
-	return NULL;
 }
 
-static char *demangle_object_with_type(char *name, char *object) {
+static char *demangle_object_with_type(const java_view_t *v, size_t object) {
 	// example: myMethod.Lsome/class/Object;
 	// name   = myMethod
 	// object = Lsome/class/Object;
 	DemString *sb = dem_string_new();
 	if (!sb) {
-		goto demangle_object_with_type_bad;
+		return NULL;
 	}
 
-	object[0] = 0;
-	object++;
-
-	dem_string_appendf(sb, "%s:", name);
-	if (!demangle_type(object, sb, NULL)) {
-		goto demangle_object_with_type_bad;
+	java_emit(v, 0, object, sb);
+	dem_string_append(sb, ":");
+	if (!demangle_type(v, object + 1, v->len, sb, NULL)) {
+		dem_string_free(sb);
+		return NULL;
 	}
-
-	free(name);
-	dem_string_replace_char(sb, '/', '.');
 	return dem_string_drain(sb);
-
-demangle_object_with_type_bad:
-	dem_string_free(sb);
-	free(name);
-	return NULL;
 }
 
-static char *demangle_any(char *mangled) {
+static char *demangle_any(const java_view_t *v) {
 	DemString *sb = dem_string_new();
 	if (!sb) {
 		return NULL;
 	}
 
-	if (!demangle_type(mangled, sb, NULL)) {
-		free(mangled);
+	if (!demangle_type(v, 0, v->len, sb, NULL)) {
 		dem_string_free(sb);
 		return NULL;
 	}
-	free(mangled);
-
-	dem_string_replace_char(sb, '/', '.');
 	return dem_string_drain(sb);
 }
 
-static char *java_replace_base_classes(char *name) {
-	for (size_t i = 0; i < RZ_ARRAY_SIZE(java_replace_table); ++i) {
-		java_replace_t *rpl = &java_replace_table[i];
-		if (!(name = dem_str_replace(name, rpl->search, rpl->replace, 1))) {
-			break;
-		}
-	}
-	return name;
-}
-
 /**
  * \brief Demangles java classes/methods/fields
  *
@@ -353,31 +638,91 @@ static char *java_replace_base_classes(char *name) {
  * - Lsome/class/Object;.myField.I      some.class.Object.myField:int
  * - myField.I                          myField:int
  * - Lsome/class/Object;.myMethod([F)I  int some.class.Object.myMethod(float[])
+ *
+ * The input is parsed in place as a (ptr, len) view, without copying it.
  */
+static char *java_demangle(const char *mangled, RzDemangleOpts opts, RzDemangleJavaBatch *batch) {
+	java_view_t v = {
+		.buf = mangled,
+		.len = strlen(mangled),
+		.simplify = opts & RZ_DEMANGLE_OPT_SIMPLIFY,
+		.batch = batch,
+	};
+	const char *arguments = NULL;
+	const char *return_type = NULL;
+	size_t first = 0;
+
+	if ((arguments = java_find(&v, 0, v.len, '(')) &&
+		(return_type = java_find(&v, arguments - mangled, v.len, ')'))) {
+		return demangle_method(&v, arguments - mangled, return_type - mangled);
+	} else if (java_peek(&v, &first, v.len) == 'L' && (arguments = java_find(&v, 0, v.len, '.'))) {
+		return demangle_class_object(&v, arguments - mangled);
+	} else if ((arguments = java_find(&v, 0, v.len, '.'))) {
+		return demangle_object_with_type(&v, arguments - mangled);
+	}
+	return demangle_any(&v);
+}
+
 DEM_LIB_EXPORT char *libdemangle_handler_java(const char *mangled, RzDemangleOpts opts) {
-	if (!mangled) {
+	DemNegativeKey key;
+	if (!mangled || dem_negative_lookup(&key, DEM_LANG_JAVA, mangled, SIZE_MAX, opts)) {
 		return NULL;
 	}
+	dem_budget_begin();
+	return dem_negative_record(&key, dem_budget_end(java_demangle(mangled, opts, NULL)));
+}
 
-	char *name = NULL;
-	char *arguments = NULL;
-	char *return_type = NULL;
-
-	name = strdup(mangled);
-	if (!name) {
+/**
+ * \brief Creates a batch for demangling the descriptors of one binary
+ *
+ * Dex files reference the same class descriptors and protos from many
+ * methods; within a batch each distinct class descriptor and each distinct
+ * `(args)ret` proto is demangled once, and the output of the following
+ * symbols is assembled from the stored pieces.
+ *
+ * \param opts  The demangling options
+ */
+DEM_LIB_EXPORT RzDemangleJavaBatch *libdemangle_java_batch_new(RzDemangleOpts opts) {
+	RzDemangleJavaBatch *batch = RZ_NEW0(RzDemangleJavaBatch);
+	if (!batch) {
 		return NULL;
 	}
+	batch->opts = opts;
+	return batch;
+}
+
+DEM_LIB_EXPORT void libdemangle_java_batch_free(RzDemangleJavaBatch *batch) {
+	if (!batch) {
+		return;
+	}
+	dem_free(batch->slots);
+	dem_free(batch->keys.buf);
+	dem_free(batch->pieces.buf);
+	dem_free(batch);
+}
 
-	if (opts & RZ_DEMANGLE_OPT_SIMPLIFY) {
-		name = java_replace_base_classes(name);
+/**
+ * \brief Demangles the next symbol of the batch, like libdemangle_handler_java()
+ */
+DEM_LIB_EXPORT char *libdemangle_java_batch_demangle(RzDemangleJavaBatch *batch, const char *symbol) {
+	DemNegativeKey key;
+	if (!batch || !symbol) {
+		return NULL;
+	}
+	batch->stats.symbols++;
+	if (dem_negative_lookup(&key, DEM_LANG_JAVA, symbol, SIZE_MAX, batch->opts)) {
+		return NULL;
 	}
+	dem_budget_begin();
+	return dem_negative_record(&key, dem_budget_end(java_demangle(symbol, batch->opts, batch)));
+}
 
-	if ((arguments = strchr(name, '(')) && (return_type = strchr(arguments, ')'))) {
-		return demangle_method(name, arguments, return_type);
-	} else if (name[0] == 'L' && (arguments = strchr(name, '.'))) {
-		return demangle_class_object(name, arguments);
-	} else if ((arguments = strchr(name, '.'))) {
-		return demangle_object_with_type(name, arguments);
+/**
+ * \brief Copies the counters of the batch into \p stats
+ */
+DEM_LIB_EXPORT void libdemangle_java_batch_stats(const RzDemangleJavaBatch *batch, RzDemangleJavaBatchStats *stats) {
+	if (!batch || !stats) {
+		return;
 	}
-	return demangle_any(name);
+	*stats = batch->stats;
 }
@@ -4,6 +4,13 @@
 #include "microsoft_demangle.h"
 #include <ctype.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MICROSOFT_USE_SSE2 1
+#else
+#define MICROSOFT_USE_SSE2 0
+#endif
+
 #define MICROSOFT_NAME_LEN            (256)
 #define MICROSOFR_CLASS_NAMESPACE_LEN (256)
 #define IMPOSSIBLE_LEN                (MICROSOFT_NAME_LEN + MICROSOFR_CLASS_NAMESPACE_LEN)
@@ -11,6 +18,8 @@
 typedef struct SAbbrState {
 	DemList *types;
 	DemList *names;
+	RzDemangleOpts opts;
+	ut32 depth; ///< nesting level of parse_microsoft_mangled_name()
 } SAbbrState;
 
 typedef enum EObjectType {
@@ -102,8 +111,8 @@ static void sstrinfo_free(void *ptr) {
 	if (!sstrinfo) {
 		return;
 	}
-	free(sstrinfo->str_ptr);
-	free(sstrinfo);
+	dem_free(sstrinfo->str_ptr);
+	dem_free(sstrinfo);
 }
 
 #define DECL_STATE_ACTION(action) static void tc_state_##action(SAbbrState *abbr, SStateInfo *state, STypeCodeStr *type_code_str);
@@ -202,6 +211,9 @@ static bool copy_string_n(STypeCodeStr *type_code_str, const char *str_for_copy,
 	if (!copy_len) {
 		return true;
 	}
+	if (!dem_budget_output(copy_len)) {
+		return false;
+	}
 	size_t free_space = type_code_str->type_str_len - type_code_str->curr_pos - 1;
 
 	if (free_space < copy_len) {
@@ -216,9 +228,9 @@ static bool copy_string_n(STypeCodeStr *type_code_str, const char *str_for_copy,
 		type_code_str->type_str_len = newlen;
 		char *type_str;
 		if (type_code_str->type_str != type_code_str->type_str_buf) {
-			type_str = realloc(type_code_str->type_str, newlen);
+			type_str = dem_realloc(type_code_str->type_str, newlen);
 		} else {
-			type_str = malloc(newlen);
+			type_str = dem_malloc(newlen);
 			if (!type_str) {
 				return false;
 			}
@@ -259,7 +271,7 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 		res = get_num(&state);
 		if (res) {
 			tmp = dem_str_newf("%s%s", template_param, res);
-			free(res);
+			dem_free(res);
 			res = tmp;
 		}
 	} else {
@@ -277,7 +289,7 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 			if (a) {
 				int signed_a = atoi(a);
 				res = dem_str_newf("%d", signed_a);
-				free(a);
+				dem_free(a);
 			}
 			break;
 		case '1': {
@@ -308,7 +320,7 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 				char *tmp = NULL;
 				err = parse_function(abbr, sym, &str, &tmp, &ret);
 				*str_type_code = dem_str_newf("&%s", tmp);
-				free(tmp);
+				dem_free(tmp);
 			}
 			sym += ret;
 			*amount_of_read_chars = sym - start_sym;
@@ -323,15 +335,15 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 				int signed_b = atoi(b);
 				res = dem_str_newf("%sE%d", a, signed_b);
 			}
-			free(a);
-			free(b);
+			dem_free(a);
+			dem_free(b);
 			break;
 		case 'D':
 			// anonymous template param
 			res = get_num(&state);
 			if (res) {
 				tmp = dem_str_newf("%s%s", template_param, res);
-				free(res);
+				dem_free(res);
 				res = tmp;
 			}
 			break;
@@ -344,8 +356,8 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 				int signed_b = atoi(b);
 				res = dem_str_newf("{%d, %d}", signed_a, signed_b);
 			}
-			free(a);
-			free(b);
+			dem_free(a);
+			dem_free(b);
 			break;
 		case 'G':
 			// Signed {a, b, c}
@@ -358,9 +370,9 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 				int signed_c = atoi(c);
 				res = dem_str_newf("{%d, %d, %d}", signed_a, signed_b, signed_c);
 			}
-			free(a);
-			free(b);
-			free(c);
+			dem_free(a);
+			dem_free(b);
+			dem_free(c);
 			break;
 		case 'H':
 			// Unsigned integer
@@ -373,8 +385,8 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 			if (a && b) {
 				res = dem_str_newf("{%s, %s}", a, b);
 			}
-			free(a);
-			free(b);
+			dem_free(a);
+			dem_free(b);
 			break;
 		case 'J':
 			// Unsigned {x, y, z}
@@ -384,22 +396,22 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 			if (a && b && c) {
 				res = dem_str_newf("{%s, %s, %s}", a, b, c);
 			}
-			free(a);
-			free(b);
-			free(c);
+			dem_free(a);
+			dem_free(b);
+			dem_free(c);
 			break;
 		case 'Q':
 			// anonymous non-type template parameter
 			res = get_num(&state);
 			if (res) {
 				tmp = dem_str_newf("non-type-%s%s", template_param, res);
-				free(res);
+				dem_free(res);
 				res = tmp;
 			}
 			break;
 		case 'S':
 			// empty non-type parameter pack
-			res = strdup("");
+			res = dem_strdup("");
 			break;
 		default:
 			break;
@@ -416,89 +428,180 @@ static int get_template_params(SAbbrState *abbr, const char *sym, size_t *amount
 	return eDemanglerErrOK;
 }
 
-static inline ut16 read_be16(const void *src) {
-	const ut8 *s = (const ut8 *)src;
-	return (((ut16)s[0]) << 8) | (((ut16)s[1]) << 0);
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Length of the run of chars that are copied as is into a narrow
+///			string literal, i.e. everything up to the next '?' escape or '@'.
+///////////////////////////////////////////////////////////////////////////////
+static size_t string_literal_plain_run(const char *buf, const char *end) {
+	const char *p = buf;
+#if MICROSOFT_USE_SSE2
+	const __m128i question = _mm_set1_epi8('?');
+	const __m128i at = _mm_set1_epi8('@');
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, question), _mm_cmpeq_epi8(v, at)));
+		if (mask) {
+			while (!(mask & 1)) {
+				mask >>= 1;
+				p++;
+			}
+			return p - buf;
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && *p != '?' && *p != '@') {
+		p++;
+	}
+	return p - buf;
+}
+
+#define IS_WIDE_ASCII_UNIT(p) \
+	((p)[0] == '?' && (p)[1] == '$' && (p)[2] == 'A' && (p)[3] == 'A' && \
+		(p)[4] != '?' && (p)[4] != '@' && !((p)[4] & 0x80))
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Wide string literals encode each ASCII char as "?$AA<char>"; this
+///			appends the run of such code units starting at buf to out.
+/// \return Returns the amount of processed chars
+///////////////////////////////////////////////////////////////////////////////
+static size_t string_literal_wide_ascii_run(const char *buf, const char *end, DemString *out) {
+	char ascii[64];
+	size_t n_ascii = 0;
+	const char *p = buf;
+#if MICROSOFT_USE_SSE2
+	// three "?$AA<char>" code units fit in a 16 bytes load.
+	const __m128i pattern = _mm_setr_epi8('?', '$', 'A', 'A', 0, '?', '$', 'A', 'A', 0, '?', '$', 'A', 'A', 0, 0);
+	const __m128i question = _mm_set1_epi8('?');
+	const __m128i at = _mm_set1_epi8('@');
+	const int pattern_mask = 0x3DEF;
+	const int chars_mask = 0x4210;
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		int eq = _mm_movemask_epi8(_mm_cmpeq_epi8(v, pattern));
+		int bad = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, question), _mm_cmpeq_epi8(v, at))) |
+			_mm_movemask_epi8(v);
+		if ((eq & pattern_mask) != pattern_mask || (bad & chars_mask)) {
+			break;
+		}
+		if (n_ascii + 3 > sizeof(ascii)) {
+			dem_string_append_n(out, ascii, n_ascii);
+			n_ascii = 0;
+		}
+		ascii[n_ascii++] = p[4];
+		ascii[n_ascii++] = p[9];
+		ascii[n_ascii++] = p[14];
+		p += 15;
+	}
+#endif
+	while (end - p >= 5 && IS_WIDE_ASCII_UNIT(p)) {
+		if (n_ascii == sizeof(ascii)) {
+			dem_string_append_n(out, ascii, n_ascii);
+			n_ascii = 0;
+		}
+		ascii[n_ascii++] = p[4];
+		p += 5;
+	}
+	dem_string_append_n(out, ascii, n_ascii);
+	return p - buf;
 }
 
-static ssize_t utf16be_to_utf8_impl(const char *utf16be, size_t utf16be_len, char *utf8, size_t utf8_len) {
-	char *const outstart = utf8;
-	char *const outend = utf8 + utf8_len;
-	const ut16 *in = (const ut16 *)utf16be;
-	ut32 c, d;
-	int bits;
-
-	const size_t inlen = utf16be_len / 2;
-	const ut16 *const inend = in + inlen;
-	while ((in < inend) && (utf8 - outstart + 5 < utf8_len)) {
-		c = read_be16(in++);
-		if ((c & 0xFC00) == 0xD800) { /* surrogates */
-			if (in >= inend) { /* (in > inend) shouldn't happen */
+#undef IS_WIDE_ASCII_UNIT
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Decodes the content of a `??_C@_0` (narrow) or `??_C@_1` (wide,
+///			UTF-16BE) string literal and appends it to out. Wide literals are
+///			transcoded to UTF-8 while the escapes are decoded, in a single pass.
+/// \param buf Current buffer position with the mangled literal
+/// \param is_double_byte True for wide string literals
+/// \param out String where the decoded literal is appended
+/// \return Returns the position after the decoded literal, or NULL when the
+///			literal is malformed
+///////////////////////////////////////////////////////////////////////////////
+static const char *decode_string_literal(const char *buf, bool is_double_byte, DemString *out) {
+	const char *const end = buf + strlen(buf);
+	const char *encoded = ",/\\:. \v\n'-";
+	ut8 c[2];
+	int high = 0;
+	ut32 surrogate = 0;
+	while (buf < end && *buf != '@') {
+		if (!high && !surrogate) {
+			size_t run = is_double_byte
+				? string_literal_wide_ascii_run(buf, end, out)
+				: string_literal_plain_run(buf, end);
+			if (!is_double_byte) {
+				dem_string_append_n(out, buf, run);
+			}
+			buf += run;
+			if (buf >= end || *buf == '@') {
 				break;
 			}
-			d = read_be16(in++);
-			if ((d & 0xFC00) == 0xDC00) {
-				c &= 0x03FF;
-				c <<= 10;
-				c |= d & 0x03FF;
-				c += 0x10000;
+		}
+		if (*buf == '?') {
+			buf++;
+			if (*buf == '$') {
+				buf++;
+				if (buf[0] < 'A' || buf[0] > 'P' ||
+					buf[1] < 'A' || buf[1] > 'P') {
+					return NULL;
+				}
+				const char nibble_high = (*buf++ - 'A');
+				const char nibble_low = (*buf - 'A');
+				c[high] = nibble_high | nibble_low;
+			} else if (isdigit((int)*buf)) {
+				c[high] = encoded[*buf - '0'];
+			} else if ((*buf > 'a' && *buf < 'p') || (*buf > 'A' && *buf < 'P')) {
+				c[high] = *buf + 0x80;
 			} else {
-				return -1;
+				return NULL;
 			}
-		}
-
-		/* assertion: c is a single UTF-4 value */
-		if (utf8 >= outend) {
-			break;
-		}
-		if (c < 0x80) {
-			*utf8++ = c;
-			bits = -6;
-		} else if (c < 0x800) {
-			*utf8++ = ((c >> 6) & 0x1F) | 0xC0;
-			bits = 0;
-		} else if (c < 0x10000) {
-			*utf8++ = ((c >> 12) & 0x0F) | 0xE0;
-			bits = 6;
 		} else {
-			*utf8++ = ((c >> 18) & 0x07) | 0xF0;
-			bits = 12;
+			c[high] = *buf;
 		}
-
-		for (; bits >= 0; bits -= 6) {
-			if (utf8 >= outend) {
+		buf++;
+		if (!is_double_byte) {
+			if (!c[0]) {
 				break;
 			}
-			*utf8++ = ((c >> bits) & 0x3F) | 0x80;
+			if (!dem_string_append_n(out, (const char *)c, 1)) {
+				return NULL;
+			}
+			continue;
+		}
+		if (++high < 2) {
+			continue;
+		}
+		high = 0;
+		if (!c[0] && !c[1]) {
+			break;
+		}
+		ut32 unit = ((ut32)c[0] << 8) | c[1];
+		if (surrogate) {
+			if ((unit & 0xFC00) != 0xDC00) {
+				return NULL;
+			}
+			unit = (((surrogate & 0x03FF) << 10) | (unit & 0x03FF)) + 0x10000;
+			surrogate = 0;
+		} else if ((unit & 0xFC00) == 0xD800) {
+			surrogate = unit;
+			continue;
+		}
+		if (!dem_string_append_utf8(out, unit)) {
+			return NULL;
 		}
 	}
-	return utf8 - outstart;
-}
-
-static EDemanglerErr utf16be_to_utf8(const char *utf16be, size_t utf16be_len, char **utf8, size_t *utf8_len) {
-	const size_t utf8_len_tmp = utf16be_len * 4;
-	*utf8 = malloc(utf8_len_tmp);
-	if (!*utf8) {
-		return eDemanglerErrMemoryAllocation;
-	}
-	ssize_t res = utf16be_to_utf8_impl(utf16be, utf16be_len, *utf8, utf8_len_tmp);
-	if (res < 0) {
-		free(*utf8);
-		return eDemanglerErrUncorrectMangledSymbol;
-	}
-	*utf8_len = res;
-	return eDemanglerErrOK;
+	return buf;
 }
 
 static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *names_l, bool memorize) {
 	// C++ operator code (one character, or two if the first is '_')
 #define SET_OPERATOR_CODE(str) \
 	{ \
-		str_info = malloc(sizeof(SStrInfo)); \
+		str_info = dem_malloc(sizeof(SStrInfo)); \
 		if (!str_info) \
 			break; \
 		str_info->len = strlen(str); \
-		str_info->str_ptr = strdup(str); \
+		str_info->str_ptr = dem_strdup(str); \
 		dem_list_append(names_l, str_info); \
 	}
 	SStrInfo *str_info;
@@ -541,7 +644,7 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 	case 'Y': SET_OPERATOR_CODE("operator+="); break;
 	case 'Z': SET_OPERATOR_CODE("operator-="); break;
 	case '$': {
-		str_info = malloc(sizeof(SStrInfo));
+		str_info = dem_malloc(sizeof(SStrInfo));
 		if (!str_info) {
 			goto fail;
 		}
@@ -594,111 +697,49 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 			if (!len) {
 				goto fail;
 			}
-			free(len);
+			dem_free(len);
 			buf += state_info.amount_of_read_chars;
 			init_state_struct(&state_info, buf);
 			char *checksum = get_num(&state_info);
 			buf += state_info.amount_of_read_chars;
 			DemString *s = dem_string_new();
 			if (!s) {
-				free(checksum);
+				dem_free(checksum);
 				goto fail;
 			}
-			dem_string_append(s, "`string'::");
-			if (checksum) {
-				dem_string_appendf(s, "%s::\"", checksum);
-				free(checksum);
-			} else {
-				dem_string_append(s, "\"");
-			}
-			DemString *unicode = NULL;
-			if (is_double_byte) {
-				unicode = dem_string_new();
-				if (!unicode) {
-					dem_string_free(s);
-					goto fail;
+			const bool literal_content = !(abbr->opts & RZ_DEMANGLE_OPT_MSVC_NO_STRING_LITERAL);
+			dem_string_append(s, "`string'");
+			if (!literal_content) {
+				dem_free(checksum);
+				buf = strchr(buf, '@');
+				if (!buf) {
+					buf = str_buf_start + strlen(str_buf_start);
 				}
-			}
-			char c[2];
-			int high = 0;
-			const char *encoded = ",/\\:. \v\n'-";
-			while (*buf && *buf != '@') {
-				if (*buf == '?') {
-					buf++;
-					if (*buf == '$') {
-						buf++;
-						if (buf[0] < 'A' || buf[0] > 'P' ||
-							buf[1] < 'A' || buf[1] > 'P') {
-							dem_string_free(s);
-							dem_string_free(unicode);
-							goto fail;
-						}
-						const char nibble_high = (*buf++ - 'A');
-						const char nibble_low = (*buf - 'A');
-						c[high] = nibble_high | nibble_low;
-					} else if (isdigit((int)*buf)) {
-						c[high] = encoded[*buf - '0'];
-					} else if ((*buf > 'a' && *buf < 'p') || (*buf > 'A' && *buf < 'P')) {
-						c[high] = *buf + 0x80;
-					} else {
-						dem_string_free(unicode);
-						dem_string_free(s);
-						goto fail;
-					}
+			} else {
+				dem_string_append(s, "::");
+				if (checksum) {
+					dem_string_appendf(s, "%s::\"", checksum);
+					dem_free(checksum);
 				} else {
-					c[high] = *buf;
+					dem_string_append(s, "\"");
 				}
-				buf++;
-				if (is_double_byte) {
-					high++;
-					if (high > 1) {
-						if (!c[0] && !c[1]) {
-							break;
-						}
-						if (!dem_string_append_n(unicode, c, 2)) {
-							dem_string_free(unicode);
-							dem_string_free(s);
-							goto fail;
-						}
-						high = 0;
-					}
-				} else {
-					if (!c[0]) {
-						break;
-					}
-					if (!dem_string_append_n(s, c, 1)) {
-						dem_string_free(s);
-						goto fail;
-					}
-				}
-			}
-			if (is_double_byte) {
-				size_t utf16_len = unicode->len;
-				char *utf16 = dem_string_drain(unicode);
-				char *utf8_buf = NULL;
-				size_t utf8_len = 0;
-				if (utf16be_to_utf8(utf16, utf16_len, &utf8_buf, &utf8_len) != eDemanglerErrOK) {
-					free(utf16);
+				buf = decode_string_literal(buf, is_double_byte, s);
+				if (!buf) {
 					dem_string_free(s);
 					goto fail;
 				}
-				free(utf16);
-				if (!dem_string_append_n(s, utf8_buf, utf8_len)) {
-					free(utf8_buf);
-					dem_string_free(s);
-					goto fail;
-				}
-				free(utf8_buf);
+				dem_string_append_n(s, "\"", 1);
 			}
-			dem_string_append_n(s, "\"", 1);
 			if (*buf == '@' && buf[1]) {
 				buf++;
 				init_state_struct(&state_info, buf);
 				char *unk = get_num(&state_info);
 				if (unk) {
 					buf += state_info.amount_of_read_chars - 1;
-					dem_string_appendf(s, "::%s", unk);
-					free(unk);
+					if (literal_content) {
+						dem_string_appendf(s, "::%s", unk);
+					}
+					dem_free(unk);
 				}
 			}
 			char *str = dem_string_drain(s);
@@ -706,7 +747,7 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 				goto fail;
 			}
 			SET_OPERATOR_CODE(str);
-			free(str);
+			dem_free(str);
 			read_len += buf - str_buf_start;
 			break;
 		case 'D': SET_OPERATOR_CODE("vbase_dtor"); break;
@@ -737,7 +778,7 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 				read_len += len + 1;
 				str = dem_str_append(str, " `RTTI Type Descriptor'");
 				SET_OPERATOR_CODE(str);
-				free(str);
+				dem_free(str);
 				break;
 			}
 			case '1': {
@@ -748,20 +789,20 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 				char *c = get_num(&state);
 				char *d = get_num(&state);
 				if (!a || !b || !c || !d) {
-					free(a);
-					free(b);
-					free(c);
-					free(d);
+					dem_free(a);
+					dem_free(b);
+					dem_free(c);
+					dem_free(d);
 					goto fail;
 				}
 				read_len += state.amount_of_read_chars;
 				char *tmp = dem_str_newf("`RTTI Base Class Descriptor at (%s,%s,%s,%s)'", a, b, c, d);
 				SET_OPERATOR_CODE(tmp);
-				free(tmp);
-				free(a);
-				free(b);
-				free(c);
-				free(d);
+				dem_free(tmp);
+				dem_free(a);
+				dem_free(b);
+				dem_free(c);
+				dem_free(d);
 				break;
 			}
 			case '2': SET_OPERATOR_CODE("`RTTI Base Class Array'"); break;
@@ -799,16 +840,16 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 				}
 				name_len = end - buf;
 				read_len += name_len + 1;
-				name = malloc(name_len + 1);
+				name = dem_malloc(name_len + 1);
 				if (!name) {
 					goto fail;
 				}
 				memcpy(name, buf, name_len);
 				name[name_len] = '\0';
 				char *tmp = dem_str_newf("`%s for '%s''", op, name);
-				free(name);
+				dem_free(name);
 				SET_OPERATOR_CODE(tmp);
-				free(tmp);
+				dem_free(tmp);
 				break;
 			}
 			case 'G': SET_OPERATOR_CODE("vector_copy_ctor_iter"); break;
@@ -842,11 +883,14 @@ static size_t get_template(SAbbrState *abbr, const char *buf, SStrInfo *str_info
 	STypeCodeStr type_code_str;
 	// DemListIter *it = NULL;
 	DemList *saved_abbr_names = abbr->names; // save current abbr names, this
-	DemList *new_abbr_names = dem_list_newf(free);
+	DemList *new_abbr_names = dem_list_newf(dem_free);
 	memset(str_info, 0, sizeof(*str_info));
 	if (!init_type_code_str_struct(&type_code_str)) {
 		goto get_template_err;
 	}
+	if (!dem_budget_node()) {
+		goto get_template_err;
+	}
 
 	if (*buf == '?') {
 		DemList *names_l = dem_list_newf(sstrinfo_free);
@@ -915,7 +959,7 @@ get_template_err:
 	abbr->names = saved_abbr_names; // restore global list with name abbr.
 
 	if (memorize && str_info->str_ptr) {
-		dem_list_append(abbr->names, strdup(str_info->str_ptr));
+		dem_list_append(abbr->names, dem_strdup(str_info->str_ptr));
 	}
 	return len;
 }
@@ -1053,7 +1097,7 @@ static size_t get_namespace_and_name(SAbbrState *abbr, const char *buf, STypeCod
 			}
 			SStrInfo *str_info = RZ_NEW0(SStrInfo);
 			if (!str_info) {
-				free(num);
+				dem_free(num);
 				break;
 			}
 			if (num && demangled) {
@@ -1063,20 +1107,20 @@ static size_t get_namespace_and_name(SAbbrState *abbr, const char *buf, STypeCod
 			} else if (num) {
 				str_info->str_ptr = dem_str_newf("`%s'", num);
 			} else {
-				str_info->str_ptr = strdup("");
+				str_info->str_ptr = dem_strdup("");
 			}
 			if (!str_info->str_ptr) {
 				RZ_FREE(str_info);
-				free(num);
+				dem_free(num);
 				break;
 			}
 			str_info->len = strlen(str_info->str_ptr);
 			dem_list_append(names_l, str_info);
 			if (demangled) {
-				dem_list_append(abbr->names, strdup(str_info->str_ptr));
+				dem_list_append(abbr->names, dem_strdup(str_info->str_ptr));
 			}
-			free(demangled);
-			free(num);
+			dem_free(demangled);
+			dem_free(num);
 			prev_pos = tmp;
 			curr_pos = strchr(tmp, '@');
 			continue;
@@ -1091,7 +1135,7 @@ static size_t get_namespace_and_name(SAbbrState *abbr, const char *buf, STypeCod
 			}
 			len = 1;
 		} else {
-			char *tmpname = malloc(len + 1);
+			char *tmpname = dem_malloc(len + 1);
 			if (!tmpname) {
 				break;
 			}
@@ -1104,7 +1148,7 @@ static size_t get_namespace_and_name(SAbbrState *abbr, const char *buf, STypeCod
 		if (!str_info) {
 			break;
 		}
-		str_info->str_ptr = strdup(tmp);
+		str_info->str_ptr = dem_strdup(tmp);
 		str_info->len = strlen(tmp);
 
 		dem_list_append(names_l, str_info);
@@ -1350,10 +1394,10 @@ static char *get_num(SStateInfo *state) {
 	if (*state->buff_for_parsing == '@') {
 		state->buff_for_parsing++;
 		state->amount_of_read_chars++;
-		return strdup("0");
+		return dem_strdup("0");
 	}
 	if (*state->buff_for_parsing >= '0' && *state->buff_for_parsing <= '8') {
-		ptr = malloc(2);
+		ptr = dem_malloc(2);
 		if (!ptr) {
 			return NULL;
 		}
@@ -1362,7 +1406,7 @@ static char *get_num(SStateInfo *state) {
 		state->buff_for_parsing++;
 		state->amount_of_read_chars++;
 	} else if (*state->buff_for_parsing == '9') {
-		ptr = strdup("10");
+		ptr = dem_strdup("10");
 		state->buff_for_parsing++;
 		state->amount_of_read_chars++;
 	} else if (*state->buff_for_parsing >= 'A' && *state->buff_for_parsing <= 'P') {
@@ -1396,7 +1440,7 @@ static char *get_num(SStateInfo *state) {
 	if (negative && ptr) {
 		char *tmp = ptr;
 		ptr = dem_str_newf("-%s", tmp);
-		free(tmp);
+		dem_free(tmp);
 	}
 	return ptr;
 }
@@ -1629,7 +1673,7 @@ static EDemanglerErr parse_function_args(SAbbrState *abbr, const char *sym, char
 			if (err != eDemanglerErrOK) {
 				// abbreviation of type processing
 				if ((*curr_pos >= '0') && (*curr_pos <= '9')) {
-					free(tmp);
+					dem_free(tmp);
 					tmp = dem_list_get_n(abbr->types, (ut32)(*curr_pos - '0'));
 					if (!tmp) {
 						err = eDemanglerErrUncorrectMangledSymbol;
@@ -1640,14 +1684,14 @@ static EDemanglerErr parse_function_args(SAbbrState *abbr, const char *sym, char
 					is_abbr_type = true;
 				} else {
 					err = eDemanglerErrUncorrectMangledSymbol;
-					free(tmp);
+					dem_free(tmp);
 					break;
 				}
 			}
 			curr_pos += len;
 
 			if (len > 1) {
-				dem_list_append(abbr->types, strdup(tmp));
+				dem_list_append(abbr->types, dem_strdup(tmp));
 			}
 
 			copy_string(&func_str, tmp);
@@ -1655,12 +1699,12 @@ static EDemanglerErr parse_function_args(SAbbrState *abbr, const char *sym, char
 			if (tmp && strncmp(tmp, "void", 4) == 0 && strlen(tmp) == 4) {
 				// arguments list is void
 				if (!is_abbr_type) {
-					free(tmp);
+					dem_free(tmp);
 				}
 				break;
 			}
 			if (!is_abbr_type) {
-				free(tmp);
+				dem_free(tmp);
 			}
 		} else {
 			curr_pos++;
@@ -1678,7 +1722,7 @@ static EDemanglerErr parse_function_args(SAbbrState *abbr, const char *sym, char
 	copy_string(&func_str, ")");
 
 	if (demangled_args) {
-		*demangled_args = strdup(func_str.type_str);
+		*demangled_args = dem_strdup(func_str.type_str);
 	}
 
 	free_type_code_str_struct(&func_str);
@@ -1744,14 +1788,14 @@ static void parse_function_pointer(SAbbrState *abbr, SStateInfo *state, STypeCod
 
 	char *demangled_args = NULL;
 	if (parse_function_args(abbr, state->buff_for_parsing, &demangled_args, &i) != eDemanglerErrOK) {
-		free(demangled_args);
+		dem_free(demangled_args);
 		state->err = eTCStateMachineErrUncorrectTypeCode;
 		return;
 	}
 	state->amount_of_read_chars += i;
 	state->buff_for_parsing += i;
 	copy_string(type_code_str, demangled_args);
-	free(demangled_args);
+	dem_free(demangled_args);
 	return;
 }
 
@@ -1950,7 +1994,7 @@ static void free_type_code_str_struct(STypeCodeStr *type_code_str) {
 static char *type_code_str_get(STypeCodeStr *type_code_str) {
 	char *ret;
 	if (type_code_str->type_str == type_code_str->type_str_buf) {
-		ret = malloc(type_code_str->curr_pos + 1);
+		ret = dem_malloc(type_code_str->curr_pos + 1);
 		if (!ret) {
 			return NULL;
 		}
@@ -1980,6 +2024,12 @@ static EDemanglerErr get_type_code_string(SAbbrState *abbr, const char *sym, siz
 	init_state_struct(&state, sym);
 
 	while (state.state != eTCStateEnd) {
+		if (!dem_budget_step()) {
+			*str_type_code = NULL;
+			*amount_of_read_chars = 0;
+			err = eDemanglerErrBudgetExceeded;
+			goto get_type_code_string_err;
+		}
 		run_state(abbr, &state, &type_code_str);
 		if (state.err != eTCStateMachineErrOK) {
 			*str_type_code = NULL;
@@ -2008,10 +2058,10 @@ get_type_code_string_err:
 static inline size_t get_ptr_modifier(const char *encoded, SDataType *ptr_modifier) {
 	const char *tmp = encoded;
 	if (!ptr_modifier->left) {
-		ptr_modifier->left = strdup("");
+		ptr_modifier->left = dem_strdup("");
 	}
 	if (!ptr_modifier->right) {
-		ptr_modifier->right = strdup("");
+		ptr_modifier->right = dem_strdup("");
 	}
 #define SET_PTR_MODIFIER(letter, modifier_left, modifier_right) \
 	case letter: \
@@ -2100,17 +2150,20 @@ static EDemanglerErr parse_data_type(SAbbrState *abbr, const char *sym, SDataTyp
 	case '5': // Normal variable
 		switch (*curr_pos) {
 		case '0':
-			modifier.left = strdup("private: static ");
+			modifier.left = dem_strdup("private: static ");
 			break;
 		case '1':
-			modifier.left = strdup("protected: static ");
+			modifier.left = dem_strdup("protected: static ");
 			break;
 		case '2':
-			modifier.left = strdup("public: static ");
+			modifier.left = dem_strdup("public: static ");
 			break;
 		default:
 			break;
 		}
+		if (abbr->opts & (RZ_DEMANGLE_OPT_MSVC_NO_ACCESS_SPECIFIER | RZ_DEMANGLE_OPT_MSVC_NAME_ONLY)) {
+			RZ_FREE(modifier.left);
+		}
 		curr_pos++;
 		i = 0;
 		err = get_type_code_string(abbr, curr_pos, &i, &tmp);
@@ -2123,18 +2176,18 @@ static EDemanglerErr parse_data_type(SAbbrState *abbr, const char *sym, SDataTyp
 		curr_pos += get_ptr_modifier(curr_pos, &modifier);
 		if (get_storage_class(*curr_pos, &storage_class) != eDemanglerErrOK) {
 			sdatatype_fini(&modifier);
-			free(tmp);
+			dem_free(tmp);
 			return eDemanglerErrUncorrectMangledSymbol;
 		}
 		curr_pos++;
 
-		data_type->right = strdup("");
+		data_type->right = dem_strdup("");
 		if (storage_class) {
 			data_type->left = dem_str_newf("%s%s %s%s", modifier.left, tmp, storage_class, modifier.right);
 		} else {
 			data_type->left = dem_str_newf("%s%s%s", modifier.left, tmp, modifier.right);
 		}
-		free(tmp);
+		dem_free(tmp);
 		sdatatype_fini(&modifier);
 		break;
 	case '6': // compiler generated static
@@ -2184,7 +2237,7 @@ static EDemanglerErr parse_data_type(SAbbrState *abbr, const char *sym, SDataTyp
 			}
 			free_type_code_str_struct(&str);
 		} else {
-			data_type->right = strdup("");
+			data_type->right = dem_strdup("");
 		}
 		if (*curr_pos == '@') {
 			curr_pos++;
@@ -2203,9 +2256,10 @@ static EDemanglerErr parse_data_type(SAbbrState *abbr, const char *sym, SDataTyp
 	return eDemanglerErrOK;
 }
 
-static EDemanglerErr parse_function_type(const char *sym, SDataType *data_type,
+static EDemanglerErr parse_function_type(const char *sym, RzDemangleOpts opts, SDataType *data_type,
 	size_t *len, bool *is_static, bool *is_implicit_this_pointer) {
 	const char *curr_pos = sym;
+	const bool access = !(opts & (RZ_DEMANGLE_OPT_MSVC_NO_ACCESS_SPECIFIER | RZ_DEMANGLE_OPT_MSVC_NAME_ONLY));
 	*is_static = *is_implicit_this_pointer = false;
 #define SET_THUNK_MODIFIER(letter, modifier_str) \
 	case letter: { \
@@ -2215,9 +2269,11 @@ static EDemanglerErr parse_function_type(const char *sym, SDataType *data_type,
 		if (!num) { \
 			return eDemanglerErrUncorrectMangledSymbol; \
 		} \
-		data_type->left = strdup(modifier_str); \
+		if (access) { \
+			data_type->left = dem_strdup(modifier_str); \
+		} \
 		data_type->right = dem_str_newf("`adjustor{%s}'", num); \
-		free(num); \
+		dem_free(num); \
 		*is_implicit_this_pointer = true; \
 		curr_pos += state.amount_of_read_chars; \
 		break; \
@@ -2225,7 +2281,9 @@ static EDemanglerErr parse_function_type(const char *sym, SDataType *data_type,
 
 #define SET_ACCESS_MODIFIER(letter, flag_set, modifier_str) \
 	case letter: \
-		data_type->left = strdup(modifier_str); \
+		if (access) { \
+			data_type->left = dem_strdup(modifier_str); \
+		} \
 		*flag_set = true; \
 		break;
 
@@ -2266,10 +2324,10 @@ static EDemanglerErr parse_function_type(const char *sym, SDataType *data_type,
 		*len = curr_pos - sym;
 	}
 	if (!data_type->left) {
-		data_type->left = strdup("");
+		data_type->left = dem_strdup("");
 	}
 	if (!data_type->right) {
-		data_type->right = strdup("");
+		data_type->right = dem_strdup("");
 	}
 	return eDemanglerErrOK;
 }
@@ -2299,7 +2357,7 @@ static EDemanglerErr parse_function(SAbbrState *abbr, const char *sym, STypeCode
 		curr_pos += 3;
 	}
 
-	err = parse_function_type(curr_pos, &data_type, &len, &is_static, &is_implicit_this_pointer);
+	err = parse_function_type(curr_pos, abbr->opts, &data_type, &len, &is_static, &is_implicit_this_pointer);
 	if (err != eDemanglerErrOK) {
 		goto parse_function_err;
 	}
@@ -2359,7 +2417,7 @@ static EDemanglerErr parse_function(SAbbrState *abbr, const char *sym, STypeCode
 
 	// Return type, or @ if 'void'
 	if (*curr_pos == '@') {
-		ret_type = strdup("void");
+		ret_type = dem_strdup("void");
 		curr_pos++;
 	} else {
 		err = get_type_code_string(abbr, curr_pos, &len, &ret_type);
@@ -2379,6 +2437,16 @@ static EDemanglerErr parse_function(SAbbrState *abbr, const char *sym, STypeCode
 
 print_function:
 
+	if (abbr->opts & RZ_DEMANGLE_OPT_MSVC_NAME_ONLY) {
+		if (type_code_str->type_str) {
+			copy_string_n(&func_str, type_code_str->type_str, type_code_str->curr_pos);
+		}
+		if (!RZ_STR_ISEMPTY(data_type.right)) {
+			copy_string(&func_str, data_type.right);
+		}
+		goto replace_return_type;
+	}
+
 	if (!RZ_STR_ISEMPTY(data_type.left)) {
 		copy_string(&func_str, data_type.left);
 		if (!strstr(data_type.left, "static")) {
@@ -2388,12 +2456,12 @@ print_function:
 		}
 	}
 
-	if (ret_type) {
+	if (ret_type && !(abbr->opts & RZ_DEMANGLE_OPT_MSVC_NO_RETURN_TYPE)) {
 		copy_string(&func_str, ret_type);
 		copy_string(&func_str, " ");
 	}
 
-	if (call_conv) {
+	if (call_conv && !(abbr->opts & RZ_DEMANGLE_OPT_MSVC_NO_CALLING_CONVENTION)) {
 		copy_string(&func_str, call_conv);
 		copy_string(&func_str, " ");
 	}
@@ -2421,6 +2489,7 @@ print_function:
 
 	copy_string(&func_str, this_pointer_modifier.right);
 
+replace_return_type:
 	if (ret_type) {
 		if (strstr(func_str.type_str, "#{return_type}")) {
 			func_str.type_str = type_code_str_get(&func_str);
@@ -2441,8 +2510,8 @@ parse_function_err:
 	sdatatype_fini(&data_type);
 	sdatatype_fini(&this_pointer_modifier);
 	free_type_code_str_struct(&func_str);
-	free(ret_type);
-	free(demangled_args);
+	dem_free(ret_type);
+	dem_free(demangled_args);
 	return err;
 }
 
@@ -2457,11 +2526,16 @@ static EDemanglerErr parse_microsoft_mangled_name(SAbbrState *abbr, const char *
 	EDemanglerErr err = eDemanglerErrOK;
 
 	const char *curr_pos = sym;
+	abbr->depth++;
 
 	if (!init_type_code_str_struct(&type_code_str)) {
 		err = eDemanglerErrMemoryAllocation;
 		goto parse_microsoft_mangled_name_err;
 	}
+	if (!dem_budget_step()) {
+		err = eDemanglerErrBudgetExceeded;
+		goto parse_microsoft_mangled_name_err;
+	}
 	size_t i;
 	size_t len = get_namespace_and_name(abbr, curr_pos, &type_code_str, &i, false);
 	if (!len) {
@@ -2471,6 +2545,9 @@ static EDemanglerErr parse_microsoft_mangled_name(SAbbrState *abbr, const char *
 
 	curr_pos += len;
 
+	// With name-only the rest is still parsed, so a symbol that does not
+	// demangle does not yield a name either; its text is just not built.
+	const bool name_only = abbr->opts & RZ_DEMANGLE_OPT_MSVC_NAME_ONLY;
 	if (!*curr_pos) {
 		*demangled_name = type_code_str_get(&type_code_str);
 		goto parse_microsoft_mangled_name_err;
@@ -2497,6 +2574,11 @@ static EDemanglerErr parse_microsoft_mangled_name(SAbbrState *abbr, const char *
 		}
 		curr_pos += len;
 		*demangled_name = NULL;
+		if (name_only) {
+			*demangled_name = type_code_str_get(&type_code_str);
+			sdatatype_fini(&data_type);
+			goto parse_microsoft_mangled_name_err;
+		}
 		if (data_type.left) {
 			*demangled_name = dem_str_newf("%s ", data_type.left);
 		}
@@ -2511,6 +2593,7 @@ static EDemanglerErr parse_microsoft_mangled_name(SAbbrState *abbr, const char *
 	}
 
 parse_microsoft_mangled_name_err:
+	abbr->depth--;
 	free_type_code_str_struct(&type_code_str);
 	if (chars_read) {
 		*chars_read = curr_pos - sym;
@@ -2545,34 +2628,72 @@ static EDemanglerErr parse_microsoft_rtti_mangled_name(SAbbrState *abbr, const c
 	if (chars_read) {
 		*chars_read = len + 1;
 	}
-	free(type);
+	dem_free(type);
 	return err;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-EDemanglerErr microsoft_demangle(SDemangler *demangler, char **demangled_name) {
+EDemanglerErr microsoft_demangle_str(const char *sym, RzDemangleOpts opts, char **demangled_name) {
 	EDemanglerErr err = eDemanglerErrOK;
-	//	DemListIter *it = NULL;
-	//	char *tmp = NULL;
+
+	if (!sym || !demangled_name) {
+		return eDemanglerErrMemoryAllocation;
+	}
+	if (*sym != '?' && *sym != '.') {
+		return eDemanglerErrUnsupportedMangling;
+	}
 
 	// TODO: need refactor... maybe remove the static variable somewhere?
 	SAbbrState abbr;
-	abbr.types = dem_list_newf(free);
-	abbr.names = dem_list_newf(free);
-
-	if (!demangler || !demangled_name) {
-		err = eDemanglerErrMemoryAllocation;
-		goto microsoft_demangle_err;
-	}
+	abbr.types = dem_list_newf(dem_free);
+	abbr.names = dem_list_newf(dem_free);
+	abbr.opts = opts;
+	abbr.depth = 0;
 
-	if (!strncmp(demangler->symbol, ".?", 2)) {
-		err = parse_microsoft_rtti_mangled_name(&abbr, demangler->symbol + 2, demangled_name, NULL);
+	if (!strncmp(sym, ".?", 2)) {
+		err = parse_microsoft_rtti_mangled_name(&abbr, sym + 2, demangled_name, NULL);
 	} else {
-		err = parse_microsoft_mangled_name(&abbr, demangler->symbol + 1, demangled_name, NULL);
+		err = parse_microsoft_mangled_name(&abbr, sym + 1, demangled_name, NULL);
 	}
 
-microsoft_demangle_err:
 	dem_list_free(abbr.names);
 	dem_list_free(abbr.types);
 	return err;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+EDemanglerErr microsoft_demangle_n(const char *sym, size_t sym_len, RzDemangleOpts opts, char **demangled_name) {
+	if (!sym || !demangled_name) {
+		return eDemanglerErrMemoryAllocation;
+	}
+	if (sym_len < 1) {
+		return eDemanglerErrUnsupportedMangling;
+	}
+
+	// The parser walks a NUL terminated buffer, so the view is copied onto
+	// the stack; only symbols longer than what MSVC itself emits go to heap.
+	char stack_buf[MICROSOFT_SYMBOL_MAX_LEN + 1];
+	char *buf = stack_buf;
+	if (sym_len > MICROSOFT_SYMBOL_MAX_LEN) {
+		buf = dem_malloc(sym_len + 1);
+		if (!buf) {
+			return eDemanglerErrMemoryAllocation;
+		}
+	}
+	memcpy(buf, sym, sym_len);
+	buf[sym_len] = '\0';
+
+	EDemanglerErr err = microsoft_demangle_str(buf, opts, demangled_name);
+	if (buf != stack_buf) {
+		dem_free(buf);
+	}
+	return err;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+EDemanglerErr microsoft_demangle(SDemangler *demangler, char **demangled_name) {
+	if (!demangler || !demangled_name) {
+		return eDemanglerErrMemoryAllocation;
+	}
+	return microsoft_demangle_str(demangler->symbol, RZ_DEMANGLE_OPT_BASE, demangled_name);
+}
@@ -6,6 +6,10 @@
 
 #include "demangler_util.h"
 #include "demangler_types.h"
+#include <rz_libdemangle.h>
+
+/// MSVC hashes any decorated name longer than this, so real symbols always fit.
+#define MICROSOFT_SYMBOL_MAX_LEN (4096)
 
 ///////////////////////////////////////////////////////////////////////////////
 /// \brief Do demangle for microsoft mangling scheme. Demangled name need to be
@@ -17,4 +21,28 @@
 ///////////////////////////////////////////////////////////////////////////////
 EDemanglerErr microsoft_demangle(SDemangler *demangler, char **demangled_name);
 
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Do demangle for microsoft mangling scheme without creating an
+///			SDemangler object. The symbol is used as is, no copy is made.
+/// \param sym NUL terminated mangled symbol, starting with '?' or '.'
+/// \param opts Demangling options, see RzDemangleOpts
+/// \param demangled_name Demangled name of symbol, need to be free by user
+/// \return Returns eDemanglerErrOK on success, else one of next errors:
+///			eDemanglerErrUnsupportedMangling, eDemanglerErrUncorrectMangledSymbol
+///////////////////////////////////////////////////////////////////////////////
+EDemanglerErr microsoft_demangle_str(const char *sym, RzDemangleOpts opts, char **demangled_name);
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Do demangle for microsoft mangling scheme from a (pointer, length)
+///			view, which does not need to be NUL terminated (e.g. an entry of a
+///			mapped string table). Symbols up to MICROSOFT_SYMBOL_MAX_LEN chars
+///			are parsed from a stack copy, without any heap allocation.
+/// \param sym Start of the mangled symbol
+/// \param sym_len Length of the mangled symbol in bytes
+/// \param opts Demangling options, see RzDemangleOpts
+/// \param demangled_name Demangled name of symbol, need to be free by user
+/// \return Same as microsoft_demangle_str()
+///////////////////////////////////////////////////////////////////////////////
+EDemanglerErr microsoft_demangle_n(const char *sym, size_t sym_len, RzDemangleOpts opts, char **demangled_name);
+
 #endif // MICROSOFT_DEMANGLE_H
@@ -1,19 +1,27 @@
 // SPDX-FileCopyrightText: 2015-2018 inisider <inisider@gmail.com>
 // SPDX-License-Identifier: LGPL-3.0-only
-#include "demangler.h"
+#include "microsoft_demangle.h"
 #include <rz_libdemangle.h>
 
 DEM_LIB_EXPORT char *libdemangle_handler_msvc(const char *str, RzDemangleOpts opts) {
 	char *out = NULL;
-	SDemangler *mangler = 0;
-
-	create_demangler(&mangler);
-	if (!mangler) {
+	DemNegativeKey key;
+	if (!str || dem_negative_lookup(&key, DEM_LANG_MSVC, str, SIZE_MAX, opts)) {
 		return NULL;
 	}
-	if (init_demangler(mangler, (char *)str) == eDemanglerErrOK) {
-		mangler->demangle(mangler, &out /*demangled_name*/);
+	// partial results are still returned on error, like the SDemangler path
+	dem_budget_begin();
+	microsoft_demangle_str(str, opts, &out);
+	return dem_negative_record(&key, dem_budget_end(out));
+}
+
+DEM_LIB_EXPORT char *libdemangle_handler_msvc_n(const char *str, size_t len, RzDemangleOpts opts) {
+	char *out = NULL;
+	DemNegativeKey key;
+	if (!str || dem_negative_lookup(&key, DEM_LANG_MSVC, str, len, opts)) {
+		return NULL;
 	}
-	free_demangler(mangler);
-	return out;
+	dem_budget_begin();
+	microsoft_demangle_n(str, len, opts, &out);
+	return dem_negative_record(&key, dem_budget_end(out));
 }
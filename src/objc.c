@@ -4,167 +4,178 @@
 #include "cplusplus/demangle.h"
 #include <rz_libdemangle.h>
 
-static char *find_block_invoke(char *p) {
-	const size_t kwlen = strlen("_block_invoke");
-	char *last = NULL;
-	char *next = p;
-	while ((next = strstr(next, "_block_invoke"))) {
-		last = next;
-		next += kwlen;
+#define OBJC_BLOCK_INVOKE "_block_invoke"
+
+/**
+ * Read-only view over the symbol, past any `___<n>` block prefix. The
+ * `_` starting the last `_block_invoke` reads as a space, which splits
+ * the suffix from the selector.
+ */
+typedef struct {
+	const char *buf;
+	size_t len;
+	size_t block; ///< offset of the last `_block_invoke`, len when there is none
+} objc_view_t;
+
+static inline char objc_at(const objc_view_t *v, size_t i) {
+	if (i >= v->len) {
+		return 0;
+	}
+	return i == v->block ? ' ' : v->buf[i];
+}
+
+/* first offset in [from, len) holding ch, len when there is none */
+static size_t objc_find(const objc_view_t *v, size_t from, char ch) {
+	for (size_t i = from; i < v->len; i++) {
+		if (objc_at(v, i) == ch) {
+			return i;
+		}
+	}
+	return v->len;
+}
+
+static size_t objc_count(const objc_view_t *v, size_t from, char ch) {
+	size_t n = 0;
+	for (size_t i = from; i < v->len; i++) {
+		n += objc_at(v, i) == ch;
+	}
+	return n;
+}
+
+static void objc_emit(const objc_view_t *v, size_t from, size_t to, DemString *ds) {
+	if (from <= v->block && v->block < to) {
+		dem_string_append_n(ds, v->buf + from, v->block - from);
+		dem_string_append_char(ds, ' ');
+		from = v->block + 1;
+	}
+	if (from < to) {
+		dem_string_append_n(ds, v->buf + from, to - from);
+	}
+}
+
+static size_t objc_find_block_invoke(const char *p, size_t len) {
+	const size_t kwlen = strlen(OBJC_BLOCK_INVOKE);
+	size_t last = len;
+	for (const char *next = p; (next = strstr(next, OBJC_BLOCK_INVOKE)); next += kwlen) {
+		last = next - p;
 	}
 	return last;
 }
 
-static char *demangle_objc(const char *symbol) {
-	char *ret = NULL;
-	char *clas = NULL;
-	char *name = NULL;
-	char *args = NULL;
-	int i, nargs = 0;
-	const char *type = NULL;
-	if (!symbol) {
+/**
+ * \brief Writes `<type> int <class>::<name>(int, ...)<block suffix>`
+ *
+ * \param clas   Offset of the class name
+ * \param sep    End of the class name
+ * \param name   Offset of the selector, which ends before the first `stop`
+ * \param nargs  Number of arguments
+ */
+static char *objc_method(const objc_view_t *v, const char *type, size_t clas, size_t sep, size_t name, char stop, char alt_stop, size_t nargs) {
+	size_t name_end = name;
+	for (char ch; (ch = objc_at(v, name_end)) && ch != stop && ch != alt_stop;) {
+		name_end++;
+	}
+	if (name_end == name) {
 		return NULL;
 	}
 
-	char *sym = strdup(symbol);
-	/* classes */
-	if (!strncmp(sym, "_OBJC_Class_", 12)) {
-		const char *className = sym + 12;
-		ret = dem_str_newf("class %s", className);
-		free(sym);
-		return ret;
-	} else if (!strncmp(sym, "_OBJC_CLASS_$_", 14)) {
-		const char *className = sym + 14;
-		ret = dem_str_newf("class %s", className);
-		free(sym);
-		return ret;
-	} else if (sym[0] == '_') {
-		// find any prefix `___[0-9]+`
-		size_t i = 0, len = strlen(sym);
-		for (i = 1; i < len && sym[i] == '_'; ++i) {
-		}
-		for (; i < len && IS_DIGIT(sym[i]); ++i) {
-		}
-		if (IS_DIGIT(sym[i - 1])) {
-			// remove prefix `___[0-9]+`
-			memmove(sym, sym + i, len - i);
-			sym[len - i] = 0;
-		}
+	// "static int " + "::" + "()" and ", int" for each argument.
+	DemString *ds = dem_string_new_with_capacity(v->len + nargs * 5 + 32);
+	if (!ds) {
+		return NULL;
+	}
+	dem_string_appends(ds, type);
+	dem_string_appends(ds, " int ");
+	objc_emit(v, clas, sep, ds);
+	dem_string_appends(ds, "::");
+	objc_emit(v, name, name_end, ds);
+	dem_string_append_char(ds, '(');
+	for (size_t i = 0; i < nargs; i++) {
+		dem_string_appends(ds, i ? ", int" : "int");
 	}
+	dem_string_append_char(ds, ')');
+	objc_emit(v, v->block, v->len, ds);
+	return dem_string_drain(ds);
+}
 
-	char *binvk = find_block_invoke(sym);
-	if (binvk) {
-		binvk[0] = ' ';
+static char *demangle_objc(const char *symbol) {
+	/* classes */
+	if (!strncmp(symbol, "_OBJC_Class_", 12)) {
+		return dem_str_newf("class %s", symbol + 12);
+	} else if (!strncmp(symbol, "_OBJC_CLASS_$_", 14)) {
+		return dem_str_newf("class %s", symbol + 14);
 	}
 
-	if (!strncmp(sym, "_OBJC_IVAR_$_", 13)) {
-		/* fields */
-		clas = strdup(sym + 13);
-		char *p = strchr(clas, '.');
-		type = "field";
-		if (p) {
-			*p = 0;
-			name = strdup(p + 1);
-		} else {
-			name = NULL;
+	objc_view_t v = { .buf = symbol, .len = strlen(symbol) };
+	if (symbol[0] == '_') {
+		// skip any prefix `___[0-9]+`
+		size_t i;
+		for (i = 1; i < v.len && symbol[i] == '_'; ++i) {
 		}
-	} else if (sym[0] && sym[1] == '[') { // apple style
-		/* methods */
-		if (sym[0] == '+') {
-			type = "static";
-		} else if (sym[0] == '-') {
-			type = "public";
+		for (; i < v.len && IS_DIGIT(symbol[i]); ++i) {
 		}
-		if (type) {
-			free(clas);
-			clas = strdup(sym + 2);
-			name = strchr(clas, ' ');
-			if (name) {
-				*name++ = 0;
-				name = strdup(name);
-				if (!name) {
-					free(clas);
-					free(sym);
-					return NULL;
-				}
-				for (i = 0; name[i]; i++) {
-					if (name[i] == ']') {
-						name[i] = 0;
-					}
-					if (name[i] == ':') {
-						nargs++;
-						name[i] = 0;
-					}
-				}
-			}
+		if (IS_DIGIT(symbol[i - 1])) {
+			v.buf += i;
+			v.len -= i;
 		}
 	}
-	if (sym[0] == '_' && sym[1] && sym[2] == '_') { // gnu style
-		free(clas);
-		clas = strdup(sym + 3);
-		args = strstr(clas, "__");
-		if (!args) {
-			free(clas);
-			if (name != clas) {
-				free(name);
-			}
-			free(sym);
+	v.block = objc_find_block_invoke(v.buf, v.len);
+
+	if (v.block >= 13 && !strncmp(v.buf, "_OBJC_IVAR_$_", 13)) {
+		/* fields */
+		size_t dot = objc_find(&v, 13, '.');
+		if (dot == v.len) {
+			return NULL;
+		}
+		DemString *ds = dem_string_new_with_capacity(v.len + 16);
+		if (!ds) {
 			return NULL;
 		}
-		*args = 0;
-		free(name);
-		name = strdup(args + 2);
-		if (!name) {
-			free(clas);
-			free(sym);
+		dem_string_appends(ds, "field int ");
+		objc_emit(&v, 13, dot, ds);
+		dem_string_appends(ds, "::");
+		objc_emit(&v, dot + 1, v.len, ds);
+		return dem_string_drain(ds);
+	} else if ((v.buf[0] == '+' || v.buf[0] == '-') && v.buf[1] == '[') {
+		/* methods, apple style */
+		const char *type = v.buf[0] == '+' ? "static" : "public";
+		size_t sep = objc_find(&v, 2, ' ');
+		if (sep == v.len) {
 			return NULL;
 		}
-		args = NULL;
-		for (i = 0; name[i]; i++) {
-			if (name[i] == '_') {
-				name[i] = 0;
-				nargs++;
-			}
+		return objc_method(&v, type, 2, sep, sep + 1, ']', ':', objc_count(&v, sep + 1, ':'));
+	} else if (objc_at(&v, 0) == '_' && objc_at(&v, 1) && objc_at(&v, 2) == '_') {
+		/* methods, gnu style */
+		size_t sep = 3;
+		while (sep < v.len && (objc_at(&v, sep) != '_' || objc_at(&v, sep + 1) != '_')) {
+			sep++;
+		}
+		if (sep == v.len) {
+			return NULL;
 		}
-		if (sym[1] == 'i') {
+		const char *type = NULL;
+		if (v.buf[1] == 'i') {
 			type = "public";
-		} else if (sym[1] == 'c') {
+		} else if (v.buf[1] == 'c') {
 			type = "static";
-		}
-	}
-	if (type) {
-		if (!strcmp(type, "field")) {
-			ret = dem_str_newf("field int %s::%s", clas, name);
 		} else {
-			if (nargs) {
-				const char *arg = "int";
-				args = malloc(((strlen(arg) + 4) * nargs) + 1);
-				args[0] = 0;
-				for (i = 0; i < nargs; i++) {
-					strcat(args, arg);
-					if (i + 1 < nargs) {
-						strcat(args, ", ");
-					}
-				}
-			} else {
-				args = strdup("");
-			}
-			if (type && name && *name) {
-				ret = dem_str_newf("%s int %s::%s(%s)%s", type, clas, name, args, binvk ? binvk : "");
-			}
+			return NULL;
 		}
+		return objc_method(&v, type, 3, sep, sep + 2, '_', '_', objc_count(&v, sep + 2, '_'));
 	}
-	free(clas);
-	free(args);
-	free(name);
-	free(sym);
-	return ret;
+	return NULL;
 }
 
 DEM_LIB_EXPORT char *libdemangle_handler_objc(const char *symbol, RzDemangleOpts opts) {
+	DemNegativeKey key;
+	if (!symbol || dem_negative_lookup(&key, DEM_LANG_OBJC, symbol, SIZE_MAX, opts)) {
+		return NULL;
+	}
+	dem_budget_begin();
 	char *res = demangle_objc(symbol);
-	if (res) {
-		return res;
+	// C++ methods called from Objective-C++, `__Z` on Mach-O.
+	if (!res && (!strncmp(symbol, "_Z", 2) || !strncmp(symbol, "__Z", 3))) {
+		res = cp_demangle(symbol, cp_options_convert(opts & RZ_DEMANGLE_OPT_SIMPLIFY));
 	}
-	return cp_demangle(symbol, cp_options_convert(opts & RZ_DEMANGLE_OPT_SIMPLIFY));
+	return dem_negative_record(&key, dem_budget_end(res));
 }
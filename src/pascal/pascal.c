@@ -3,14 +3,13 @@
 
 #include "demangler_util.h"
 #include <rz_libdemangle.h>
-#include <ctype.h>
 
-#define IS_NAME(x) (IS_LOWER(x) || IS_DIGIT(x) || (x) == '_')
+#define IS_NAME(x) (IS_ALPHA(x) || IS_DIGIT(x) || (x) == '_')
 
-static char *demangle_free_pascal_function(DemString *ds, char *mangled, size_t mangled_len) {
-	char *next = mangled;
-	char *end = mangled + mangled_len;
-	char *tmp = strchr(next, '$');
+static const char *demangle_free_pascal_function(DemString *ds, const char *mangled, size_t mangled_len) {
+	const char *next = mangled;
+	const char *end = mangled + mangled_len;
+	const char *tmp = strchr(next, '$');
 
 	// <func_name>$<type0$type1>$$<ret_type>
 	dem_string_append_n(ds, next, tmp - next);
@@ -51,13 +50,13 @@ static char *demangle_free_pascal_function(DemString *ds, char *mangled, size_t
 	return next;
 }
 
-static void demangle_free_pascal_unit(DemString *ds, char *mangled, size_t mangled_len) {
+static void demangle_free_pascal_unit(DemString *ds, const char *mangled, size_t mangled_len) {
 	dem_string_appends(ds, "unit ");
 
-	char *end = mangled + mangled_len;
-	char *tmp = strstr(mangled, "_$");
+	const char *end = mangled + mangled_len;
+	const char *tmp = strstr(mangled, "_$");
 
-	if (tmp && tmp < end) {
+	if (tmp && tmp + strlen("_$") <= end) {
 		dem_string_append_n(ds, mangled, tmp - mangled);
 		dem_string_appends(ds, ".");
 		mangled = tmp + strlen("_$");
@@ -88,29 +87,31 @@ static void demangle_free_pascal_unit(DemString *ds, char *mangled, size_t mangl
 /**
  * \brief      Demangles freepascal 2.6.x to 3.2.x symbols
  *
+ * The mangled string is only read; since the separators are made of `$`
+ * and `_`, the names are lowercased once the output is complete.
+ *
  * \param      mangled      The mangled string
  * \param[in]  mangled_len  The mangled string length
  *
  * \return     Demangled string on success otherwise NULL
  */
-static char *demangle_free_pascal(char *mangled, size_t mangled_len) {
-	char *tmp = NULL;
-	char *next = mangled;
-	char *end = mangled + mangled_len;
+static char *demangle_free_pascal(const char *mangled, size_t mangled_len) {
+	const char *tmp = NULL;
+	const char *next = mangled;
+	const char *end = mangled + mangled_len;
 	DemString *ds = NULL;
 	bool unit = false;
 
 	for (size_t i = 0; i < mangled_len; ++i) {
-		char ch = tolower(mangled[i]);
-		if (!IS_LOWER(ch) && !IS_DIGIT(ch) && ch != '_' && ch != '$') {
-			goto demangle_fail;
+		if (!IS_NAME(mangled[i]) && mangled[i] != '$') {
+			return NULL;
 		}
-		mangled[i] = ch;
 	}
 
-	ds = dem_string_new();
+	// separators shrink in the output, the slack covers "unit ", "::" and "()".
+	ds = dem_string_new_with_capacity(mangled_len + 16);
 	if (!ds) {
-		goto demangle_fail;
+		return NULL;
 	}
 
 	if (next < end && (tmp = strstr(next, "$_$")) && tmp > next && IS_NAME(tmp[-1])) {
@@ -144,21 +145,21 @@ static char *demangle_free_pascal(char *mangled, size_t mangled_len) {
 		next = demangle_free_pascal_function(ds, next, end - next);
 	} else {
 		// <func_name>
-		dem_string_append(ds, next);
+		dem_string_append_n(ds, next, end - next);
 		dem_string_appends(ds, "()");
 	}
 
 	if (ds->len < 1) {
-		goto demangle_fail;
+		dem_string_free(ds);
+		return NULL;
 	}
 
-	free(mangled);
+	for (size_t i = 0; i < ds->len; ++i) {
+		if (IS_UPPER(ds->buf[i])) {
+			ds->buf[i] += 'a' - 'A';
+		}
+	}
 	return dem_string_drain(ds);
-
-demangle_fail:
-	dem_string_free(ds);
-	free(mangled);
-	return NULL;
 }
 
 /**
@@ -167,7 +168,8 @@ demangle_fail:
  * Demangles pascal symbols
  */
 DEM_LIB_EXPORT char *libdemangle_handler_pascal(const char *mangled, RzDemangleOpts opts) {
-	if (!mangled || !strchr(mangled, '$')) {
+	DemNegativeKey key;
+	if (!mangled || !strchr(mangled, '$') || dem_negative_lookup(&key, DEM_LANG_PASCAL, mangled, SIZE_MAX, opts)) {
 		return NULL;
 	}
 
@@ -176,10 +178,6 @@ DEM_LIB_EXPORT char *libdemangle_handler_pascal(const char *mangled, RzDemangleO
 		return NULL;
 	}
 
-	char *copy = strdup(mangled);
-	if (!copy) {
-		return NULL;
-	}
-
-	return demangle_free_pascal(copy, length);
+	dem_budget_begin();
+	return dem_negative_record(&key, dem_budget_end(demangle_free_pascal(mangled, length)));
 }
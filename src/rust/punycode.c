@@ -12,57 +12,24 @@
 #define INITIAL_N    128
 #define INITIAL_BIAS 72
 
-static size_t utf32_len(ut32 *input) {
-	size_t i = 0;
-	while (*(input + i)) {
-		i++;
-	}
-	return i;
-}
-
-static ut32 utf32_to_utf8(ut32 utf32, ut8 *utf8) {
-	if (utf32 < 0x80) {
-		*utf8 = utf32 & 0xff;
-		return 1;
-	} else if (utf32 < 0x800) {
-		utf8[1] = 0x80 | (utf32 & 0x3f);
-		utf8[0] = 0xc0 | ((utf32 >> 6) & 0x1f);
-		return 2;
-	} else if (utf32 < 0x10000) {
-		utf8[2] = 0x80 | (utf32 & 0x3f);
-		utf8[1] = 0x80 | ((utf32 >> 6) & 0x3f);
-		utf8[0] = 0xe0 | ((utf32 >> 12) & 0xf);
-		return 3;
-	} else if (utf32 < 0x200000) {
-		utf8[3] = 0x80 | (utf32 & 0x3f);
-		utf8[2] = 0x80 | ((utf32 >> 6) & 0x3f);
-		utf8[1] = 0x80 | ((utf32 >> 12) & 0x3f);
-		utf8[0] = 0xf0 | ((utf32 >> 18) & 0x7);
-		return 4;
+/**
+ * \brief Returns the byte offset of the code point at \p index
+ *
+ * The first \p ascii code points are known to be single bytes,
+ * thus only the tail after them needs to be walked.
+ */
+static size_t utf8_offset(const char *utf8, size_t ascii, size_t index) {
+	if (index <= ascii) {
+		return index;
 	}
-	return 0;
-}
-
-static ut8 *utf32_to_utf8_string(ut32 *input, size_t *length) {
-	size_t len = utf32_len(input);
-	ut8 *result = calloc(4, len + 1);
-	if (!result) {
-		return NULL;
-	}
-
-	size_t j = 0;
-	for (size_t i = 0; i < len; i++) {
-		ut32 used = utf32_to_utf8(input[i], result + j);
-		if (used < 1) {
-			free(result);
-			return NULL;
+	const char *p = utf8 + ascii;
+	for (index -= ascii; index > 0; index--) {
+		// skip the continuation bytes
+		for (p++; (*p & 0xc0) == 0x80; p++) {
+			;
 		}
-		j += used;
 	}
-
-	result[j] = 0;
-	*length = j;
-	return result;
+	return p - utf8;
 }
 
 static ut32 adapt_bias(ut32 delta, unsigned n_points, int is_first) {
@@ -91,41 +58,46 @@ static bool decode_digit(ut32 v, ut32 *digit) {
 	return true;
 }
 
-char *rust_punycode_to_utf8(const char *encoded, size_t length, size_t *decoded_len) {
-	const char *p = NULL;
+/**
+ * \brief Decodes a rust punycode identifier and appends it as UTF-8
+ *
+ * Code points are inserted in place into the output, thus no
+ * intermediate UTF-32 buffer is needed; on failure \p out is
+ * left as it was before the call.
+ */
+bool rust_punycode_decode(const char *encoded, size_t length, DemString *out) {
 	ut32 di = 0;
 	ut32 b = 0, n = 0, t = 0;
 	ut32 digit = 0, org_i = 0, bias = 0;
-	ut32 *utf32_string = NULL;
-	ut8 *decoded = NULL;
+	ut8 utf8[4];
 
 	if (length < 1) {
-		return NULL;
+		return false;
 	}
 
+	// Rust punycode deviates from standard
+	// https://rust-lang.github.io/rfcs/2603-rust-symbol-name-mangling-v0.html#punycode-identifiers
+	const char *delim = NULL;
 	for (size_t si = 0; si < length; si++) {
 		if (encoded[si] & 0x80) {
-			return NULL;
+			return false;
+		} else if (encoded[si] == '_') {
+			delim = encoded + si;
 		}
 	}
 
-	utf32_string = calloc((2 * length) + 10, 4);
-	if (!utf32_string) {
-		return NULL;
-	}
-
-	// Rust punycode deviates from standard
-	// https://rust-lang.github.io/rfcs/2603-rust-symbol-name-mangling-v0.html#punycode-identifiers
-	for (p = encoded + length - 1; p > encoded && *p != '_'; p--) {
-		;
+	const size_t base = out->len;
+	// identifiers without delimiter are made only of encoded code points.
+	if (delim && delim > encoded) {
+		b = delim - encoded;
+		if (!dem_string_append_n(out, encoded, b)) {
+			return false;
+		}
 	}
-	b = p - encoded;
 
+	// number of leading code points that are still plain ascii.
+	size_t ascii = b;
 	di = b;
-	for (size_t i = 0; i < b; i++) {
-		utf32_string[i] = encoded[i];
-	}
-
 	n = INITIAL_N;
 	bias = INITIAL_BIAS;
 
@@ -133,14 +105,13 @@ char *rust_punycode_to_utf8(const char *encoded, size_t length, size_t *decoded_
 		org_i = i;
 
 		for (ut32 w = 1, k = BASE;; k += BASE) {
-			if (!decode_digit(encoded[si++], &digit)) {
-				free(utf32_string);
-				return NULL;
+			// a truncated integer must not read into the rest of the symbol.
+			if (si >= length || !decode_digit(encoded[si++], &digit)) {
+				goto fail;
 			}
 
 			if (digit > (UT32_MAX - i) / w) {
-				free(utf32_string);
-				return NULL;
+				goto fail;
 			}
 
 			i += digit * w;
@@ -158,8 +129,7 @@ char *rust_punycode_to_utf8(const char *encoded, size_t length, size_t *decoded_
 			}
 
 			if (w > UT32_MAX / (BASE - t)) {
-				free(utf32_string);
-				return NULL;
+				goto fail;
 			}
 
 			w *= BASE - t;
@@ -168,21 +138,31 @@ char *rust_punycode_to_utf8(const char *encoded, size_t length, size_t *decoded_
 		bias = adapt_bias(i - org_i, di + 1, org_i == 0);
 
 		if (i / (di + 1) > UT32_MAX - n) {
-			free(utf32_string);
-			return NULL;
+			goto fail;
 		}
 
 		n += i / (di + 1);
 		i %= (di + 1);
 
-		memmove(utf32_string + i + 1, utf32_string + i, (di - i) * sizeof(ut32));
-		utf32_string[i++] = n;
+		// append, then rotate the new bytes into their position.
+		size_t tail = out->len;
+		size_t offset = base + utf8_offset(out->buf + base, ascii, i);
+		if (!dem_string_append_utf8(out, n)) {
+			goto fail;
+		}
+		size_t used = out->len - tail;
+		memcpy(utf8, out->buf + tail, used);
+		memmove(out->buf + offset + used, out->buf + offset, tail - offset);
+		memcpy(out->buf + offset, utf8, used);
+		ascii = RZ_MIN(ascii, i);
+		i++;
 	}
+	return true;
 
-	decoded = utf32_to_utf8_string(utf32_string, decoded_len);
-	free(utf32_string);
-	if (!decoded) {
-		return NULL;
+fail:
+	out->len = base;
+	if (out->buf) {
+		out->buf[base] = 0;
 	}
-	return (char *)decoded;
+	return false;
 }
@@ -5,10 +5,55 @@
 #include "rust.h"
 
 DEM_LIB_EXPORT char *libdemangle_handler_rust(const char *symbol, RzDemangleOpts opts) {
-	char *result = rust_demangle_legacy(symbol);
-	if (result) {
-		return result;
+	DemNegativeKey key;
+	if (!symbol || dem_negative_lookup(&key, DEM_LANG_RUST, symbol, SIZE_MAX, opts)) {
+		return NULL;
 	}
 
-	return rust_demangle_v0(symbol, opts & RZ_DEMANGLE_OPT_SIMPLIFY);
+	// v0 symbols are `_R`, `__R`, ... while legacy ones are `_ZN`, `ZN` or `__ZN`.
+	const char *p = symbol;
+	while (*p == '_') {
+		p++;
+	}
+
+	char *result = NULL;
+	dem_budget_begin();
+	if (*p == 'R' && p > symbol) {
+		result = rust_demangle_v0(symbol, opts, NULL);
+	} else {
+		result = rust_demangle_legacy(symbol);
+	}
+	return dem_negative_record(&key, dem_budget_end(result));
+}
+
+/**
+ * \brief Demangles a Rust v0 symbol and reports the position of its crates,
+ * path segments, disambiguators and generic arguments.
+ *
+ * \return the structured symbol, to be freed with libdemangle_rust_symbol_free(), or NULL.
+ */
+DEM_LIB_EXPORT RzDemangleRustSymbol *libdemangle_rust_v0_symbol(const char *symbol, RzDemangleOpts opts) {
+	if (!symbol) {
+		return NULL;
+	}
+	RzDemangleRustSymbol *structured = RZ_NEW0(RzDemangleRustSymbol);
+	if (!structured) {
+		return NULL;
+	}
+	dem_budget_begin();
+	structured->demangled = dem_budget_end(rust_demangle_v0(symbol, opts, structured));
+	if (!structured->demangled) {
+		libdemangle_rust_symbol_free(structured);
+		return NULL;
+	}
+	return structured;
+}
+
+DEM_LIB_EXPORT void libdemangle_rust_symbol_free(RzDemangleRustSymbol *symbol) {
+	if (!symbol) {
+		return;
+	}
+	dem_free(symbol->demangled);
+	dem_free(symbol->spans);
+	dem_free(symbol);
 }
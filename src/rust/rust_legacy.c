@@ -33,95 +33,84 @@ static uint32_t get_integer(const char **str, uint8_t base) {
 	return result;
 }
 
-static uint32_t utf_to_bytes(uint32_t utf) {
-	/* returns in big endian */
-	uint32_t result = 0;
+typedef struct {
+	char code[2];
+	char replacement;
+} RustEscape;
+
+static const RustEscape escapes[] = {
+	{ "SP", '@' },
+	{ "BP", '*' },
+	{ "RF", '&' },
+	{ "LT", '<' },
+	{ "GT", '>' },
+	{ "LP", '(' },
+	{ "RP", ')' },
+};
 
-	if (utf < 0x80) {
-		result = utf << 24;
-	} else if (utf < 0x800) {
-		result = (utf & 0x3f) << 16;
-		result |= ((utf >> 6) & 0x1f) << 24;
-		result |= 0xc0800000;
-	} else if (utf < 0x10000) {
-		result = (utf & 0x3f) << 8;
-		result |= ((utf >> 6) & 0x3f) << 16;
-		result |= ((utf >> 12) & 0xf) << 24;
-		result |= 0xe0808000;
-	} else if (utf < 0x110000) {
-		result = utf & 0x3f;
-		result |= ((utf >> 6) & 0x3f) << 8;
-		result |= ((utf >> 12) & 0x3f) << 16;
-		result |= ((utf >> 18) & 0x7) << 24;
-		result |= 0xf0808080;
+/**
+ * Decodes the `$..$` escape starting at \p esc ('$') and ending before \p end,
+ * \return the amount of consumed chars, or 0 when it is not a valid escape.
+ */
+static size_t decode_escape(const char *esc, const char *end, DemString *out) {
+	const char *close = memchr(esc + 1, '$', end - esc - 1);
+	if (!close) {
+		return 0;
 	}
-
-	return result;
-}
-
-static DemString *replace_utf(const char *utf_str) {
-	DemString *demstr = dem_string_new();
-	const char *utf_char = strchr(utf_str, '$');
-	const char *last_ptr = utf_str;
-
-	while (utf_char) {
-		if (*(utf_char + 1) != 'u') {
-			utf_char++;
-			goto next_delim;
+	const char *code = esc + 1;
+	size_t code_len = close - code;
+	if (code_len == 1 && *code == 'C') {
+		dem_string_append_n(out, ",", 1);
+		return 3;
+	}
+	if (code_len == 2) {
+		for (size_t i = 0; i < RZ_ARRAY_SIZE(escapes); i++) {
+			if (code[0] == escapes[i].code[0] && code[1] == escapes[i].code[1]) {
+				dem_string_append_n(out, &escapes[i].replacement, 1);
+				return 4;
+			}
 		}
+	}
+	if (code_len < 2 || *code != 'u') {
+		return 0;
+	}
+	const char *hex = code + 1;
+	uint32_t cp = get_integer(&hex, 16);
+	if (hex != close || !cp || !dem_string_append_utf8(out, cp)) {
+		return 0;
+	}
+	return code_len + 2;
+}
 
-		dem_string_append_n(demstr, last_ptr, utf_char - last_ptr);
-		utf_char += 2;
-
-		uint32_t utf_int = get_integer((const char **)&utf_char, 16);
-		uint32_t utf_bytes = utf_to_bytes(utf_int);
-		if (utf_bytes) {
-			const char bytes_str[5] = { (utf_bytes >> 24) & 0xff, (utf_bytes >> 16) & 0xff,
-				(utf_bytes >> 8) & 0xff, utf_bytes & 0xff,
-				'\0' };
-			dem_string_append(demstr, bytes_str);
-			/* Consume closing $ */
-			utf_char += 1;
+/**
+ * Appends one path segment decoding `$..$` escapes and `..` on the fly.
+ */
+static void append_segment(const char *seg, size_t len, DemString *out) {
+	const char *end = seg + len;
+	const char *run = seg;
+	for (const char *p = seg; p < end;) {
+		size_t consumed;
+		if (*p == '$') {
+			dem_string_append_n(out, run, p - run);
+			consumed = decode_escape(p, end, out);
+			if (!consumed) {
+				dem_string_append_n(out, p, 1);
+				consumed = 1;
+			}
+		} else if (*p == '.' && p + 1 < end && p[1] == '.') {
+			dem_string_append_n(out, run, p - run);
+			dem_string_append_n(out, "::", 2);
+			consumed = 2;
 		} else {
-			/* Not a UTF character (unreachable, but just in case) */
-			dem_string_append(demstr, "$u");
+			p++;
+			continue;
 		}
-
-		last_ptr = utf_char;
-
-	next_delim:
-		utf_char = strchr(utf_char, '$');
+		p += consumed;
+		run = p;
 	}
-
-	dem_string_append(demstr, last_ptr);
-	return demstr;
+	dem_string_append_n(out, run, end - run);
 }
 
-static char *special_symbols[] = {
-	"$SP$",
-	"$BP$",
-	"$RF$",
-	"$LT$",
-	"$GT$",
-	"$LP$",
-	"$RP$",
-	"$C$",
-	/* namespace */
-	".."
-};
-
-static char *replacements[] = {
-	"@",
-	"*",
-	"&",
-	"<",
-	">",
-	"(",
-	")",
-	",",
-	"::"
-};
-
 /**
  * \brief We return NULL instead of strdup-ing the string, because that way we can check for NULL
  * and invoke the CXX demangler \p sym again in case it a CXX symbol
@@ -153,8 +142,14 @@ char *rust_demangle_legacy(const char *sym) {
 		}
 		itr++;
 	}
+	const char *end = itr;
 
-	DemString *result = dem_string_new();
+	/* escapes only shrink, while each "::" replaces at least one length digit */
+	size_t length = end - post;
+	DemString *result = dem_string_new_with_capacity(length + length / 2 + 2);
+	if (!result) {
+		return NULL;
+	}
 
 	while (*post != 'E') {
 		uint32_t len = get_integer(&post, 10);
@@ -162,33 +157,25 @@ char *rust_demangle_legacy(const char *sym) {
 		/* Check if no digits found
 		OR If end of string reached
 		OR Element ends after (or when) the string ends */
-		if (len == 0 || *post == '\0' || len >= strlen(post)) {
+		if (len == 0 || *post == '\0' || len >= (size_t)(end - post)) {
 			/* All these cases are malformed */
 			dem_string_free(result);
 			return NULL;
 		}
 
-		if (!strncmp(post, "_$", strlen("_$"))) {
+		if (post[0] == '_' && post[1] == '$') {
 			/* special symbols can have an extra underscore before it, if first in token */
 			post++;
 			len--;
 		}
-		dem_string_append_n(result, post, len);
+		append_segment(post, len, result);
 		post += len;
 
 		if (*post != 'E') {
-			dem_string_append(result, "::");
+			dem_string_append_n(result, "::", 2);
 		}
 	}
 
-	char *demangled = dem_string_drain(result);
-	for (uint8_t i = 0; i < sizeof(special_symbols) / sizeof(special_symbols[0]); i++) {
-		demangled = dem_str_replace(demangled, special_symbols[i], replacements[i], 1);
-	}
-
-	DemString *utf_free = replace_utf(demangled);
-	free(demangled);
-
 	/* ThinLTO LLVM IR period delimited suffixes */
 	const char *suff = post + 1;
 	uint8_t llvm_len = strlen(".llvm.");
@@ -209,7 +196,7 @@ char *rust_demangle_legacy(const char *sym) {
 	}
 	if (*post != 0x00) {
 		/* Invalid character found in suffix (post did not end yet) */
-		dem_string_free(utf_free);
+		dem_string_free(result);
 		return NULL;
 	}
 
@@ -218,6 +205,6 @@ char *rust_demangle_legacy(const char *sym) {
 		post = llvm_str;
 	}
 
-	dem_string_append_n(utf_free, suff, post - suff);
-	return dem_string_drain(utf_free);
+	dem_string_append_n(result, suff, post - suff);
+	return dem_string_drain(result);
 }
@@ -16,7 +16,7 @@
 #define RUST_MAX_RECURSION_LEVEL 512
 
 // import the modified punycode for rust.
-char *rust_punycode_to_utf8(const char *encoded, size_t length, size_t *decoded_len);
+bool rust_punycode_decode(const char *encoded, size_t length, DemString *out);
 
 #define rust_v0_set_error(d) \
 	do { \
@@ -70,6 +70,44 @@ typedef struct rust_substr_s {
 	bool is_puny;
 } rust_substr_t;
 
+/**
+ * Rendered output of a backref target, valid for the same production
+ * and the same amount of bound lifetimes.
+ */
+typedef struct rust_v0_backref_s {
+	size_t key; ///< offset of the target + 1, 0 for free slots
+	size_t bound_lifetimes;
+	size_t start; ///< offset of the rendered span within the output
+	size_t size;
+	size_t first_span; ///< structured spans emitted while rendering
+	size_t n_spans;
+	size_t generic_depth;
+	ut8 kind;
+	bool ret;
+} rust_v0_backref_t;
+
+typedef struct rust_v0_backrefs_s {
+	rust_v0_backref_t *entries;
+	size_t capacity; ///< always a power of two
+	size_t count;
+} rust_v0_backrefs_t;
+
+typedef struct rust_v0_spans_s {
+	RzDemangleRustSpan *data;
+	size_t length;
+	size_t capacity;
+} rust_v0_spans_t;
+
+#define RUST_V0_NO_SPAN SIZE_MAX
+
+enum {
+	RUST_V0_BACKREF_PATH = 0,
+	RUST_V0_BACKREF_TYPE,
+	RUST_V0_BACKREF_CONST,
+	RUST_V0_BACKREF_IS_TYPE = 1 << 2,
+	RUST_V0_BACKREF_NO_TRAIL = 1 << 3,
+};
+
 typedef struct rust_v0_s {
 	const char *trail;
 	const char *symbol;
@@ -79,13 +117,18 @@ typedef struct rust_v0_s {
 	size_t current;
 	bool error;
 	bool hide_disambiguator;
+	bool hide_generics;
+	size_t generic_depth;
 	DemString *demangled;
+	rust_v0_backrefs_t *backrefs; ///< shared with the copies made for backrefs
+	rust_v0_spans_t *spans; ///< NULL unless structured output is requested
 } rust_v0_t;
 
 static bool rust_v0_parse_path(rust_v0_t *v0, bool is_type, bool no_trail);
 static void rust_v0_parse_type(rust_v0_t *v0);
+static void rust_v0_parse_const(rust_v0_t *v0);
 
-static bool rust_v0_init(rust_v0_t *v0, const char *symbol, bool hide_disambiguator) {
+static bool rust_v0_init(rust_v0_t *v0, const char *symbol, RzDemangleOpts opts) {
 	if (!v0 || !symbol) {
 		return false;
 	}
@@ -96,13 +139,19 @@ static bool rust_v0_init(rust_v0_t *v0, const char *symbol, bool hide_disambigua
 	} else {
 		v0->symbol_size = strlen(symbol);
 	}
+	// https://doc.rust-lang.org/rustc/symbol-mangling/v0.html#path
+	if (!v0->symbol_size || !strchr("CMXYNIB", symbol[0])) {
+		return false;
+	}
 	v0->recursion_level = 0;
 	v0->bound_lifetimes = 0;
 	v0->current = 0;
 	v0->error = false;
 	v0->symbol = symbol;
-	v0->hide_disambiguator = hide_disambiguator;
-	v0->demangled = dem_string_new_with_capacity(1024);
+	v0->hide_disambiguator = opts & RZ_DEMANGLE_OPT_SIMPLIFY;
+	v0->hide_generics = opts & RZ_DEMANGLE_OPT_RUST_NO_GENERICS;
+	// the demangled form is usually about twice as long as the mangled one.
+	v0->demangled = dem_string_new_with_capacity(v0->symbol_size * 2 + 32);
 	return v0->demangled != NULL;
 }
 
@@ -148,6 +197,51 @@ static char rust_v0_consume_when(rust_v0_t *v0, char expected) {
 	return true;
 }
 
+static size_t rust_v0_output_len(rust_v0_t *v0) {
+	return v0->demangled ? v0->demangled->len : 0;
+}
+
+static bool rust_v0_spans_reserve(rust_v0_t *v0, size_t amount) {
+	rust_v0_spans_t *spans = v0->spans;
+	if (spans->length + amount <= spans->capacity) {
+		return true;
+	}
+	size_t capacity = RZ_MAX(spans->capacity * 2, spans->length + amount);
+	capacity = RZ_MAX(capacity, 16);
+	RzDemangleRustSpan *data = dem_realloc(spans->data, capacity * sizeof(RzDemangleRustSpan));
+	if (!data) {
+		rust_v0_set_error(v0);
+		return false;
+	}
+	spans->data = data;
+	spans->capacity = capacity;
+	return true;
+}
+
+/**
+ * Starts a structured span at the current end of the output,
+ * \return its index, to be passed to rust_v0_span_close().
+ */
+static size_t rust_v0_span_open(rust_v0_t *v0, RzDemangleRustSpanKind kind) {
+	if (!v0->spans || !v0->demangled || rust_v0_errored(v0) || !rust_v0_spans_reserve(v0, 1)) {
+		return RUST_V0_NO_SPAN;
+	}
+	RzDemangleRustSpan *span = &v0->spans->data[v0->spans->length];
+	span->kind = kind;
+	span->offset = v0->demangled->len;
+	span->length = 0;
+	span->depth = v0->generic_depth;
+	return v0->spans->length++;
+}
+
+static void rust_v0_span_close(rust_v0_t *v0, size_t index) {
+	if (index == RUST_V0_NO_SPAN) {
+		return;
+	}
+	RzDemangleRustSpan *span = &v0->spans->data[index];
+	span->length = v0->demangled->len - span->offset;
+}
+
 static bool rust_v0_parse_basic_type(rust_v0_t *v0, char tag) {
 	switch (tag) {
 	case 'b':
@@ -372,12 +466,9 @@ static void rust_v0_print_substr(rust_v0_t *v0, rust_substr_t *substr) {
 	}
 
 	// then we add the decoded chars
-	size_t utf8_len = 0;
-	char *utf8 = rust_punycode_to_utf8(substr->token, substr->size, &utf8_len);
-	if (!utf8 || !dem_string_append_n(v0->demangled, utf8, utf8_len)) {
+	if (!rust_punycode_decode(substr->token, substr->size, v0->demangled)) {
 		rust_v0_set_error(v0);
 	}
-	free(utf8);
 }
 
 static void rust_v0_demangleFnSig(rust_v0_t *v0) {
@@ -427,11 +518,39 @@ static void rust_v0_demangleFnSig(rust_v0_t *v0) {
 	v0->bound_lifetimes = bound_lifetimes;
 }
 
+/**
+ * \return the generic arguments of a trait path left open by `no_trail`.
+ */
+static size_t rust_v0_span_find_open(rust_v0_t *v0, size_t first) {
+	if (!v0->spans) {
+		return RUST_V0_NO_SPAN;
+	}
+	for (size_t i = v0->spans->length; i-- > first;) {
+		const RzDemangleRustSpan *span = &v0->spans->data[i];
+		if (span->kind == RZ_DEMANGLE_RUST_SPAN_GENERIC_ARGS && span->depth == v0->generic_depth) {
+			return i;
+		}
+	}
+	return RUST_V0_NO_SPAN;
+}
+
 static void rust_v0_parse_dynamic_trait(rust_v0_t *v0) {
+	size_t first_span = v0->spans ? v0->spans->length : 0;
 	bool open = rust_v0_parse_path(v0, true, true);
+	size_t generics = open ? rust_v0_span_find_open(v0, first_span) : RUST_V0_NO_SPAN;
+
+	// associated type bindings are generic arguments too.
+	DemString *output = v0->demangled;
+	if (v0->hide_generics) {
+		v0->demangled = NULL;
+	}
+	v0->generic_depth++;
 	while (!v0->error && rust_v0_consume_when(v0, 'p')) {
 		if (!open) {
 			open = true;
+			v0->generic_depth--;
+			generics = rust_v0_span_open(v0, RZ_DEMANGLE_RUST_SPAN_GENERIC_ARGS);
+			v0->generic_depth++;
 			rust_v0_putc(v0, '<');
 		} else {
 			rust_v0_print(v0, ", ");
@@ -439,15 +558,18 @@ static void rust_v0_parse_dynamic_trait(rust_v0_t *v0) {
 		rust_substr_t name = { 0 };
 		rust_v0_parse_identifier(v0, &name);
 		if (rust_v0_errored(v0)) {
-			return;
+			break;
 		}
 		rust_v0_print_substr(v0, &name);
 		rust_v0_print(v0, " = ");
 		rust_v0_parse_type(v0);
 	}
-	if (open) {
+	v0->generic_depth--;
+	if (open && !rust_v0_errored(v0)) {
 		rust_v0_putc(v0, '>');
 	}
+	v0->demangled = output;
+	rust_v0_span_close(v0, generics);
 }
 
 static void rust_v0_parse_dynamic_bounds(rust_v0_t *v0) {
@@ -593,7 +715,7 @@ static void rust_v0_parse_const_char(rust_v0_t *v0) {
 
 static void rust_v0_parse_backref(rust_v0_t *v0, rust_v0_t *copy) {
 	uint64_t backref = rust_v0_parse_base62(v0);
-	if (rust_v0_errored(v0) || backref >= v0->current) {
+	if (rust_v0_errored(v0) || backref >= v0->current || !dem_budget_node()) {
 		rust_v0_set_error(v0);
 		return;
 	}
@@ -602,8 +724,111 @@ static void rust_v0_parse_backref(rust_v0_t *v0, rust_v0_t *copy) {
 	copy->current = backref;
 }
 
+static rust_v0_backref_t *rust_v0_backref_slot(rust_v0_backrefs_t *backrefs, size_t key, ut8 kind, size_t bound_lifetimes) {
+	size_t mask = backrefs->capacity - 1;
+	size_t i = (key * 31 + kind) & mask;
+	while (backrefs->entries[i].key) {
+		rust_v0_backref_t *entry = &backrefs->entries[i];
+		if (entry->key == key && entry->kind == kind && entry->bound_lifetimes == bound_lifetimes) {
+			break;
+		}
+		i = (i + 1) & mask;
+	}
+	return &backrefs->entries[i];
+}
+
+static void rust_v0_backref_insert(rust_v0_backrefs_t *backrefs, const rust_v0_backref_t *entry) {
+	if ((backrefs->count + 1) * 2 > backrefs->capacity) {
+		rust_v0_backrefs_t grown = { 0 };
+		grown.capacity = backrefs->capacity ? backrefs->capacity * 2 : 16;
+		grown.entries = dem_calloc(grown.capacity, sizeof(rust_v0_backref_t));
+		if (!grown.entries) {
+			return;
+		}
+		for (size_t i = 0; i < backrefs->capacity; i++) {
+			rust_v0_backref_t *old = &backrefs->entries[i];
+			if (old->key) {
+				*rust_v0_backref_slot(&grown, old->key, old->kind, old->bound_lifetimes) = *old;
+			}
+		}
+		grown.count = backrefs->count;
+		dem_free(backrefs->entries);
+		*backrefs = grown;
+	}
+	rust_v0_backref_t *slot = rust_v0_backref_slot(backrefs, entry->key, entry->kind, entry->bound_lifetimes);
+	if (!slot->key) {
+		backrefs->count++;
+	}
+	*slot = *entry;
+}
+
+/**
+ * Copies the spans emitted by a cached expansion, moved to \p start.
+ * The generic arguments left open by a `no_trail` path are clamped to the
+ * cached output, since the caller extends them after the expansion.
+ */
+static void rust_v0_replay_spans(rust_v0_t *v0, const rust_v0_backref_t *cached, size_t start) {
+	rust_v0_spans_t *spans = v0->spans;
+	size_t end = cached->start + cached->size;
+	for (size_t i = 0; i < cached->n_spans; i++) {
+		RzDemangleRustSpan span = spans->data[cached->first_span + i];
+		span.length = RZ_MIN(span.length, end - span.offset);
+		span.offset = span.offset - cached->start + start;
+		span.depth = span.depth - cached->generic_depth + v0->generic_depth;
+		spans->data[spans->length++] = span;
+	}
+}
+
+/**
+ * Parses the target of a backref, reusing the output already rendered for
+ * the same target instead of walking it again.
+ */
+static bool rust_v0_expand_backref(rust_v0_t *v0, rust_v0_t *backref, ut8 kind) {
+	rust_v0_backrefs_t *backrefs = v0->demangled ? v0->backrefs : NULL;
+	rust_v0_backref_t entry = {
+		.key = backref->current + 1,
+		.bound_lifetimes = backref->bound_lifetimes,
+		.kind = kind,
+	};
+	if (backrefs && backrefs->count) {
+		const rust_v0_backref_t *cached = rust_v0_backref_slot(backrefs, entry.key, kind, entry.bound_lifetimes);
+		if (cached->key) {
+			size_t start = v0->demangled->len;
+			if (!dem_string_append_n(v0->demangled, v0->demangled->buf + cached->start, cached->size)) {
+				rust_v0_set_error(v0);
+			} else if (v0->spans && cached->n_spans && rust_v0_spans_reserve(v0, cached->n_spans)) {
+				rust_v0_replay_spans(v0, cached, start);
+			}
+			return cached->ret;
+		}
+	}
+
+	entry.start = rust_v0_output_len(v0);
+	entry.first_span = v0->spans ? v0->spans->length : 0;
+	entry.generic_depth = v0->generic_depth;
+	switch (kind & 3) {
+	case RUST_V0_BACKREF_TYPE:
+		rust_v0_parse_type(backref);
+		break;
+	case RUST_V0_BACKREF_CONST:
+		rust_v0_parse_const(backref);
+		break;
+	default:
+		entry.ret = rust_v0_parse_path(backref, kind & RUST_V0_BACKREF_IS_TYPE, kind & RUST_V0_BACKREF_NO_TRAIL);
+		break;
+	}
+
+	// partial output of a failed expansion depends on the recursion level.
+	if (backrefs && !rust_v0_errored(backref)) {
+		entry.size = v0->demangled->len - entry.start;
+		entry.n_spans = v0->spans ? v0->spans->length - entry.first_span : 0;
+		rust_v0_backref_insert(backrefs, &entry);
+	}
+	return entry.ret;
+}
+
 static void rust_v0_parse_const(rust_v0_t *v0) {
-	if (rust_v0_errored(v0) || v0->recursion_level >= RUST_MAX_RECURSION_LEVEL) {
+	if (rust_v0_errored(v0) || v0->recursion_level >= RUST_MAX_RECURSION_LEVEL || !dem_budget_step()) {
 		rust_v0_set_error(v0);
 		return;
 	}
@@ -642,7 +867,7 @@ static void rust_v0_parse_const(rust_v0_t *v0) {
 			return;
 		}
 		// use the backref
-		rust_v0_parse_const(&backref);
+		rust_v0_expand_backref(v0, &backref, RUST_V0_BACKREF_CONST);
 		break;
 	}
 	default:
@@ -653,7 +878,7 @@ static void rust_v0_parse_const(rust_v0_t *v0) {
 }
 
 static void rust_v0_parse_type(rust_v0_t *v0) {
-	if (rust_v0_errored(v0) || v0->recursion_level >= RUST_MAX_RECURSION_LEVEL) {
+	if (rust_v0_errored(v0) || v0->recursion_level >= RUST_MAX_RECURSION_LEVEL || !dem_budget_step()) {
 		rust_v0_set_error(v0);
 		return;
 	}
@@ -743,7 +968,7 @@ static void rust_v0_parse_type(rust_v0_t *v0) {
 			return;
 		}
 		// use backref
-		rust_v0_parse_type(&backref);
+		rust_v0_expand_backref(v0, &backref, RUST_V0_BACKREF_TYPE);
 		break;
 	}
 	default:
@@ -775,7 +1000,7 @@ static void rust_v0_parse_path_no_print(rust_v0_t *v0, bool is_type) {
 }
 
 static bool rust_v0_parse_path(rust_v0_t *v0, bool is_type, bool no_trail) {
-	if (rust_v0_errored(v0) || v0->recursion_level >= RUST_MAX_RECURSION_LEVEL) {
+	if (rust_v0_errored(v0) || v0->recursion_level >= RUST_MAX_RECURSION_LEVEL || !dem_budget_step()) {
 		rust_v0_set_error(v0);
 		return false;
 	}
@@ -792,10 +1017,14 @@ static bool rust_v0_parse_path(rust_v0_t *v0, bool is_type, bool no_trail) {
 		if (rust_v0_errored(v0)) {
 			goto end;
 		}
+		size_t span = rust_v0_span_open(v0, RZ_DEMANGLE_RUST_SPAN_CRATE);
 		rust_v0_print_substr(v0, &crate);
+		rust_v0_span_close(v0, span);
 		if (!v0->hide_disambiguator && disambiguator) {
 			// https://doc.rust-lang.org/rustc/symbol-mangling/v0.html#path-crate-root
+			span = rust_v0_span_open(v0, RZ_DEMANGLE_RUST_SPAN_DISAMBIGUATOR);
 			rust_v0_printf(v0, "[%" PRIx64 "]", disambiguator);
+			rust_v0_span_close(v0, span);
 		}
 		break;
 	}
@@ -840,7 +1069,9 @@ static bool rust_v0_parse_path(rust_v0_t *v0, bool is_type, bool no_trail) {
 
 		if (IS_UPPER(namespace)) {
 			// special namespaces
-			rust_v0_print(v0, "::{");
+			rust_v0_print(v0, "::");
+			size_t span = rust_v0_span_open(v0, RZ_DEMANGLE_RUST_SPAN_SEGMENT);
+			rust_v0_putc(v0, '{');
 			if (namespace == 'C') {
 				rust_v0_print(v0, "closure");
 			} else if (namespace == 'S') {
@@ -853,30 +1084,46 @@ static bool rust_v0_parse_path(rust_v0_t *v0, bool is_type, bool no_trail) {
 				rust_v0_print_substr(v0, &ident);
 			}
 			rust_v0_printf(v0, "#%" PRIu64 "}", disambiguator);
+			rust_v0_span_close(v0, span);
 		} else if (!rust_substr_is_empty(&ident)) {
 			// internal namespaces.
 			rust_v0_print(v0, "::");
+			size_t span = rust_v0_span_open(v0, RZ_DEMANGLE_RUST_SPAN_SEGMENT);
 			rust_v0_print_substr(v0, &ident);
+			rust_v0_span_close(v0, span);
 		}
 		break;
 	}
 	case 'I': { // ...<T, U> (generic args)
 		rust_v0_parse_path(v0, is_type, false);
-		if (!is_type) {
+		DemString *output = v0->demangled;
+		if (v0->hide_generics) {
+			v0->demangled = NULL;
+		} else if (!is_type) {
 			rust_v0_print(v0, "::");
 		}
+		size_t span = rust_v0_span_open(v0, RZ_DEMANGLE_RUST_SPAN_GENERIC_ARGS);
 		rust_v0_putc(v0, '<');
+		v0->generic_depth++;
 		for (size_t idx = 0; !v0->error && !rust_v0_consume_when(v0, 'E'); ++idx) {
 			if (idx > 0) {
 				rust_v0_print(v0, ", ");
 			}
 			rust_v0_parse_generic_arg(v0);
 		}
+		v0->generic_depth--;
+		if (v0->hide_generics) {
+			v0->demangled = output;
+			break;
+		}
 		if (no_trail) {
+			// closed by rust_v0_parse_dynamic_trait()
+			rust_v0_span_close(v0, span);
 			ret = true;
 			goto end;
 		}
 		rust_v0_putc(v0, '>');
+		rust_v0_span_close(v0, span);
 		break;
 	}
 	case 'B': { // backref
@@ -886,7 +1133,10 @@ static bool rust_v0_parse_path(rust_v0_t *v0, bool is_type, bool no_trail) {
 			goto end;
 		}
 		// use the backref
-		ret = rust_v0_parse_path(&backref, is_type, no_trail);
+		ut8 kind = RUST_V0_BACKREF_PATH;
+		kind |= is_type ? RUST_V0_BACKREF_IS_TYPE : 0;
+		kind |= no_trail ? RUST_V0_BACKREF_NO_TRAIL : 0;
+		ret = rust_v0_expand_backref(v0, &backref, kind);
 		break;
 	}
 	default:
@@ -906,7 +1156,7 @@ end:
  *
  * \return     On success a valid pointer is returned, otherwise NULL.
  */
-char *rust_demangle_v0(const char *sym, bool simplify) {
+char *rust_demangle_v0(const char *sym, RzDemangleOpts opts, RzDemangleRustSymbol *structured) {
 	if (!sym || *sym != '_') {
 		return false;
 	}
@@ -918,11 +1168,23 @@ char *rust_demangle_v0(const char *sym, bool simplify) {
 
 	rust_v0_t v0 = { 0 };
 	// rust v0 symbols always starts with `_R`
-	if (sym[0] != 'R' || !rust_v0_init(&v0, sym + 1, simplify)) {
+	if (sym[0] != 'R' || !rust_v0_init(&v0, sym + 1, opts)) {
 		return NULL;
 	}
 
+	rust_v0_backrefs_t backrefs = { 0 };
+	rust_v0_spans_t spans = { 0 };
+	v0.backrefs = &backrefs;
+	v0.spans = structured ? &spans : NULL;
 	rust_v0_parse_path(&v0, false, false);
+	dem_free(backrefs.entries);
 
-	return rust_v0_fini(&v0);
+	char *demangled = rust_v0_fini(&v0);
+	if (structured && demangled) {
+		structured->spans = spans.data;
+		structured->n_spans = spans.length;
+	} else {
+		dem_free(spans.data);
+	}
+	return demangled;
 }
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2015-2019 pancake <pancake@nopcode.org>
+// SPDX-License-Identifier: MIT
+
+#include "swift.h"
+
+DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *symbol, RzDemangleOpts opts) {
+	DemNegativeKey key;
+	if (!symbol || dem_negative_lookup(&key, DEM_LANG_SWIFT, symbol, SIZE_MAX, opts)) {
+		return NULL;
+	}
+
+	// Swift 4.2+ symbols are `$s`, `_$s`, ... while older ones are `_T`, `__T` or `T`.
+	const char *p = symbol;
+	if (!strncmp(p, "imp.", 4)) {
+		p += 4;
+	}
+	if (!strncmp(p, "reloc.", 6)) {
+		p += 6;
+	}
+
+	char *result = NULL;
+	dem_budget_begin();
+	if (swift_v5_prefix_size(p)) {
+		result = swift_demangle_v5(p, opts);
+	} else {
+		result = swift_demangle_legacy(p);
+	}
+	return dem_negative_record(&key, dem_budget_end(result));
+}
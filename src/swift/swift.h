@@ -0,0 +1,14 @@
+// SPDX-FileCopyrightText: 2015-2019 pancake <pancake@nopcode.org>
+// SPDX-License-Identifier: MIT
+
+#ifndef SWIFT_H
+#define SWIFT_H
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+char *swift_demangle_legacy(const char *sym);
+size_t swift_v5_prefix_size(const char *sym);
+char *swift_demangle_v5(const char *sym, RzDemangleOpts opts);
+
+#endif // SWIFT_H
@@ -0,0 +1,2864 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file swift5.c
+ *
+ * Demangles the symbols of the Swift 4.2+ mangling (`$s`, `_$s`, `$S`, `$e`).
+ * https://github.com/swiftlang/swift/blob/main/docs/ABI/Mangling.rst
+ *
+ * The mangling is postfix: every operator pops its operands from a node
+ * stack and pushes the node it builds. Nodes are allocated from a per-call
+ * arena and are shared by reference through the substitution table, then
+ * the tree is rendered by the printer with the layout of swift-demangle.
+ */
+
+#include "swift.h"
+
+#define SWIFT5_MAX_WORDS       26
+#define SWIFT5_MAX_REPEAT      2048
+#define SWIFT5_MAX_DEPTH       512
+#define SWIFT5_MAX_OUTPUT      (1 << 18)
+#define SWIFT5_ARENA_MIN_BLOCK 4096
+
+#define SWIFT5_ALIGN(x)      (((x) + 7) & ~(size_t)7)
+#define SWIFT5_BLOCK_DATA(b) ((char *)(b) + SWIFT5_ALIGN(sizeof(SwiftArenaBlock)))
+
+typedef enum {
+	SWIFT_NODE_GLOBAL = 0,
+	SWIFT_NODE_SUFFIX,
+	SWIFT_NODE_NUMBER,
+	SWIFT_NODE_MODULE,
+	SWIFT_NODE_IDENTIFIER,
+	SWIFT_NODE_LOCAL_DECL_NAME,
+	SWIFT_NODE_PRIVATE_DECL_NAME,
+	SWIFT_NODE_INFIX_OPERATOR,
+	SWIFT_NODE_PREFIX_OPERATOR,
+	SWIFT_NODE_POSTFIX_OPERATOR,
+	/* nominal types and contexts */
+	SWIFT_NODE_CLASS,
+	SWIFT_NODE_STRUCTURE,
+	SWIFT_NODE_ENUM,
+	SWIFT_NODE_PROTOCOL,
+	SWIFT_NODE_TYPE_ALIAS,
+	SWIFT_NODE_EXTENSION,
+	/* types */
+	SWIFT_NODE_TYPE,
+	SWIFT_NODE_TYPE_LIST,
+	SWIFT_NODE_TUPLE,
+	SWIFT_NODE_TUPLE_ELEMENT,
+	SWIFT_NODE_TUPLE_ELEMENT_NAME,
+	SWIFT_NODE_VARIADIC_MARKER,
+	SWIFT_NODE_EMPTY_LIST,
+	SWIFT_NODE_FIRST_ELEMENT_MARKER,
+	SWIFT_NODE_LABEL_LIST,
+	SWIFT_NODE_FUNCTION_TYPE,
+	SWIFT_NODE_NOESCAPE_FUNCTION_TYPE,
+	SWIFT_NODE_THIN_FUNCTION_TYPE,
+	SWIFT_NODE_C_FUNCTION_POINTER,
+	SWIFT_NODE_OBJC_BLOCK,
+	SWIFT_NODE_AUTO_CLOSURE_TYPE,
+	SWIFT_NODE_ESCAPING_AUTO_CLOSURE_TYPE,
+	SWIFT_NODE_ARGUMENT_TUPLE,
+	SWIFT_NODE_RETURN_TYPE,
+	SWIFT_NODE_THROWS_ANNOTATION,
+	SWIFT_NODE_ASYNC_ANNOTATION,
+	SWIFT_NODE_CONCURRENT_FUNCTION_TYPE,
+	SWIFT_NODE_BOUND_GENERIC_CLASS,
+	SWIFT_NODE_BOUND_GENERIC_STRUCTURE,
+	SWIFT_NODE_BOUND_GENERIC_ENUM,
+	SWIFT_NODE_BOUND_GENERIC_PROTOCOL,
+	SWIFT_NODE_BOUND_GENERIC_TYPE_ALIAS,
+	SWIFT_NODE_DEPENDENT_GENERIC_TYPE,
+	SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE,
+	SWIFT_NODE_DEPENDENT_GENERIC_PARAM_COUNT,
+	SWIFT_NODE_DEPENDENT_GENERIC_PARAM_TYPE,
+	SWIFT_NODE_DEPENDENT_GENERIC_CONFORMANCE_REQUIREMENT,
+	SWIFT_NODE_DEPENDENT_GENERIC_SAME_TYPE_REQUIREMENT,
+	SWIFT_NODE_DEPENDENT_GENERIC_LAYOUT_REQUIREMENT,
+	SWIFT_NODE_DEPENDENT_MEMBER_TYPE,
+	SWIFT_NODE_DEPENDENT_ASSOCIATED_TYPE_REF,
+	SWIFT_NODE_BUILTIN_TYPE_NAME,
+	SWIFT_NODE_METATYPE,
+	SWIFT_NODE_EXISTENTIAL_METATYPE,
+	SWIFT_NODE_PROTOCOL_LIST,
+	SWIFT_NODE_PROTOCOL_LIST_WITH_CLASS,
+	SWIFT_NODE_PROTOCOL_LIST_WITH_ANY_OBJECT,
+	SWIFT_NODE_DYNAMIC_SELF,
+	SWIFT_NODE_IN_OUT,
+	SWIFT_NODE_SHARED,
+	SWIFT_NODE_OWNED,
+	SWIFT_NODE_WEAK,
+	SWIFT_NODE_UNOWNED,
+	SWIFT_NODE_UNMANAGED,
+	/* entities */
+	SWIFT_NODE_FUNCTION,
+	SWIFT_NODE_ALLOCATOR,
+	SWIFT_NODE_CONSTRUCTOR,
+	SWIFT_NODE_DESTRUCTOR,
+	SWIFT_NODE_DEALLOCATOR,
+	SWIFT_NODE_IVAR_INITIALIZER,
+	SWIFT_NODE_IVAR_DESTROYER,
+	SWIFT_NODE_INITIALIZER,
+	SWIFT_NODE_DEFAULT_ARGUMENT_INITIALIZER,
+	SWIFT_NODE_EXPLICIT_CLOSURE,
+	SWIFT_NODE_IMPLICIT_CLOSURE,
+	SWIFT_NODE_VARIABLE,
+	SWIFT_NODE_SUBSCRIPT,
+	SWIFT_NODE_STATIC,
+	SWIFT_NODE_GETTER,
+	SWIFT_NODE_SETTER,
+	SWIFT_NODE_GLOBAL_GETTER,
+	SWIFT_NODE_MODIFY_ACCESSOR,
+	SWIFT_NODE_READ_ACCESSOR,
+	SWIFT_NODE_INIT_ACCESSOR,
+	SWIFT_NODE_WILL_SET,
+	SWIFT_NODE_DID_SET,
+	SWIFT_NODE_MATERIALIZE_FOR_SET,
+	SWIFT_NODE_UNSAFE_ADDRESSOR,
+	SWIFT_NODE_UNSAFE_MUTABLE_ADDRESSOR,
+	/* metadata */
+	SWIFT_NODE_TYPE_MANGLING,
+	SWIFT_NODE_TYPE_METADATA,
+	SWIFT_NODE_TYPE_METADATA_ACCESS_FUNCTION,
+	SWIFT_NODE_FULL_TYPE_METADATA,
+	SWIFT_NODE_METACLASS,
+	SWIFT_NODE_NOMINAL_TYPE_DESCRIPTOR,
+	SWIFT_NODE_PROTOCOL_DESCRIPTOR,
+	SWIFT_NODE_TYPE_METADATA_LAZY_CACHE,
+	SWIFT_NODE_TYPE_METADATA_INSTANTIATION_CACHE,
+	SWIFT_NODE_TYPE_METADATA_INSTANTIATION_FUNCTION,
+	SWIFT_NODE_TYPE_METADATA_COMPLETION_FUNCTION,
+	SWIFT_NODE_TYPE_METADATA_SINGLETON_INITIALIZATION_CACHE,
+	SWIFT_NODE_TYPE_METADATA_DEMANGLING_CACHE,
+	SWIFT_NODE_CLASS_METADATA_BASE_OFFSET,
+	SWIFT_NODE_METHOD_LOOKUP_FUNCTION,
+	SWIFT_NODE_OBJC_METADATA_UPDATE_FUNCTION,
+	SWIFT_NODE_OBJC_RESILIENT_CLASS_STUB,
+	SWIFT_NODE_FULL_OBJC_RESILIENT_CLASS_STUB,
+	SWIFT_NODE_GENERIC_TYPE_METADATA_PATTERN,
+	SWIFT_NODE_PROPERTY_DESCRIPTOR,
+	SWIFT_NODE_REFLECTION_METADATA_FIELD_DESCRIPTOR,
+	SWIFT_NODE_REFLECTION_METADATA_BUILTIN_DESCRIPTOR,
+	SWIFT_NODE_PROTOCOL_CONFORMANCE_DESCRIPTOR,
+	SWIFT_NODE_PROTOCOL_SELF_CONFORMANCE_DESCRIPTOR,
+	SWIFT_NODE_MODULE_DESCRIPTOR,
+	SWIFT_NODE_EXTENSION_DESCRIPTOR,
+	SWIFT_NODE_ANONYMOUS_DESCRIPTOR,
+	/* witnesses */
+	SWIFT_NODE_PROTOCOL_CONFORMANCE,
+	SWIFT_NODE_VALUE_WITNESS_TABLE,
+	SWIFT_NODE_FIELD_OFFSET,
+	SWIFT_NODE_DIRECTNESS,
+	SWIFT_NODE_ENUM_CASE,
+	SWIFT_NODE_PROTOCOL_WITNESS_TABLE,
+	SWIFT_NODE_PROTOCOL_WITNESS_TABLE_PATTERN,
+	SWIFT_NODE_PROTOCOL_WITNESS_TABLE_ACCESSOR,
+	SWIFT_NODE_GENERIC_PROTOCOL_WITNESS_TABLE,
+	SWIFT_NODE_GENERIC_PROTOCOL_WITNESS_TABLE_INSTANTIATION_FUNCTION,
+	SWIFT_NODE_RESILIENT_PROTOCOL_WITNESS_TABLE,
+	SWIFT_NODE_LAZY_PROTOCOL_WITNESS_TABLE_ACCESSOR,
+	SWIFT_NODE_LAZY_PROTOCOL_WITNESS_TABLE_CACHE_VARIABLE,
+	SWIFT_NODE_ASSOCIATED_TYPE_METADATA_ACCESSOR,
+	/* thunks and function attributes */
+	SWIFT_NODE_CURRY_THUNK,
+	SWIFT_NODE_DISPATCH_THUNK,
+	SWIFT_NODE_METHOD_DESCRIPTOR,
+	SWIFT_NODE_PROTOCOL_REQUIREMENTS_BASE_DESCRIPTOR,
+	SWIFT_NODE_PROTOCOL_WITNESS,
+	SWIFT_NODE_VTABLE_THUNK,
+	SWIFT_NODE_OBJC_ATTRIBUTE,
+	SWIFT_NODE_NON_OBJC_ATTRIBUTE,
+	SWIFT_NODE_DYNAMIC_ATTRIBUTE,
+	SWIFT_NODE_DIRECT_METHOD_REFERENCE_ATTRIBUTE,
+	SWIFT_NODE_PARTIAL_APPLY_FORWARDER,
+	SWIFT_NODE_PARTIAL_APPLY_OBJC_FORWARDER,
+	SWIFT_NODE_MERGED_FUNCTION,
+	SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_VAR,
+	SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_KEY,
+	SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_IMPL,
+	SWIFT_NODE_GENERIC_SPECIALIZATION,
+	SWIFT_NODE_GENERIC_SPECIALIZATION_NOT_RE_ABSTRACTED,
+	SWIFT_NODE_GENERIC_SPECIALIZATION_PARAM,
+	SWIFT_NODE_SPECIALIZATION_PASS_ID,
+	SWIFT_NODE_IS_SERIALIZED,
+} SwiftNodeKind;
+
+typedef struct SwiftNode_t SwiftNode;
+
+/**
+ * Array of node references; the storage lives in the arena and is
+ * extended in place while it is the last allocation of the block.
+ */
+typedef struct {
+	SwiftNode **data;
+	ut32 length;
+	ut32 capacity;
+} SwiftNodes;
+
+struct SwiftNode_t {
+	SwiftNodeKind kind;
+	const char *text; ///< points into the symbol or into the arena
+	size_t size;
+	ut64 index;
+	SwiftNodes children;
+};
+
+typedef struct SwiftArenaBlock_t {
+	struct SwiftArenaBlock_t *next;
+	size_t size;
+	size_t used;
+} SwiftArenaBlock;
+
+typedef struct {
+	const char *text;
+	size_t size;
+} SwiftWord;
+
+typedef struct {
+	const char *beg;
+	const char *cur;
+	const char *end;
+	SwiftArenaBlock *arena;
+	SwiftNodes stack;
+	SwiftNodes substitutions;
+	SwiftWord words[SWIFT5_MAX_WORDS]; ///< words of the identifiers, see swift5_add_words()
+	ut32 n_words;
+	ut32 depth;
+	DemString scratch; ///< identifiers built from more than one piece
+	bool error;
+} SwiftDemangler;
+
+typedef struct {
+	DemString out;
+	ut32 depth;
+	bool simplify;
+	bool error;
+} SwiftPrinter;
+
+typedef enum {
+	SWIFT_TYPE_PR_NONE = 0,
+	SWIFT_TYPE_PR_WITH_COLON,
+	SWIFT_TYPE_PR_FUNCTION_STYLE,
+} SwiftTypePrinting;
+
+typedef struct {
+	SwiftNodeKind kind;
+	const char *name;
+} SwiftStandardType;
+
+/* `S<code>`, types of the Swift module that have a dedicated substitution, indexed by code */
+static const SwiftStandardType swift5_standard_types[128] = {
+	['A'] = { SWIFT_NODE_STRUCTURE, "AutoreleasingUnsafeMutablePointer" },
+	['a'] = { SWIFT_NODE_STRUCTURE, "Array" },
+	['b'] = { SWIFT_NODE_STRUCTURE, "Bool" },
+	['D'] = { SWIFT_NODE_STRUCTURE, "Dictionary" },
+	['d'] = { SWIFT_NODE_STRUCTURE, "Double" },
+	['f'] = { SWIFT_NODE_STRUCTURE, "Float" },
+	['h'] = { SWIFT_NODE_STRUCTURE, "Set" },
+	['I'] = { SWIFT_NODE_STRUCTURE, "DefaultIndices" },
+	['i'] = { SWIFT_NODE_STRUCTURE, "Int" },
+	['J'] = { SWIFT_NODE_STRUCTURE, "Character" },
+	['N'] = { SWIFT_NODE_STRUCTURE, "ClosedRange" },
+	['n'] = { SWIFT_NODE_STRUCTURE, "Range" },
+	['O'] = { SWIFT_NODE_STRUCTURE, "ObjectIdentifier" },
+	['P'] = { SWIFT_NODE_STRUCTURE, "UnsafePointer" },
+	['p'] = { SWIFT_NODE_STRUCTURE, "UnsafeMutablePointer" },
+	['R'] = { SWIFT_NODE_STRUCTURE, "UnsafeBufferPointer" },
+	['r'] = { SWIFT_NODE_STRUCTURE, "UnsafeMutableBufferPointer" },
+	['S'] = { SWIFT_NODE_STRUCTURE, "String" },
+	['s'] = { SWIFT_NODE_STRUCTURE, "Substring" },
+	['u'] = { SWIFT_NODE_STRUCTURE, "UInt" },
+	['V'] = { SWIFT_NODE_STRUCTURE, "UnsafeRawPointer" },
+	['v'] = { SWIFT_NODE_STRUCTURE, "UnsafeMutableRawPointer" },
+	['W'] = { SWIFT_NODE_STRUCTURE, "UnsafeRawBufferPointer" },
+	['w'] = { SWIFT_NODE_STRUCTURE, "UnsafeMutableRawBufferPointer" },
+	['q'] = { SWIFT_NODE_ENUM, "Optional" },
+	['B'] = { SWIFT_NODE_PROTOCOL, "BinaryFloatingPoint" },
+	['E'] = { SWIFT_NODE_PROTOCOL, "Encodable" },
+	['e'] = { SWIFT_NODE_PROTOCOL, "Decodable" },
+	['F'] = { SWIFT_NODE_PROTOCOL, "FloatingPoint" },
+	['G'] = { SWIFT_NODE_PROTOCOL, "RandomNumberGenerator" },
+	['H'] = { SWIFT_NODE_PROTOCOL, "Hashable" },
+	['j'] = { SWIFT_NODE_PROTOCOL, "Numeric" },
+	['K'] = { SWIFT_NODE_PROTOCOL, "BidirectionalCollection" },
+	['k'] = { SWIFT_NODE_PROTOCOL, "RandomAccessCollection" },
+	['L'] = { SWIFT_NODE_PROTOCOL, "Comparable" },
+	['l'] = { SWIFT_NODE_PROTOCOL, "Collection" },
+	['M'] = { SWIFT_NODE_PROTOCOL, "MutableCollection" },
+	['m'] = { SWIFT_NODE_PROTOCOL, "RangeReplaceableCollection" },
+	['Q'] = { SWIFT_NODE_PROTOCOL, "Equatable" },
+	['T'] = { SWIFT_NODE_PROTOCOL, "Sequence" },
+	['t'] = { SWIFT_NODE_PROTOCOL, "IteratorProtocol" },
+	['U'] = { SWIFT_NODE_PROTOCOL, "UnsignedInteger" },
+	['X'] = { SWIFT_NODE_PROTOCOL, "RangeExpression" },
+	['x'] = { SWIFT_NODE_PROTOCOL, "Strideable" },
+	['Y'] = { SWIFT_NODE_PROTOCOL, "RawRepresentable" },
+	['y'] = { SWIFT_NODE_PROTOCOL, "StringProtocol" },
+	['Z'] = { SWIFT_NODE_PROTOCOL, "SignedInteger" },
+	['z'] = { SWIFT_NODE_PROTOCOL, "BinaryInteger" },
+};
+
+/* `Sc<code>`, types of the concurrency library */
+static const SwiftStandardType swift5_concurrency_types[128] = {
+	['A'] = { SWIFT_NODE_PROTOCOL, "Actor" },
+	['C'] = { SWIFT_NODE_STRUCTURE, "CheckedContinuation" },
+	['c'] = { SWIFT_NODE_STRUCTURE, "UnsafeContinuation" },
+	['E'] = { SWIFT_NODE_STRUCTURE, "CancellationError" },
+	['e'] = { SWIFT_NODE_STRUCTURE, "UnownedSerialExecutor" },
+	['F'] = { SWIFT_NODE_PROTOCOL, "Executor" },
+	['f'] = { SWIFT_NODE_PROTOCOL, "SerialExecutor" },
+	['G'] = { SWIFT_NODE_STRUCTURE, "TaskGroup" },
+	['g'] = { SWIFT_NODE_STRUCTURE, "ThrowingTaskGroup" },
+	['I'] = { SWIFT_NODE_PROTOCOL, "AsyncIteratorProtocol" },
+	['i'] = { SWIFT_NODE_PROTOCOL, "AsyncSequence" },
+	['J'] = { SWIFT_NODE_STRUCTURE, "UnownedJob" },
+	['M'] = { SWIFT_NODE_CLASS, "MainActor" },
+	['P'] = { SWIFT_NODE_STRUCTURE, "TaskPriority" },
+	['S'] = { SWIFT_NODE_STRUCTURE, "AsyncStream" },
+	['s'] = { SWIFT_NODE_STRUCTURE, "AsyncThrowingStream" },
+	['T'] = { SWIFT_NODE_STRUCTURE, "Task" },
+	['t'] = { SWIFT_NODE_STRUCTURE, "UnsafeCurrentTask" },
+};
+
+/* ----------------------------------------------------------------------------
+ * Arena
+ * --------------------------------------------------------------------------*/
+
+static void *swift5_alloc(SwiftDemangler *d, size_t size) {
+	size = SWIFT5_ALIGN(size);
+	SwiftArenaBlock *block = d->arena;
+	if (!block || block->size - block->used < size) {
+		size_t block_size = block ? block->size * 2 : SWIFT5_ALIGN((size_t)(d->end - d->beg) * 64);
+		block_size = RZ_MAX(block_size, SWIFT5_ARENA_MIN_BLOCK);
+		while (block_size < size) {
+			block_size *= 2;
+		}
+		SwiftArenaBlock *next = dem_malloc(SWIFT5_ALIGN(sizeof(SwiftArenaBlock)) + block_size);
+		if (!next) {
+			d->error = true;
+			return NULL;
+		}
+		next->next = block;
+		next->size = block_size;
+		next->used = 0;
+		d->arena = block = next;
+	}
+	void *ptr = SWIFT5_BLOCK_DATA(block) + block->used;
+	block->used += size;
+	return ptr;
+}
+
+static void swift5_arena_fini(SwiftDemangler *d) {
+	while (d->arena) {
+		SwiftArenaBlock *next = d->arena->next;
+		dem_free(d->arena);
+		d->arena = next;
+	}
+}
+
+static bool swift5_nodes_push(SwiftDemangler *d, SwiftNodes *nodes, SwiftNode *node) {
+	if (nodes->length == nodes->capacity) {
+		if (nodes->capacity >= UT32_MAX / 2) {
+			d->error = true;
+			return false;
+		}
+		ut32 capacity = nodes->capacity ? nodes->capacity * 2 : 4;
+		size_t old_size = SWIFT5_ALIGN(nodes->capacity * sizeof(SwiftNode *));
+		size_t new_size = SWIFT5_ALIGN(capacity * sizeof(SwiftNode *));
+		SwiftArenaBlock *block = d->arena;
+		if (nodes->data && (char *)nodes->data + old_size == SWIFT5_BLOCK_DATA(block) + block->used &&
+			block->size - block->used >= new_size - old_size) {
+			block->used += new_size - old_size;
+		} else {
+			SwiftNode **data = swift5_alloc(d, new_size);
+			if (!data) {
+				return false;
+			}
+			if (nodes->length) {
+				memcpy(data, nodes->data, nodes->length * sizeof(SwiftNode *));
+			}
+			nodes->data = data;
+		}
+		nodes->capacity = capacity;
+	}
+	nodes->data[nodes->length++] = node;
+	return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Nodes
+ * --------------------------------------------------------------------------*/
+
+static SwiftNode *swift5_node(SwiftDemangler *d, SwiftNodeKind kind) {
+	if (!dem_budget_node()) {
+		d->error = true;
+		return NULL;
+	}
+	SwiftNode *node = swift5_alloc(d, sizeof(SwiftNode));
+	if (!node) {
+		return NULL;
+	}
+	memset(node, 0, sizeof(SwiftNode));
+	node->kind = kind;
+	return node;
+}
+
+static SwiftNode *swift5_node_text(SwiftDemangler *d, SwiftNodeKind kind, const char *text, size_t size) {
+	SwiftNode *node = swift5_node(d, kind);
+	if (node) {
+		node->text = text;
+		node->size = size;
+	}
+	return node;
+}
+
+/* like swift5_node_text(), for text that does not outlive the caller */
+static SwiftNode *swift5_node_copy(SwiftDemangler *d, SwiftNodeKind kind, const char *text, size_t size) {
+	char *copy = swift5_alloc(d, size + 1);
+	if (!copy) {
+		return NULL;
+	}
+	memcpy(copy, text, size);
+	copy[size] = 0;
+	return swift5_node_text(d, kind, copy, size);
+}
+
+static SwiftNode *swift5_node_index(SwiftDemangler *d, SwiftNodeKind kind, ut64 index) {
+	SwiftNode *node = swift5_node(d, kind);
+	if (node) {
+		node->index = index;
+	}
+	return node;
+}
+
+/* returns the parent, or NULL when either node is missing */
+static SwiftNode *swift5_add(SwiftDemangler *d, SwiftNode *parent, SwiftNode *child) {
+	if (!parent || !child || !swift5_nodes_push(d, &parent->children, child)) {
+		return NULL;
+	}
+	return parent;
+}
+
+static SwiftNode *swift5_with_child(SwiftDemangler *d, SwiftNodeKind kind, SwiftNode *child) {
+	if (!child) {
+		return NULL;
+	}
+	return swift5_add(d, swift5_node(d, kind), child);
+}
+
+static SwiftNode *swift5_with_children(SwiftDemangler *d, SwiftNodeKind kind, SwiftNode *first, SwiftNode *second) {
+	if (!first || !second) {
+		return NULL;
+	}
+	return swift5_add(d, swift5_with_child(d, kind, first), second);
+}
+
+static SwiftNode *swift5_type(SwiftDemangler *d, SwiftNode *child) {
+	return swift5_with_child(d, SWIFT_NODE_TYPE, child);
+}
+
+static SwiftNode *swift5_child(const SwiftNode *node, ut32 idx) {
+	return node && idx < node->children.length ? node->children.data[idx] : NULL;
+}
+
+static SwiftNode *swift5_child_of_kind(const SwiftNode *node, SwiftNodeKind kind) {
+	for (ut32 i = 0; node && i < node->children.length; i++) {
+		if (node->children.data[i]->kind == kind) {
+			return node->children.data[i];
+		}
+	}
+	return NULL;
+}
+
+static void swift5_reverse_children(SwiftNode *node, ut32 from) {
+	if (!node || node->children.length < 2) {
+		return;
+	}
+	SwiftNode **data = node->children.data;
+	for (ut32 i = from, j = node->children.length - 1; i < j; i++, j--) {
+		SwiftNode *tmp = data[i];
+		data[i] = data[j];
+		data[j] = tmp;
+	}
+}
+
+static bool swift5_is_context(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_MODULE:
+	case SWIFT_NODE_CLASS:
+	case SWIFT_NODE_STRUCTURE:
+	case SWIFT_NODE_ENUM:
+	case SWIFT_NODE_PROTOCOL:
+	case SWIFT_NODE_TYPE_ALIAS:
+	case SWIFT_NODE_EXTENSION:
+	case SWIFT_NODE_FUNCTION:
+	case SWIFT_NODE_ALLOCATOR:
+	case SWIFT_NODE_CONSTRUCTOR:
+	case SWIFT_NODE_DESTRUCTOR:
+	case SWIFT_NODE_DEALLOCATOR:
+	case SWIFT_NODE_IVAR_INITIALIZER:
+	case SWIFT_NODE_IVAR_DESTROYER:
+	case SWIFT_NODE_INITIALIZER:
+	case SWIFT_NODE_DEFAULT_ARGUMENT_INITIALIZER:
+	case SWIFT_NODE_EXPLICIT_CLOSURE:
+	case SWIFT_NODE_IMPLICIT_CLOSURE:
+	case SWIFT_NODE_VARIABLE:
+	case SWIFT_NODE_SUBSCRIPT:
+	case SWIFT_NODE_STATIC:
+	case SWIFT_NODE_GETTER:
+	case SWIFT_NODE_SETTER:
+	case SWIFT_NODE_GLOBAL_GETTER:
+	case SWIFT_NODE_MODIFY_ACCESSOR:
+	case SWIFT_NODE_READ_ACCESSOR:
+	case SWIFT_NODE_INIT_ACCESSOR:
+	case SWIFT_NODE_WILL_SET:
+	case SWIFT_NODE_DID_SET:
+	case SWIFT_NODE_MATERIALIZE_FOR_SET:
+	case SWIFT_NODE_UNSAFE_ADDRESSOR:
+	case SWIFT_NODE_UNSAFE_MUTABLE_ADDRESSOR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool swift5_is_entity(SwiftNodeKind kind) {
+	return kind == SWIFT_NODE_TYPE || swift5_is_context(kind);
+}
+
+static bool swift5_is_decl_name(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_IDENTIFIER:
+	case SWIFT_NODE_LOCAL_DECL_NAME:
+	case SWIFT_NODE_PRIVATE_DECL_NAME:
+	case SWIFT_NODE_INFIX_OPERATOR:
+	case SWIFT_NODE_PREFIX_OPERATOR:
+	case SWIFT_NODE_POSTFIX_OPERATOR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool swift5_is_any_generic(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_CLASS:
+	case SWIFT_NODE_STRUCTURE:
+	case SWIFT_NODE_ENUM:
+	case SWIFT_NODE_PROTOCOL:
+	case SWIFT_NODE_TYPE_ALIAS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool swift5_is_requirement(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_DEPENDENT_GENERIC_CONFORMANCE_REQUIREMENT:
+	case SWIFT_NODE_DEPENDENT_GENERIC_SAME_TYPE_REQUIREMENT:
+	case SWIFT_NODE_DEPENDENT_GENERIC_LAYOUT_REQUIREMENT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool swift5_is_function_attr(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_OBJC_ATTRIBUTE:
+	case SWIFT_NODE_NON_OBJC_ATTRIBUTE:
+	case SWIFT_NODE_DYNAMIC_ATTRIBUTE:
+	case SWIFT_NODE_DIRECT_METHOD_REFERENCE_ATTRIBUTE:
+	case SWIFT_NODE_PARTIAL_APPLY_FORWARDER:
+	case SWIFT_NODE_PARTIAL_APPLY_OBJC_FORWARDER:
+	case SWIFT_NODE_MERGED_FUNCTION:
+	case SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_VAR:
+	case SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_KEY:
+	case SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_IMPL:
+	case SWIFT_NODE_GENERIC_SPECIALIZATION:
+	case SWIFT_NODE_GENERIC_SPECIALIZATION_NOT_RE_ABSTRACTED:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool swift5_is_function_type(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_FUNCTION_TYPE:
+	case SWIFT_NODE_NOESCAPE_FUNCTION_TYPE:
+	case SWIFT_NODE_THIN_FUNCTION_TYPE:
+	case SWIFT_NODE_C_FUNCTION_POINTER:
+	case SWIFT_NODE_OBJC_BLOCK:
+	case SWIFT_NODE_AUTO_CLOSURE_TYPE:
+	case SWIFT_NODE_ESCAPING_AUTO_CLOSURE_TYPE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool swift5_is_protocol(const SwiftNode *node) {
+	if (node && node->kind == SWIFT_NODE_TYPE) {
+		node = swift5_child(node, 0);
+	}
+	return node && node->kind == SWIFT_NODE_PROTOCOL;
+}
+
+/* ----------------------------------------------------------------------------
+ * Input and node stack
+ * --------------------------------------------------------------------------*/
+
+static inline char swift5_peek(const SwiftDemangler *d) {
+	return d->cur < d->end ? *d->cur : 0;
+}
+
+static inline char swift5_next(SwiftDemangler *d) {
+	return d->cur < d->end ? *d->cur++ : 0;
+}
+
+static inline bool swift5_next_if(SwiftDemangler *d, char c) {
+	if (d->cur < d->end && *d->cur == c) {
+		d->cur++;
+		return true;
+	}
+	return false;
+}
+
+static bool swift5_push(SwiftDemangler *d, SwiftNode *node) {
+	return swift5_nodes_push(d, &d->stack, node);
+}
+
+static SwiftNode *swift5_pop(SwiftDemangler *d) {
+	return d->stack.length ? d->stack.data[--d->stack.length] : NULL;
+}
+
+static SwiftNode *swift5_pop_kind(SwiftDemangler *d, SwiftNodeKind kind) {
+	if (!d->stack.length || d->stack.data[d->stack.length - 1]->kind != kind) {
+		return NULL;
+	}
+	return swift5_pop(d);
+}
+
+static SwiftNode *swift5_pop_if(SwiftDemangler *d, bool (*predicate)(SwiftNodeKind)) {
+	if (!d->stack.length || !predicate(d->stack.data[d->stack.length - 1]->kind)) {
+		return NULL;
+	}
+	return swift5_pop(d);
+}
+
+static void swift5_add_substitution(SwiftDemangler *d, SwiftNode *node) {
+	if (node) {
+		swift5_nodes_push(d, &d->substitutions, node);
+	}
+}
+
+/* decimal number, -1 when missing or too large */
+static st64 swift5_natural(SwiftDemangler *d) {
+	if (!IS_DIGIT(swift5_peek(d))) {
+		return -1;
+	}
+	st64 num = 0;
+	while (IS_DIGIT(swift5_peek(d))) {
+		num = num * 10 + (swift5_next(d) - '0');
+		if (num > INT32_MAX) {
+			return -1;
+		}
+	}
+	return num;
+}
+
+/* `_` is 0, `<n>_` is n + 1; -1 on error */
+static st64 swift5_index(SwiftDemangler *d) {
+	if (swift5_next_if(d, '_')) {
+		return 0;
+	}
+	st64 num = swift5_natural(d);
+	if (num >= 0 && swift5_next_if(d, '_')) {
+		return num + 1;
+	}
+	return -1;
+}
+
+static SwiftNode *swift5_index_node(SwiftDemangler *d) {
+	st64 idx = swift5_index(d);
+	return idx < 0 ? NULL : swift5_node_index(d, SWIFT_NODE_NUMBER, idx);
+}
+
+/* ----------------------------------------------------------------------------
+ * Identifiers and substitutions
+ * --------------------------------------------------------------------------*/
+
+static inline bool swift5_is_word_start(char c) {
+	return c && c != '_' && !IS_DIGIT(c);
+}
+
+static inline bool swift5_is_word_end(char c, char prev) {
+	return !c || c == '_' || (!IS_UPPER(prev) && IS_UPPER(c));
+}
+
+/**
+ * Records the words of an identifier, which later identifiers can reference
+ * by index. A word starts with a non-digit and ends before `_` or before an
+ * uppercase letter that follows a non-uppercase one.
+ */
+static void swift5_add_words(SwiftDemangler *d, const char *text, size_t size) {
+	size_t start = SIZE_MAX;
+	for (size_t i = 0; i <= size && d->n_words < SWIFT5_MAX_WORDS; i++) {
+		char c = i < size ? text[i] : 0;
+		if (start != SIZE_MAX && swift5_is_word_end(c, text[i - 1])) {
+			if (i - start >= 2) {
+				d->words[d->n_words].text = text + start;
+				d->words[d->n_words].size = i - start;
+				d->n_words++;
+			}
+			start = SIZE_MAX;
+		}
+		if (start == SIZE_MAX && swift5_is_word_start(c)) {
+			start = i;
+		}
+	}
+}
+
+typedef struct {
+	const char *text; ///< the first piece, used as is when it is the only one
+	size_t size;
+	ut32 pieces;
+} SwiftIdentifier;
+
+static bool swift5_identifier_append(SwiftDemangler *d, SwiftIdentifier *id, const char *text, size_t size) {
+	if (!id->pieces++) {
+		id->text = text;
+		id->size = size;
+		return true;
+	}
+	if (id->pieces == 2) {
+		d->scratch.len = 0;
+		if (!dem_string_append_n(&d->scratch, id->text, id->size)) {
+			return false;
+		}
+	}
+	return dem_string_append_n(&d->scratch, text, size);
+}
+
+/**
+ * `<len><chars>`, or `0` followed by word references (lowercase, the last
+ * one uppercase) mixed with `<len><chars>` pieces and terminated by `0`
+ * when it ends with a word. `00` starts a punycode identifier.
+ */
+static SwiftNode *swift5_identifier(SwiftDemangler *d) {
+	SwiftIdentifier id = { 0 };
+	bool words = false;
+	if (!IS_DIGIT(swift5_peek(d))) {
+		return NULL;
+	}
+	if (swift5_next_if(d, '0')) {
+		if (swift5_peek(d) == '0') {
+			// punycode is not supported
+			return NULL;
+		}
+		words = true;
+	}
+	do {
+		while (words && IS_ALPHA(swift5_peek(d))) {
+			char c = swift5_next(d);
+			ut32 word = IS_LOWER(c) ? c - 'a' : c - 'A';
+			words = IS_LOWER(c);
+			if (word >= d->n_words || !swift5_identifier_append(d, &id, d->words[word].text, d->words[word].size)) {
+				return NULL;
+			}
+		}
+		if (swift5_next_if(d, '0')) {
+			break;
+		}
+		st64 size = swift5_natural(d);
+		if (size <= 0 || size > d->end - d->cur) {
+			return NULL;
+		}
+		if (!swift5_identifier_append(d, &id, d->cur, size)) {
+			return NULL;
+		}
+		swift5_add_words(d, d->cur, size);
+		d->cur += size;
+	} while (words);
+
+	SwiftNode *ident = NULL;
+	if (id.pieces == 1) {
+		ident = swift5_node_text(d, SWIFT_NODE_IDENTIFIER, id.text, id.size);
+	} else if (id.pieces > 1) {
+		ident = swift5_node_copy(d, SWIFT_NODE_IDENTIFIER, d->scratch.buf, d->scratch.len);
+	}
+	swift5_add_substitution(d, ident);
+	return ident;
+}
+
+static SwiftNode *swift5_push_substitution(SwiftDemangler *d, st64 repeat, ut32 idx) {
+	if (idx >= d->substitutions.length || repeat > SWIFT5_MAX_REPEAT) {
+		return NULL;
+	}
+	SwiftNode *node = d->substitutions.data[idx];
+	while (repeat-- > 1) {
+		if (!swift5_push(d, node)) {
+			return NULL;
+		}
+	}
+	return node;
+}
+
+/**
+ * `A` followed by `[<count>]<a-z>` substitutions, each pushed on the stack
+ * `<count>` times, up to the final `[<count>]<A-Z>` one. `A<n>_` references
+ * the substitutions after the 26th.
+ */
+static SwiftNode *swift5_multi_substitutions(SwiftDemangler *d) {
+	st64 repeat = -1;
+	for (;;) {
+		char c = swift5_next(d);
+		if (IS_LOWER(c)) {
+			SwiftNode *node = swift5_push_substitution(d, repeat, c - 'a');
+			if (!node || !swift5_push(d, node)) {
+				return NULL;
+			}
+			repeat = -1;
+		} else if (IS_UPPER(c)) {
+			return swift5_push_substitution(d, repeat, c - 'A');
+		} else if (c == '_') {
+			st64 idx = repeat + 27;
+			return idx < d->substitutions.length ? d->substitutions.data[idx] : NULL;
+		} else if (IS_DIGIT(c)) {
+			d->cur--;
+			repeat = swift5_natural(d);
+			if (repeat < 0) {
+				return NULL;
+			}
+		} else {
+			return NULL;
+		}
+	}
+}
+
+static SwiftNode *swift5_swift_type(SwiftDemangler *d, SwiftNodeKind kind, const char *name) {
+	SwiftNode *module = swift5_node_text(d, SWIFT_NODE_MODULE, "Swift", 5);
+	SwiftNode *ident = swift5_node_text(d, SWIFT_NODE_IDENTIFIER, name, strlen(name));
+	return swift5_type(d, swift5_with_children(d, kind, module, ident));
+}
+
+static const SwiftStandardType *swift5_standard_type(char code, bool concurrency) {
+	const SwiftStandardType *types = concurrency ? swift5_concurrency_types : swift5_standard_types;
+	if ((ut8)code >= 128 || !types[(ut8)code].name) {
+		return NULL;
+	}
+	return &types[(ut8)code];
+}
+
+static SwiftNode *swift5_standard_substitution(SwiftDemangler *d) {
+	switch (swift5_peek(d)) {
+	case 'o':
+		d->cur++;
+		return swift5_node_text(d, SWIFT_NODE_MODULE, "__C", 3);
+	case 'C':
+		d->cur++;
+		return swift5_node_text(d, SWIFT_NODE_MODULE, "__C_Synthesized", 15);
+	case 'g': {
+		d->cur++;
+		SwiftNode *optional = swift5_swift_type(d, SWIFT_NODE_ENUM, "Optional");
+		SwiftNode *args = swift5_with_child(d, SWIFT_NODE_TYPE_LIST, swift5_pop_kind(d, SWIFT_NODE_TYPE));
+		SwiftNode *type = swift5_type(d, swift5_with_children(d, SWIFT_NODE_BOUND_GENERIC_ENUM, optional, args));
+		swift5_add_substitution(d, type);
+		return type;
+	}
+	default:
+		break;
+	}
+	st64 repeat = swift5_natural(d);
+	if (repeat > SWIFT5_MAX_REPEAT) {
+		return NULL;
+	}
+	bool concurrency = swift5_next_if(d, 'c');
+	const SwiftStandardType *std = swift5_standard_type(swift5_next(d), concurrency);
+	if (!std) {
+		return NULL;
+	}
+	SwiftNode *node = swift5_swift_type(d, std->kind, std->name);
+	while (node && repeat-- > 1) {
+		if (!swift5_push(d, node)) {
+			return NULL;
+		}
+	}
+	return node;
+}
+
+/* ----------------------------------------------------------------------------
+ * Contexts, types and entities
+ * --------------------------------------------------------------------------*/
+
+static SwiftNode *swift5_pop_module(SwiftDemangler *d) {
+	SwiftNode *ident = swift5_pop_kind(d, SWIFT_NODE_IDENTIFIER);
+	if (ident) {
+		return swift5_node_text(d, SWIFT_NODE_MODULE, ident->text, ident->size);
+	}
+	return swift5_pop_kind(d, SWIFT_NODE_MODULE);
+}
+
+static SwiftNode *swift5_pop_context(SwiftDemangler *d) {
+	SwiftNode *module = swift5_pop_module(d);
+	if (module) {
+		return module;
+	}
+	SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	if (type) {
+		SwiftNode *child = swift5_child(type, 0);
+		return type->children.length == 1 && swift5_is_context(child->kind) ? child : NULL;
+	}
+	return swift5_pop_if(d, swift5_is_context);
+}
+
+static SwiftNode *swift5_pop_type_any_generic(SwiftDemangler *d) {
+	SwiftNode *child = swift5_child(swift5_pop_kind(d, SWIFT_NODE_TYPE), 0);
+	return child && swift5_is_any_generic(child->kind) ? child : NULL;
+}
+
+static SwiftNode *swift5_pop_type_child(SwiftDemangler *d) {
+	return swift5_child(swift5_pop_kind(d, SWIFT_NODE_TYPE), 0);
+}
+
+static SwiftNode *swift5_pop_protocol(SwiftDemangler *d) {
+	SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	if (type) {
+		return swift5_is_protocol(type) ? type : NULL;
+	}
+	SwiftNode *name = swift5_pop_if(d, swift5_is_decl_name);
+	SwiftNode *ctx = swift5_pop_context(d);
+	return swift5_type(d, swift5_with_children(d, SWIFT_NODE_PROTOCOL, ctx, name));
+}
+
+static SwiftNode *swift5_pop_protocol_conformance(SwiftDemangler *d) {
+	SwiftNode *sig = swift5_pop_kind(d, SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE);
+	SwiftNode *module = swift5_pop_module(d);
+	SwiftNode *proto = swift5_pop_protocol(d);
+	SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	if (sig) {
+		type = swift5_type(d, swift5_with_children(d, SWIFT_NODE_DEPENDENT_GENERIC_TYPE, sig, type));
+	}
+	SwiftNode *conformance = swift5_with_children(d, SWIFT_NODE_PROTOCOL_CONFORMANCE, type, proto);
+	return swift5_add(d, conformance, module);
+}
+
+static SwiftNode *swift5_any_generic_type(SwiftDemangler *d, SwiftNodeKind kind) {
+	SwiftNode *name = swift5_pop_if(d, swift5_is_decl_name);
+	SwiftNode *ctx = swift5_pop_context(d);
+	SwiftNode *type = swift5_type(d, swift5_with_children(d, kind, ctx, name));
+	swift5_add_substitution(d, type);
+	return type;
+}
+
+/* the members of some contexts, like variables and closures, are generic through their parent */
+static bool swift5_consumes_generic_args(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_VARIABLE:
+	case SWIFT_NODE_SUBSCRIPT:
+	case SWIFT_NODE_IMPLICIT_CLOSURE:
+	case SWIFT_NODE_EXPLICIT_CLOSURE:
+	case SWIFT_NODE_DEFAULT_ARGUMENT_INITIALIZER:
+	case SWIFT_NODE_INITIALIZER:
+		return false;
+	default:
+		return true;
+	}
+}
+
+/**
+ * Applies the generic argument lists to \p nominal and to its generic
+ * parents, the innermost list belongs to \p nominal.
+ */
+static SwiftNode *swift5_bound_generic_args(SwiftDemangler *d, SwiftNode *nominal, const SwiftNodes *lists, ut32 idx) {
+	if (!nominal || idx >= lists->length || !nominal->children.length || d->depth >= SWIFT5_MAX_DEPTH) {
+		return NULL;
+	}
+	SwiftNode *ctx = nominal->children.data[0];
+	bool consumes = swift5_consumes_generic_args(nominal->kind);
+	SwiftNode *args = lists->data[idx];
+	if (consumes) {
+		idx++;
+	}
+	if (idx < lists->length) {
+		SwiftNode *parent = NULL;
+		d->depth++;
+		if (ctx->kind == SWIFT_NODE_EXTENSION) {
+			parent = swift5_bound_generic_args(d, swift5_child(ctx, 1), lists, idx);
+			parent = swift5_with_children(d, SWIFT_NODE_EXTENSION, swift5_child(ctx, 0), parent);
+			if (ctx->children.length == 3) {
+				parent = swift5_add(d, parent, ctx->children.data[2]);
+			}
+		} else {
+			parent = swift5_bound_generic_args(d, ctx, lists, idx);
+		}
+		d->depth--;
+		SwiftNode *rebuilt = swift5_with_child(d, nominal->kind, parent);
+		for (ut32 i = 1; i < nominal->children.length; i++) {
+			rebuilt = swift5_add(d, rebuilt, nominal->children.data[i]);
+		}
+		if (!rebuilt) {
+			return NULL;
+		}
+		nominal = rebuilt;
+	}
+	if (!consumes || !args->children.length) {
+		return nominal;
+	}
+	SwiftNodeKind kind;
+	switch (nominal->kind) {
+	case SWIFT_NODE_CLASS:
+		kind = SWIFT_NODE_BOUND_GENERIC_CLASS;
+		break;
+	case SWIFT_NODE_STRUCTURE:
+		kind = SWIFT_NODE_BOUND_GENERIC_STRUCTURE;
+		break;
+	case SWIFT_NODE_ENUM:
+		kind = SWIFT_NODE_BOUND_GENERIC_ENUM;
+		break;
+	case SWIFT_NODE_PROTOCOL:
+		kind = SWIFT_NODE_BOUND_GENERIC_PROTOCOL;
+		break;
+	case SWIFT_NODE_TYPE_ALIAS:
+		kind = SWIFT_NODE_BOUND_GENERIC_TYPE_ALIAS;
+		break;
+	default:
+		return NULL;
+	}
+	return swift5_with_children(d, kind, swift5_type(d, nominal), args);
+}
+
+/* `<nominal> y <args> [_ <parent args>]* G` */
+static SwiftNode *swift5_bound_generic_type(SwiftDemangler *d) {
+	SwiftNodes lists = { 0 };
+	for (;;) {
+		SwiftNode *list = swift5_node(d, SWIFT_NODE_TYPE_LIST);
+		if (!list || !swift5_nodes_push(d, &lists, list)) {
+			return NULL;
+		}
+		SwiftNode *type;
+		while ((type = swift5_pop_kind(d, SWIFT_NODE_TYPE))) {
+			if (!swift5_add(d, list, type)) {
+				return NULL;
+			}
+		}
+		swift5_reverse_children(list, 0);
+		if (swift5_pop_kind(d, SWIFT_NODE_EMPTY_LIST)) {
+			break;
+		}
+		if (!swift5_pop_kind(d, SWIFT_NODE_FIRST_ELEMENT_MARKER)) {
+			return NULL;
+		}
+	}
+	SwiftNode *nominal = swift5_pop_type_any_generic(d);
+	SwiftNode *type = swift5_type(d, swift5_bound_generic_args(d, nominal, &lists, 0));
+	swift5_add_substitution(d, type);
+	return type;
+}
+
+/* `<type> [<label>] [d]` elements, `_` after the first one, then `t` */
+static SwiftNode *swift5_pop_tuple(SwiftDemangler *d) {
+	SwiftNode *root = swift5_node(d, SWIFT_NODE_TUPLE);
+	if (!root) {
+		return NULL;
+	}
+	if (!swift5_pop_kind(d, SWIFT_NODE_EMPTY_LIST)) {
+		bool first = false;
+		do {
+			first = swift5_pop_kind(d, SWIFT_NODE_FIRST_ELEMENT_MARKER) != NULL;
+			SwiftNode *element = swift5_node(d, SWIFT_NODE_TUPLE_ELEMENT);
+			SwiftNode *variadic = swift5_pop_kind(d, SWIFT_NODE_VARIADIC_MARKER);
+			if (variadic) {
+				element = swift5_add(d, element, variadic);
+			}
+			SwiftNode *label = swift5_pop_kind(d, SWIFT_NODE_IDENTIFIER);
+			if (label) {
+				element = swift5_add(d, element, swift5_node_text(d, SWIFT_NODE_TUPLE_ELEMENT_NAME, label->text, label->size));
+			}
+			element = swift5_add(d, element, swift5_pop_kind(d, SWIFT_NODE_TYPE));
+			if (!swift5_add(d, root, element)) {
+				return NULL;
+			}
+		} while (!first);
+		swift5_reverse_children(root, 0);
+	}
+	return swift5_type(d, root);
+}
+
+static SwiftNode *swift5_pop_type_list(SwiftDemangler *d) {
+	SwiftNode *root = swift5_node(d, SWIFT_NODE_TYPE_LIST);
+	if (!root) {
+		return NULL;
+	}
+	if (!swift5_pop_kind(d, SWIFT_NODE_EMPTY_LIST)) {
+		bool first = false;
+		do {
+			first = swift5_pop_kind(d, SWIFT_NODE_FIRST_ELEMENT_MARKER) != NULL;
+			if (!swift5_add(d, root, swift5_pop_kind(d, SWIFT_NODE_TYPE))) {
+				return NULL;
+			}
+		} while (!first);
+		swift5_reverse_children(root, 0);
+	}
+	return root;
+}
+
+static SwiftNode *swift5_pop_function_params(SwiftDemangler *d, SwiftNodeKind kind) {
+	SwiftNode *params = NULL;
+	if (swift5_pop_kind(d, SWIFT_NODE_EMPTY_LIST)) {
+		params = swift5_type(d, swift5_node(d, SWIFT_NODE_TUPLE));
+	} else {
+		params = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	}
+	return swift5_with_child(d, kind, params);
+}
+
+/* `<result> <params> [Ya] [Yb] [K] c`, the operands are popped in reverse */
+static SwiftNode *swift5_pop_function_type(SwiftDemangler *d, SwiftNodeKind kind) {
+	static const SwiftNodeKind annotations[] = {
+		SWIFT_NODE_THROWS_ANNOTATION,
+		SWIFT_NODE_CONCURRENT_FUNCTION_TYPE,
+		SWIFT_NODE_ASYNC_ANNOTATION,
+	};
+	SwiftNode *fn = swift5_node(d, kind);
+	for (size_t i = 0; fn && i < RZ_ARRAY_SIZE(annotations); i++) {
+		SwiftNode *annotation = swift5_pop_kind(d, annotations[i]);
+		if (annotation) {
+			fn = swift5_add(d, fn, annotation);
+		}
+	}
+	fn = swift5_add(d, fn, swift5_pop_function_params(d, SWIFT_NODE_ARGUMENT_TUPLE));
+	fn = swift5_add(d, fn, swift5_pop_function_params(d, SWIFT_NODE_RETURN_TYPE));
+	return swift5_type(d, fn);
+}
+
+/**
+ * Argument labels of a function entity: `y` when none of the parameters
+ * has one, otherwise one identifier or `_` per parameter.
+ */
+static SwiftNode *swift5_pop_function_param_labels(SwiftDemangler *d, SwiftNode *type) {
+	if (swift5_pop_kind(d, SWIFT_NODE_EMPTY_LIST)) {
+		return swift5_node(d, SWIFT_NODE_LABEL_LIST);
+	}
+	if (!type || type->kind != SWIFT_NODE_TYPE) {
+		return NULL;
+	}
+	SwiftNode *fn = swift5_child(type, 0);
+	if (fn && fn->kind == SWIFT_NODE_DEPENDENT_GENERIC_TYPE) {
+		fn = swift5_child(swift5_child(fn, 1), 0);
+	}
+	if (!fn || (fn->kind != SWIFT_NODE_FUNCTION_TYPE && fn->kind != SWIFT_NODE_NOESCAPE_FUNCTION_TYPE)) {
+		return NULL;
+	}
+	SwiftNode *params = swift5_child(swift5_child(swift5_child_of_kind(fn, SWIFT_NODE_ARGUMENT_TUPLE), 0), 0);
+	if (!params) {
+		return NULL;
+	}
+	ut32 n_params = params->kind == SWIFT_NODE_TUPLE ? params->children.length : 1;
+	if (!n_params) {
+		return NULL;
+	}
+	SwiftNode *labels = swift5_node(d, SWIFT_NODE_LABEL_LIST);
+	bool has_labels = false;
+	for (ut32 i = 0; i < n_params; i++) {
+		SwiftNode *label = swift5_pop(d);
+		if (!label || (label->kind != SWIFT_NODE_IDENTIFIER && label->kind != SWIFT_NODE_FIRST_ELEMENT_MARKER)) {
+			return NULL;
+		}
+		labels = swift5_add(d, labels, label);
+		has_labels |= label->kind == SWIFT_NODE_IDENTIFIER;
+	}
+	if (!has_labels) {
+		return swift5_node(d, SWIFT_NODE_LABEL_LIST);
+	}
+	swift5_reverse_children(labels, 0);
+	return labels;
+}
+
+static SwiftNode *swift5_plain_function(SwiftDemangler *d) {
+	SwiftNode *sig = swift5_pop_kind(d, SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE);
+	SwiftNode *type = swift5_pop_function_type(d, SWIFT_NODE_FUNCTION_TYPE);
+	SwiftNode *labels = swift5_pop_function_param_labels(d, type);
+	if (sig) {
+		type = swift5_type(d, swift5_with_children(d, SWIFT_NODE_DEPENDENT_GENERIC_TYPE, sig, type));
+	}
+	SwiftNode *name = swift5_pop_if(d, swift5_is_decl_name);
+	SwiftNode *ctx = swift5_pop_context(d);
+	SwiftNode *fn = swift5_with_children(d, SWIFT_NODE_FUNCTION, ctx, name);
+	if (labels) {
+		fn = swift5_add(d, fn, labels);
+	}
+	return swift5_add(d, fn, type);
+}
+
+static SwiftNode *swift5_entity(SwiftDemangler *d, SwiftNodeKind kind) {
+	SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	SwiftNode *labels = swift5_pop_function_param_labels(d, type);
+	SwiftNode *name = swift5_pop_if(d, swift5_is_decl_name);
+	SwiftNode *ctx = swift5_pop_context(d);
+	SwiftNode *entity = swift5_with_children(d, kind, ctx, name);
+	if (labels) {
+		entity = swift5_add(d, entity, labels);
+	}
+	return swift5_add(d, entity, type);
+}
+
+static SwiftNode *swift5_accessor(SwiftDemangler *d, SwiftNode *storage) {
+	SwiftNodeKind kind;
+	switch (swift5_next(d)) {
+	case 'm': kind = SWIFT_NODE_MATERIALIZE_FOR_SET; break;
+	case 's': kind = SWIFT_NODE_SETTER; break;
+	case 'g': kind = SWIFT_NODE_GETTER; break;
+	case 'G': kind = SWIFT_NODE_GLOBAL_GETTER; break;
+	case 'w': kind = SWIFT_NODE_WILL_SET; break;
+	case 'W': kind = SWIFT_NODE_DID_SET; break;
+	case 'r': kind = SWIFT_NODE_READ_ACCESSOR; break;
+	case 'M': kind = SWIFT_NODE_MODIFY_ACCESSOR; break;
+	case 'i': kind = SWIFT_NODE_INIT_ACCESSOR; break;
+	case 'a':
+		if (!swift5_next_if(d, 'u')) {
+			return NULL;
+		}
+		kind = SWIFT_NODE_UNSAFE_MUTABLE_ADDRESSOR;
+		break;
+	case 'l':
+		if (!swift5_next_if(d, 'u')) {
+			return NULL;
+		}
+		kind = SWIFT_NODE_UNSAFE_ADDRESSOR;
+		break;
+	case 'p':
+		// the storage itself
+		return storage;
+	default:
+		return NULL;
+	}
+	return swift5_with_child(d, kind, storage);
+}
+
+static SwiftNode *swift5_variable(SwiftDemangler *d) {
+	return swift5_accessor(d, swift5_entity(d, SWIFT_NODE_VARIABLE));
+}
+
+static SwiftNode *swift5_subscript(SwiftDemangler *d) {
+	SwiftNode *private_name = swift5_pop_kind(d, SWIFT_NODE_PRIVATE_DECL_NAME);
+	SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	SwiftNode *labels = swift5_pop_function_param_labels(d, type);
+	SwiftNode *ctx = swift5_pop_context(d);
+	SwiftNode *subscript = swift5_with_child(d, SWIFT_NODE_SUBSCRIPT, ctx);
+	if (labels) {
+		subscript = swift5_add(d, subscript, labels);
+	}
+	subscript = swift5_add(d, subscript, type);
+	if (private_name) {
+		subscript = swift5_add(d, subscript, private_name);
+	}
+	return swift5_accessor(d, subscript);
+}
+
+/* `f<kind>`: constructors, destructors, closures, initializers */
+static SwiftNode *swift5_function_entity(SwiftDemangler *d) {
+	enum { ARGS_NONE, ARGS_TYPE_AND_NAME, ARGS_TYPE_AND_INDEX, ARGS_INDEX } args;
+	SwiftNodeKind kind;
+	switch (swift5_next(d)) {
+	case 'D': args = ARGS_NONE, kind = SWIFT_NODE_DEALLOCATOR; break;
+	case 'd': args = ARGS_NONE, kind = SWIFT_NODE_DESTRUCTOR; break;
+	case 'E': args = ARGS_NONE, kind = SWIFT_NODE_IVAR_DESTROYER; break;
+	case 'e': args = ARGS_NONE, kind = SWIFT_NODE_IVAR_INITIALIZER; break;
+	case 'i': args = ARGS_NONE, kind = SWIFT_NODE_INITIALIZER; break;
+	case 'C': args = ARGS_TYPE_AND_NAME, kind = SWIFT_NODE_ALLOCATOR; break;
+	case 'c': args = ARGS_TYPE_AND_NAME, kind = SWIFT_NODE_CONSTRUCTOR; break;
+	case 'U': args = ARGS_TYPE_AND_INDEX, kind = SWIFT_NODE_EXPLICIT_CLOSURE; break;
+	case 'u': args = ARGS_TYPE_AND_INDEX, kind = SWIFT_NODE_IMPLICIT_CLOSURE; break;
+	case 'A': args = ARGS_INDEX, kind = SWIFT_NODE_DEFAULT_ARGUMENT_INITIALIZER; break;
+	default:
+		return NULL;
+	}
+	SwiftNode *name_or_index = NULL;
+	SwiftNode *type = NULL;
+	SwiftNode *labels = NULL;
+	switch (args) {
+	case ARGS_TYPE_AND_NAME:
+		name_or_index = swift5_pop_kind(d, SWIFT_NODE_PRIVATE_DECL_NAME);
+		type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+		labels = swift5_pop_function_param_labels(d, type);
+		break;
+	case ARGS_TYPE_AND_INDEX:
+		name_or_index = swift5_index_node(d);
+		type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+		break;
+	case ARGS_INDEX:
+		name_or_index = swift5_index_node(d);
+		break;
+	default:
+		break;
+	}
+	SwiftNode *entity = swift5_with_child(d, kind, swift5_pop_context(d));
+	switch (args) {
+	case ARGS_TYPE_AND_NAME:
+		if (labels) {
+			entity = swift5_add(d, entity, labels);
+		}
+		entity = swift5_add(d, entity, type);
+		if (name_or_index) {
+			entity = swift5_add(d, entity, name_or_index);
+		}
+		break;
+	case ARGS_TYPE_AND_INDEX:
+		entity = swift5_add(d, entity, name_or_index);
+		entity = swift5_add(d, entity, type);
+		break;
+	case ARGS_INDEX:
+		entity = swift5_add(d, entity, name_or_index);
+		break;
+	default:
+		break;
+	}
+	return entity;
+}
+
+static SwiftNode *swift5_extension_context(SwiftDemangler *d) {
+	SwiftNode *sig = swift5_pop_kind(d, SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE);
+	SwiftNode *module = swift5_pop_module(d);
+	SwiftNode *type = swift5_pop_type_any_generic(d);
+	SwiftNode *extension = swift5_with_children(d, SWIFT_NODE_EXTENSION, module, type);
+	if (sig) {
+		extension = swift5_add(d, extension, sig);
+	}
+	return extension;
+}
+
+/* `L<index>` local, `LL` private and `Ll` file-private names */
+static SwiftNode *swift5_local_identifier(SwiftDemangler *d) {
+	if (swift5_next_if(d, 'L')) {
+		SwiftNode *discriminator = swift5_pop_kind(d, SWIFT_NODE_IDENTIFIER);
+		SwiftNode *name = swift5_pop_if(d, swift5_is_decl_name);
+		return swift5_with_children(d, SWIFT_NODE_PRIVATE_DECL_NAME, discriminator, name);
+	}
+	if (swift5_next_if(d, 'l')) {
+		return swift5_with_child(d, SWIFT_NODE_PRIVATE_DECL_NAME, swift5_pop_kind(d, SWIFT_NODE_IDENTIFIER));
+	}
+	SwiftNode *discriminator = swift5_index_node(d);
+	SwiftNode *name = swift5_pop_if(d, swift5_is_decl_name);
+	return swift5_with_children(d, SWIFT_NODE_LOCAL_DECL_NAME, discriminator, name);
+}
+
+static SwiftNode *swift5_operator_identifier(SwiftDemangler *d) {
+	static const char op_chars[] = "& @/= >    <*!|+?%-~   ^ .";
+	SwiftNode *ident = swift5_pop_kind(d, SWIFT_NODE_IDENTIFIER);
+	if (!ident) {
+		return NULL;
+	}
+	SwiftNodeKind kind;
+	switch (swift5_next(d)) {
+	case 'i': kind = SWIFT_NODE_INFIX_OPERATOR; break;
+	case 'p': kind = SWIFT_NODE_PREFIX_OPERATOR; break;
+	case 'P': kind = SWIFT_NODE_POSTFIX_OPERATOR; break;
+	default:
+		return NULL;
+	}
+	char *op = swift5_alloc(d, ident->size + 1);
+	if (!op) {
+		return NULL;
+	}
+	for (size_t i = 0; i < ident->size; i++) {
+		char c = ident->text[i];
+		if (c & 0x80) {
+			// unicode operators are kept as they are
+			op[i] = c;
+			continue;
+		}
+		if (!IS_LOWER(c) || op_chars[c - 'a'] == ' ') {
+			return NULL;
+		}
+		op[i] = op_chars[c - 'a'];
+	}
+	op[ident->size] = 0;
+	return swift5_node_text(d, kind, op, ident->size);
+}
+
+/* ----------------------------------------------------------------------------
+ * Generics
+ * --------------------------------------------------------------------------*/
+
+static SwiftNode *swift5_generic_param(SwiftDemangler *d, ut64 depth, ut64 index) {
+	char name[64];
+	size_t size = 0;
+	do {
+		name[size++] = 'A' + (index % 26);
+		index /= 26;
+	} while (index && size < 16);
+	if (depth) {
+		size += snprintf(name + size, sizeof(name) - size, "%" PRIu64, depth);
+	}
+	return swift5_node_copy(d, SWIFT_NODE_DEPENDENT_GENERIC_PARAM_TYPE, name, size);
+}
+
+/* `x` is the first parameter, `<index>` the next ones, `d<depth><index>` the outer ones */
+static SwiftNode *swift5_generic_param_index(SwiftDemangler *d) {
+	if (swift5_next_if(d, 'd')) {
+		st64 depth = swift5_index(d);
+		st64 index = depth < 0 ? -1 : swift5_index(d);
+		return index < 0 ? NULL : swift5_generic_param(d, depth + 1, index);
+	}
+	if (swift5_next_if(d, 'z')) {
+		return swift5_generic_param(d, 0, 0);
+	}
+	st64 index = swift5_index(d);
+	return index < 0 ? NULL : swift5_generic_param(d, 0, index + 1);
+}
+
+static SwiftNode *swift5_pop_assoc_type_name(SwiftDemangler *d) {
+	SwiftNode *proto = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	if (proto && !swift5_is_protocol(proto)) {
+		return NULL;
+	}
+	SwiftNode *ident = swift5_pop_kind(d, SWIFT_NODE_IDENTIFIER);
+	SwiftNode *ref = swift5_with_child(d, SWIFT_NODE_DEPENDENT_ASSOCIATED_TYPE_REF, ident);
+	if (proto) {
+		ref = swift5_add(d, ref, proto);
+	}
+	return ref;
+}
+
+static SwiftNode *swift5_assoc_type_simple(SwiftDemangler *d, SwiftNode *base) {
+	SwiftNode *name = swift5_pop_assoc_type_name(d);
+	SwiftNode *base_type = base ? swift5_type(d, base) : swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	return swift5_type(d, swift5_with_children(d, SWIFT_NODE_DEPENDENT_MEMBER_TYPE, base_type, name));
+}
+
+static SwiftNode *swift5_assoc_type_compound(SwiftDemangler *d, SwiftNode *base) {
+	SwiftNodes names = { 0 };
+	bool first = false;
+	do {
+		first = swift5_pop_kind(d, SWIFT_NODE_FIRST_ELEMENT_MARKER) != NULL;
+		SwiftNode *name = swift5_pop_assoc_type_name(d);
+		if (!name || !swift5_nodes_push(d, &names, name)) {
+			return NULL;
+		}
+	} while (!first);
+	SwiftNode *type = base ? swift5_type(d, base) : swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	while (names.length) {
+		SwiftNode *name = names.data[--names.length];
+		type = swift5_type(d, swift5_with_children(d, SWIFT_NODE_DEPENDENT_MEMBER_TYPE, type, name));
+	}
+	return type;
+}
+
+static SwiftNode *swift5_archetype(SwiftDemangler *d) {
+	SwiftNode *type = NULL;
+	switch (swift5_next(d)) {
+	case 'y':
+		type = swift5_assoc_type_simple(d, swift5_generic_param_index(d));
+		break;
+	case 'z':
+		type = swift5_assoc_type_simple(d, swift5_generic_param(d, 0, 0));
+		break;
+	case 'Y':
+		type = swift5_assoc_type_compound(d, swift5_generic_param_index(d));
+		break;
+	case 'Z':
+		type = swift5_assoc_type_compound(d, swift5_generic_param(d, 0, 0));
+		break;
+	default:
+		return NULL;
+	}
+	swift5_add_substitution(d, type);
+	return type;
+}
+
+/* `r<counts>l` with explicit parameter counts or `l` for a single parameter, after the requirements */
+static SwiftNode *swift5_generic_signature(SwiftDemangler *d, bool has_param_counts) {
+	SwiftNode *sig = swift5_node(d, SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE);
+	if (!sig) {
+		return NULL;
+	}
+	if (has_param_counts) {
+		while (!swift5_next_if(d, 'l')) {
+			st64 count = 0;
+			if (!swift5_next_if(d, 'z')) {
+				count = swift5_index(d);
+				if (count < 0) {
+					return NULL;
+				}
+				count++;
+			}
+			if (!swift5_add(d, sig, swift5_node_index(d, SWIFT_NODE_DEPENDENT_GENERIC_PARAM_COUNT, count))) {
+				return NULL;
+			}
+		}
+	} else if (!swift5_add(d, sig, swift5_node_index(d, SWIFT_NODE_DEPENDENT_GENERIC_PARAM_COUNT, 1))) {
+		return NULL;
+	}
+	ut32 n_counts = sig->children.length;
+	SwiftNode *req;
+	while ((req = swift5_pop_if(d, swift5_is_requirement))) {
+		if (!swift5_add(d, sig, req)) {
+			return NULL;
+		}
+	}
+	swift5_reverse_children(sig, n_counts);
+	return sig;
+}
+
+static SwiftNode *swift5_generic_requirement(SwiftDemangler *d) {
+	enum { TYPE_GENERIC, TYPE_ASSOC, TYPE_COMPOUND_ASSOC, TYPE_SUBSTITUTION } type_kind;
+	enum { CONSTRAINT_PROTOCOL, CONSTRAINT_BASE_CLASS, CONSTRAINT_SAME_TYPE, CONSTRAINT_LAYOUT } constraint;
+	switch (swift5_peek(d)) {
+	case 'c': constraint = CONSTRAINT_BASE_CLASS, type_kind = TYPE_ASSOC; break;
+	case 'C': constraint = CONSTRAINT_BASE_CLASS, type_kind = TYPE_COMPOUND_ASSOC; break;
+	case 'b': constraint = CONSTRAINT_BASE_CLASS, type_kind = TYPE_GENERIC; break;
+	case 'B': constraint = CONSTRAINT_BASE_CLASS, type_kind = TYPE_SUBSTITUTION; break;
+	case 't': constraint = CONSTRAINT_SAME_TYPE, type_kind = TYPE_ASSOC; break;
+	case 'T': constraint = CONSTRAINT_SAME_TYPE, type_kind = TYPE_COMPOUND_ASSOC; break;
+	case 's': constraint = CONSTRAINT_SAME_TYPE, type_kind = TYPE_GENERIC; break;
+	case 'S': constraint = CONSTRAINT_SAME_TYPE, type_kind = TYPE_SUBSTITUTION; break;
+	case 'm': constraint = CONSTRAINT_LAYOUT, type_kind = TYPE_ASSOC; break;
+	case 'M': constraint = CONSTRAINT_LAYOUT, type_kind = TYPE_COMPOUND_ASSOC; break;
+	case 'l': constraint = CONSTRAINT_LAYOUT, type_kind = TYPE_GENERIC; break;
+	case 'L': constraint = CONSTRAINT_LAYOUT, type_kind = TYPE_SUBSTITUTION; break;
+	case 'p': constraint = CONSTRAINT_PROTOCOL, type_kind = TYPE_ASSOC; break;
+	case 'P': constraint = CONSTRAINT_PROTOCOL, type_kind = TYPE_COMPOUND_ASSOC; break;
+	case 'Q': constraint = CONSTRAINT_PROTOCOL, type_kind = TYPE_SUBSTITUTION; break;
+	default:
+		// a protocol conformance of a generic parameter, the code is the parameter
+		constraint = CONSTRAINT_PROTOCOL, type_kind = TYPE_GENERIC;
+		d->cur--;
+		break;
+	}
+	d->cur++;
+
+	SwiftNode *constrained = NULL;
+	switch (type_kind) {
+	case TYPE_GENERIC:
+		constrained = swift5_type(d, swift5_generic_param_index(d));
+		break;
+	case TYPE_ASSOC:
+		constrained = swift5_assoc_type_simple(d, swift5_generic_param_index(d));
+		swift5_add_substitution(d, constrained);
+		break;
+	case TYPE_COMPOUND_ASSOC:
+		constrained = swift5_assoc_type_compound(d, swift5_generic_param_index(d));
+		swift5_add_substitution(d, constrained);
+		break;
+	default:
+		constrained = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+		break;
+	}
+
+	switch (constraint) {
+	case CONSTRAINT_PROTOCOL:
+		return swift5_with_children(d, SWIFT_NODE_DEPENDENT_GENERIC_CONFORMANCE_REQUIREMENT, constrained, swift5_pop_protocol(d));
+	case CONSTRAINT_BASE_CLASS:
+		return swift5_with_children(d, SWIFT_NODE_DEPENDENT_GENERIC_CONFORMANCE_REQUIREMENT, constrained, swift5_pop_kind(d, SWIFT_NODE_TYPE));
+	case CONSTRAINT_SAME_TYPE:
+		return swift5_with_children(d, SWIFT_NODE_DEPENDENT_GENERIC_SAME_TYPE_REQUIREMENT, constrained, swift5_pop_kind(d, SWIFT_NODE_TYPE));
+	default:
+		break;
+	}
+
+	const char *layout = d->cur < d->end ? d->cur : NULL;
+	SwiftNode *size = NULL;
+	SwiftNode *alignment = NULL;
+	switch (swift5_next(d)) {
+	case 'U':
+	case 'R':
+	case 'N':
+	case 'C':
+	case 'D':
+	case 'T':
+		break;
+	case 'E':
+	case 'M':
+		size = swift5_index_node(d);
+		alignment = swift5_index_node(d);
+		if (!size || !alignment) {
+			return NULL;
+		}
+		break;
+	case 'e':
+	case 'm':
+		size = swift5_index_node(d);
+		if (!size) {
+			return NULL;
+		}
+		break;
+	default:
+		return NULL;
+	}
+	SwiftNode *name = swift5_node_text(d, SWIFT_NODE_IDENTIFIER, layout, 1);
+	SwiftNode *req = swift5_with_children(d, SWIFT_NODE_DEPENDENT_GENERIC_LAYOUT_REQUIREMENT, constrained, name);
+	if (size) {
+		req = swift5_add(d, req, size);
+	}
+	if (alignment) {
+		req = swift5_add(d, req, alignment);
+	}
+	return req;
+}
+
+static SwiftNode *swift5_generic_type(SwiftDemangler *d) {
+	SwiftNode *sig = swift5_pop_kind(d, SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE);
+	SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	return swift5_type(d, swift5_with_children(d, SWIFT_NODE_DEPENDENT_GENERIC_TYPE, sig, type));
+}
+
+/* ----------------------------------------------------------------------------
+ * Other types
+ * --------------------------------------------------------------------------*/
+
+static SwiftNode *swift5_builtin_type(SwiftDemangler *d) {
+	char name[64];
+	const char *text = NULL;
+	switch (swift5_next(d)) {
+	case 'b': text = "Builtin.BridgeObject"; break;
+	case 'B': text = "Builtin.UnsafeValueBuffer"; break;
+	case 'c': text = "Builtin.RawUnsafeContinuation"; break;
+	case 'D': text = "Builtin.DefaultActorStorage"; break;
+	case 'e': text = "Builtin.Executor"; break;
+	case 'I': text = "Builtin.IntLiteral"; break;
+	case 'j': text = "Builtin.Job"; break;
+	case 'O': text = "Builtin.UnknownObject"; break;
+	case 'o': text = "Builtin.NativeObject"; break;
+	case 'p': text = "Builtin.RawPointer"; break;
+	case 't': text = "Builtin.SILToken"; break;
+	case 'w': text = "Builtin.Word"; break;
+	case 'f':
+	case 'i': {
+		bool is_float = d->cur[-1] == 'f';
+		st64 bits = swift5_index(d) - 1;
+		if (bits <= 0 || bits > 4096) {
+			return NULL;
+		}
+		int size = snprintf(name, sizeof(name), "%s%d", is_float ? "Builtin.FPIEEE" : "Builtin.Int", (int)bits);
+		return swift5_type(d, swift5_node_copy(d, SWIFT_NODE_BUILTIN_TYPE_NAME, name, size));
+	}
+	case 'v': {
+		st64 elements = swift5_index(d) - 1;
+		SwiftNode *element = swift5_pop_type_child(d);
+		if (elements <= 0 || elements > 4096 || !element || element->kind != SWIFT_NODE_BUILTIN_TYPE_NAME ||
+			element->size < 8 || strncmp(element->text, "Builtin.", 8)) {
+			return NULL;
+		}
+		int size = snprintf(name, sizeof(name), "Builtin.Vec%dx%.*s", (int)elements, (int)RZ_MIN(element->size - 8, 32), element->text + 8);
+		return swift5_type(d, swift5_node_copy(d, SWIFT_NODE_BUILTIN_TYPE_NAME, name, size));
+	}
+	default:
+		return NULL;
+	}
+	return swift5_type(d, swift5_node_text(d, SWIFT_NODE_BUILTIN_TYPE_NAME, text, strlen(text)));
+}
+
+/* `<protocol>* [_]` protocol compositions, `y` for `Any` */
+static SwiftNode *swift5_protocol_list(SwiftDemangler *d) {
+	SwiftNode *types = swift5_node(d, SWIFT_NODE_TYPE_LIST);
+	SwiftNode *list = swift5_with_child(d, SWIFT_NODE_PROTOCOL_LIST, types);
+	if (!list) {
+		return NULL;
+	}
+	if (!swift5_pop_kind(d, SWIFT_NODE_EMPTY_LIST)) {
+		bool first = false;
+		do {
+			first = swift5_pop_kind(d, SWIFT_NODE_FIRST_ELEMENT_MARKER) != NULL;
+			if (!swift5_add(d, types, swift5_pop_protocol(d))) {
+				return NULL;
+			}
+		} while (!first);
+		swift5_reverse_children(types, 0);
+	}
+	return list;
+}
+
+static SwiftNode *swift5_special_type(SwiftDemangler *d) {
+	SwiftNodeKind kind;
+	switch (swift5_next(d)) {
+	case 'c': {
+		SwiftNode *superclass = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+		SwiftNode *list = swift5_protocol_list(d);
+		return swift5_type(d, swift5_with_children(d, SWIFT_NODE_PROTOCOL_LIST_WITH_CLASS, list, superclass));
+	}
+	case 'l':
+		return swift5_type(d, swift5_with_child(d, SWIFT_NODE_PROTOCOL_LIST_WITH_ANY_OBJECT, swift5_protocol_list(d)));
+	case 'E': return swift5_pop_function_type(d, SWIFT_NODE_NOESCAPE_FUNCTION_TYPE);
+	case 'A': return swift5_pop_function_type(d, SWIFT_NODE_ESCAPING_AUTO_CLOSURE_TYPE);
+	case 'K': return swift5_pop_function_type(d, SWIFT_NODE_AUTO_CLOSURE_TYPE);
+	case 'f': return swift5_pop_function_type(d, SWIFT_NODE_THIN_FUNCTION_TYPE);
+	case 'B': return swift5_pop_function_type(d, SWIFT_NODE_OBJC_BLOCK);
+	case 'C': return swift5_pop_function_type(d, SWIFT_NODE_C_FUNCTION_POINTER);
+	case 'p': kind = SWIFT_NODE_EXISTENTIAL_METATYPE; break;
+	case 'D': kind = SWIFT_NODE_DYNAMIC_SELF; break;
+	case 'o': kind = SWIFT_NODE_UNOWNED; break;
+	case 'u': kind = SWIFT_NODE_UNMANAGED; break;
+	case 'w': kind = SWIFT_NODE_WEAK; break;
+	default:
+		return NULL;
+	}
+	return swift5_type(d, swift5_with_child(d, kind, swift5_pop_kind(d, SWIFT_NODE_TYPE)));
+}
+
+static SwiftNode *swift5_type_mangling(SwiftDemangler *d) {
+	SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+	SwiftNode *labels = swift5_pop_function_param_labels(d, type);
+	SwiftNode *mangling = swift5_node(d, SWIFT_NODE_TYPE_MANGLING);
+	if (labels) {
+		mangling = swift5_add(d, mangling, labels);
+	}
+	return swift5_add(d, mangling, type);
+}
+
+/* ----------------------------------------------------------------------------
+ * Metadata, witnesses and thunks
+ * --------------------------------------------------------------------------*/
+
+static SwiftNode *swift5_private_context_descriptor(SwiftDemangler *d) {
+	switch (swift5_next(d)) {
+	case 'E':
+		return swift5_with_child(d, SWIFT_NODE_EXTENSION_DESCRIPTOR, swift5_pop_context(d));
+	case 'M':
+		return swift5_with_child(d, SWIFT_NODE_MODULE_DESCRIPTOR, swift5_pop_module(d));
+	case 'X':
+		return swift5_with_child(d, SWIFT_NODE_ANONYMOUS_DESCRIPTOR, swift5_pop_context(d));
+	default:
+		return NULL;
+	}
+}
+
+static SwiftNode *swift5_metatype(SwiftDemangler *d) {
+	SwiftNodeKind kind;
+	switch (swift5_next(d)) {
+	case 'a': kind = SWIFT_NODE_TYPE_METADATA_ACCESS_FUNCTION; break;
+	case 'B': kind = SWIFT_NODE_REFLECTION_METADATA_BUILTIN_DESCRIPTOR; break;
+	case 'D': kind = SWIFT_NODE_TYPE_METADATA_DEMANGLING_CACHE; break;
+	case 'f': kind = SWIFT_NODE_FULL_TYPE_METADATA; break;
+	case 'F': kind = SWIFT_NODE_REFLECTION_METADATA_FIELD_DESCRIPTOR; break;
+	case 'i': kind = SWIFT_NODE_TYPE_METADATA_INSTANTIATION_FUNCTION; break;
+	case 'I': kind = SWIFT_NODE_TYPE_METADATA_INSTANTIATION_CACHE; break;
+	case 'l': kind = SWIFT_NODE_TYPE_METADATA_SINGLETON_INITIALIZATION_CACHE; break;
+	case 'L': kind = SWIFT_NODE_TYPE_METADATA_LAZY_CACHE; break;
+	case 'm': kind = SWIFT_NODE_METACLASS; break;
+	case 'n': kind = SWIFT_NODE_NOMINAL_TYPE_DESCRIPTOR; break;
+	case 'o': kind = SWIFT_NODE_CLASS_METADATA_BASE_OFFSET; break;
+	case 'P': kind = SWIFT_NODE_GENERIC_TYPE_METADATA_PATTERN; break;
+	case 'r': kind = SWIFT_NODE_TYPE_METADATA_COMPLETION_FUNCTION; break;
+	case 's': kind = SWIFT_NODE_OBJC_RESILIENT_CLASS_STUB; break;
+	case 't': kind = SWIFT_NODE_FULL_OBJC_RESILIENT_CLASS_STUB; break;
+	case 'u': kind = SWIFT_NODE_METHOD_LOOKUP_FUNCTION; break;
+	case 'U': kind = SWIFT_NODE_OBJC_METADATA_UPDATE_FUNCTION; break;
+	case 'c':
+		return swift5_with_child(d, SWIFT_NODE_PROTOCOL_CONFORMANCE_DESCRIPTOR, swift5_pop_protocol_conformance(d));
+	case 'p':
+		return swift5_with_child(d, SWIFT_NODE_PROTOCOL_DESCRIPTOR, swift5_pop_protocol(d));
+	case 'S':
+		return swift5_with_child(d, SWIFT_NODE_PROTOCOL_SELF_CONFORMANCE_DESCRIPTOR, swift5_pop_protocol(d));
+	case 'V':
+		return swift5_with_child(d, SWIFT_NODE_PROPERTY_DESCRIPTOR, swift5_pop_if(d, swift5_is_entity));
+	case 'X':
+		return swift5_private_context_descriptor(d);
+	default:
+		return NULL;
+	}
+	return swift5_with_child(d, kind, swift5_pop_kind(d, SWIFT_NODE_TYPE));
+}
+
+static SwiftNode *swift5_witness(SwiftDemangler *d) {
+	SwiftNodeKind kind;
+	switch (swift5_next(d)) {
+	case 'C':
+		return swift5_with_child(d, SWIFT_NODE_ENUM_CASE, swift5_pop_if(d, swift5_is_entity));
+	case 'V':
+		return swift5_with_child(d, SWIFT_NODE_VALUE_WITNESS_TABLE, swift5_pop_kind(d, SWIFT_NODE_TYPE));
+	case 'v': {
+		char directness = swift5_next(d);
+		if (directness != 'd' && directness != 'i') {
+			return NULL;
+		}
+		SwiftNode *node = swift5_node_index(d, SWIFT_NODE_DIRECTNESS, directness == 'd');
+		return swift5_with_children(d, SWIFT_NODE_FIELD_OFFSET, node, swift5_pop_if(d, swift5_is_entity));
+	}
+	case 'P': kind = SWIFT_NODE_PROTOCOL_WITNESS_TABLE; break;
+	case 'p': kind = SWIFT_NODE_PROTOCOL_WITNESS_TABLE_PATTERN; break;
+	case 'G': kind = SWIFT_NODE_GENERIC_PROTOCOL_WITNESS_TABLE; break;
+	case 'I': kind = SWIFT_NODE_GENERIC_PROTOCOL_WITNESS_TABLE_INSTANTIATION_FUNCTION; break;
+	case 'r': kind = SWIFT_NODE_RESILIENT_PROTOCOL_WITNESS_TABLE; break;
+	case 'a': kind = SWIFT_NODE_PROTOCOL_WITNESS_TABLE_ACCESSOR; break;
+	case 'l':
+	case 'L': {
+		kind = d->cur[-1] == 'l' ? SWIFT_NODE_LAZY_PROTOCOL_WITNESS_TABLE_ACCESSOR : SWIFT_NODE_LAZY_PROTOCOL_WITNESS_TABLE_CACHE_VARIABLE;
+		SwiftNode *conformance = swift5_pop_protocol_conformance(d);
+		SwiftNode *type = swift5_pop_kind(d, SWIFT_NODE_TYPE);
+		return swift5_with_children(d, kind, type, conformance);
+	}
+	case 't': {
+		SwiftNode *name = swift5_pop_if(d, swift5_is_decl_name);
+		SwiftNode *conformance = swift5_pop_protocol_conformance(d);
+		return swift5_with_children(d, SWIFT_NODE_ASSOCIATED_TYPE_METADATA_ACCESSOR, conformance, name);
+	}
+	default:
+		return NULL;
+	}
+	return swift5_with_child(d, kind, swift5_pop_protocol_conformance(d));
+}
+
+/* `<pass>` with optional `m` (metatype params removed) and `q` (serialized) flags */
+static SwiftNode *swift5_generic_specialization(SwiftDemangler *d, SwiftNodeKind kind) {
+	swift5_next_if(d, 'm');
+	bool serialized = swift5_next_if(d, 'q');
+	char pass = swift5_next(d);
+	if (!IS_DIGIT(pass)) {
+		return NULL;
+	}
+	SwiftNode *spec = swift5_node(d, kind);
+	if (serialized) {
+		spec = swift5_add(d, spec, swift5_node(d, SWIFT_NODE_IS_SERIALIZED));
+	}
+	spec = swift5_add(d, spec, swift5_node_index(d, SWIFT_NODE_SPECIALIZATION_PASS_ID, pass - '0'));
+	SwiftNode *types = swift5_pop_type_list(d);
+	for (ut32 i = 0; spec && types && i < types->children.length; i++) {
+		spec = swift5_add(d, spec, swift5_with_child(d, SWIFT_NODE_GENERIC_SPECIALIZATION_PARAM, types->children.data[i]));
+	}
+	return types ? spec : NULL;
+}
+
+static SwiftNode *swift5_thunk_or_specialization(SwiftDemangler *d) {
+	SwiftNodeKind kind;
+	switch (swift5_next(d)) {
+	case 'o': return swift5_node(d, SWIFT_NODE_OBJC_ATTRIBUTE);
+	case 'O': return swift5_node(d, SWIFT_NODE_NON_OBJC_ATTRIBUTE);
+	case 'D': return swift5_node(d, SWIFT_NODE_DYNAMIC_ATTRIBUTE);
+	case 'd': return swift5_node(d, SWIFT_NODE_DIRECT_METHOD_REFERENCE_ATTRIBUTE);
+	case 'a': return swift5_node(d, SWIFT_NODE_PARTIAL_APPLY_OBJC_FORWARDER);
+	case 'A': return swift5_node(d, SWIFT_NODE_PARTIAL_APPLY_FORWARDER);
+	case 'm': return swift5_node(d, SWIFT_NODE_MERGED_FUNCTION);
+	case 'X': return swift5_node(d, SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_VAR);
+	case 'x': return swift5_node(d, SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_KEY);
+	case 'I': return swift5_node(d, SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_IMPL);
+	case 'c': kind = SWIFT_NODE_CURRY_THUNK; break;
+	case 'j': kind = SWIFT_NODE_DISPATCH_THUNK; break;
+	case 'q': kind = SWIFT_NODE_METHOD_DESCRIPTOR; break;
+	case 'L':
+		return swift5_with_child(d, SWIFT_NODE_PROTOCOL_REQUIREMENTS_BASE_DESCRIPTOR, swift5_pop_protocol(d));
+	case 'V': {
+		SwiftNode *base = swift5_pop_if(d, swift5_is_entity);
+		SwiftNode *derived = swift5_pop_if(d, swift5_is_entity);
+		return swift5_with_children(d, SWIFT_NODE_VTABLE_THUNK, derived, base);
+	}
+	case 'W': {
+		SwiftNode *entity = swift5_pop_if(d, swift5_is_entity);
+		SwiftNode *conformance = swift5_pop_protocol_conformance(d);
+		return swift5_with_children(d, SWIFT_NODE_PROTOCOL_WITNESS, conformance, entity);
+	}
+	case 'g':
+		return swift5_generic_specialization(d, SWIFT_NODE_GENERIC_SPECIALIZATION);
+	case 'G':
+		return swift5_generic_specialization(d, SWIFT_NODE_GENERIC_SPECIALIZATION_NOT_RE_ABSTRACTED);
+	default:
+		return NULL;
+	}
+	return swift5_with_child(d, kind, swift5_pop_if(d, swift5_is_entity));
+}
+
+/* ----------------------------------------------------------------------------
+ * Operators
+ * --------------------------------------------------------------------------*/
+
+static SwiftNode *swift5_operator(SwiftDemangler *d) {
+	SwiftNodeKind kind;
+	char c = swift5_next(d);
+	switch (c) {
+	case 'A': return swift5_multi_substitutions(d);
+	case 'B': return swift5_builtin_type(d);
+	case 'C': return swift5_any_generic_type(d, SWIFT_NODE_CLASS);
+	case 'D': return swift5_type_mangling(d);
+	case 'E': return swift5_extension_context(d);
+	case 'F': return swift5_plain_function(d);
+	case 'G': return swift5_bound_generic_type(d);
+	case 'K': return swift5_node(d, SWIFT_NODE_THROWS_ANNOTATION);
+	case 'L': return swift5_local_identifier(d);
+	case 'M': return swift5_metatype(d);
+	case 'N': return swift5_with_child(d, SWIFT_NODE_TYPE_METADATA, swift5_pop_kind(d, SWIFT_NODE_TYPE));
+	case 'O': return swift5_any_generic_type(d, SWIFT_NODE_ENUM);
+	case 'P': return swift5_any_generic_type(d, SWIFT_NODE_PROTOCOL);
+	case 'Q': return swift5_archetype(d);
+	case 'R': return swift5_generic_requirement(d);
+	case 'S': return swift5_standard_substitution(d);
+	case 'T': return swift5_thunk_or_specialization(d);
+	case 'V': return swift5_any_generic_type(d, SWIFT_NODE_STRUCTURE);
+	case 'W': return swift5_witness(d);
+	case 'X': return swift5_special_type(d);
+	case 'Z': return swift5_with_child(d, SWIFT_NODE_STATIC, swift5_pop_if(d, swift5_is_entity));
+	case 'a': return swift5_any_generic_type(d, SWIFT_NODE_TYPE_ALIAS);
+	case 'c': return swift5_pop_function_type(d, SWIFT_NODE_FUNCTION_TYPE);
+	case 'd': return swift5_node(d, SWIFT_NODE_VARIADIC_MARKER);
+	case 'f': return swift5_function_entity(d);
+	case 'i': return swift5_subscript(d);
+	case 'l': return swift5_generic_signature(d, false);
+	case 'o': return swift5_operator_identifier(d);
+	case 'p': return swift5_type(d, swift5_protocol_list(d));
+	case 'q': return swift5_type(d, swift5_generic_param_index(d));
+	case 'r': return swift5_generic_signature(d, true);
+	case 's': return swift5_node_text(d, SWIFT_NODE_MODULE, "Swift", 5);
+	case 't': return swift5_pop_tuple(d);
+	case 'u': return swift5_generic_type(d);
+	case 'v': return swift5_variable(d);
+	case 'x': return swift5_type(d, swift5_generic_param(d, 0, 0));
+	case 'y': return swift5_node(d, SWIFT_NODE_EMPTY_LIST);
+	case '_': return swift5_node(d, SWIFT_NODE_FIRST_ELEMENT_MARKER);
+	case 'Y':
+		switch (swift5_next(d)) {
+		case 'a': return swift5_node(d, SWIFT_NODE_ASYNC_ANNOTATION);
+		case 'b': return swift5_node(d, SWIFT_NODE_CONCURRENT_FUNCTION_TYPE);
+		default: return NULL;
+		}
+	case 'h': kind = SWIFT_NODE_SHARED; break;
+	case 'n': kind = SWIFT_NODE_OWNED; break;
+	case 'z': kind = SWIFT_NODE_IN_OUT; break;
+	case 'm': kind = SWIFT_NODE_METATYPE; break;
+	case '.': {
+		// vendor suffix, like `.cold` or `.resume.0`
+		SwiftNode *suffix = swift5_node_text(d, SWIFT_NODE_SUFFIX, d->cur - 1, d->end - d->cur + 1);
+		d->cur = d->end;
+		return suffix;
+	}
+	default:
+		if (!IS_DIGIT(c)) {
+			return NULL;
+		}
+		d->cur--;
+		return swift5_identifier(d);
+	}
+	if (kind == SWIFT_NODE_METATYPE) {
+		return swift5_type(d, swift5_with_child(d, kind, swift5_pop_kind(d, SWIFT_NODE_TYPE)));
+	}
+	return swift5_type(d, swift5_with_child(d, kind, swift5_pop_type_child(d)));
+}
+
+static SwiftNode *swift5_parse(SwiftDemangler *d) {
+	while (d->cur < d->end) {
+		if (!dem_budget_step()) {
+			return NULL;
+		}
+		SwiftNode *node = swift5_operator(d);
+		if (!node || !swift5_push(d, node)) {
+			return NULL;
+		}
+	}
+
+	SwiftNode *global = swift5_node(d, SWIFT_NODE_GLOBAL);
+	SwiftNode *parent = global;
+	SwiftNode *attr;
+	while ((attr = swift5_pop_if(d, swift5_is_function_attr))) {
+		if (!swift5_add(d, parent, attr)) {
+			return NULL;
+		}
+		if (attr->kind == SWIFT_NODE_PARTIAL_APPLY_FORWARDER || attr->kind == SWIFT_NODE_PARTIAL_APPLY_OBJC_FORWARDER) {
+			parent = attr;
+		}
+	}
+	ut32 n_entities = 0;
+	for (ut32 i = 0; i < d->stack.length; i++) {
+		SwiftNode *node = d->stack.data[i];
+		n_entities += node->kind != SWIFT_NODE_SUFFIX;
+		switch (node->kind) {
+		case SWIFT_NODE_TYPE:
+			node = swift5_child(node, 0);
+			break;
+		case SWIFT_NODE_EMPTY_LIST:
+		case SWIFT_NODE_FIRST_ELEMENT_MARKER:
+		case SWIFT_NODE_VARIADIC_MARKER:
+		case SWIFT_NODE_THROWS_ANNOTATION:
+		case SWIFT_NODE_ASYNC_ANNOTATION:
+		case SWIFT_NODE_CONCURRENT_FUNCTION_TYPE:
+		case SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE:
+			// operands that no operator consumed
+			return NULL;
+		default:
+			break;
+		}
+		if (!swift5_add(d, parent, node)) {
+			return NULL;
+		}
+	}
+	// a truncated symbol leaves its pieces on the stack, like `4main3foo`;
+	// attributes and suffixes alone, like `TO` or `.cold`, name nothing.
+	return global && n_entities == 1 ? global : NULL;
+}
+
+/* ----------------------------------------------------------------------------
+ * Printer
+ * --------------------------------------------------------------------------*/
+
+static const SwiftNode *swift5_print(SwiftPrinter *P, const SwiftNode *node, bool as_prefix);
+
+static void swift5_put_n(SwiftPrinter *P, const char *text, size_t size) {
+	if (size && !P->error && !dem_string_append_n(&P->out, text, size)) {
+		P->error = true;
+	}
+}
+
+static void swift5_puts(SwiftPrinter *P, const char *text) {
+	swift5_put_n(P, text, strlen(text));
+}
+
+static void swift5_putc(SwiftPrinter *P, char c) {
+	if (!P->error && !dem_string_append_char(&P->out, c)) {
+		P->error = true;
+	}
+}
+
+static void swift5_put_index(SwiftPrinter *P, ut64 index) {
+	if (!P->error && !dem_string_appendf(&P->out, "%" PRIu64, index)) {
+		P->error = true;
+	}
+}
+
+static void swift5_print_children(SwiftPrinter *P, const SwiftNode *node, const char *sep) {
+	for (ut32 i = 0; node && i < node->children.length && !P->error; i++) {
+		if (i && sep) {
+			swift5_puts(P, sep);
+		}
+		swift5_print(P, node->children.data[i], false);
+	}
+}
+
+static void swift5_print_child(SwiftPrinter *P, const SwiftNode *node, ut32 idx) {
+	const SwiftNode *child = swift5_child(node, idx);
+	if (!child) {
+		P->error = true;
+		return;
+	}
+	swift5_print(P, child, false);
+}
+
+/* the module of the standard library and the Clang importer are hidden by RZ_DEMANGLE_OPT_SIMPLIFY */
+static bool swift5_print_context(SwiftPrinter *P, const SwiftNode *ctx) {
+	if (!P->simplify || ctx->kind != SWIFT_NODE_MODULE) {
+		return true;
+	}
+	return !((ctx->size == 5 && !memcmp(ctx->text, "Swift", 5)) ||
+		(ctx->size >= 3 && !memcmp(ctx->text, "__C", 3)));
+}
+
+static bool swift5_need_space_before_type(const SwiftNode *type) {
+	while (type && type->kind == SWIFT_NODE_TYPE) {
+		type = swift5_child(type, 0);
+	}
+	if (!type) {
+		return true;
+	}
+	switch (type->kind) {
+	case SWIFT_NODE_FUNCTION_TYPE:
+	case SWIFT_NODE_NOESCAPE_FUNCTION_TYPE:
+	case SWIFT_NODE_DEPENDENT_GENERIC_TYPE:
+		return false;
+	default:
+		return true;
+	}
+}
+
+static const char *swift5_function_convention(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_THIN_FUNCTION_TYPE: return "@convention(thin) ";
+	case SWIFT_NODE_C_FUNCTION_POINTER: return "@convention(c) ";
+	case SWIFT_NODE_OBJC_BLOCK: return "@convention(block) ";
+	case SWIFT_NODE_AUTO_CLOSURE_TYPE: return "@autoclosure ";
+	case SWIFT_NODE_ESCAPING_AUTO_CLOSURE_TYPE: return "@escaping @autoclosure ";
+	default: return "";
+	}
+}
+
+static void swift5_print_function_parameters(SwiftPrinter *P, const SwiftNode *labels, const SwiftNode *args) {
+	const SwiftNode *params = swift5_child(swift5_child(args, 0), 0);
+	if (!args || args->kind != SWIFT_NODE_ARGUMENT_TUPLE || !params) {
+		P->error = true;
+		return;
+	}
+	if (params->kind != SWIFT_NODE_TUPLE) {
+		swift5_putc(P, '(');
+		swift5_print(P, params, false);
+		swift5_putc(P, ')');
+		return;
+	}
+	bool has_labels = labels && labels->children.length;
+	swift5_putc(P, '(');
+	for (ut32 i = 0; i < params->children.length && !P->error; i++) {
+		if (i) {
+			swift5_puts(P, ", ");
+		}
+		if (has_labels) {
+			const SwiftNode *label = swift5_child(labels, i);
+			if (!label) {
+				P->error = true;
+				return;
+			}
+			if (label->kind == SWIFT_NODE_IDENTIFIER) {
+				swift5_put_n(P, label->text, label->size);
+			} else {
+				swift5_putc(P, '_');
+			}
+			swift5_puts(P, ": ");
+		}
+		swift5_print(P, params->children.data[i], false);
+	}
+	swift5_putc(P, ')');
+}
+
+static void swift5_print_function_type(SwiftPrinter *P, const SwiftNode *labels, const SwiftNode *fn) {
+	const SwiftNode *throws = NULL;
+	bool is_async = false;
+	bool is_sendable = false;
+	ut32 start = 0;
+	if (!fn || fn->children.length < 2) {
+		P->error = true;
+		return;
+	}
+	if (fn->children.data[start]->kind == SWIFT_NODE_THROWS_ANNOTATION) {
+		throws = fn->children.data[start++];
+	}
+	if (start < fn->children.length && fn->children.data[start]->kind == SWIFT_NODE_CONCURRENT_FUNCTION_TYPE) {
+		is_sendable = true;
+		start++;
+	}
+	if (start < fn->children.length && fn->children.data[start]->kind == SWIFT_NODE_ASYNC_ANNOTATION) {
+		is_async = true;
+		start++;
+	}
+	if (is_sendable) {
+		swift5_puts(P, "@Sendable ");
+	}
+	swift5_print_function_parameters(P, labels, swift5_child(fn, start));
+	if (is_async) {
+		swift5_puts(P, " async");
+	}
+	if (throws) {
+		swift5_print(P, throws, false);
+	}
+	swift5_print_child(P, fn, start + 1);
+}
+
+static void swift5_print_entity_type(SwiftPrinter *P, const SwiftNode *entity, const SwiftNode *type) {
+	const SwiftNode *labels = swift5_child_of_kind(entity, SWIFT_NODE_LABEL_LIST);
+	if (!labels) {
+		swift5_print(P, type, false);
+		return;
+	}
+	if (type->kind == SWIFT_NODE_DEPENDENT_GENERIC_TYPE) {
+		const SwiftNode *dependent = swift5_child(type, 1);
+		swift5_print_child(P, type, 0);
+		if (swift5_need_space_before_type(dependent)) {
+			swift5_putc(P, ' ');
+		}
+		type = swift5_child(dependent, 0);
+	}
+	swift5_print_function_type(P, labels, type);
+}
+
+/**
+ * Prints `<context>.<name> <type>`. When the entity is printed as the
+ * context of another one and its own form does not fit a prefix, nothing is
+ * printed and the entity is returned, so that the caller appends it after
+ * ` in `. The same happens to the context of multi-word names.
+ */
+static const SwiftNode *swift5_print_entity(SwiftPrinter *P, const SwiftNode *entity, bool as_prefix, SwiftTypePrinting type_pr, bool has_name, const char *extra_name, st64 extra_index, const char *overwrite_name) {
+	const SwiftNode *name = swift5_child(entity, 1);
+	bool local_name = has_name && name && name->kind == SWIFT_NODE_LOCAL_DECL_NAME;
+	bool multi_word = local_name || (extra_name && strchr(extra_name, ' '));
+	if (as_prefix && (type_pr != SWIFT_TYPE_PR_NONE || multi_word)) {
+		return entity;
+	}
+	const SwiftNode *ctx = swift5_child(entity, 0);
+	const SwiftNode *postfix = NULL;
+	if (!ctx) {
+		P->error = true;
+		return NULL;
+	}
+	if (swift5_print_context(P, ctx)) {
+		if (multi_word) {
+			postfix = ctx;
+		} else {
+			size_t pos = P->out.len;
+			postfix = swift5_print(P, ctx, true);
+			if (P->out.len != pos) {
+				swift5_putc(P, '.');
+			}
+		}
+	}
+	if (has_name || overwrite_name) {
+		if (extra_name && multi_word) {
+			swift5_puts(P, extra_name);
+			if (extra_index >= 0) {
+				swift5_put_index(P, extra_index);
+			}
+			swift5_puts(P, " of ");
+			extra_name = NULL;
+			extra_index = -1;
+		}
+		size_t pos = P->out.len;
+		if (overwrite_name) {
+			swift5_puts(P, overwrite_name);
+		} else {
+			const SwiftNode *private_name = swift5_child_of_kind(entity, SWIFT_NODE_PRIVATE_DECL_NAME);
+			if (name && name->kind != SWIFT_NODE_PRIVATE_DECL_NAME) {
+				swift5_print(P, name, false);
+			}
+			if (private_name) {
+				swift5_print(P, private_name, false);
+			}
+		}
+		if (P->out.len != pos && extra_name) {
+			swift5_putc(P, '.');
+		}
+	}
+	if (extra_name) {
+		swift5_puts(P, extra_name);
+		if (extra_index >= 0) {
+			swift5_put_index(P, extra_index);
+		}
+	}
+	if (type_pr != SWIFT_TYPE_PR_NONE) {
+		const SwiftNode *type = swift5_child(swift5_child_of_kind(entity, SWIFT_NODE_TYPE), 0);
+		if (!type) {
+			P->error = true;
+			return NULL;
+		}
+		if (type_pr == SWIFT_TYPE_PR_FUNCTION_STYLE) {
+			const SwiftNode *fn = type;
+			while (fn && fn->kind == SWIFT_NODE_DEPENDENT_GENERIC_TYPE) {
+				fn = swift5_child(swift5_child(fn, 1), 0);
+			}
+			if (!fn || (fn->kind != SWIFT_NODE_FUNCTION_TYPE && fn->kind != SWIFT_NODE_NOESCAPE_FUNCTION_TYPE &&
+					   fn->kind != SWIFT_NODE_C_FUNCTION_POINTER && fn->kind != SWIFT_NODE_THIN_FUNCTION_TYPE)) {
+				type_pr = SWIFT_TYPE_PR_WITH_COLON;
+			}
+		}
+		if (type_pr == SWIFT_TYPE_PR_WITH_COLON) {
+			swift5_puts(P, " : ");
+		} else if (multi_word || swift5_need_space_before_type(type)) {
+			swift5_putc(P, ' ');
+		}
+		swift5_print_entity_type(P, entity, type);
+	}
+	if (!as_prefix && postfix) {
+		bool is_initializer = entity->kind == SWIFT_NODE_DEFAULT_ARGUMENT_INITIALIZER || entity->kind == SWIFT_NODE_INITIALIZER;
+		swift5_puts(P, is_initializer ? " of " : " in ");
+		swift5_print(P, postfix, false);
+		postfix = NULL;
+	}
+	return postfix;
+}
+
+static const SwiftNode *swift5_print_abstract_storage(SwiftPrinter *P, const SwiftNode *storage, bool as_prefix, const char *extra_name) {
+	switch (storage ? storage->kind : SWIFT_NODE_GLOBAL) {
+	case SWIFT_NODE_VARIABLE:
+		return swift5_print_entity(P, storage, as_prefix, SWIFT_TYPE_PR_WITH_COLON, true, extra_name, -1, NULL);
+	case SWIFT_NODE_SUBSCRIPT:
+		return swift5_print_entity(P, storage, as_prefix, SWIFT_TYPE_PR_WITH_COLON, false, extra_name, -1, "subscript");
+	default:
+		P->error = true;
+		return NULL;
+	}
+}
+
+static void swift5_print_generic_signature(SwiftPrinter *P, const SwiftNode *sig) {
+	ut32 depth = 0;
+	swift5_putc(P, '<');
+	for (; depth < sig->children.length && sig->children.data[depth]->kind == SWIFT_NODE_DEPENDENT_GENERIC_PARAM_COUNT; depth++) {
+		if (depth) {
+			swift5_puts(P, "><");
+		}
+		ut64 count = sig->children.data[depth]->index;
+		for (ut64 index = 0; index < count; index++) {
+			if (index) {
+				swift5_puts(P, ", ");
+			}
+			if (index >= 128) {
+				swift5_puts(P, "...");
+				break;
+			}
+			char name[32];
+			size_t size = 0;
+			ut64 i = index;
+			do {
+				name[size++] = 'A' + (i % 26);
+				i /= 26;
+			} while (i);
+			swift5_put_n(P, name, size);
+			if (depth) {
+				swift5_put_index(P, depth);
+			}
+		}
+	}
+	if (depth != sig->children.length) {
+		swift5_puts(P, " where ");
+		for (ut32 i = depth; i < sig->children.length; i++) {
+			if (i > depth) {
+				swift5_puts(P, ", ");
+			}
+			swift5_print(P, sig->children.data[i], false);
+		}
+	}
+	swift5_putc(P, '>');
+}
+
+static void swift5_print_layout_requirement(SwiftPrinter *P, const SwiftNode *req) {
+	const SwiftNode *layout = swift5_child(req, 1);
+	const char *name = NULL;
+	if (!layout || !layout->size) {
+		P->error = true;
+		return;
+	}
+	switch (layout->text[0]) {
+	case 'U': name = "_UnknownLayout"; break;
+	case 'R': name = "_RefCountedObject"; break;
+	case 'N': name = "_NativeRefCountedObject"; break;
+	case 'C': name = "AnyObject"; break;
+	case 'D': name = "_NativeClass"; break;
+	case 'T':
+	case 'E':
+	case 'e': name = "_Trivial"; break;
+	default: name = "_TrivialAtMost"; break;
+	}
+	swift5_print_child(P, req, 0);
+	swift5_puts(P, ": ");
+	swift5_puts(P, name);
+	if (req->children.length > 2) {
+		swift5_putc(P, '(');
+		swift5_print_child(P, req, 2);
+		if (req->children.length > 3) {
+			swift5_puts(P, ", ");
+			swift5_print_child(P, req, 3);
+		}
+		swift5_putc(P, ')');
+	}
+}
+
+static void swift5_print_specialization(SwiftPrinter *P, const SwiftNode *spec, const char *description) {
+	const char *sep = "";
+	swift5_puts(P, description);
+	swift5_puts(P, " <");
+	for (ut32 i = 0; i < spec->children.length; i++) {
+		const SwiftNode *child = spec->children.data[i];
+		if (child->kind == SWIFT_NODE_SPECIALIZATION_PASS_ID) {
+			continue;
+		}
+		swift5_puts(P, sep);
+		sep = ", ";
+		swift5_print(P, child, false);
+	}
+	swift5_puts(P, "> of ");
+}
+
+static bool swift5_is_simple_type(const SwiftNode *type) {
+	while (type && type->kind == SWIFT_NODE_TYPE) {
+		type = swift5_child(type, 0);
+	}
+	if (!type) {
+		return false;
+	}
+	switch (type->kind) {
+	case SWIFT_NODE_PROTOCOL_LIST:
+		return swift5_child(type, 0)->children.length <= 1;
+	case SWIFT_NODE_PROTOCOL_LIST_WITH_CLASS:
+	case SWIFT_NODE_PROTOCOL_LIST_WITH_ANY_OBJECT:
+	case SWIFT_NODE_DEPENDENT_GENERIC_TYPE:
+	case SWIFT_NODE_IN_OUT:
+	case SWIFT_NODE_SHARED:
+	case SWIFT_NODE_OWNED:
+	case SWIFT_NODE_WEAK:
+	case SWIFT_NODE_UNOWNED:
+	case SWIFT_NODE_UNMANAGED:
+		return false;
+	default:
+		return !swift5_is_function_type(type->kind);
+	}
+}
+
+static void swift5_print_with_parens(SwiftPrinter *P, const SwiftNode *type) {
+	bool parens = !swift5_is_simple_type(type);
+	if (parens) {
+		swift5_putc(P, '(');
+	}
+	swift5_print(P, type, false);
+	if (parens) {
+		swift5_putc(P, ')');
+	}
+}
+
+/* `Swift.<name>` nominal types, which get the sugared `T?`, `[T]` and `[K : V]` forms */
+static bool swift5_is_swift_type(const SwiftNode *type, const char *name) {
+	const SwiftNode *module = swift5_child(type, 0);
+	const SwiftNode *ident = swift5_child(type, 1);
+	size_t size = strlen(name);
+	return module && ident && module->kind == SWIFT_NODE_MODULE && module->size == 5 && !memcmp(module->text, "Swift", 5) &&
+		ident->kind == SWIFT_NODE_IDENTIFIER && ident->size == size && !memcmp(ident->text, name, size);
+}
+
+static void swift5_print_bound_generic(SwiftPrinter *P, const SwiftNode *node) {
+	const SwiftNode *nominal = swift5_child(swift5_child(node, 0), 0);
+	const SwiftNode *args = swift5_child(node, 1);
+	if (!nominal || !args) {
+		P->error = true;
+		return;
+	}
+	if (node->kind == SWIFT_NODE_BOUND_GENERIC_ENUM && args->children.length == 1 && swift5_is_swift_type(nominal, "Optional")) {
+		swift5_print_with_parens(P, args->children.data[0]);
+		swift5_putc(P, '?');
+		return;
+	}
+	if (node->kind == SWIFT_NODE_BOUND_GENERIC_STRUCTURE && args->children.length == 1 && swift5_is_swift_type(nominal, "Array")) {
+		swift5_putc(P, '[');
+		swift5_print(P, args->children.data[0], false);
+		swift5_putc(P, ']');
+		return;
+	}
+	if (node->kind == SWIFT_NODE_BOUND_GENERIC_STRUCTURE && args->children.length == 2 && swift5_is_swift_type(nominal, "Dictionary")) {
+		swift5_putc(P, '[');
+		swift5_print(P, args->children.data[0], false);
+		swift5_puts(P, " : ");
+		swift5_print(P, args->children.data[1], false);
+		swift5_putc(P, ']');
+		return;
+	}
+	swift5_print(P, nominal, false);
+	swift5_putc(P, '<');
+	swift5_print_children(P, args, ", ");
+	swift5_putc(P, '>');
+}
+
+/* nodes printed as a fixed prefix followed by their children */
+static const char *swift5_node_prefix(SwiftNodeKind kind) {
+	switch (kind) {
+	case SWIFT_NODE_STATIC: return "static ";
+	case SWIFT_NODE_IN_OUT: return "inout ";
+	case SWIFT_NODE_SHARED: return "__shared ";
+	case SWIFT_NODE_OWNED: return "__owned ";
+	case SWIFT_NODE_WEAK: return "weak ";
+	case SWIFT_NODE_UNOWNED: return "unowned ";
+	case SWIFT_NODE_UNMANAGED: return "unowned(unsafe) ";
+	case SWIFT_NODE_THROWS_ANNOTATION: return " throws";
+	case SWIFT_NODE_TYPE_METADATA: return "type metadata for ";
+	case SWIFT_NODE_TYPE_METADATA_ACCESS_FUNCTION: return "type metadata accessor for ";
+	case SWIFT_NODE_FULL_TYPE_METADATA: return "full type metadata for ";
+	case SWIFT_NODE_METACLASS: return "metaclass for ";
+	case SWIFT_NODE_NOMINAL_TYPE_DESCRIPTOR: return "nominal type descriptor for ";
+	case SWIFT_NODE_PROTOCOL_DESCRIPTOR: return "protocol descriptor for ";
+	case SWIFT_NODE_TYPE_METADATA_LAZY_CACHE: return "lazy cache variable for type metadata for ";
+	case SWIFT_NODE_TYPE_METADATA_INSTANTIATION_CACHE: return "type metadata instantiation cache for ";
+	case SWIFT_NODE_TYPE_METADATA_INSTANTIATION_FUNCTION: return "type metadata instantiation function for ";
+	case SWIFT_NODE_TYPE_METADATA_COMPLETION_FUNCTION: return "type metadata completion function for ";
+	case SWIFT_NODE_TYPE_METADATA_SINGLETON_INITIALIZATION_CACHE: return "type metadata singleton initialization cache for ";
+	case SWIFT_NODE_TYPE_METADATA_DEMANGLING_CACHE: return "demangling cache variable for type metadata for ";
+	case SWIFT_NODE_CLASS_METADATA_BASE_OFFSET: return "class metadata base offset for ";
+	case SWIFT_NODE_METHOD_LOOKUP_FUNCTION: return "method lookup function for ";
+	case SWIFT_NODE_OBJC_METADATA_UPDATE_FUNCTION: return "ObjC metadata update function for ";
+	case SWIFT_NODE_OBJC_RESILIENT_CLASS_STUB: return "ObjC resilient class stub for ";
+	case SWIFT_NODE_FULL_OBJC_RESILIENT_CLASS_STUB: return "full ObjC resilient class stub for ";
+	case SWIFT_NODE_GENERIC_TYPE_METADATA_PATTERN: return "generic type metadata pattern for ";
+	case SWIFT_NODE_PROPERTY_DESCRIPTOR: return "property descriptor for ";
+	case SWIFT_NODE_REFLECTION_METADATA_FIELD_DESCRIPTOR: return "reflection metadata field descriptor ";
+	case SWIFT_NODE_REFLECTION_METADATA_BUILTIN_DESCRIPTOR: return "reflection metadata builtin descriptor ";
+	case SWIFT_NODE_PROTOCOL_CONFORMANCE_DESCRIPTOR: return "protocol conformance descriptor for ";
+	case SWIFT_NODE_PROTOCOL_SELF_CONFORMANCE_DESCRIPTOR: return "protocol self-conformance descriptor for ";
+	case SWIFT_NODE_MODULE_DESCRIPTOR: return "module descriptor ";
+	case SWIFT_NODE_EXTENSION_DESCRIPTOR: return "extension descriptor ";
+	case SWIFT_NODE_ANONYMOUS_DESCRIPTOR: return "anonymous descriptor ";
+	case SWIFT_NODE_VALUE_WITNESS_TABLE: return "value witness table for ";
+	case SWIFT_NODE_ENUM_CASE: return "enum case for ";
+	case SWIFT_NODE_PROTOCOL_WITNESS_TABLE: return "protocol witness table for ";
+	case SWIFT_NODE_PROTOCOL_WITNESS_TABLE_PATTERN: return "protocol witness table pattern for ";
+	case SWIFT_NODE_PROTOCOL_WITNESS_TABLE_ACCESSOR: return "protocol witness table accessor for ";
+	case SWIFT_NODE_GENERIC_PROTOCOL_WITNESS_TABLE: return "generic protocol witness table for ";
+	case SWIFT_NODE_GENERIC_PROTOCOL_WITNESS_TABLE_INSTANTIATION_FUNCTION: return "instantiation function for generic protocol witness table for ";
+	case SWIFT_NODE_RESILIENT_PROTOCOL_WITNESS_TABLE: return "resilient protocol witness table for ";
+	case SWIFT_NODE_CURRY_THUNK: return "curry thunk of ";
+	case SWIFT_NODE_DISPATCH_THUNK: return "dispatch thunk of ";
+	case SWIFT_NODE_METHOD_DESCRIPTOR: return "method descriptor for ";
+	case SWIFT_NODE_PROTOCOL_REQUIREMENTS_BASE_DESCRIPTOR: return "protocol requirements base descriptor for ";
+	case SWIFT_NODE_OBJC_ATTRIBUTE: return "@objc ";
+	case SWIFT_NODE_NON_OBJC_ATTRIBUTE: return "@nonobjc ";
+	case SWIFT_NODE_DYNAMIC_ATTRIBUTE: return "dynamic ";
+	case SWIFT_NODE_DIRECT_METHOD_REFERENCE_ATTRIBUTE: return "super ";
+	case SWIFT_NODE_MERGED_FUNCTION: return "merged ";
+	case SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_VAR: return "dynamically replaceable variable for ";
+	case SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_KEY: return "dynamically replaceable key for ";
+	case SWIFT_NODE_DYNAMICALLY_REPLACEABLE_FUNCTION_IMPL: return "dynamically replaceable thunk for ";
+	case SWIFT_NODE_IS_SERIALIZED: return "serialized";
+	case SWIFT_NODE_DYNAMIC_SELF: return "Self";
+	default: return NULL;
+	}
+}
+
+static const SwiftNode *swift5_print_node(SwiftPrinter *P, const SwiftNode *node, bool as_prefix) {
+	const char *prefix = swift5_node_prefix(node->kind);
+	if (prefix) {
+		swift5_puts(P, prefix);
+		if (node->kind != SWIFT_NODE_DYNAMIC_SELF) {
+			swift5_print_children(P, node, NULL);
+		}
+		return NULL;
+	}
+	switch (node->kind) {
+	case SWIFT_NODE_GLOBAL:
+	case SWIFT_NODE_TYPE_LIST:
+		swift5_print_children(P, node, NULL);
+		break;
+	case SWIFT_NODE_TYPE:
+		swift5_print_child(P, node, 0);
+		break;
+	case SWIFT_NODE_TYPE_MANGLING:
+		if (node->children.length == 2) {
+			swift5_print_entity_type(P, node, swift5_child(swift5_child(node, 1), 0));
+		} else {
+			swift5_print_child(P, node, 0);
+		}
+		break;
+	case SWIFT_NODE_SUFFIX:
+		swift5_puts(P, " with unmangled suffix \"");
+		swift5_put_n(P, node->text, node->size);
+		swift5_putc(P, '"');
+		break;
+	case SWIFT_NODE_NUMBER:
+		swift5_put_index(P, node->index);
+		break;
+	case SWIFT_NODE_MODULE:
+	case SWIFT_NODE_IDENTIFIER:
+	case SWIFT_NODE_BUILTIN_TYPE_NAME:
+	case SWIFT_NODE_DEPENDENT_GENERIC_PARAM_TYPE:
+		swift5_put_n(P, node->text, node->size);
+		break;
+	case SWIFT_NODE_INFIX_OPERATOR:
+	case SWIFT_NODE_PREFIX_OPERATOR:
+	case SWIFT_NODE_POSTFIX_OPERATOR:
+		swift5_put_n(P, node->text, node->size);
+		if (node->kind == SWIFT_NODE_INFIX_OPERATOR) {
+			swift5_puts(P, " infix");
+		} else if (node->kind == SWIFT_NODE_PREFIX_OPERATOR) {
+			swift5_puts(P, " prefix");
+		} else {
+			swift5_puts(P, " postfix");
+		}
+		break;
+	case SWIFT_NODE_LOCAL_DECL_NAME:
+		swift5_print_child(P, node, 1);
+		swift5_puts(P, " #");
+		swift5_put_index(P, swift5_child(node, 0)->index + 1);
+		break;
+	case SWIFT_NODE_PRIVATE_DECL_NAME: {
+		const SwiftNode *discriminator = swift5_child(node, 0);
+		if (node->children.length > 1) {
+			if (!P->simplify) {
+				swift5_putc(P, '(');
+			}
+			swift5_print_child(P, node, 1);
+			if (!P->simplify) {
+				swift5_puts(P, " in ");
+				swift5_put_n(P, discriminator->text, discriminator->size);
+				swift5_putc(P, ')');
+			}
+		} else if (!P->simplify) {
+			swift5_puts(P, "(in ");
+			swift5_put_n(P, discriminator->text, discriminator->size);
+			swift5_putc(P, ')');
+		}
+		break;
+	}
+	case SWIFT_NODE_CLASS:
+	case SWIFT_NODE_STRUCTURE:
+	case SWIFT_NODE_ENUM:
+	case SWIFT_NODE_PROTOCOL:
+	case SWIFT_NODE_TYPE_ALIAS:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_NONE, true, NULL, -1, NULL);
+	case SWIFT_NODE_EXTENSION:
+		if (!P->simplify) {
+			swift5_puts(P, "(extension in ");
+			swift5_print(P, swift5_child(node, 0), true);
+			swift5_puts(P, "):");
+		}
+		swift5_print_child(P, node, 1);
+		if (node->children.length == 3) {
+			swift5_print_child(P, node, 2);
+		}
+		break;
+	case SWIFT_NODE_FUNCTION:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_FUNCTION_STYLE, true, NULL, -1, NULL);
+	case SWIFT_NODE_ALLOCATOR: {
+		bool is_class = swift5_child(node, 0)->kind == SWIFT_NODE_CLASS;
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_FUNCTION_STYLE, false, is_class ? "__allocating_init" : "init", -1, NULL);
+	}
+	case SWIFT_NODE_CONSTRUCTOR:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_FUNCTION_STYLE, node->children.length > 2, "init", -1, NULL);
+	case SWIFT_NODE_DESTRUCTOR:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_NONE, false, "deinit", -1, NULL);
+	case SWIFT_NODE_DEALLOCATOR: {
+		bool is_class = swift5_child(node, 0)->kind == SWIFT_NODE_CLASS;
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_NONE, false, is_class ? "__deallocating_deinit" : "deinit", -1, NULL);
+	}
+	case SWIFT_NODE_IVAR_INITIALIZER:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_NONE, false, "__ivar_initializer", -1, NULL);
+	case SWIFT_NODE_IVAR_DESTROYER:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_NONE, false, "__ivar_destroyer", -1, NULL);
+	case SWIFT_NODE_INITIALIZER:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_NONE, false, "variable initialization expression", -1, NULL);
+	case SWIFT_NODE_DEFAULT_ARGUMENT_INITIALIZER:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_NONE, false, "default argument ", swift5_child(node, 1)->index, NULL);
+	case SWIFT_NODE_EXPLICIT_CLOSURE:
+	case SWIFT_NODE_IMPLICIT_CLOSURE: {
+		const char *name = node->kind == SWIFT_NODE_EXPLICIT_CLOSURE ? "closure #" : "implicit closure #";
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_FUNCTION_STYLE, false, name, swift5_child(node, 1)->index + 1, NULL);
+	}
+	case SWIFT_NODE_VARIABLE:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_WITH_COLON, true, NULL, -1, NULL);
+	case SWIFT_NODE_SUBSCRIPT:
+		return swift5_print_entity(P, node, as_prefix, SWIFT_TYPE_PR_FUNCTION_STYLE, false, NULL, -1, "subscript");
+	case SWIFT_NODE_GETTER:
+	case SWIFT_NODE_GLOBAL_GETTER:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "getter");
+	case SWIFT_NODE_SETTER:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "setter");
+	case SWIFT_NODE_MODIFY_ACCESSOR:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "modify");
+	case SWIFT_NODE_READ_ACCESSOR:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "read");
+	case SWIFT_NODE_INIT_ACCESSOR:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "init");
+	case SWIFT_NODE_WILL_SET:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "willset");
+	case SWIFT_NODE_DID_SET:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "didset");
+	case SWIFT_NODE_MATERIALIZE_FOR_SET:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "materializeForSet");
+	case SWIFT_NODE_UNSAFE_ADDRESSOR:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "unsafeAddressor");
+	case SWIFT_NODE_UNSAFE_MUTABLE_ADDRESSOR:
+		return swift5_print_abstract_storage(P, swift5_child(node, 0), as_prefix, "unsafeMutableAddressor");
+	case SWIFT_NODE_TUPLE:
+		swift5_putc(P, '(');
+		swift5_print_children(P, node, ", ");
+		swift5_putc(P, ')');
+		break;
+	case SWIFT_NODE_TUPLE_ELEMENT: {
+		const SwiftNode *label = swift5_child_of_kind(node, SWIFT_NODE_TUPLE_ELEMENT_NAME);
+		if (label) {
+			swift5_put_n(P, label->text, label->size);
+			swift5_puts(P, ": ");
+		}
+		swift5_print(P, swift5_child_of_kind(node, SWIFT_NODE_TYPE), false);
+		if (swift5_child_of_kind(node, SWIFT_NODE_VARIADIC_MARKER)) {
+			swift5_puts(P, "...");
+		}
+		break;
+	}
+	case SWIFT_NODE_LABEL_LIST:
+		break;
+	case SWIFT_NODE_FUNCTION_TYPE:
+	case SWIFT_NODE_NOESCAPE_FUNCTION_TYPE:
+		swift5_print_function_type(P, NULL, node);
+		break;
+	case SWIFT_NODE_THIN_FUNCTION_TYPE:
+	case SWIFT_NODE_C_FUNCTION_POINTER:
+	case SWIFT_NODE_OBJC_BLOCK:
+	case SWIFT_NODE_AUTO_CLOSURE_TYPE:
+	case SWIFT_NODE_ESCAPING_AUTO_CLOSURE_TYPE:
+		swift5_puts(P, swift5_function_convention(node->kind));
+		swift5_print_function_type(P, NULL, node);
+		break;
+	case SWIFT_NODE_RETURN_TYPE:
+		swift5_puts(P, " -> ");
+		swift5_print_children(P, node, NULL);
+		break;
+	case SWIFT_NODE_BOUND_GENERIC_CLASS:
+	case SWIFT_NODE_BOUND_GENERIC_STRUCTURE:
+	case SWIFT_NODE_BOUND_GENERIC_ENUM:
+	case SWIFT_NODE_BOUND_GENERIC_PROTOCOL:
+	case SWIFT_NODE_BOUND_GENERIC_TYPE_ALIAS:
+		swift5_print_bound_generic(P, node);
+		break;
+	case SWIFT_NODE_DEPENDENT_GENERIC_TYPE: {
+		const SwiftNode *dependent = swift5_child(node, 1);
+		swift5_print_child(P, node, 0);
+		if (swift5_need_space_before_type(dependent)) {
+			swift5_putc(P, ' ');
+		}
+		swift5_print_child(P, node, 1);
+		break;
+	}
+	case SWIFT_NODE_DEPENDENT_GENERIC_SIGNATURE:
+		swift5_print_generic_signature(P, node);
+		break;
+	case SWIFT_NODE_DEPENDENT_GENERIC_CONFORMANCE_REQUIREMENT:
+	case SWIFT_NODE_DEPENDENT_GENERIC_SAME_TYPE_REQUIREMENT:
+		swift5_print_child(P, node, 0);
+		swift5_puts(P, node->kind == SWIFT_NODE_DEPENDENT_GENERIC_SAME_TYPE_REQUIREMENT ? " == " : ": ");
+		swift5_print_child(P, node, 1);
+		break;
+	case SWIFT_NODE_DEPENDENT_GENERIC_LAYOUT_REQUIREMENT:
+		swift5_print_layout_requirement(P, node);
+		break;
+	case SWIFT_NODE_DEPENDENT_MEMBER_TYPE:
+		swift5_print_child(P, node, 0);
+		swift5_putc(P, '.');
+		swift5_print_child(P, node, 1);
+		break;
+	case SWIFT_NODE_DEPENDENT_ASSOCIATED_TYPE_REF:
+		swift5_print_child(P, node, 0);
+		break;
+	case SWIFT_NODE_METATYPE:
+	case SWIFT_NODE_EXISTENTIAL_METATYPE: {
+		const SwiftNode *type = swift5_child(swift5_child(node, 0), 0);
+		if (!type) {
+			P->error = true;
+			break;
+		}
+		swift5_print_with_parens(P, type);
+		bool existential = node->kind == SWIFT_NODE_METATYPE &&
+			(type->kind == SWIFT_NODE_EXISTENTIAL_METATYPE || type->kind == SWIFT_NODE_PROTOCOL_LIST ||
+				type->kind == SWIFT_NODE_PROTOCOL_LIST_WITH_CLASS || type->kind == SWIFT_NODE_PROTOCOL_LIST_WITH_ANY_OBJECT);
+		swift5_puts(P, existential ? ".Protocol" : ".Type");
+		break;
+	}
+	case SWIFT_NODE_PROTOCOL_LIST: {
+		const SwiftNode *types = swift5_child(node, 0);
+		if (!types || !types->children.length) {
+			swift5_puts(P, "Any");
+		} else {
+			swift5_print_children(P, types, " & ");
+		}
+		break;
+	}
+	case SWIFT_NODE_PROTOCOL_LIST_WITH_CLASS:
+		swift5_print_child(P, node, 1);
+		swift5_puts(P, " & ");
+		swift5_print_children(P, swift5_child(swift5_child(node, 0), 0), " & ");
+		break;
+	case SWIFT_NODE_PROTOCOL_LIST_WITH_ANY_OBJECT: {
+		const SwiftNode *types = swift5_child(swift5_child(node, 0), 0);
+		if (types && types->children.length) {
+			swift5_print_children(P, types, " & ");
+			swift5_puts(P, " & ");
+		}
+		if (!P->simplify) {
+			swift5_puts(P, "Swift.");
+		}
+		swift5_puts(P, "AnyObject");
+		break;
+	}
+	case SWIFT_NODE_PROTOCOL_CONFORMANCE:
+		swift5_print_child(P, node, 0);
+		swift5_puts(P, " : ");
+		swift5_print_child(P, node, 1);
+		swift5_puts(P, " in ");
+		swift5_print_child(P, node, 2);
+		break;
+	case SWIFT_NODE_FIELD_OFFSET:
+		swift5_puts(P, swift5_child(node, 0)->index ? "direct " : "indirect ");
+		swift5_puts(P, "field offset for ");
+		swift5_print_child(P, node, 1);
+		break;
+	case SWIFT_NODE_LAZY_PROTOCOL_WITNESS_TABLE_ACCESSOR:
+	case SWIFT_NODE_LAZY_PROTOCOL_WITNESS_TABLE_CACHE_VARIABLE:
+		swift5_puts(P, node->kind == SWIFT_NODE_LAZY_PROTOCOL_WITNESS_TABLE_ACCESSOR ? "lazy protocol witness table accessor for type " : "lazy protocol witness table cache variable for type ");
+		swift5_print_child(P, node, 0);
+		swift5_puts(P, " and conformance ");
+		swift5_print_child(P, node, 1);
+		break;
+	case SWIFT_NODE_ASSOCIATED_TYPE_METADATA_ACCESSOR:
+		swift5_puts(P, "associated type metadata accessor for ");
+		swift5_print_child(P, node, 1);
+		swift5_puts(P, " in ");
+		swift5_print_child(P, node, 0);
+		break;
+	case SWIFT_NODE_PROTOCOL_WITNESS:
+		swift5_puts(P, "protocol witness for ");
+		swift5_print_child(P, node, 1);
+		swift5_puts(P, " in conformance ");
+		swift5_print_child(P, node, 0);
+		break;
+	case SWIFT_NODE_VTABLE_THUNK:
+		swift5_puts(P, "vtable thunk for ");
+		swift5_print_child(P, node, 1);
+		swift5_puts(P, " dispatching to ");
+		swift5_print_child(P, node, 0);
+		break;
+	case SWIFT_NODE_PARTIAL_APPLY_FORWARDER:
+	case SWIFT_NODE_PARTIAL_APPLY_OBJC_FORWARDER:
+		swift5_puts(P, P->simplify ? "partial apply" : node->kind == SWIFT_NODE_PARTIAL_APPLY_FORWARDER ? "partial apply forwarder"
+													       : "partial apply ObjC forwarder");
+		if (node->children.length) {
+			swift5_puts(P, " for ");
+			swift5_print_children(P, node, NULL);
+		}
+		break;
+	case SWIFT_NODE_GENERIC_SPECIALIZATION:
+		swift5_print_specialization(P, node, "generic specialization");
+		break;
+	case SWIFT_NODE_GENERIC_SPECIALIZATION_NOT_RE_ABSTRACTED:
+		swift5_print_specialization(P, node, "generic not re-abstracted specialization");
+		break;
+	case SWIFT_NODE_GENERIC_SPECIALIZATION_PARAM:
+		swift5_print_child(P, node, 0);
+		break;
+	default:
+		// operands that are only printed by their parents
+		P->error = true;
+		break;
+	}
+	return NULL;
+}
+
+static const SwiftNode *swift5_print(SwiftPrinter *P, const SwiftNode *node, bool as_prefix) {
+	if (!node || P->error || P->depth >= SWIFT5_MAX_DEPTH || P->out.len > SWIFT5_MAX_OUTPUT) {
+		P->error = true;
+		return NULL;
+	}
+	P->depth++;
+	const SwiftNode *postfix = swift5_print_node(P, node, as_prefix);
+	P->depth--;
+	return postfix;
+}
+
+/* ----------------------------------------------------------------------------
+ * Entry points
+ * --------------------------------------------------------------------------*/
+
+/**
+ * \brief Returns the size of the Swift 4.2+ prefix of \p sym, 0 for other symbols.
+ */
+size_t swift_v5_prefix_size(const char *sym) {
+	size_t skip = sym[0] == '_' ? 1 : 0;
+	if (sym[skip] == '$' && (sym[skip + 1] == 's' || sym[skip + 1] == 'S' || sym[skip + 1] == 'e')) {
+		return skip + 2;
+	}
+	return 0;
+}
+
+/**
+ * \brief Demangles a Swift 4.2+ symbol; the whole symbol must be consumed.
+ */
+char *swift_demangle_v5(const char *sym, RzDemangleOpts opts) {
+	size_t prefix = swift_v5_prefix_size(sym);
+	if (!prefix) {
+		return NULL;
+	}
+	SwiftDemangler d = { 0 };
+	d.beg = d.cur = sym + prefix;
+	d.end = d.beg + strlen(d.beg);
+	dem_string_init(&d.scratch);
+
+	char *result = NULL;
+	SwiftNode *global = swift5_parse(&d);
+	if (global && !d.error) {
+		SwiftPrinter P = { 0 };
+		dem_string_init(&P.out);
+		P.simplify = opts & RZ_DEMANGLE_OPT_SIMPLIFY;
+		swift5_print(&P, global, false);
+		if (!P.error && P.out.len) {
+			result = dem_string_drain_no_free(&P.out);
+		}
+		dem_string_deinit(&P.out);
+	}
+	dem_string_deinit(&d.scratch);
+	swift5_arena_fini(&d);
+	return result;
+}
@@ -1,65 +1,107 @@
 // SPDX-FileCopyrightText: 2015-2019 pancake <pancake@nopcode.org>
 // SPDX-License-Identifier: MIT
 /* work-in-progress reverse engineered swift-demangler in C */
-#include "demangler_util.h"
-#include <rz_libdemangle.h>
+#include "swift.h"
 
-struct Type {
-	const char *code;
-	const char *name;
-};
+/*
+ * The known codes are matched with a switch on their first bytes, which
+ * keeps the first-match order of the original tables: longer codes that
+ * share a prefix are tested first.
+ */
 
-static struct Type types[] = {
-	/* basic types */
-	{ "Sb", "Bool" },
-	{ "SS", "String" },
-	{ "FS", "String" },
-	{ "GV", "mutableAddressor" }, // C_ARGC
-	{ "Ss", "generic" }, // C_ARGC
-	{ "S_", "Generic" }, // C_ARGC
-	{ "TF", "GenericSpec" }, // C_ARGC
-	{ "Ts", "String" }, // C_ARGC
-	{ "Sa", "Array" },
-	{ "Si", "Swift.Int" },
-	{ "Sf", "Float" },
-	{ "Sb", "Bool" },
-	{ "Su", "UInt" },
-	{ "SQ", "ImplicitlyUnwrappedOptional" },
-	{ "Sc", "UnicodeScalar" },
-	{ "Sd", "Double" },
-	{ "SS", "String" }, // Swift.String
-	/* builtin */
-	{ "Bi1", "Builtin.Int1" },
-	{ "Bp", "Builtin.RawPointer" },
-	{ "Bw", "Builtin.Word" }, // isASCII ?
-	/* eol */
-	{ NULL, NULL }
-};
+static const char *resolve_hit(const char *s, size_t len, const char *name, const char **bar) {
+	if (bar) {
+		*bar = name;
+	}
+	return s + len;
+}
 
-static struct Type metas[] = {
-	/* attributes */
-	{ "FC", "ClassFunc" },
-	{ "S0_FT", "?" },
-	{ "RxC", ".." },
-	{ "S0", "self" },
-	{ "U__FQ_T_", "<A>(A)" },
-	{ "ToFC", "@objc class func" },
-	{ "ToF", "@objc func" },
-	/* eol */
-	{ NULL, NULL }
-};
+/* basic and builtin types */
+static const char *resolve_type(const char *s, const char **bar) {
+	if (!s || !*s) {
+		return NULL;
+	}
+	switch (s[0]) {
+	case 'S':
+		switch (s[1]) {
+		case 'b': return resolve_hit(s, 2, "Bool", bar);
+		case 'S': return resolve_hit(s, 2, "String", bar);
+		case 's': return resolve_hit(s, 2, "generic", bar); // C_ARGC
+		case '_': return resolve_hit(s, 2, "Generic", bar); // C_ARGC
+		case 'a': return resolve_hit(s, 2, "Array", bar);
+		case 'i': return resolve_hit(s, 2, "Swift.Int", bar);
+		case 'f': return resolve_hit(s, 2, "Float", bar);
+		case 'u': return resolve_hit(s, 2, "UInt", bar);
+		case 'Q': return resolve_hit(s, 2, "ImplicitlyUnwrappedOptional", bar);
+		case 'c': return resolve_hit(s, 2, "UnicodeScalar", bar);
+		case 'd': return resolve_hit(s, 2, "Double", bar);
+		default: return NULL;
+		}
+	case 'F':
+		return s[1] == 'S' ? resolve_hit(s, 2, "String", bar) : NULL;
+	case 'G':
+		return s[1] == 'V' ? resolve_hit(s, 2, "mutableAddressor", bar) : NULL; // C_ARGC
+	case 'T':
+		switch (s[1]) {
+		case 'F': return resolve_hit(s, 2, "GenericSpec", bar); // C_ARGC
+		case 's': return resolve_hit(s, 2, "String", bar); // C_ARGC
+		default: return NULL;
+		}
+	case 'B':
+		switch (s[1]) {
+		case 'i': return s[2] == '1' ? resolve_hit(s, 3, "Builtin.Int1", bar) : NULL;
+		case 'p': return resolve_hit(s, 2, "Builtin.RawPointer", bar);
+		case 'w': return resolve_hit(s, 2, "Builtin.Word", bar); // isASCII ?
+		default: return NULL;
+		}
+	default:
+		return NULL;
+	}
+}
 
-static struct Type flags[] = {
-	//{ "f", "function" }, // this is not an accessor
-	{ "s", "setter" },
-	{ "g", "getter" },
-	{ "m", "method" }, // field?
-	{ "d", "destructor" },
-	{ "D", "deallocator" },
-	{ "c", "constructor" },
-	{ "C", "allocator" },
-	{ NULL, NULL }
-};
+/* attributes */
+static const char *resolve_meta(const char *s, const char **bar) {
+	if (!s || !*s) {
+		return NULL;
+	}
+	switch (s[0]) {
+	case 'F':
+		return s[1] == 'C' ? resolve_hit(s, 2, "ClassFunc", bar) : NULL;
+	case 'S':
+		if (s[1] != '0') {
+			return NULL;
+		}
+		return !strncmp(s + 2, "_FT", 3) ? resolve_hit(s, 5, "?", bar) : resolve_hit(s, 2, "self", bar);
+	case 'R':
+		return s[1] == 'x' && s[2] == 'C' ? resolve_hit(s, 3, "..", bar) : NULL;
+	case 'U':
+		return !strncmp(s + 1, "__FQ_T_", 7) ? resolve_hit(s, 8, "<A>(A)", bar) : NULL;
+	case 'T':
+		if (s[1] != 'o' || s[2] != 'F') {
+			return NULL;
+		}
+		return s[3] == 'C' ? resolve_hit(s, 4, "@objc class func", bar) : resolve_hit(s, 3, "@objc func", bar);
+	default:
+		return NULL;
+	}
+}
+
+/* accessors; `f` is a function, not an accessor */
+static const char *resolve_flag(const char *s, const char **bar) {
+	if (!s) {
+		return NULL;
+	}
+	switch (s[0]) {
+	case 's': return resolve_hit(s, 1, "setter", bar);
+	case 'g': return resolve_hit(s, 1, "getter", bar);
+	case 'm': return resolve_hit(s, 1, "method", bar); // field?
+	case 'd': return resolve_hit(s, 1, "destructor", bar);
+	case 'D': return resolve_hit(s, 1, "deallocator", bar);
+	case 'c': return resolve_hit(s, 1, "constructor", bar);
+	case 'C': return resolve_hit(s, 1, "allocator", bar);
+	default: return NULL;
+	}
+}
 
 static const char *getnum(const char *n, int *num) {
 	if (num && *n) {
@@ -80,31 +122,18 @@ static const char *numpos(const char *n) {
 
 static char *getstring(const char *s, int len) {
 	if (len < 1) {
-		return strdup("");
+		return dem_strdup("");
 	}
-	char *buf = malloc(len + 1);
+	char *buf = dem_malloc(len + 1);
 	memcpy(buf, s, len);
 	buf[len] = 0;
 	return buf;
 }
 
-static const char *resolve(struct Type *t, const char *foo, const char **bar) {
-	if (!t || !foo || !*foo) {
-		return NULL;
-	}
-	for (; t[0].code; t++) {
-		int len = strlen(t[0].code);
-		if (!strncmp(foo, t[0].code, len)) {
-			if (bar) {
-				*bar = t[0].name;
-			}
-			return foo + len;
-		}
-	}
-	return NULL;
-}
-
-DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opts) {
+/**
+ * \brief Demangles the pre-Swift 4 `_T` mangling with a best-effort matcher.
+ */
+char *swift_demangle_legacy(const char *s) {
 #define STRCAT_BOUNDS(x) \
 	if (((x) + 2 + strlen(out)) > sizeof(out)) \
 		break;
@@ -121,10 +150,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 	}
 
 	if (*s != 'T' && strncmp(s, "_T", 2) && strncmp(s, "__T", 3)) {
-		// modern swift symbols
-		if (strncmp(s, "$s", 2)) {
-			return NULL;
-		}
+		return NULL;
 	}
 
 	if (!strncmp(s, "__", 2)) {
@@ -236,14 +262,14 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 				str = getstring(q, len);
 				strcat(out, str);
 			}
-			free(str);
+			dem_free(str);
 		}
 		if (q > q_end) {
 			return 0;
 		}
-		p = resolve(flags, q, &attr);
+		p = resolve_flag(q, &attr);
 		if (!p && ((*q == 'U') || (*q == 'R'))) {
-			p = resolve(metas, q, &attr);
+			p = resolve_meta(q, &attr);
 			if (attr && *q == 'R') {
 				attr = NULL;
 				q += 3;
@@ -254,13 +280,13 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 			int len = 0;
 			char *name = NULL;
 			/* get field name and then type */
-			resolve(types, q, &attr);
+			resolve_type(q, &attr);
 
 			q = getnum(q + 1, &len);
 			if (len < strlen(q)) {
-				resolve(types, q + len, &attr2);
+				resolve_type(q + len, &attr2);
 			} else {
-				resolve(types, q, &attr2);
+				resolve_type(q, &attr2);
 			}
 			name = getstring(q, len);
 			do {
@@ -280,7 +306,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 					strcat(out, attr2);
 				}
 			} while (0);
-			free(name);
+			dem_free(name);
 			if (*q == '_') {
 				strcat(out, " -> ()");
 			}
@@ -297,7 +323,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 					const char *Q = getnum(q + 1, &n);
 					char *res = getstring(Q, n);
 					strcat(out, res);
-					free(res);
+					dem_free(res);
 					q = Q + n + 1;
 					continue;
 				} break;
@@ -308,7 +334,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 						const char *Q = getnum(q + 4, &n);
 						char *res = getstring(Q, n);
 						strcat(out, res);
-						free(res);
+						dem_free(res);
 						q = Q + n + 1;
 						continue;
 					}
@@ -338,7 +364,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 							const char *Q = getnum(q + 2, &n);
 							char *res = getstring(Q, n);
 							strcat(out, res);
-							free(res);
+							dem_free(res);
 							q = Q + n + 1;
 							continue;
 						}
@@ -348,31 +374,31 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 				case 'B':
 				case 'T':
 				case 'I':
-					p = resolve(types, q + 0, &attr); // type
+					p = resolve_type(q + 0, &attr); // type
 					if (p && *p && IS_DIGIT(p[1])) {
 						p--;
 					}
 					break;
 				case 'F':
 					strcat(out, " ()");
-					p = resolve(types, (strlen(q) > 2) ? q + 3 : "", &attr); // type
+					p = resolve_type((strlen(q) > 2) ? q + 3 : "", &attr); // type
 					break;
 				case 'G':
 					q += 2;
 					if (!strncmp(q, "_V", 2)) {
 						q += 2;
 					}
-					p = resolve(types, q, &attr); // type
+					p = resolve_type(q, &attr); // type
 					break;
 				case 'V':
-					p = resolve(types, q + 1, &attr); // type
+					p = resolve_type(q + 1, &attr); // type
 					break;
 				case '_':
 					// it's return value time!
-					p = resolve(types, q + 1, &attr); // type
+					p = resolve_type(q + 1, &attr); // type
 					break;
 				default:
-					p = resolve(types, q, &attr); // type
+					p = resolve_type(q, &attr); // type
 				}
 
 				if (p) {
@@ -390,7 +416,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 								}
 								break;
 							}
-							resolve(types, *q ? q + 1 : q, &attr); // type
+							resolve_type(*q ? q + 1 : q, &attr); // type
 							if (attr) {
 								strcat(out, " -> ");
 								STRCAT_BOUNDS(strlen(attr));
@@ -436,7 +462,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 								strcat(out, attr);
 							}
 						}
-						free(s);
+						dem_free(s);
 					} else {
 						if (attr) {
 							strcat(out, " -> ");
@@ -472,7 +498,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 			strcat(out, tail);
 		}
 #if 1
-		char *p, *outstr = strdup(out);
+		char *p, *outstr = dem_strdup(out);
 		p = outstr;
 		for (;;) {
 			p = strstr(p, ")(");
@@ -130,7 +130,7 @@ static int run_csv_tests(void) {
 		char *demangled = csv_parse_field(&cursor);
 		char *expected = (demangled && demangled[0]) ? demangled : NULL;
 
-		char *result = libdemangle_handler_cxx(mangled, default_opts);
+		char *result = libdemangle_handler_cxx(mangled, default_opts | RZ_DEMANGLE_OPT_CXX_V2_FALLBACK | RZ_DEMANGLE_OPT_CXX_TYPE_FALLBACK);
 		test_count++;
 
 		int passed = 0;
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+
+mu_demangle_tests(d,
+	mu_demangle_test("_D8demangle4testFZv", "void demangle.test()"),
+	mu_demangle_test("_D8demangle4testFaZv", "void demangle.test(char)"),
+	mu_demangle_test("_D8demangle4testFbZv", "void demangle.test(bool)"),
+	mu_demangle_test("_D8demangle4testFdZv", "void demangle.test(double)"),
+	mu_demangle_test("_D8demangle4testFiZv", "void demangle.test(int)"),
+	mu_demangle_test("_D8demangle4testFmZv", "void demangle.test(ulong)"),
+	mu_demangle_test("_D8demangle4testFwZv", "void demangle.test(dchar)"),
+	mu_demangle_test("_D8demangle4testFxaZv", "void demangle.test(const(char))"),
+	mu_demangle_test("_D8demangle4testFyaZv", "void demangle.test(immutable(char))"),
+	mu_demangle_test("_D8demangle4testFOaZv", "void demangle.test(shared(char))"),
+	mu_demangle_test("_D8demangle4testFNgaZv", "void demangle.test(inout(char))"),
+	mu_demangle_test("_D8demangle4testFAiZv", "void demangle.test(int[])"),
+	mu_demangle_test("_D8demangle4testFAyaZv", "void demangle.test(immutable(char)[])"),
+	mu_demangle_test("_D8demangle4testFG42iZv", "void demangle.test(int[42])"),
+	mu_demangle_test("_D8demangle4testFHiiZv", "void demangle.test(int[int])"),
+	mu_demangle_test("_D8demangle4testFPiZv", "void demangle.test(int*)"),
+	mu_demangle_test("_D8demangle4testFPFZiZv", "void demangle.test(int function()*)"),
+	mu_demangle_test("_D8demangle4testFDFZaZv", "void demangle.test(char delegate())"),
+	mu_demangle_test("_D8demangle4testFNhG16gZv", "void demangle.test(__vector(byte[16]))"),
+	mu_demangle_test("_D8demangle4testFC6ObjectZv", "void demangle.test(Object)"),
+	mu_demangle_test("_D8demangle4testFS8demangle6StructZv", "void demangle.test(demangle.Struct)"),
+	mu_demangle_test("_D8demangle4testFJiZv", "void demangle.test(out int)"),
+	mu_demangle_test("_D8demangle4testFKiZv", "void demangle.test(ref int)"),
+	mu_demangle_test("_D8demangle4testFLiZv", "void demangle.test(lazy int)"),
+	mu_demangle_test("_D8demangle4testFiXv", "void demangle.test(int...)"),
+	mu_demangle_test("_D8demangle4testFiYv", "void demangle.test(int, ...)"),
+	mu_demangle_test("_D8demangle4testFiiZv", "void demangle.test(int, int)"),
+	mu_demangle_test("_D8demangle4testFNaNbNiNfZv", "pure nothrow @nogc @safe void demangle.test()"),
+	mu_demangle_test("_D8demangle4testUZv", "extern (C) void demangle.test()"),
+	mu_demangle_test("_D8demangle4testRZv", "extern (C++) void demangle.test()"),
+	mu_demangle_test("_D8demangle4test6__ctorMFZv", "void demangle.test.__ctor()"),
+	mu_demangle_test("_D8demangle4test4funcMxFZv", "const void demangle.test.func()"),
+	mu_demangle_test("_D8demangle4test4funcMOxFZv", "shared const void demangle.test.func()"),
+	mu_demangle_test("_D8demangle__T4testTiTaZ4testFZv", "void demangle.test!(int, char).test()"),
+	mu_demangle_test("_D8demangle__T4testVii123Z4testFZv", "void demangle.test!(123).test()"),
+	mu_demangle_test("_D8demangle__T4testVbi1Z4testFZv", "void demangle.test!(true).test()"),
+	mu_demangle_test("_D8demangle__T4testVai65Z4testFZv", "void demangle.test!('A').test()"),
+	mu_demangle_test("_D8demangle__T4testVAyaa3_616263Z4testFZv", "void demangle.test!(\"abc\").test()"),
+	mu_demangle_test("_D8demangle__T4testVAiA3i1i2i3Z4testFZv", "void demangle.test!([1, 2, 3]).test()"),
+	mu_demangle_test("_D8demangle__T4testVHiiA2i1i2i3i4Z4testFZv", "void demangle.test!([1:2, 3:4]).test()"),
+	mu_demangle_test("_D8demangle__T4testVS8demangle1SS2i1a3_616263Z4testFZv", "void demangle.test!(demangle.S(1, \"abc\")).test()"),
+	mu_demangle_test("_D8demangle__T4testVdeNINFZ4testFZv", "void demangle.test!(-real.infinity).test()"),
+	mu_demangle_test("_D8demangle__T4testVfe1P1Z4testFZv", "void demangle.test!(0x1p+1f).test()"),
+	mu_demangle_test("_D8demangle__T4testS8demangle3fooZ4testFZv", "void demangle.test!(demangle.foo).test()"),
+	mu_demangle_test("_D3std5stdio__T7writelnTAyaZQnFNfQjZv", "@safe void std.stdio.writeln!(immutable(char)[]).writeln(immutable(char)[])"),
+	mu_demangle_test("_D3std5array__T8AppenderTAyaZQo6appendMFNaNbNfxwZv", "pure nothrow @safe void std.array.Appender!(immutable(char)[]).Appender.append(const(dchar))"),
+	mu_demangle_test("_D4core4stdc5errnoQgFZi", "int core.stdc.errno.errno()"),
+	mu_demangle_test("_D3foo3bar6__initZ", "foo.bar.__init"),
+	mu_demangle_test("_D3foo12__ModuleInfoZ", "foo.__ModuleInfo"),
+	mu_demangle_test("_D3foo3barFZ__T3bazTiZQhFZv", "void foo.bar().baz!(int).baz()"),
+	mu_demangle_test("_D1a1bi", "int a.b"),
+	mu_demangle_test("_D1a1bFZ1ci", "int a.b().c"),
+	mu_demangle_test("_D2rt6dmain212_d_run_main2UAAamPUQgZiZ6runAllMFZv", "void rt.dmain2._d_run_main2(char[][], ulong, extern (C) int function(char[][])*).runAll()"),
+	mu_demangle_test("_D3foo3barFS3foo__T3BazTiTaZQkAQuAQeAQeZv", "void foo.bar(foo.Baz!(int, char).Baz!(int, char), foo.Baz!(int, char).Baz!(int, char)[], foo.Baz!(int, char).Baz!(int, char)[][], foo.Baz!(int, char).Baz!(int, char)[][][])"),
+	// invalid symbols
+	mu_demangle_test("main", NULL),
+	mu_demangle_test("_D", NULL),
+	mu_demangle_test("_D8demangle4testFQzZv", NULL),
+	mu_demangle_test("_D3fooQa", NULL),
+	mu_demangle_test("_D3std5array__T8AppenderTAyaZQo6appendMFNaNbQfxwZv", NULL),
+	mu_demangle_test("_D3foo3barFZ__TQbazTiZQhFZv", NULL),
+	mu_demangle_test("_D3foo__TQbarTS3foo3bazZQrFZv", NULL),
+	mu_demangle_test("_D3foo3barFNjNkPiZQi", NULL),
+	mu_demangle_test("_D1a1bFZQci", NULL),
+	mu_demangle_test("_D1a1bFQbNiZ4implFNaNfZv", NULL),
+	// end
+);
+
+mu_main2(d);
@@ -356,6 +356,11 @@ mu_demangle_tests(java,
 	mu_demangle_test("Lorg/json/JSONTokener;", "org.json.JSONTokener"),
 	mu_demangle_test("Lsome/jar/Fake<[BCDFIJSZLjava/lang/String;Ljava/lang/String;>", "some.jar.Fake<byte[], char, double, float, int, long, short, boolean, String, String>"),
 	mu_demangle_test("Ljava/io/BufferedReader;.<init>(Ljava/io/Reader;)V", "void java.io.BufferedReader.<init>(java.io.Reader)"),
+	mu_demangle_test("Ljava/lang/StringBuilder;.append(Ljava/lang/CharSequence;II)Ljava/lang/StringBuilder;", "StringBuilder StringBuilder.append(java.lang.CharSequence, int, int)"),
+	mu_demangle_test("Ljava/util/List<Ljava/lang/String;>;.get(I)Ljava/lang/Object;", "Object java.util.List<String>.get(int)"),
+	mu_demangle_test("sort(Ljava/util/List<*>;[I)V", "void sort(java.util.List<T>, int[])"),
+	mu_demangle_test("Ljava/lang/Stringy;", "Stringy"),
+	mu_demangle_test("Ljava/lang/java/lang/String;", "java.lang.String"),
 	// end
 );
 
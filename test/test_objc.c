@@ -27,6 +27,12 @@ mu_demangle_tests(objc,
 	mu_demangle_test("___25-", NULL),
 	mu_demangle_test("___25-[", NULL),
 	mu_demangle_test("_Z11GetFileNamePc", "GetFileName(char*)"),
+	mu_demangle_test("__Z11GetFileNamePc", "GetFileName(char*)"),
+	mu_demangle_test("saveOnQuitOverlay__Fv", NULL),
+	mu_demangle_test("_OBJC_IVAR_$_Employee", NULL),
+	mu_demangle_test("_OBJC_IVAR_$_Employee._name_block_invoke", "field int Employee::_name block_invoke"),
+	mu_demangle_test("+[NSString stringWithFormat:]", "static int NSString::stringWithFormat(int)"),
+	mu_demangle_test("_c_NSString__stringWithFormat_", "static int NSString::stringWithFormat(int)"),
 	// end
 );
 
@@ -27,6 +27,9 @@ mu_demangle_tests(pascal,
 	mu_demangle_test("WRPR_$SYSTEM_$$_TINTERFACEDOBJECT_$_IUNKNOWN_$_0_$_SYSTEM$_$TINTERFACEDOBJECT_$__$$_QUERYINTERFACE$TGUID$formal$$LONGINT", "unit wrpr.system.tinterfacedobject.iunknown.0.system tinterfacedobject.queryinterface(tguid,formal)longint"),
 	mu_demangle_test("WRPR_$SYSTEM_$$_TINTERFACEDOBJECT_$_IUNKNOWN_$_1_$_SYSTEM$_$TINTERFACEDOBJECT_$__$$__ADDREF$$LONGINT", "unit wrpr.system.tinterfacedobject.iunknown.1.system tinterfacedobject._addref()longint"),
 	mu_demangle_test("WRPR_$SYSTEM_$$_TINTERFACEDOBJECT_$_IUNKNOWN_$_2_$_SYSTEM$_$TINTERFACEDOBJECT_$__$$__RELEASE$$LONGINT", "unit wrpr.system.tinterfacedobject.iunknown.2.system tinterfacedobject._release()longint"),
+	mu_demangle_test("SYSUTILS$_$TEncoding_$__$$_GetBytes$UnicodeString$$TBytes", "unit sysutils tencoding.getbytes(unicodestring)tbytes"),
+	mu_demangle_test("SYSTEM_$$_Move$formal$formal$Int64", "unit system move(formal,formal,int64)"),
+	mu_demangle_test("OUTPUT_$$_SQUARE$SMALL-INT", NULL),
 	// end
 );
 
@@ -30,6 +30,9 @@ mu_demangle_tests(rust,
 	mu_demangle_test("_ZN28_$u7b$$u7b$closure$u7d$$u7d$E", "{{closure}}"),
 	mu_demangle_test("_ZN15__STATIC_FMTSTRE", "__STATIC_FMTSTR"),
 	mu_demangle_test("_ZN71_$LT$Test$u20$$u2b$$u20$$u27$static$u20$as$u20$foo..Bar$LT$Test$GT$$GT$3barE", "<Test + 'static as foo::Bar<Test>>::bar"),
+	mu_demangle_test("_ZN18_$GT$LT$u3b1$LT$C$E", ">LTαLT,"),
+	mu_demangle_test("_ZN16$u27$LT$u27$ufmtE", "'LT'ufmt"),
+	mu_demangle_test("_ZN10foo$u$$LT$E", "foo$u$<"),
 	mu_demangle_test("_ZN3foo17h05af221e174051e9E", "foo::h05af221e174051e9"),
 	mu_demangle_test("_ZN3fooE", "foo"),
 	mu_demangle_test("_ZN3foo3barE", "foo::bar"),
@@ -86,6 +89,11 @@ mu_demangle_tests(rust,
 	mu_demangle_test("_RNvMINtC7mycrate3FoomE3foo", NULL),
 	mu_demangle_test("_RNvNtCs1234_7mycrate3foo3bar", "mycrate[3c1c0]::foo::bar"),
 	mu_demangle_test("_RNvNtNtC7mycrateu8gdel_5qa6escher4bach", "mycrate::gödel::escher::bach"),
+	mu_demangle_test("_RNvNtNtC7mycrateu7gdel_5q6escher4bach", NULL),
+	mu_demangle_test("_RNvNtC7mycrateu7gdel_5q4bach", NULL),
+	mu_demangle_test("_RNvC7mycrateu10wgv71a119e", "mycrate::日本語"),
+	mu_demangle_test("_RNvNtC7mycrateu7ao_siapu9b1agh1afp", "mycrate::ação::привет"),
+	mu_demangle_test("_RNvC7mycrateu3_", NULL),
 	mu_demangle_test("_RNvNtNtCs1234_7mycrate3foo3bar3baz", "mycrate[3c1c0]::foo::bar::baz"),
 	mu_demangle_test("_RNvNvCs1234_7mycrate4QUUX3FOO", "mycrate[3c1c0]::QUUX::FOO"),
 	mu_demangle_test("_RNvNvMCs1234_7mycrateINtCs1234_7mycrate3FoopE3bar4QUUX", "<mycrate[3c1c0]::Foo<_>>::bar::QUUX"),
@@ -104,6 +112,8 @@ mu_demangle_tests(rust,
 	mu_demangle_test("_RNvMsr_NtCs3ssYzQotkvD_3std4pathNtB5_7PathBuf3newCs15kBYyAo9fc_7mycrate", "<std[284a76a8b41a7fd3]::path::PathBuf>::new"),
 	mu_demangle_test("_RINvCs7qp2U7fqm6G_7mycrate7exampleNtB2_7ExampleBw_EB2_", "mycrate[567e63b0a19c5b38]::example::<mycrate[567e63b0a19c5b38]::Example, mycrate[567e63b0a19c5b38]::Example>"),
 	mu_demangle_test("_RNvCs15kBYyAo9fc_7mycrate7example", "mycrate[ca63f166dbe9294]::example"),
+	mu_demangle_test("_RINvC3foo3barTuuETBb_Bb_ETBf_Bf_EE", "foo::bar::<((), ()), (((), ()), ((), ())), ((((), ()), ((), ())), (((), ()), ((), ())))>"),
+	mu_demangle_test("_RINvC1a1fFG0_RL1_hEuFG1_Bb_EuFG0_Bb_EuE", "a::f::<for<'a, 'b> fn(&'a u8), for<'a, 'b, 'c> fn(&'b u8), for<'a, 'b> fn(&'a u8)>"),
 	// end
 );
 
@@ -86,6 +86,36 @@ mu_demangle_tests(swift,
 	mu_demangle_test("__TMSS", "Swift.String.init (..metadata"),
 	mu_demangle_test("__TZvOs7Process11_unsafeArgvGSpGSpVs4Int8__", "Process._unsafeArgv"),
 	mu_demangle_test("__TZvOs7Process5_argcVs5Int32", "Process._argc"),
+	mu_demangle_test("$s4main3FooV", "main.Foo"),
+	mu_demangle_test("$s4main3addyS2i_SitF", "main.add(Int, Int) -> Int"),
+	mu_demangle_test("_$s4main3FooV3baryyF", "main.Foo.bar() -> ()"),
+	mu_demangle_test("$s4main3FooC5valueSivg", "main.Foo.value.getter : Int"),
+	mu_demangle_test("$s4main3FooCACycfc", "main.Foo.init() -> main.Foo"),
+	mu_demangle_test("$s4main3FooCfD", "main.Foo.__deallocating_deinit"),
+	mu_demangle_test("$s4main3FooVMa", "type metadata accessor for main.Foo"),
+	mu_demangle_test("$s4main3FooVMn", "nominal type descriptor for main.Foo"),
+	mu_demangle_test("$s4main3FooVN", "type metadata for main.Foo"),
+	mu_demangle_test("$s4main3fooyyxSQRzlF", "main.foo<A where A: Equatable>(A) -> ()"),
+	mu_demangle_test("$s4main3FooVSQAAMc", "protocol conformance descriptor for main.Foo : Equatable in main"),
+	mu_demangle_test("$s4main1f1xySi_tF", "main.f(x: Int) -> ()"),
+	mu_demangle_test("$ss5print_9separator10terminatoryypd_S2StF", "print(_: Any..., separator: String, terminator: String) -> ()"),
+	mu_demangle_test("$sSo5GizmoC11doSomethingyypSgSaySSGSgFTO", "@nonobjc Gizmo.doSomething([String]?) -> Any?"),
+	mu_demangle_test("$s4main1fSiyYaKF", "main.f() async throws -> Int"),
+	mu_demangle_test("$s4main3fooyyFyycfU_", "closure #1 () -> () in main.foo() -> ()"),
+	mu_demangle_test("$s4main3FooV2eeoiySbAC_ACtFZ", "static main.Foo.== infix(main.Foo, main.Foo) -> Bool"),
+	mu_demangle_test("$s4main3fooyySi_tFfA_", "default argument 0 of main.foo(Int) -> ()"),
+	mu_demangle_test("$s4main3FooVySiSicig", "main.Foo.subscript.getter : (Int) -> Int"),
+	mu_demangle_test("$s4main3FooVAA8ProtocolA2aDP3fooyyFTW", "protocol witness for main.Protocol.foo() -> () in conformance main.Foo : main.Protocol in main"),
+	mu_demangle_test("$s4main3fooyyxAA1PRzlFSi_Tg5", "generic specialization <Int> of main.foo<A where A: main.P>(A) -> ()"),
+	mu_demangle_test("$s4main3Foo33_0123456789ABCDEF0123456789ABCDEFLLV", "main.Foo"),
+	mu_demangle_test("$s4main7MyClassC11doSomething4withySS_tF", "main.MyClass.doSomething(with: String) -> ()"),
+	mu_demangle_test("$sSS4mainE5helloSSvg", "String.hello.getter : String"),
+	mu_demangle_test("$s4main3fooyyF.cold", "main.foo() -> () with unmangled suffix \".cold\""),
+	mu_demangle_test("$s.cold", NULL),
+	mu_demangle_test("$sTO", NULL),
+	mu_demangle_test("$sTo", NULL),
+	mu_demangle_test("$s4main3foo", NULL),
+	mu_demangle_test("$s4main3fooyyF00", NULL),
 	// end
 );
 
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "rz-minunit.h"
+#include "rz_libdemangle.h"
+
+typedef struct {
+	size_t calls; ///< number of calls made to the allocator
+	size_t live; ///< number of blocks not yet released
+} CountingAllocator;
+
+static void *counting_malloc(void *user, size_t size) {
+	CountingAllocator *counter = user;
+	counter->calls++;
+	counter->live++;
+	return malloc(size);
+}
+
+static void *counting_calloc(void *user, size_t count, size_t size) {
+	CountingAllocator *counter = user;
+	counter->calls++;
+	counter->live++;
+	return calloc(count, size);
+}
+
+static void *counting_realloc(void *user, void *ptr, size_t size) {
+	CountingAllocator *counter = user;
+	counter->calls++;
+	counter->live += ptr ? 0 : 1;
+	return realloc(ptr, size);
+}
+
+static void counting_free(void *user, void *ptr) {
+	CountingAllocator *counter = user;
+	counter->calls++;
+	counter->live--;
+	free(ptr);
+}
+
+typedef char *(*DemangleHandler)(const char *symbol, RzDemangleOpts opts);
+
+static const struct {
+	DemangleHandler handler;
+	const char *symbol;
+} symbols[] = {
+	{ libdemangle_handler_cxx, "_ZN4base8internal13FunctorTraitsIPFvvEvE6InvokeIJEEEvS3_DpOT_" },
+	{ libdemangle_handler_cxx, "@Foo@bar$qv" },
+	{ libdemangle_handler_msvc, "?public_func@TEST_CLASS@@QEAAHXZ" },
+	{ libdemangle_handler_rust, "_RNvCs1234_7mycrate3foo" },
+	{ libdemangle_handler_rust, "_ZN4core3fmt9Formatter3pad17h1234567890abcdefE" },
+	{ libdemangle_handler_d, "_D3foo3barFiZv" },
+	{ libdemangle_handler_java, "Ljava/lang/String;" },
+	{ libdemangle_handler_objc, "-[NSObject init]" },
+	{ libdemangle_handler_pascal, "OUTPUT_$$_SQUARE$SMALLINT$$SMALLINT" },
+};
+
+bool test_alloc_custom_allocator(void) {
+	CountingAllocator counter = { 0 };
+	RzDemangleAllocator allocator = {
+		.malloc = counting_malloc,
+		.calloc = counting_calloc,
+		.realloc = counting_realloc,
+		.free = counting_free,
+		.user = &counter,
+	};
+	libdemangle_set_allocator(&allocator);
+	for (size_t i = 0; i < sizeof(symbols) / sizeof(symbols[0]); i++) {
+		char *res = symbols[i].handler(symbols[i].symbol, RZ_DEMANGLE_OPT_ENABLE_ALL);
+		mu_assert_notnull(res, symbols[i].symbol);
+		libdemangle_free(res);
+	}
+	libdemangle_set_allocator(NULL);
+
+	mu_assert_true(counter.calls > 0, "allocator is used");
+	mu_assert_true(counter.live == 0, "every allocation is released through the allocator");
+	mu_end;
+}
+
+bool test_alloc_thread_allocator(void) {
+	CountingAllocator counter = { 0 };
+	RzDemangleAllocator allocator = {
+		.malloc = counting_malloc,
+		.calloc = counting_calloc,
+		.realloc = counting_realloc,
+		.free = counting_free,
+		.user = &counter,
+	};
+	const RzDemangleAllocator *previous = libdemangle_set_thread_allocator(&allocator);
+	mu_assert_null(previous, "no thread allocator by default");
+	char *res = libdemangle_handler_cxx("_ZN3foo3barEv", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_streq("foo::bar()", res, "demangled with the thread allocator");
+	libdemangle_free(res);
+	mu_assert_ptreq(libdemangle_set_thread_allocator(previous), &allocator, "previous allocator is returned");
+
+	mu_assert_true(counter.calls > 0, "allocator is used");
+	mu_assert_true(counter.live == 0, "every allocation is released through the allocator");
+	mu_end;
+}
+
+bool test_alloc_stats(void) {
+	RzDemangleAllocStats stats;
+	libdemangle_stats_enable(true);
+	libdemangle_stats_reset();
+	char *res = libdemangle_handler_cxx("_ZN4base8internal13FunctorTraitsIPFvvEvE6InvokeIJEEEvS3_DpOT_", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(res, "demangled");
+	libdemangle_stats_get(&stats);
+	mu_assert_true(stats.allocations > 0, "allocations are counted");
+	mu_assert_true(stats.bytes >= strlen(res) + 1, "bytes are counted");
+	mu_assert_true(stats.peak >= stats.live, "peak is at least the live size");
+	mu_assert_true(stats.live >= strlen(res) + 1, "the result is still alive");
+
+	libdemangle_free(res);
+	libdemangle_stats_get(&stats);
+	mu_assert_true(stats.live == 0, "nothing is leaked");
+	mu_assert_true(stats.frees > 0, "frees are counted");
+
+	libdemangle_stats_reset();
+	libdemangle_stats_get(&stats);
+	mu_assert_true(stats.allocations == 0, "reset clears the counters");
+	mu_assert_true(stats.peak == 0, "reset clears the peak");
+	libdemangle_stats_enable(false);
+	mu_end;
+}
+
+bool test_alloc_rejected_rust(void) {
+	RzDemangleAllocStats stats;
+	libdemangle_stats_enable(true);
+	libdemangle_stats_reset();
+	mu_assert_null(libdemangle_handler_rust("_Rq3foo", RZ_DEMANGLE_OPT_ENABLE_ALL), "invalid v0 path");
+	mu_assert_null(libdemangle_handler_rust("_R", RZ_DEMANGLE_OPT_ENABLE_ALL), "empty v0 symbol");
+	mu_assert_null(libdemangle_handler_rust("main", RZ_DEMANGLE_OPT_ENABLE_ALL), "not a rust symbol");
+	libdemangle_stats_get(&stats);
+	mu_assert_true(stats.allocations == 0, "rejected symbols do not allocate");
+	libdemangle_stats_enable(false);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_alloc_custom_allocator);
+	mu_run_test(test_alloc_thread_allocator);
+	mu_run_test(test_alloc_stats);
+	mu_run_test(test_alloc_rejected_rust);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
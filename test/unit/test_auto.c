@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "rz-minunit.h"
+#include "rz_libdemangle.h"
+
+static const struct {
+	const char *symbol;
+	RzDemangleScheme scheme;
+} classified[] = {
+	{ "_ZN4base8internal13FunctorTraitsIPFvvEvE6InvokeIJEEEvS3_DpOT_", RZ_DEMANGLE_SCHEME_CXX },
+	{ "__Z3fooi", RZ_DEMANGLE_SCHEME_CXX },
+	{ "_ZN3foo3barE", RZ_DEMANGLE_SCHEME_CXX },
+	{ "overloadargs__Fii", RZ_DEMANGLE_SCHEME_CXX },
+	{ "_vt$foo", RZ_DEMANGLE_SCHEME_CXX },
+	{ "_ZN5alloc3oom3oom17h722648b727b8bcd0E", RZ_DEMANGLE_SCHEME_RUST_LEGACY },
+	{ "_ZN8$RF$testE", RZ_DEMANGLE_SCHEME_RUST_LEGACY },
+	{ "_RNvNtCs1234_7mycrate3bar3foo", RZ_DEMANGLE_SCHEME_RUST_V0 },
+	{ "?public_func@TEST_CLASS@@QEAAHXZ", RZ_DEMANGLE_SCHEME_MSVC },
+	{ ".?AVtype_info@@", RZ_DEMANGLE_SCHEME_MSVC },
+	{ "@Foo@bar$qv", RZ_DEMANGLE_SCHEME_BORLAND },
+	{ "_D3foo3barFiZv", RZ_DEMANGLE_SCHEME_D },
+	{ "$s4main3FooV", RZ_DEMANGLE_SCHEME_SWIFT },
+	{ "_$s4main3FooVMn", RZ_DEMANGLE_SCHEME_SWIFT },
+	{ "__TFV4main7Balanceg5widthSd", RZ_DEMANGLE_SCHEME_SWIFT },
+	{ "Ljava/lang/String;", RZ_DEMANGLE_SCHEME_JAVA },
+	{ "[I", RZ_DEMANGLE_SCHEME_JAVA },
+	{ "Lsome/random/Class;.myMethod([F)I", RZ_DEMANGLE_SCHEME_JAVA },
+	{ "_OBJC_CLASS_$_Employee", RZ_DEMANGLE_SCHEME_OBJC },
+	{ "-[class1 method2:arg2:]", RZ_DEMANGLE_SCHEME_OBJC },
+	{ "___32+[XPCAgentServer sharedInstance]_block_invoke", RZ_DEMANGLE_SCHEME_OBJC },
+	{ "OUTPUT_$$_SQUARE$SMALLINT$$SMALLINT", RZ_DEMANGLE_SCHEME_PASCAL },
+	{ "main", RZ_DEMANGLE_SCHEME_UNKNOWN },
+	{ "", RZ_DEMANGLE_SCHEME_UNKNOWN },
+	{ NULL, RZ_DEMANGLE_SCHEME_UNKNOWN },
+};
+
+bool test_auto_classify(void) {
+	for (size_t i = 0; i < sizeof(classified) / sizeof(classified[0]); i++) {
+		const char *symbol = classified[i].symbol;
+		mu_assert_true(libdemangle_classify(symbol) == classified[i].scheme, symbol ? symbol : "NULL");
+	}
+	mu_end;
+}
+
+bool test_auto_demangle(void) {
+	RzDemangleScheme scheme = RZ_DEMANGLE_SCHEME_MAX;
+	mu_assert_streq_free(libdemangle_auto("_ZN5alloc3oom3oom17h722648b727b8bcd0E", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "alloc::oom::oom::h722648b727b8bcd0", "rust legacy");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_RUST_LEGACY, "rust legacy scheme");
+	mu_assert_streq_free(libdemangle_auto("_ZN4$RP$E", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), ")", "rust escapes");
+	mu_assert_streq_free(libdemangle_auto("?public_func@TEST_CLASS@@QEAAHXZ", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "public: int __cdecl TEST_CLASS::public_func(void) __ptr64", "msvc");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_MSVC, "msvc scheme");
+	mu_assert_streq_free(libdemangle_auto("_D3foo3barFiZv", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "void foo.bar(int)", "d");
+	mu_assert_streq_free(libdemangle_auto("Ljava/lang/String;", RZ_DEMANGLE_OPT_BASE, &scheme), "java.lang.String", "java");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_JAVA, "java scheme");
+#if WITH_SWIFT_DEMANGLER
+	mu_assert_streq_free(libdemangle_auto("_$s4main3addyS2i_SitF", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "main.add(Int, Int) -> Int", "swift 5");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_SWIFT, "swift 5 scheme");
+#endif
+	mu_assert_streq_free(libdemangle_auto("OUTPUT_$$_init", RZ_DEMANGLE_OPT_ENABLE_ALL, NULL), "unit output init()", "pascal");
+
+	mu_assert_null(libdemangle_auto("main", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "plain name");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_UNKNOWN, "plain name scheme");
+	mu_assert_null(libdemangle_auto(NULL, RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "NULL symbol");
+	mu_end;
+}
+
+bool test_auto_gnu_v2(void) {
+	// the GNU v2 fallback of the C++ handler is opt-in, the classifier is not.
+	const RzDemangleOpts opts[] = { RZ_DEMANGLE_OPT_BASE, RZ_DEMANGLE_OPT_SIMPLIFY, RZ_DEMANGLE_OPT_ENABLE_ALL };
+	for (size_t i = 0; i < sizeof(opts) / sizeof(opts[0]); i++) {
+		RzDemangleScheme scheme = RZ_DEMANGLE_SCHEME_MAX;
+		mu_assert_streq_free(libdemangle_auto("overloadargs__Fii", opts[i], &scheme), "overloadargs(int, int)", "function");
+		mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_CXX, "function scheme");
+		mu_assert_streq_free(libdemangle_auto("__10ostrstream", opts[i], &scheme), "ostrstream::ostrstream(void)", "constructor");
+		mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_CXX, "constructor scheme");
+
+		RzDemangleBatch *batch = libdemangle_batch_new(1, opts[i]);
+		mu_assert_notnull(batch, "batch");
+		mu_assert_streq_free(libdemangle_batch_demangle(batch, "overloadargs__Fii", NULL), "overloadargs(int, int)", "batch sample");
+		mu_assert_streq_free(libdemangle_batch_demangle(batch, "__10ostrstream", NULL), "ostrstream::ostrstream(void)", "batch");
+		libdemangle_batch_free(batch);
+	}
+	mu_end;
+}
+
+bool test_auto_fallback(void) {
+	// `$` classifies it as rust legacy, but only C++ accepts the template.
+	RzDemangleScheme scheme = RZ_DEMANGLE_SCHEME_MAX;
+	mu_assert_streq_free(libdemangle_auto("_ZN3fooIiE3$a$Ev", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "foo<int>::$a$()", "fallback to C++");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_CXX, "fallback scheme");
+
+	// C++ first, rust legacy when C++ fails.
+	mu_assert_streq_free(libdemangle_auto("_ZN4testE.llvm moocow", RZ_DEMANGLE_OPT_ENABLE_ALL, &scheme), "test (.llvm moocow)", "nested name");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_CXX, "nested name scheme");
+	mu_end;
+}
+
+bool test_auto_batch_rust(void) {
+	RzDemangleBatch *batch = libdemangle_batch_new(2, RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(batch, "batch");
+	RzDemangleScheme scheme = RZ_DEMANGLE_SCHEME_MAX;
+	mu_assert_streq_free(libdemangle_batch_demangle(batch, "_ZN5alloc3oom3oom17h722648b727b8bcd0E", &scheme), "alloc::oom::oom::h722648b727b8bcd0", "first sample");
+	mu_assert_streq_free(libdemangle_batch_demangle(batch, "_RNvNtCs1234_7mycrate3bar3foo", &scheme), "mycrate::bar::foo", "second sample");
+
+	// without hash nor escapes this is C++ first, unless the table says otherwise.
+	mu_assert_streq_free(libdemangle_auto("_ZN3fooE.llvm.9D1C9369", RZ_DEMANGLE_OPT_ENABLE_ALL, NULL), "foo (.9D1C9369)", "auto");
+	mu_assert_streq_free(libdemangle_batch_demangle(batch, "_ZN3fooE.llvm.9D1C9369", &scheme), "foo", "voted");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_RUST_LEGACY, "voted scheme");
+
+	RzDemangleBatchStats stats = { 0 };
+	libdemangle_batch_stats(batch, &stats);
+	mu_assert_true(stats.symbols == 3 && stats.demangled == 3 && stats.sampled == 2, "batch counters");
+	mu_assert_true(stats.votes[RZ_DEMANGLE_SCHEME_RUST_LEGACY] == 1 && stats.votes[RZ_DEMANGLE_SCHEME_RUST_V0] == 1, "votes");
+	mu_assert_true(stats.attempts[RZ_DEMANGLE_SCHEME_RUST_LEGACY] == 2 && stats.successes[RZ_DEMANGLE_SCHEME_RUST_LEGACY] == 2, "rust legacy attempts");
+	mu_assert_true(stats.attempts[RZ_DEMANGLE_SCHEME_CXX] == 0, "no C++ attempts");
+	libdemangle_batch_free(batch);
+	mu_end;
+}
+
+bool test_auto_batch_cxx(void) {
+	RzDemangleBatch *batch = libdemangle_batch_new(1, RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(batch, "batch");
+	RzDemangleScheme scheme = RZ_DEMANGLE_SCHEME_MAX;
+	mu_assert_streq_free(libdemangle_batch_demangle(batch, "_Z3fooi", &scheme), "foo(int)", "sample");
+
+	// rust legacy got no vote: C++ goes first and rust is never tried.
+	mu_assert_streq_free(libdemangle_batch_demangle(batch, "_ZN3fooIiE3$a$Ev", &scheme), "foo<int>::$a$()", "escapes");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_CXX, "escapes scheme");
+	mu_assert_null(libdemangle_batch_demangle(batch, "_ZNfoo", &scheme), "invalid");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_UNKNOWN, "invalid scheme");
+
+	RzDemangleBatchStats stats = { 0 };
+	libdemangle_batch_stats(batch, &stats);
+	mu_assert_true(stats.symbols == 3 && stats.demangled == 2, "batch counters");
+	mu_assert_true(stats.attempts[RZ_DEMANGLE_SCHEME_CXX] == 3 && stats.successes[RZ_DEMANGLE_SCHEME_CXX] == 2, "C++ attempts");
+	mu_assert_true(stats.attempts[RZ_DEMANGLE_SCHEME_RUST_LEGACY] == 0, "no rust attempts");
+	libdemangle_batch_free(batch);
+
+	mu_assert_null(libdemangle_batch_demangle(NULL, "_Z3fooi", NULL), "NULL batch");
+	libdemangle_batch_free(NULL);
+	mu_end;
+}
+
+bool test_auto_batch_unmangled(void) {
+	RzDemangleBatch *batch = libdemangle_batch_new(2, RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(batch, "batch");
+	RzDemangleScheme scheme = RZ_DEMANGLE_SCHEME_MAX;
+	const char *plain[] = { "main", "printf", "_start", "memcpy" };
+	for (size_t i = 0; i < sizeof(plain) / sizeof(plain[0]); i++) {
+		mu_assert_null(libdemangle_batch_demangle(batch, plain[i], &scheme), plain[i]);
+	}
+
+	// plain names do not vote, so the C++ fallback is still tried.
+	mu_assert_streq_free(libdemangle_batch_demangle(batch, "_ZN3fooIiE3$a$Ev", &scheme), "foo<int>::$a$()", "fallback");
+	mu_assert_true(scheme == RZ_DEMANGLE_SCHEME_CXX, "fallback scheme");
+
+	RzDemangleBatchStats stats = { 0 };
+	libdemangle_batch_stats(batch, &stats);
+	mu_assert_true(stats.symbols == 5 && stats.demangled == 1 && stats.sampled == 1, "batch counters");
+	mu_assert_true(stats.votes[RZ_DEMANGLE_SCHEME_UNKNOWN] == 0 && stats.votes[RZ_DEMANGLE_SCHEME_RUST_LEGACY] == 1, "votes");
+	libdemangle_batch_free(batch);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_auto_classify);
+	mu_run_test(test_auto_demangle);
+	mu_run_test(test_auto_gnu_v2);
+	mu_run_test(test_auto_fallback);
+	mu_run_test(test_auto_batch_rust);
+	mu_run_test(test_auto_batch_cxx);
+	mu_run_test(test_auto_batch_unmangled);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
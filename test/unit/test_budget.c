@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "rz-minunit.h"
+#include "rz_libdemangle.h"
+
+typedef char *(*DemangleHandler)(const char *symbol, RzDemangleOpts opts);
+
+static const struct {
+	DemangleHandler handler;
+	const char *symbol;
+	const char *expected;
+} symbols[] = {
+	{ libdemangle_handler_cxx, "_ZN4base8internal13FunctorTraitsIPFvvEvE6InvokeIJEEEvS3_DpOT_", "void base::internal::FunctorTraits<void (*)(), void>::Invoke<>(void (*)())" },
+	{ libdemangle_handler_cxx, "overloadargs__Fii", "overloadargs(int, int)" },
+	{ libdemangle_handler_msvc, "?public_func@TEST_CLASS@@QEAAHXZ", "public: int __cdecl TEST_CLASS::public_func(void) __ptr64" },
+	{ libdemangle_handler_rust, "_RNvNtCs1234_7mycrate3bar3foo", "mycrate::bar::foo" },
+	{ libdemangle_handler_d, "_D3foo3barFiZv", "void foo.bar(int)" },
+};
+
+static bool check_all(const RzDemangleBudget *budget, RzDemangleStatus status) {
+	libdemangle_set_budget(budget);
+	for (size_t i = 0; i < sizeof(symbols) / sizeof(symbols[0]); i++) {
+		char *res = symbols[i].handler(symbols[i].symbol, RZ_DEMANGLE_OPT_ENABLE_ALL);
+		if (status == RZ_DEMANGLE_STATUS_OK) {
+			mu_assert_streq_free(res, symbols[i].expected, symbols[i].symbol);
+		} else {
+			mu_assert_null(res, symbols[i].symbol);
+		}
+		mu_assert_true(libdemangle_last_status() == status, symbols[i].symbol);
+	}
+	libdemangle_set_budget(NULL);
+	return true;
+}
+
+bool test_budget_unlimited(void) {
+	RzDemangleBudget budget = { 0 };
+	mu_assert_true(check_all(&budget, RZ_DEMANGLE_STATUS_OK), "no limits");
+	mu_assert_true(check_all(NULL, RZ_DEMANGLE_STATUS_OK), "default budget");
+	mu_end;
+}
+
+bool test_budget_steps(void) {
+	RzDemangleBudget budget = { .max_steps = 1 };
+	mu_assert_true(check_all(&budget, RZ_DEMANGLE_STATUS_BUDGET_EXCEEDED), "step limit");
+	mu_end;
+}
+
+bool test_budget_output(void) {
+	RzDemangleBudget budget = { .max_output = 8 };
+	mu_assert_true(check_all(&budget, RZ_DEMANGLE_STATUS_BUDGET_EXCEEDED), "output limit");
+	mu_end;
+}
+
+bool test_budget_nodes(void) {
+	RzDemangleBudget budget = { .max_nodes = 16 };
+	libdemangle_set_budget(&budget);
+	char *res = libdemangle_handler_cxx("_ZN4base8internal13FunctorTraitsIPFvvEvE6InvokeIJEEEvS3_DpOT_", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_null(res, "too many AST nodes");
+	mu_assert_true(libdemangle_last_status() == RZ_DEMANGLE_STATUS_BUDGET_EXCEEDED, "status of the node limit");
+
+	// the budget is per call, a short symbol still fits
+	res = libdemangle_handler_cxx("_Z1fv", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_streq_free(res, "f()", "budget is reset on each call");
+	mu_assert_true(libdemangle_last_status() == RZ_DEMANGLE_STATUS_OK, "status of a call within the budget");
+	libdemangle_set_budget(NULL);
+	mu_end;
+}
+
+bool test_budget_failure(void) {
+	char *res = libdemangle_handler_cxx("main", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_null(res, "not a mangled symbol");
+	mu_assert_true(libdemangle_last_status() == RZ_DEMANGLE_STATUS_FAILED, "a plain failure is not a budget failure");
+	mu_end;
+}
+
+bool test_budget_backref_blowup(void) {
+	// each tuple refers twice to the previous one: about 25MB of output without a budget
+	const char *symbol = "_RINvC3foo3barTuuETBb_Bb_ETBf_Bf_ETBn_Bn_ETBv_Bv_ETBD_BD_ETBL_BL_ETBT_BT_ETB11_B11_ETB19_B19_ETB1j_B1j_"
+			     "ETB1t_B1t_ETB1D_B1D_ETB1N_B1N_ETB1X_B1X_ETB27_B27_ETB2h_B2h_ETB2r_B2r_ETB2B_B2B_ETB2L_B2L_ETB2V_B2V_EE";
+	RzDemangleBudget budget = { .max_output = 1 << 16 };
+	libdemangle_set_budget(&budget);
+	char *res = libdemangle_handler_rust(symbol, RZ_DEMANGLE_OPT_ENABLE_ALL);
+	libdemangle_set_budget(NULL);
+	mu_assert_null(res, "the expansion is stopped");
+	mu_assert_true(libdemangle_last_status() == RZ_DEMANGLE_STATUS_BUDGET_EXCEEDED, "status of the expansion");
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_budget_unlimited);
+	mu_run_test(test_budget_steps);
+	mu_run_test(test_budget_output);
+	mu_run_test(test_budget_nodes);
+	mu_run_test(test_budget_failure);
+	mu_run_test(test_budget_backref_blowup);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
@@ -69,9 +69,54 @@ bool test_template_param_scope_double_free(void) {
 	mu_end;
 }
 
+/**
+ * The GNU v2 and bare type fallbacks of cp_demangle() only run when
+ * requested, and GNU v2 only for symbols that can be v2 encodings.
+ */
+bool test_fallbacks_opt_in(void) {
+	mu_assert_true(cp_demangle_v2_plausible("overloadargs__Fii"), "v2 function");
+	mu_assert_true(cp_demangle_v2_plausible("_vt$foo"), "v2 virtual table");
+	mu_assert_true(cp_demangle_v2_plausible("_$_3foo"), "v2 destructor");
+	mu_assert_true(cp_demangle_v2_plausible("_3foo$varname"), "v2 static member");
+	mu_assert_true(!cp_demangle_v2_plausible("main"), "plain name");
+	mu_assert_true(!cp_demangle_v2_plausible("_start"), "plain name with underscore");
+
+	mu_assert_null(libdemangle_handler_cxx("overloadargs__Fii", RZ_DEMANGLE_OPT_BASE), "v2 disabled");
+	mu_assert_streq_free(libdemangle_handler_cxx("overloadargs__Fii", RZ_DEMANGLE_OPT_CXX_V2_FALLBACK), "overloadargs(int, int)", "v2 enabled");
+	mu_assert_null(libdemangle_handler_cxx("PKc", RZ_DEMANGLE_OPT_CXX_V2_FALLBACK), "type disabled");
+	mu_assert_streq_free(libdemangle_handler_cxx("PKc", RZ_DEMANGLE_OPT_CXX_TYPE_FALLBACK), "char const*", "type enabled");
+	mu_assert_streq_free(libdemangle_handler_cxx("PKc", RZ_DEMANGLE_OPT_ENABLE_ALL), "char const*", "enabled by all");
+	mu_assert_streq_free(libdemangle_handler_cxx("_Z3fooi", RZ_DEMANGLE_OPT_BASE), "foo(int)", "itanium");
+	mu_assert_null(libdemangle_handler_cxx(NULL, RZ_DEMANGLE_OPT_ENABLE_ALL), "NULL symbol");
+	mu_end;
+}
+
+bool test_plain_c_names(void) {
+	mu_assert_true(cp_demangle_v2_plausible("__10ostrstream"), "v2 constructor");
+	mu_assert_true(cp_demangle_v2_plausible("__aa__3fooRT0"), "v2 operator");
+	mu_assert_true(cp_demangle_v2_plausible("__tf3foo"), "v2 type info");
+	mu_assert_true(!cp_demangle_v2_plausible("__libc_start_main"), "reserved C name");
+	mu_assert_true(!cp_demangle_v2_plausible("_3foo"), "static member without term");
+	mu_assert_true(!cp_demangle_v2_plausible("memcpy"), "C function");
+
+	mu_assert_true(cp_demangle_v3_type_plausible("i"), "builtin type");
+	mu_assert_true(cp_demangle_v3_type_plausible("PKc"), "pointer type");
+	mu_assert_true(cp_demangle_v3_type_plausible("3foo"), "class type");
+	mu_assert_true(!cp_demangle_v3_type_plausible("main"), "lowercase name");
+	mu_assert_true(!cp_demangle_v3_type_plausible("_start"), "underscore name");
+	mu_assert_true(!cp_demangle_v3_type_plausible("P"), "pointer to nothing");
+
+	mu_assert_null(libdemangle_handler_cxx("main", RZ_DEMANGLE_OPT_ENABLE_ALL), "main");
+	mu_assert_null(libdemangle_handler_cxx("__libc_start_main", RZ_DEMANGLE_OPT_ENABLE_ALL), "__libc_start_main");
+	mu_assert_streq_free(libdemangle_handler_cxx("__10ostrstream", RZ_DEMANGLE_OPT_ENABLE_ALL), "ostrstream::ostrstream(void)", "v2 constructor");
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_parse_base36_oob);
 	mu_run_test(test_template_param_scope_double_free);
+	mu_run_test(test_fallbacks_opt_in);
+	mu_run_test(test_plain_c_names);
 
 	return tests_passed != tests_run;
 }
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "rz-minunit.h"
+#include "rz_libdemangle.h"
+
+static const char *dex_symbols[] = {
+	"Lcom/example/Foo;.onCreate(Landroid/os/Bundle;)V",
+	"Lcom/example/Bar;.onCreate(Landroid/os/Bundle;)V",
+	"Lcom/example/Foo;.getName()Ljava/lang/String;",
+	"Lcom/example/Foo;.name.Ljava/lang/String;",
+	"Lcom/example/Foo;.bad(Q)V",
+	"Lcom/example/Bar;.bad(Q)V",
+	"Ljava/util/List<Ljava/lang/String;>;.get(I)Ljava/lang/Object;",
+	"[Ljava/lang/String;",
+};
+
+bool test_java_batch_same_output(void) {
+	RzDemangleJavaBatch *batch = libdemangle_java_batch_new(RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(batch, "batch");
+	for (size_t round = 0; round < 2; round++) {
+		for (size_t i = 0; i < sizeof(dex_symbols) / sizeof(dex_symbols[0]); i++) {
+			char *expected = libdemangle_handler_java(dex_symbols[i], RZ_DEMANGLE_OPT_ENABLE_ALL);
+			char *actual = libdemangle_java_batch_demangle(batch, dex_symbols[i]);
+			if (expected) {
+				mu_assert_streq_free(actual, expected, dex_symbols[i]);
+			} else {
+				mu_assert_null(actual, dex_symbols[i]);
+			}
+			free(expected);
+		}
+	}
+	libdemangle_java_batch_free(batch);
+	mu_end;
+}
+
+bool test_java_batch_interning(void) {
+	RzDemangleJavaBatch *batch = libdemangle_java_batch_new(RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(batch, "batch");
+	mu_assert_streq_free(libdemangle_java_batch_demangle(batch, dex_symbols[0]), "void com.example.Foo.onCreate(android.os.Bundle)", "first proto");
+	mu_assert_streq_free(libdemangle_java_batch_demangle(batch, dex_symbols[1]), "void com.example.Bar.onCreate(android.os.Bundle)", "same proto");
+	mu_assert_streq_free(libdemangle_java_batch_demangle(batch, dex_symbols[2]), "String com.example.Foo.getName()", "same owner");
+	mu_assert_streq_free(libdemangle_java_batch_demangle(batch, dex_symbols[3]), "com.example.Foo.name:String", "field");
+	mu_assert_null(libdemangle_java_batch_demangle(batch, dex_symbols[4]), "invalid proto");
+	mu_assert_null(libdemangle_java_batch_demangle(batch, dex_symbols[5]), "invalid proto, interned");
+
+	RzDemangleJavaBatchStats stats = { 0 };
+	libdemangle_java_batch_stats(batch, &stats);
+	mu_assert_true(stats.symbols == 6, "symbols");
+	mu_assert_true(stats.protos == 3 && stats.proto_hits == 2, "protos");
+	// Foo, Bundle, Bar and String; Foo and String are then reused.
+	mu_assert_true(stats.types == 4 && stats.type_hits == 4, "types");
+	libdemangle_java_batch_free(batch);
+
+	mu_assert_null(libdemangle_java_batch_demangle(NULL, dex_symbols[0]), "NULL batch");
+	libdemangle_java_batch_free(NULL);
+	mu_end;
+}
+
+bool test_java_batch_options(void) {
+	// pieces are interned with the options of the batch.
+	RzDemangleJavaBatch *plain = libdemangle_java_batch_new(0);
+	RzDemangleJavaBatch *simple = libdemangle_java_batch_new(RZ_DEMANGLE_OPT_SIMPLIFY);
+	mu_assert_true(plain && simple, "batches");
+	const char *symbol = "Lcom/example/Foo;.getName()Ljava/lang/String;";
+	for (size_t i = 0; i < 2; i++) {
+		mu_assert_streq_free(libdemangle_java_batch_demangle(plain, symbol), "java.lang.String com.example.Foo.getName()", "plain");
+		mu_assert_streq_free(libdemangle_java_batch_demangle(simple, symbol), "String com.example.Foo.getName()", "simplified");
+	}
+	libdemangle_java_batch_free(plain);
+	libdemangle_java_batch_free(simple);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_java_batch_same_output);
+	mu_run_test(test_java_batch_interning);
+	mu_run_test(test_java_batch_options);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "rz-minunit.h"
+#include "rz_libdemangle.h"
+
+/**
+ * The (pointer, length) entry must only look at the first `length` bytes,
+ * as symbols coming from a mapped string table are not NUL terminated.
+ */
+bool test_msvc_view_not_terminated(void) {
+	const char table[] = "?arr@@3PAHA?public_func@TEST_CLASS@@QEAAHXZ";
+	const size_t first = strlen("?arr@@3PAHA");
+
+	char *r = libdemangle_handler_msvc_n(table, first, RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_streq_free(r, "int * arr", "first entry of the table");
+
+	r = libdemangle_handler_msvc_n(table + first, strlen(table + first), RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_streq_free(r, "public: int __cdecl TEST_CLASS::public_func(void) __ptr64", "second entry of the table");
+
+	mu_end;
+}
+
+bool test_msvc_view_invalid(void) {
+	mu_assert_null(libdemangle_handler_msvc_n(NULL, 10, RZ_DEMANGLE_OPT_ENABLE_ALL), "NULL view");
+	mu_assert_null(libdemangle_handler_msvc_n("?arr@@3PAHA", 0, RZ_DEMANGLE_OPT_ENABLE_ALL), "empty view");
+	mu_assert_null(libdemangle_handler_msvc_n("_Z3foov", 7, RZ_DEMANGLE_OPT_ENABLE_ALL), "not a MSVC symbol");
+	mu_end;
+}
+
+bool test_msvc_view_long(void) {
+	// longer than MICROSOFT_SYMBOL_MAX_LEN, takes the heap path.
+	size_t len = 5000;
+	char *sym = malloc(len);
+	mu_assert_notnull(sym, "alloc");
+	memset(sym, 'a', len);
+	sym[0] = '?';
+	char *r = libdemangle_handler_msvc_n(sym, len, RZ_DEMANGLE_OPT_ENABLE_ALL);
+	free(sym);
+	mu_assert_null(r, "names longer than MICROSOFT_NAME_LEN are rejected");
+	mu_end;
+}
+
+bool test_msvc_wide_string_literal(void) {
+	// "N-" is the raw UTF-16BE code unit of U+4E2D
+	char *r = libdemangle_handler_msvc("??_C@_1BK@FIHMCKAM@N-?$AAa?$AAb?$AAc?$AAd?$AAe?$AAf?$AAg?$AAh?$AA@", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_streq_free(r, "`string'::1484532236::\"\xe4\xb8\xad" "abcdefgh\"", "mixed wide literal");
+
+	// surrogate pair, U+1F600
+	r = libdemangle_handler_msvc("??_C@_1BK@FIHMCKAM@\xd8=\xde?$AA?$AA?$AA@", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_streq_free(r, "`string'::1484532236::\"\xf0\x9f\x98\x80\"", "surrogate pair");
+
+	// high surrogate followed by a non low surrogate is invalid
+	r = libdemangle_handler_msvc("??_C@_1BK@FIHMCKAM@\xd8=?$AAa@", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_null(r, "unpaired surrogate");
+	mu_end;
+}
+
+bool test_msvc_no_string_literal(void) {
+	const RzDemangleOpts opts = RZ_DEMANGLE_OPT_ENABLE_ALL | RZ_DEMANGLE_OPT_MSVC_NO_STRING_LITERAL;
+	char *r = libdemangle_handler_msvc("??_C@_1CK@EOPGIILJ@?$AAi?$AAn?$AAv?$AAa?$AAl?$AAi?$AAd?$AA@", opts);
+	mu_assert_streq_free(r, "`string'", "wide literal");
+
+	r = libdemangle_handler_msvc("??_C@_0CL@CODINPLA@Failed?5to?5get?5the?5string?5from?5t@NNGAKEGL@", opts);
+	mu_assert_streq_free(r, "`string'", "narrow literal with trailing hash");
+	mu_end;
+}
+
+bool test_msvc_reduced_output(void) {
+	const char *method = "?public_func@TEST_CLASS@@QEAAHXZ";
+	char *r = libdemangle_handler_msvc(method, RZ_DEMANGLE_OPT_MSVC_NAME_ONLY);
+	mu_assert_streq_free(r, "TEST_CLASS::public_func", "name only");
+	r = libdemangle_handler_msvc("?public_func@TEST_CLASS@@QEAAHX", RZ_DEMANGLE_OPT_MSVC_NAME_ONLY);
+	mu_assert_null(r, "name only of a malformed tail");
+	r = libdemangle_handler_msvc("?public_func@TEST_CLASS@@!", RZ_DEMANGLE_OPT_MSVC_NAME_ONLY);
+	mu_assert_null(r, "name only of an invalid tail");
+
+	r = libdemangle_handler_msvc(method, RZ_DEMANGLE_OPT_MSVC_NO_ACCESS_SPECIFIER);
+	mu_assert_streq_free(r, "int __cdecl TEST_CLASS::public_func(void) __ptr64", "no access specifier");
+
+	r = libdemangle_handler_msvc(method, RZ_DEMANGLE_OPT_MSVC_NO_CALLING_CONVENTION);
+	mu_assert_streq_free(r, "public: int TEST_CLASS::public_func(void) __ptr64", "no calling convention");
+
+	r = libdemangle_handler_msvc(method, RZ_DEMANGLE_OPT_MSVC_NO_RETURN_TYPE);
+	mu_assert_streq_free(r, "public: __cdecl TEST_CLASS::public_func(void) __ptr64", "no return type");
+
+	r = libdemangle_handler_msvc(method, RZ_DEMANGLE_OPT_MSVC_NO_ACCESS_SPECIFIER | RZ_DEMANGLE_OPT_MSVC_NO_CALLING_CONVENTION | RZ_DEMANGLE_OPT_MSVC_NO_RETURN_TYPE);
+	mu_assert_streq_free(r, "TEST_CLASS::public_func(void) __ptr64", "all reductions");
+
+	// conversion operators still need the return type to build the name
+	r = libdemangle_handler_msvc("??B?$ABC@DUDEF@@@@QEBA_NXZ", RZ_DEMANGLE_OPT_MSVC_NAME_ONLY);
+	mu_assert_streq_free(r, "ABC<char, struct DEF>::operator bool", "name only of a conversion operator");
+
+	r = libdemangle_handler_msvc("?instance_@?$StaticStorage@VInProcModule@Details@Platform@@$0A@H@Details@WRL@Microsoft@@0V1234@A", RZ_DEMANGLE_OPT_MSVC_NO_ACCESS_SPECIFIER);
+	mu_assert_streq_free(r, "class Microsoft::WRL::Details::StaticStorage<class Platform::Details::InProcModule, 0, int> Microsoft::WRL::Details::StaticStorage<class Platform::Details::InProcModule, 0, int>::instance_", "static member without access specifier");
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_msvc_view_not_terminated);
+	mu_run_test(test_msvc_view_invalid);
+	mu_run_test(test_msvc_view_long);
+	mu_run_test(test_msvc_wide_string_literal);
+	mu_run_test(test_msvc_no_string_literal);
+	mu_run_test(test_msvc_reduced_output);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests);
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "rz-minunit.h"
+#include "rz_libdemangle.h"
+
+static size_t filter_hits(void) {
+	RzDemangleNegativeStats stats;
+	libdemangle_negative_filter_stats(&stats);
+	return stats.hits;
+}
+
+bool test_negative_disabled(void) {
+	RzDemangleNegativeStats stats;
+	mu_assert_null(libdemangle_handler_cxx("memcpy", RZ_DEMANGLE_OPT_ENABLE_ALL), "plain name");
+	mu_assert_null(libdemangle_handler_cxx("memcpy", RZ_DEMANGLE_OPT_ENABLE_ALL), "plain name again");
+	libdemangle_negative_filter_stats(&stats);
+	mu_assert_true(stats.bits == 0 && stats.hits == 0 && stats.insertions == 0, "disabled by default");
+	mu_end;
+}
+
+bool test_negative_repeated_failures(void) {
+	mu_assert_true(libdemangle_negative_filter_enable(1 << 16), "enable");
+	mu_assert_null(libdemangle_handler_cxx("memcpy", RZ_DEMANGLE_OPT_ENABLE_ALL), "first failure");
+	mu_assert_true(filter_hits() == 0, "first failure is parsed");
+	mu_assert_null(libdemangle_handler_cxx("memcpy", RZ_DEMANGLE_OPT_ENABLE_ALL), "repeated failure");
+	mu_assert_true(filter_hits() == 1, "repeated failure is filtered");
+	mu_assert_true(libdemangle_last_status() == RZ_DEMANGLE_STATUS_FAILED, "status of a filtered call");
+
+	// keys include the language and the options
+	mu_assert_null(libdemangle_handler_cxx("memcpy", RZ_DEMANGLE_OPT_BASE), "other options");
+	mu_assert_null(libdemangle_handler_rust("memcpy", RZ_DEMANGLE_OPT_ENABLE_ALL), "other language");
+	mu_assert_true(filter_hits() == 1, "other keys are parsed");
+
+	mu_assert_null(libdemangle_handler_msvc_n("?foo", 4, RZ_DEMANGLE_OPT_ENABLE_ALL), "msvc failure");
+	mu_assert_null(libdemangle_handler_msvc_n("?foo@@YAXXZ", 4, RZ_DEMANGLE_OPT_ENABLE_ALL), "same msvc prefix");
+	mu_assert_true(filter_hits() == 2, "msvc keys stop at the given length");
+
+	mu_assert_streq_free(libdemangle_handler_cxx("_Z3fooi", RZ_DEMANGLE_OPT_ENABLE_ALL), "foo(int)", "success");
+	mu_assert_streq_free(libdemangle_handler_cxx("_Z3fooi", RZ_DEMANGLE_OPT_ENABLE_ALL), "foo(int)", "success again");
+
+	libdemangle_negative_filter_reset();
+	mu_assert_null(libdemangle_handler_cxx("memcpy", RZ_DEMANGLE_OPT_ENABLE_ALL), "after reset");
+	mu_assert_true(filter_hits() == 0, "reset forgets failures");
+	mu_assert_true(libdemangle_negative_filter_enable(0), "disable");
+	mu_end;
+}
+
+bool test_negative_budget(void) {
+	const char *symbol = "_ZN4base8internal13FunctorTraitsIPFvvEvE6InvokeIJEEEvS3_DpOT_";
+	RzDemangleBudget budget = { .max_steps = 1 };
+	mu_assert_true(libdemangle_negative_filter_enable(1 << 16), "enable");
+	libdemangle_set_budget(&budget);
+	mu_assert_null(libdemangle_handler_cxx(symbol, RZ_DEMANGLE_OPT_ENABLE_ALL), "budget exceeded");
+	libdemangle_set_budget(NULL);
+	mu_assert_streq_free(libdemangle_handler_cxx(symbol, RZ_DEMANGLE_OPT_ENABLE_ALL),
+		"void base::internal::FunctorTraits<void (*)(), void>::Invoke<>(void (*)())", "budget failures are not recorded");
+	mu_assert_true(libdemangle_negative_filter_enable(0), "disable");
+	mu_end;
+}
+
+bool test_negative_saturation(void) {
+	RzDemangleNegativeStats stats;
+	char symbol[32];
+	mu_assert_true(libdemangle_negative_filter_enable(1), "smallest filter");
+	for (int i = 0; i < 64; i++) {
+		snprintf(symbol, sizeof(symbol), "label_%d", i);
+		mu_assert_null(libdemangle_handler_java(symbol, RZ_DEMANGLE_OPT_BASE), symbol);
+	}
+	libdemangle_negative_filter_stats(&stats);
+	mu_assert_true(stats.bits == 512, "rounded size");
+	mu_assert_true(stats.saturations > 0, "cleared when full");
+	mu_assert_true(stats.insertions <= stats.bits / 24, "bounded load");
+	mu_assert_true(libdemangle_negative_filter_enable(0), "disable");
+	mu_end;
+}
+
+static size_t arena_calls;
+
+static void *arena_malloc(void *user, size_t size) {
+	arena_calls++;
+	return malloc(size);
+}
+
+static void *arena_calloc(void *user, size_t count, size_t size) {
+	arena_calls++;
+	return calloc(count, size);
+}
+
+static void *arena_realloc(void *user, void *ptr, size_t size) {
+	arena_calls++;
+	return realloc(ptr, size);
+}
+
+static void arena_free(void *user, void *ptr) {
+	arena_calls++;
+	free(ptr);
+}
+
+bool test_negative_allocator(void) {
+	// the filter outlives the calls, so it never comes from a thread allocator.
+	const RzDemangleAllocator arena = {
+		.malloc = arena_malloc,
+		.calloc = arena_calloc,
+		.realloc = arena_realloc,
+		.free = arena_free,
+	};
+	RzDemangleAllocStats stats;
+	libdemangle_stats_enable(true);
+	libdemangle_stats_reset();
+	libdemangle_set_thread_allocator(&arena);
+	mu_assert_true(libdemangle_negative_filter_enable(1 << 16), "enable");
+	libdemangle_set_thread_allocator(NULL);
+	mu_assert_null(libdemangle_handler_java("label", RZ_DEMANGLE_OPT_BASE), "recorded");
+	mu_assert_null(libdemangle_handler_java("label", RZ_DEMANGLE_OPT_BASE), "filtered");
+	libdemangle_set_thread_allocator(&arena);
+	mu_assert_true(libdemangle_negative_filter_enable(0), "disable");
+	libdemangle_set_thread_allocator(NULL);
+	libdemangle_stats_get(&stats);
+	mu_assert_true(arena_calls == 0, "not from the thread allocator");
+	mu_assert_true(stats.live == 0 && stats.peak < (1 << 16) / 8, "not in the statistics");
+	libdemangle_stats_enable(false);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_negative_disabled);
+	mu_run_test(test_negative_repeated_failures);
+	mu_run_test(test_negative_budget);
+	mu_run_test(test_negative_saturation);
+	mu_run_test(test_negative_allocator);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests);
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "rz-minunit.h"
+#include "rz_libdemangle.h"
+#include <string.h>
+
+static bool span_is(const RzDemangleRustSymbol *sym, size_t index, RzDemangleRustSpanKind kind, size_t depth, const char *text) {
+	if (index >= sym->n_spans) {
+		return false;
+	}
+	const RzDemangleRustSpan *span = &sym->spans[index];
+	return span->kind == kind && span->depth == depth &&
+		span->length == strlen(text) && !strncmp(sym->demangled + span->offset, text, span->length);
+}
+
+bool test_rust_api_spans(void) {
+	RzDemangleRustSymbol *sym = libdemangle_rust_v0_symbol("_RNCNvCsgStHSCytQ6I_7mycrate4main0B3_", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(sym, "closure symbol");
+	mu_assert_streq(sym->demangled, "mycrate::main::{closure#0}", "closure output");
+	mu_assert_true(sym->n_spans == 3, "closure span count");
+	mu_assert_true(span_is(sym, 0, RZ_DEMANGLE_RUST_SPAN_CRATE, 0, "mycrate"), "crate span");
+	mu_assert_true(span_is(sym, 1, RZ_DEMANGLE_RUST_SPAN_SEGMENT, 0, "main"), "segment span");
+	mu_assert_true(span_is(sym, 2, RZ_DEMANGLE_RUST_SPAN_SEGMENT, 0, "{closure#0}"), "closure span");
+	libdemangle_rust_symbol_free(sym);
+
+	sym = libdemangle_rust_v0_symbol("_RNvNtCs1234_7mycrate3bar3foo", RZ_DEMANGLE_OPT_BASE);
+	mu_assert_notnull(sym, "disambiguated symbol");
+	mu_assert_streq(sym->demangled, "mycrate[3c1c0]::bar::foo", "disambiguated output");
+	mu_assert_true(sym->n_spans == 4, "disambiguated span count");
+	mu_assert_true(span_is(sym, 1, RZ_DEMANGLE_RUST_SPAN_DISAMBIGUATOR, 0, "[3c1c0]"), "disambiguator span");
+	libdemangle_rust_symbol_free(sym);
+
+	mu_assert_null(libdemangle_rust_v0_symbol("_ZN3foo3barE", RZ_DEMANGLE_OPT_ENABLE_ALL), "legacy symbol");
+	mu_assert_null(libdemangle_rust_v0_symbol("_RNvC", RZ_DEMANGLE_OPT_ENABLE_ALL), "truncated symbol");
+	libdemangle_rust_symbol_free(NULL);
+	mu_end;
+}
+
+bool test_rust_api_generics(void) {
+	const char *symbol = "_RNvYINtC3std3VecDNtC4core3AnyEL_ENtC3std5Trait4call";
+	RzDemangleRustSymbol *sym = libdemangle_rust_v0_symbol(symbol, RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(sym, "generic symbol");
+	mu_assert_streq(sym->demangled, "<std::Vec<dyn core::Any> as std::Trait>::call", "generic output");
+	mu_assert_true(span_is(sym, 2, RZ_DEMANGLE_RUST_SPAN_GENERIC_ARGS, 0, "<dyn core::Any>"), "generic args span");
+	mu_assert_true(span_is(sym, 3, RZ_DEMANGLE_RUST_SPAN_CRATE, 1, "core"), "nested crate span");
+	mu_assert_true(span_is(sym, 4, RZ_DEMANGLE_RUST_SPAN_SEGMENT, 1, "Any"), "nested segment span");
+	libdemangle_rust_symbol_free(sym);
+
+	sym = libdemangle_rust_v0_symbol("_RINvC1a1fDINtC4core2FnTuEEp6OutputuEL_EB2_", RZ_DEMANGLE_OPT_ENABLE_ALL);
+	mu_assert_notnull(sym, "dyn bindings symbol");
+	mu_assert_streq(sym->demangled, "a::f::<dyn core::Fn<((),), Output = ()>>", "dyn bindings output");
+	mu_assert_true(span_is(sym, 5, RZ_DEMANGLE_RUST_SPAN_GENERIC_ARGS, 1, "<((),), Output = ()>"), "bindings extend the generic args");
+	libdemangle_rust_symbol_free(sym);
+
+	mu_assert_streq_free(libdemangle_handler_rust(symbol, RZ_DEMANGLE_OPT_ENABLE_ALL | RZ_DEMANGLE_OPT_RUST_NO_GENERICS),
+		"<std::Vec as std::Trait>::call", "no generics");
+	mu_assert_streq_free(libdemangle_handler_rust("_RINvC1a1fDINtC4core2FnTuEEp6OutputuEL_EB2_", RZ_DEMANGLE_OPT_RUST_NO_GENERICS),
+		"a::f", "no generics with bindings");
+	mu_end;
+}
+
+bool test_rust_api_backrefs(void) {
+	RzDemangleRustSymbol *sym = libdemangle_rust_v0_symbol("_RINvCs7qp2U7fqm6G_7mycrate7exampleNtB2_7ExampleBw_EB2_", RZ_DEMANGLE_OPT_SIMPLIFY);
+	mu_assert_notnull(sym, "backref symbol");
+	mu_assert_streq(sym->demangled, "mycrate::example::<mycrate::Example, mycrate::Example>", "backref output");
+	mu_assert_true(sym->n_spans == 7, "backref span count");
+	mu_assert_true(span_is(sym, 2, RZ_DEMANGLE_RUST_SPAN_GENERIC_ARGS, 0, "<mycrate::Example, mycrate::Example>"), "generic args span");
+	// the second argument is replayed from the cached expansion of the first one.
+	mu_assert_true(span_is(sym, 5, RZ_DEMANGLE_RUST_SPAN_CRATE, 1, "mycrate"), "replayed crate span");
+	mu_assert_true(span_is(sym, 6, RZ_DEMANGLE_RUST_SPAN_SEGMENT, 1, "Example"), "replayed segment span");
+	mu_assert_true(sym->spans[5].offset > sym->spans[4].offset, "replayed spans are moved");
+	libdemangle_rust_symbol_free(sym);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_rust_api_spans);
+	mu_run_test(test_rust_api_generics);
+	mu_run_test(test_rust_api_backrefs);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)